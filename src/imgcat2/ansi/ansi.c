@@ -41,6 +41,32 @@ void ansi_cursor_up(int lines)
 	fflush(stdout);
 }
 
+/**
+ * @brief Move cursor to a cell
+ */
+void ansi_cursor_move(int row, int col)
+{
+	printf(ANSI_CURSOR_POSITION, row + 1, col + 1);
+	fflush(stdout);
+}
+
+/**
+ * @brief Erase a rectangular area of cells
+ */
+void ansi_clear_area(int row, int col, int width, int height)
+{
+	if (width <= 0 || height <= 0) {
+		return;
+	}
+
+	printf(ANSI_RESET);
+	for (int i = 0; i < height; i++) {
+		printf(ANSI_CURSOR_POSITION ANSI_ERASE_CHARS, row + i + 1, col + 1, width);
+	}
+	printf(ANSI_CURSOR_POSITION, row + 1, col + 1);
+	fflush(stdout);
+}
+
 /**
  * @brief Reset all ANSI attributes
  */
@@ -27,6 +27,12 @@
 /** Move cursor up N lines (format string, use with sprintf) */
 #define ANSI_CURSOR_UP "\x1B[%dA"
 
+/** Move cursor to 1-based row and column (format string: row, col) */
+#define ANSI_CURSOR_POSITION "\x1B[%d;%dH"
+
+/** Erase N characters from the cursor (ECH, format string) */
+#define ANSI_ERASE_CHARS "\x1B[%dX"
+
 /** @} */
 
 /**
@@ -91,6 +97,28 @@ void ansi_cursor_show(void);
  */
 void ansi_cursor_up(int lines);
 
+/**
+ * @brief Move cursor to a cell
+ *
+ * @param row 0-based row
+ * @param col 0-based column
+ */
+void ansi_cursor_move(int row, int col);
+
+/**
+ * @brief Erase a rectangular area of cells
+ *
+ * Erases width cells on each of height rows starting at (row, col),
+ * without moving the rest of the line. Leaves the cursor at the
+ * top-left cell of the area.
+ *
+ * @param row 0-based top row
+ * @param col 0-based left column
+ * @param width Area width in cells
+ * @param height Area height in cells
+ */
+void ansi_clear_area(int row, int col, int width, int height);
+
 /**
  * @brief Reset all ANSI attributes
  *
@@ -2,73 +2,326 @@
  * @file base64.c
  * @brief Base64 encoding implementation
  *
- * Implements RFC 4648 base64 encoding for the iTerm2 inline images protocol.
+ * Implements RFC 4648 base64 encoding for the iTerm2 inline images and
+ * Kitty graphics protocols.
+ *
+ * The bulk of the input is encoded by a SIMD kernel chosen by base64_init():
+ * AVX2 (24 bytes in, 32 characters out per iteration), SSSE3 (12 in,
+ * 16 out) or a scalar loop. The vector kernels use the pshufb/multiply
+ * bit-shuffle and range-lookup technique described by Muła and Lemire.
  */
 
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "base64.h"
 
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define BASE64_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
 /**
  * @brief Base64 encoding table (RFC 4648)
  */
 static const char base64_table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-char *base64_encode(const uint8_t *data, size_t input_size, size_t *output_size)
-{
-	/* Validate inputs */
-	if (data == NULL || input_size == 0 || output_size == NULL) {
-		return NULL;
-	}
-
-	/* Calculate output size: ceil(input_size / 3) * 4 */
-	size_t encoded_size = ((input_size + 2) / 3) * 4;
-
-	/* Allocate output buffer (+1 for null terminator) */
-	char *encoded = malloc(encoded_size + 1);
-	if (encoded == NULL) {
-		return NULL;
-	}
+/**
+ * @brief Bulk kernel: encodes whole 3-byte groups from the start of the input
+ *
+ * @return Number of input bytes consumed (a multiple of 3)
+ */
+typedef size_t (*base64_kernel_t)(const uint8_t *data, size_t size, char *output);
 
+/**
+ * @brief Scalar kernel: encode all complete 3-byte groups
+ */
+static size_t base64_kernel_scalar(const uint8_t *data, size_t size, char *output)
+{
 	size_t i = 0; /* Input position */
 	size_t j = 0; /* Output position */
 
 	/* Process 3-byte chunks */
-	while (i + 2 < input_size) {
+	while (i + 2 < size) {
 		/* First 6 bits of byte 0 */
-		encoded[j++] = base64_table[(data[i] >> 2) & 0x3F];
+		output[j++] = base64_table[(data[i] >> 2) & 0x3F];
 
 		/* Last 2 bits of byte 0 + first 4 bits of byte 1 */
-		encoded[j++] = base64_table[((data[i] & 0x03) << 4) | ((data[i + 1] >> 4) & 0x0F)];
+		output[j++] = base64_table[((data[i] & 0x03) << 4) | ((data[i + 1] >> 4) & 0x0F)];
 
 		/* Last 4 bits of byte 1 + first 2 bits of byte 2 */
-		encoded[j++] = base64_table[((data[i + 1] & 0x0F) << 2) | ((data[i + 2] >> 6) & 0x03)];
+		output[j++] = base64_table[((data[i + 1] & 0x0F) << 2) | ((data[i + 2] >> 6) & 0x03)];
 
 		/* Last 6 bits of byte 2 */
-		encoded[j++] = base64_table[data[i + 2] & 0x3F];
+		output[j++] = base64_table[data[i + 2] & 0x3F];
 
 		i += 3;
 	}
 
+	return i;
+}
+
+#ifdef BASE64_X86_SIMD
+
+/**
+ * @brief Spread 12 input bytes into 16 bytes of 6-bit indices
+ *
+ * Each 3-byte group [a b c] is shuffled to [b a c b], then the four
+ * 6-bit fields are moved into the low bits of separate bytes with one
+ * high-multiply and one low-multiply on 16-bit lanes.
+ */
+__attribute__((target("ssse3"))) static inline __m128i base64_reshuffle_ssse3(__m128i in)
+{
+	in = _mm_shuffle_epi8(in, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+
+	const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+	const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+	const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+	const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+
+	return _mm_or_si128(t1, t3);
+}
+
+/**
+ * @brief Map 6-bit indices to base64 ASCII
+ *
+ * Reduces each index to one of 14 ranges and adds a per-range offset
+ * looked up with pshufb.
+ */
+__attribute__((target("ssse3"))) static inline __m128i base64_lookup_ssse3(__m128i indices)
+{
+	__m128i result = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+	const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+	result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+
+	const __m128i shift_lut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+	result = _mm_shuffle_epi8(shift_lut, result);
+
+	return _mm_add_epi8(result, indices);
+}
+
+/**
+ * @brief SSSE3 kernel: 12 input bytes per iteration
+ *
+ * Loads 16 bytes per step, so it stops while at least 16 bytes remain.
+ */
+__attribute__((target("ssse3"))) static size_t base64_kernel_ssse3(const uint8_t *data, size_t size, char *output)
+{
+	size_t i = 0;
+
+	while (i + 16 <= size) {
+		__m128i in = _mm_loadu_si128((const __m128i *)(data + i));
+		__m128i out = base64_lookup_ssse3(base64_reshuffle_ssse3(in));
+		_mm_storeu_si128((__m128i *)output, out);
+
+		i += 12;
+		output += 16;
+	}
+
+	return i + base64_kernel_scalar(data + i, size - i, output);
+}
+
+/**
+ * @brief AVX2 version of base64_reshuffle_ssse3() on two 128-bit lanes
+ */
+__attribute__((target("avx2"))) static inline __m256i base64_reshuffle_avx2(__m256i in)
+{
+	in = _mm256_shuffle_epi8(in, _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, 1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+
+	const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+	const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+	const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+	const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+
+	return _mm256_or_si256(t1, t3);
+}
+
+/**
+ * @brief AVX2 version of base64_lookup_ssse3()
+ */
+__attribute__((target("avx2"))) static inline __m256i base64_lookup_avx2(__m256i indices)
+{
+	__m256i result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+	const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+	result = _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+
+	const __m256i shift_lut = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0, 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+	result = _mm256_shuffle_epi8(shift_lut, result);
+
+	return _mm256_add_epi8(result, indices);
+}
+
+/**
+ * @brief AVX2 kernel: 24 input bytes per iteration
+ *
+ * Each lane gets its own 12-byte group (loaded as 16 bytes at offsets
+ * 0 and 12), so the loop stops while at least 28 bytes remain.
+ */
+__attribute__((target("avx2"))) static size_t base64_kernel_avx2(const uint8_t *data, size_t size, char *output)
+{
+	size_t i = 0;
+
+	while (i + 28 <= size) {
+		__m128i lo = _mm_loadu_si128((const __m128i *)(data + i));
+		__m128i hi = _mm_loadu_si128((const __m128i *)(data + i + 12));
+		__m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+
+		__m256i out = base64_lookup_avx2(base64_reshuffle_avx2(in));
+		_mm256_storeu_si256((__m256i *)output, out);
+
+		i += 24;
+		output += 32;
+	}
+
+	return i + base64_kernel_ssse3(data + i, size - i, output);
+}
+
+#endif /* BASE64_X86_SIMD */
+
+/**
+ * @brief Pick the fastest kernel supported by this CPU
+ */
+static base64_kernel_t base64_select_kernel(void)
+{
+#ifdef BASE64_X86_SIMD
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return base64_kernel_avx2;
+	}
+	if (__builtin_cpu_supports("ssse3")) {
+		return base64_kernel_ssse3;
+	}
+#endif
+	return base64_kernel_scalar;
+}
+
+/* Scalar until base64_init() runs */
+static base64_kernel_t base64_kernel = base64_kernel_scalar;
+
+void base64_init(void)
+{
+	base64_kernel = base64_select_kernel();
+}
+
+/**
+ * @brief Encode the final 1 or 2 bytes with padding
+ *
+ * @return Number of characters written (always 4)
+ */
+static size_t base64_encode_tail(const uint8_t *data, size_t size, char *output)
+{
+	size_t j = 0;
+
+	/* First 6 bits of remaining byte */
+	output[j++] = base64_table[(data[0] >> 2) & 0x3F];
+
+	if (size == 2) {
+		/* 2 bytes remaining */
+		output[j++] = base64_table[((data[0] & 0x03) << 4) | ((data[1] >> 4) & 0x0F)];
+		output[j++] = base64_table[((data[1] & 0x0F) << 2)];
+		output[j++] = '=';
+
+	} else {
+		/* 1 byte remaining */
+		output[j++] = base64_table[((data[0] & 0x03) << 4)];
+		output[j++] = '=';
+		output[j++] = '=';
+	}
+
+	return j;
+}
+
+/**
+ * @brief Encode all complete 3-byte groups with the selected kernel
+ *
+ * @return Number of input bytes consumed (a multiple of 3)
+ */
+static size_t base64_encode_groups(const uint8_t *data, size_t size, char *output)
+{
+	return base64_kernel(data, size, output);
+}
+
+size_t base64_encode_to(const uint8_t *data, size_t input_size, char *output)
+{
+	size_t i = base64_encode_groups(data, input_size, output);
+	size_t j = (i / 3) * 4;
+
 	/* Handle remaining bytes with padding */
 	if (i < input_size) {
-		/* First 6 bits of remaining byte */
-		encoded[j++] = base64_table[(data[i] >> 2) & 0x3F];
-
-		if (i + 1 < input_size) {
-			/* 2 bytes remaining */
-			encoded[j++] = base64_table[((data[i] & 0x03) << 4) | ((data[i + 1] >> 4) & 0x0F)];
-			encoded[j++] = base64_table[((data[i + 1] & 0x0F) << 2)];
-			encoded[j++] = '=';
-
-		} else {
-			/* 1 byte remaining */
-			encoded[j++] = base64_table[((data[i] & 0x03) << 4)];
-			encoded[j++] = '=';
-			encoded[j++] = '=';
+		j += base64_encode_tail(data + i, input_size - i, output + j);
+	}
+
+	return j;
+}
+
+void base64_encode_init(base64_state_t *state)
+{
+	state->carry_len = 0;
+}
+
+size_t base64_encode_update(base64_state_t *state, const uint8_t *data, size_t size, char *output)
+{
+	size_t j = 0;
+
+	/* Complete the pending group first */
+	if (state->carry_len > 0) {
+		size_t need = 3 - state->carry_len;
+		if (size < need) {
+			memcpy(state->carry + state->carry_len, data, size);
+			state->carry_len += size;
+			return 0;
 		}
+
+		uint8_t group[3];
+		memcpy(group, state->carry, state->carry_len);
+		memcpy(group + state->carry_len, data, need);
+		j = base64_kernel_scalar(group, 3, output) / 3 * 4;
+
+		data += need;
+		size -= need;
+		state->carry_len = 0;
+	}
+
+	size_t i = base64_encode_groups(data, size, output + j);
+	j += (i / 3) * 4;
+
+	/* Keep the 0-2 leftover bytes for the next slice */
+	state->carry_len = size - i;
+	memcpy(state->carry, data + i, state->carry_len);
+
+	return j;
+}
+
+size_t base64_encode_final(base64_state_t *state, char *output)
+{
+	size_t j = 0;
+
+	if (state->carry_len > 0) {
+		j = base64_encode_tail(state->carry, state->carry_len, output);
 	}
+	state->carry_len = 0;
+
+	return j;
+}
+
+char *base64_encode(const uint8_t *data, size_t input_size, size_t *output_size)
+{
+	/* Validate inputs */
+	if (data == NULL || input_size == 0 || output_size == NULL) {
+		return NULL;
+	}
+
+	/* Calculate output size: ceil(input_size / 3) * 4 */
+	size_t encoded_size = BASE64_ENCODED_SIZE(input_size);
+
+	/* Allocate output buffer (+1 for null terminator) */
+	char *encoded = malloc(encoded_size + 1);
+	if (encoded == NULL) {
+		return NULL;
+	}
+
+	size_t j = base64_encode_to(data, input_size, encoded);
 
 	/* Null-terminate the string */
 	encoded[j] = '\0';
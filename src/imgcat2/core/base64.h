@@ -3,8 +3,11 @@
  * @brief Base64 encoding for iTerm2 inline images protocol
  *
  * Provides base64 encoding functionality required by the iTerm2
- * inline images protocol (OSC 1337). Used to encode image data
- * for transmission to the terminal.
+ * inline images protocol (OSC 1337) and the Kitty graphics protocol.
+ * Used to encode image data for transmission to the terminal.
+ *
+ * Bulk encoding runs on AVX2 or SSSE3 kernels when the CPU supports
+ * them (selected by base64_init()), with a portable scalar fallback.
  */
 
 #ifndef IMGCAT2_BASE64_H
@@ -13,6 +16,30 @@
 #include <stddef.h>
 #include <stdint.h>
 
+/**
+ * @brief Encoded size of n input bytes, including padding
+ */
+#define BASE64_ENCODED_SIZE(n) ((((n) + 2) / 3) * 4)
+
+/**
+ * @brief Incremental encoder state
+ *
+ * Holds the 0-2 input bytes left over from the previous slice, so that
+ * arbitrary slices can be encoded without padding in between.
+ */
+typedef struct {
+	uint8_t carry[2]; /**< Pending input bytes (less than one 3-byte group) */
+	size_t carry_len; /**< Number of pending bytes (0-2) */
+} base64_state_t;
+
+/**
+ * @brief Select the fastest encoding kernel the CPU supports
+ *
+ * Call once before starting threads; encoders read the selection without
+ * locking. Until then the scalar kernel is used.
+ */
+void base64_init(void);
+
 /**
  * @brief Encode data to base64
  *
@@ -31,4 +58,56 @@
  */
 char *base64_encode(const uint8_t *data, size_t input_size, size_t *output_size);
 
+/**
+ * @brief Encode data to base64 into a caller-provided buffer
+ *
+ * Non-allocating variant of base64_encode() for callers that stream
+ * output in fixed-size chunks. The output is NOT null-terminated.
+ *
+ * @param data Input data to encode (must not be NULL)
+ * @param input_size Size of input data in bytes
+ * @param output Destination buffer, at least BASE64_ENCODED_SIZE(input_size) bytes
+ *
+ * @return Number of characters written to output
+ */
+size_t base64_encode_to(const uint8_t *data, size_t input_size, char *output);
+
+/**
+ * @brief Initialize an incremental encoder
+ *
+ * @param state Encoder state to reset
+ */
+void base64_encode_init(base64_state_t *state);
+
+/**
+ * @brief Encode a slice of input with an incremental encoder
+ *
+ * Encodes all complete 3-byte groups formed by the pending bytes and
+ * the new slice; up to 2 trailing bytes are kept in the state for the
+ * next call. Concatenating the output of every update plus the final
+ * call yields exactly base64_encode() of the concatenated input.
+ *
+ * @param state Encoder state
+ * @param data Input slice (may be NULL if size is 0)
+ * @param size Slice size in bytes
+ * @param output Destination buffer, at least BASE64_ENCODED_SIZE(size) bytes
+ *
+ * @return Number of characters written to output
+ *
+ * @note Output is not null-terminated
+ */
+size_t base64_encode_update(base64_state_t *state, const uint8_t *data, size_t size, char *output);
+
+/**
+ * @brief Flush an incremental encoder
+ *
+ * Encodes the pending bytes with padding and resets the state.
+ *
+ * @param state Encoder state
+ * @param output Destination buffer, at least 4 bytes
+ *
+ * @return Number of characters written to output (0 or 4)
+ */
+size_t base64_encode_final(base64_state_t *state, char *output);
+
 #endif /* IMGCAT2_BASE64_H */
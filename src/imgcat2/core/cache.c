@@ -0,0 +1,419 @@
+/**
+ * @file cache.c
+ * @brief Persistent on-disk render cache implementation
+ *
+ * Captures rendered output by pointing STDOUT_FILENO at a temporary
+ * file in the cache directory, so every renderer (printf, fwrite and
+ * direct write() users alike) is recorded without changes. Hits are
+ * replayed from a read-only mapping.
+ */
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cache.h"
+
+/** XXH64 primes */
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ULL
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME64_3 0x165667B19E3779F9ULL
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ULL
+
+/** Name prefix of in-progress entries (skipped by eviction) */
+#define CACHE_TEMP_PREFIX "tmp-"
+
+static inline uint64_t cache_rotl64(uint64_t x, int r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t cache_read64(const uint8_t *p)
+{
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint32_t cache_read32(const uint8_t *p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint64_t cache_xxh_round(uint64_t acc, uint64_t input)
+{
+	acc += input * XXH_PRIME64_2;
+	acc = cache_rotl64(acc, 31);
+	return acc * XXH_PRIME64_1;
+}
+
+static inline uint64_t cache_xxh_merge(uint64_t acc, uint64_t val)
+{
+	acc ^= cache_xxh_round(0, val);
+	return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+uint64_t cache_hash(const void *data, size_t size, uint64_t seed)
+{
+	const uint8_t *p = (const uint8_t *)data;
+	const uint8_t *end = p + size;
+	uint64_t h;
+
+	if (size >= 32) {
+		/* Four independent lanes over 32-byte stripes */
+		uint64_t v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+		uint64_t v2 = seed + XXH_PRIME64_2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - XXH_PRIME64_1;
+
+		const uint8_t *limit = end - 32;
+		do {
+			v1 = cache_xxh_round(v1, cache_read64(p));
+			v2 = cache_xxh_round(v2, cache_read64(p + 8));
+			v3 = cache_xxh_round(v3, cache_read64(p + 16));
+			v4 = cache_xxh_round(v4, cache_read64(p + 24));
+			p += 32;
+		} while (p <= limit);
+
+		h = cache_rotl64(v1, 1) + cache_rotl64(v2, 7) + cache_rotl64(v3, 12) + cache_rotl64(v4, 18);
+		h = cache_xxh_merge(h, v1);
+		h = cache_xxh_merge(h, v2);
+		h = cache_xxh_merge(h, v3);
+		h = cache_xxh_merge(h, v4);
+
+	} else {
+		h = seed + XXH_PRIME64_5;
+	}
+
+	h += (uint64_t)size;
+
+	while (p + 8 <= end) {
+		h ^= cache_xxh_round(0, cache_read64(p));
+		h = cache_rotl64(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+		p += 8;
+	}
+
+	if (p + 4 <= end) {
+		h ^= (uint64_t)cache_read32(p) * XXH_PRIME64_1;
+		h = cache_rotl64(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+		p += 4;
+	}
+
+	while (p < end) {
+		h ^= (uint64_t)(*p) * XXH_PRIME64_5;
+		h = cache_rotl64(h, 11) * XXH_PRIME64_1;
+		p++;
+	}
+
+	/* Avalanche */
+	h ^= h >> 33;
+	h *= XXH_PRIME64_2;
+	h ^= h >> 29;
+	h *= XXH_PRIME64_3;
+	h ^= h >> 32;
+
+	return h;
+}
+
+/**
+ * @brief Create a directory if it does not exist yet
+ */
+static bool cache_mkdir(const char *path)
+{
+	return mkdir(path, 0700) == 0 || errno == EEXIST;
+}
+
+/**
+ * @brief Resolve and create the cache directory
+ *
+ * @param out Output buffer (PATH_MAX bytes)
+ * @return true if the directory exists
+ */
+static bool cache_directory(char *out)
+{
+	char base[PATH_MAX];
+
+	const char *xdg = getenv("XDG_CACHE_HOME");
+	if (xdg != NULL && xdg[0] == '/') {
+		snprintf(base, sizeof(base), "%s", xdg);
+
+	} else {
+		const char *home = getenv("HOME");
+		if (home == NULL || home[0] == '\0') {
+			return false;
+		}
+
+		if ((size_t)snprintf(base, sizeof(base), "%s/.cache", home) >= sizeof(base) || !cache_mkdir(base)) {
+			return false;
+		}
+	}
+
+	if ((size_t)snprintf(out, PATH_MAX, "%s/imgcat2", base) >= PATH_MAX) {
+		return false;
+	}
+
+	return cache_mkdir(out);
+}
+
+/**
+ * @brief Write a whole buffer to a file descriptor
+ */
+static bool cache_write_all(int fd, const uint8_t *data, size_t size)
+{
+	while (size > 0) {
+		ssize_t n = write(fd, data, size);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+
+		data += n;
+		size -= (size_t)n;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Map a file descriptor and copy its contents to stdout
+ */
+static int cache_write_fd(int fd)
+{
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		return -1;
+	}
+
+	if (st.st_size == 0) {
+		return 0;
+	}
+
+	void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (map == MAP_FAILED) {
+		return -1;
+	}
+
+	bool ok = cache_write_all(STDOUT_FILENO, (const uint8_t *)map, (size_t)st.st_size);
+	munmap(map, (size_t)st.st_size);
+
+	return ok ? 0 : -1;
+}
+
+int cache_open(const cli_options_t *opts, const uint8_t *data, size_t size, cache_entry_t *entry)
+{
+	if (opts == NULL || data == NULL || size == 0 || entry == NULL) {
+		return -1;
+	}
+
+	entry->temp_fd = -1;
+	entry->saved_stdout = -1;
+	entry->temp_path[0] = '\0';
+
+	/* Animations are timed playback, --info output is trivial */
+	if (opts->animate || opts->info_mode) {
+		return -1;
+	}
+
+	if (!cache_directory(entry->dir)) {
+		return -1;
+	}
+
+	/* Everything besides the content that changes the output (placed renders embed absolute cursor moves) */
+	char key[512];
+	int key_len = snprintf(key, sizeof(key), "v%d|%dx%d|%dx%d|%s|fit=%d|w=%d|h=%d|custom=%d|ansi=%d|downscale=%d|iterm2=%d|kitty=%d|ghostty=%d|has_kitty=%d|tmux=%d|remote=%d|origin=%d,%d|file=%s",
+		CACHE_FORMAT_VERSION,
+		opts->terminal.cols, opts->terminal.rows, opts->terminal.width, opts->terminal.height,
+		opts->interpolation != NULL ? opts->interpolation : "",
+		opts->fit_mode, opts->target_width, opts->target_height, opts->has_custom_dimensions,
+		opts->force_ansi, opts->downscale,
+		opts->terminal.is_iterm2, opts->terminal.is_kitty, opts->terminal.is_ghostty, opts->terminal.has_kitty,
+		opts->terminal.is_tmux, opts->terminal.is_remote,
+		opts->origin_row, opts->origin_col,
+		opts->input_file != NULL ? opts->input_file : "-");
+
+	if (key_len < 0 || (size_t)key_len >= sizeof(key)) {
+		return -1;
+	}
+
+	uint64_t content_hash = cache_hash(data, size, 0);
+	uint64_t options_hash = cache_hash(key, (size_t)key_len, content_hash);
+
+	if ((size_t)snprintf(entry->path, sizeof(entry->path), "%s/%016llx%016llx", entry->dir, (unsigned long long)content_hash, (unsigned long long)options_hash) >= sizeof(entry->path)) {
+		return -1;
+	}
+
+	return 0;
+}
+
+bool cache_exists(const cache_entry_t *entry)
+{
+	return access(entry->path, R_OK) == 0;
+}
+
+int cache_replay(cache_entry_t *entry)
+{
+	int fd = open(entry->path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return -1;
+	}
+
+	int result = cache_write_fd(fd);
+
+	/* Refresh the modification time: eviction is least-recently-used */
+	if (result == 0) {
+		futimens(fd, NULL);
+	}
+
+	close(fd);
+	return result;
+}
+
+int cache_capture_begin(cache_entry_t *entry)
+{
+	if ((size_t)snprintf(entry->temp_path, sizeof(entry->temp_path), "%s/" CACHE_TEMP_PREFIX "XXXXXX", entry->dir) >= sizeof(entry->temp_path)) {
+		return -1;
+	}
+
+	entry->temp_fd = mkstemp(entry->temp_path);
+	if (entry->temp_fd < 0) {
+		entry->temp_path[0] = '\0';
+		return -1;
+	}
+
+	fflush(stdout);
+
+	entry->saved_stdout = dup(STDOUT_FILENO);
+	if (entry->saved_stdout < 0 || dup2(entry->temp_fd, STDOUT_FILENO) < 0) {
+		if (entry->saved_stdout >= 0) {
+			close(entry->saved_stdout);
+			entry->saved_stdout = -1;
+		}
+		close(entry->temp_fd);
+		entry->temp_fd = -1;
+		unlink(entry->temp_path);
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * @struct cache_file_t
+ * @brief Cache directory listing entry for eviction
+ */
+typedef struct {
+	char name[64]; /**< Entry file name */
+	off_t size; /**< File size */
+	time_t mtime; /**< Last use */
+} cache_file_t;
+
+static int cache_file_compare(const void *a, const void *b)
+{
+	const cache_file_t *fa = (const cache_file_t *)a;
+	const cache_file_t *fb = (const cache_file_t *)b;
+
+	return (fa->mtime > fb->mtime) - (fa->mtime < fb->mtime);
+}
+
+/**
+ * @brief Trim the cache directory to CACHE_MAX_SIZE
+ *
+ * Removes the least recently used entries until the total drops to
+ * three quarters of the limit, so eviction does not run on every store.
+ */
+static void cache_evict(const char *dir)
+{
+	DIR *d = opendir(dir);
+	if (d == NULL) {
+		return;
+	}
+
+	int dfd = dirfd(d);
+	cache_file_t *files = NULL;
+	size_t count = 0;
+	size_t capacity = 0;
+	unsigned long long total = 0;
+
+	struct dirent *de;
+	while ((de = readdir(d)) != NULL) {
+		if (de->d_name[0] == '.' || strncmp(de->d_name, CACHE_TEMP_PREFIX, strlen(CACHE_TEMP_PREFIX)) == 0 || strlen(de->d_name) >= sizeof(files[0].name)) {
+			continue;
+		}
+
+		struct stat st;
+		if (fstatat(dfd, de->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0 || !S_ISREG(st.st_mode)) {
+			continue;
+		}
+
+		if (count == capacity) {
+			size_t new_capacity = capacity ? capacity * 2 : 64;
+			cache_file_t *grown = realloc(files, new_capacity * sizeof(cache_file_t));
+			if (grown == NULL) {
+				break;
+			}
+			files = grown;
+			capacity = new_capacity;
+		}
+
+		snprintf(files[count].name, sizeof(files[count].name), "%s", de->d_name);
+		files[count].size = st.st_size;
+		files[count].mtime = st.st_mtime;
+		total += (unsigned long long)st.st_size;
+		count++;
+	}
+
+	if (total > CACHE_MAX_SIZE) {
+		qsort(files, count, sizeof(cache_file_t), cache_file_compare);
+
+		for (size_t i = 0; i < count && total > CACHE_MAX_SIZE / 4 * 3; i++) {
+			if (unlinkat(dfd, files[i].name, 0) == 0) {
+				total -= (unsigned long long)files[i].size;
+			}
+		}
+	}
+
+	free(files);
+	closedir(d);
+}
+
+void cache_capture_end(cache_entry_t *entry, bool commit)
+{
+	if (entry->temp_fd < 0) {
+		return;
+	}
+
+	/* Restore the real stdout */
+	fflush(stdout);
+	dup2(entry->saved_stdout, STDOUT_FILENO);
+	close(entry->saved_stdout);
+	entry->saved_stdout = -1;
+
+	/* Show what was rendered, whether or not it is kept */
+	if (cache_write_fd(entry->temp_fd) != 0) {
+		commit = false;
+	}
+
+	close(entry->temp_fd);
+	entry->temp_fd = -1;
+
+	if (commit && rename(entry->temp_path, entry->path) == 0) {
+		cache_evict(entry->dir);
+
+	} else {
+		unlink(entry->temp_path);
+	}
+
+	entry->temp_path[0] = '\0';
+}
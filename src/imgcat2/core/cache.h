@@ -0,0 +1,117 @@
+/**
+ * @file cache.h
+ * @brief Persistent on-disk render cache
+ *
+ * Stores the final terminal output of a render (ANSI, iTerm2 or Kitty
+ * escape stream) under $XDG_CACHE_HOME/imgcat2, keyed by a 64-bit hash
+ * of the input content plus a hash of the terminal geometry and render
+ * options. A hit replays the stored bytes with one mmap() and one
+ * write(), skipping decode, scale and encode entirely.
+ *
+ * Entries are written to a temporary file and renamed into place, so
+ * readers never see partial output. The directory is bounded by
+ * CACHE_MAX_SIZE with least-recently-used eviction (hits refresh the
+ * entry's modification time).
+ */
+
+#ifndef IMGCAT2_CACHE_H
+#define IMGCAT2_CACHE_H
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cli.h"
+
+/** Maximum total size of the cache directory (128MB) */
+#define CACHE_MAX_SIZE (128UL * 1024 * 1024)
+
+/** Cache entry format version, part of every key */
+#define CACHE_FORMAT_VERSION 1
+
+/**
+ * @struct cache_entry_t
+ * @brief A cache slot for one render
+ */
+typedef struct {
+	char dir[PATH_MAX]; /**< Cache directory */
+	char path[PATH_MAX]; /**< Entry path */
+	char temp_path[PATH_MAX]; /**< Temporary file while capturing */
+	int temp_fd; /**< Temporary file descriptor, or -1 */
+	int saved_stdout; /**< Original stdout while capturing, or -1 */
+} cache_entry_t;
+
+/**
+ * @brief Compute a 64-bit content hash (XXH64)
+ *
+ * @param data Input data
+ * @param size Size in bytes
+ * @param seed Hash seed
+ *
+ * @return 64-bit hash
+ */
+uint64_t cache_hash(const void *data, size_t size, uint64_t seed);
+
+/**
+ * @brief Resolve the cache entry for an input and the current options
+ *
+ * Creates the cache directory if needed and derives the entry path
+ * from the content hash, terminal geometry and render options.
+ *
+ * @param opts CLI options (geometry, sizing, protocol selection)
+ * @param data Input file data
+ * @param size Input size in bytes
+ * @param entry Output entry
+ *
+ * @return 0 on success, -1 if caching is not possible for this render
+ *
+ * @note Animations and --info output are never cached
+ */
+int cache_open(const cli_options_t *opts, const uint8_t *data, size_t size, cache_entry_t *entry);
+
+/**
+ * @brief Check whether an entry has been stored
+ *
+ * Lets callers skip decoding early; the entry may still be evicted
+ * before cache_replay(), which must be checked as usual.
+ *
+ * @param entry Entry from cache_open()
+ *
+ * @return true if the entry exists
+ */
+bool cache_exists(const cache_entry_t *entry);
+
+/**
+ * @brief Replay a cached render to stdout
+ *
+ * @param entry Entry from cache_open()
+ *
+ * @return 0 on hit (output written), -1 on miss or error
+ */
+int cache_replay(cache_entry_t *entry);
+
+/**
+ * @brief Start capturing stdout into a new cache entry
+ *
+ * Redirects STDOUT_FILENO to a temporary file in the cache directory.
+ *
+ * @param entry Entry from cache_open()
+ *
+ * @return 0 on success, -1 on error (stdout is left untouched)
+ */
+int cache_capture_begin(cache_entry_t *entry);
+
+/**
+ * @brief Stop capturing and commit or discard the entry
+ *
+ * Restores stdout and writes the captured output to it. On commit the
+ * temporary file is atomically renamed into place and the cache is
+ * trimmed to CACHE_MAX_SIZE; otherwise it is removed.
+ *
+ * @param entry Entry being captured
+ * @param commit true to store the entry (render succeeded)
+ */
+void cache_capture_end(cache_entry_t *entry, bool commit);
+
+#endif /* IMGCAT2_CACHE_H */
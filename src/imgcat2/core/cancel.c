@@ -0,0 +1,52 @@
+/**
+ * @file cancel.c
+ * @brief Cooperative cancellation of in-flight renders implementation
+ */
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#include "cancel.h"
+
+/** Installed check callback, or NULL */
+static cancel_check_func_t g_cancel_check = NULL;
+
+/** User context for the check callback */
+static void *g_cancel_ctx = NULL;
+
+/** Sticky cancellation state (polled from decoder worker threads) */
+static atomic_bool g_cancelled = false;
+
+/** Set while one thread runs the check callback */
+static atomic_flag g_check_busy = ATOMIC_FLAG_INIT;
+
+void cancel_set_check(cancel_check_func_t check, void *ctx)
+{
+	g_cancel_check = check;
+	g_cancel_ctx = ctx;
+	atomic_store(&g_cancelled, false);
+}
+
+bool cancel_requested(void)
+{
+	if (atomic_load(&g_cancelled) || g_cancel_check == NULL) {
+		return atomic_load(&g_cancelled);
+	}
+
+	/* Callbacks need not be thread-safe: while one runs, others keep the last result */
+	if (atomic_flag_test_and_set(&g_check_busy)) {
+		return atomic_load(&g_cancelled);
+	}
+
+	if (g_cancel_check(g_cancel_ctx)) {
+		atomic_store(&g_cancelled, true);
+	}
+	atomic_flag_clear(&g_check_busy);
+
+	return atomic_load(&g_cancelled);
+}
+
+void cancel_reset(void)
+{
+	atomic_store(&g_cancelled, false);
+}
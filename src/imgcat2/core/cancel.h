@@ -0,0 +1,58 @@
+/**
+ * @file cancel.h
+ * @brief Cooperative cancellation of in-flight renders
+ *
+ * Long-running modes (--preview-server) install a check callback that
+ * reports whether the current request has become stale. Pipeline stages
+ * poll cancel_requested() at stage boundaries and every CANCEL_ROW_BATCH
+ * rows of row-based loops, and unwind as if the stage had failed.
+ * Without a callback, cancel_requested() is always false.
+ */
+
+#ifndef IMGCAT2_CANCEL_H
+#define IMGCAT2_CANCEL_H
+
+#include <stdbool.h>
+
+/** Rows processed between two cancellation checks */
+#define CANCEL_ROW_BATCH 64
+
+/**
+ * @brief Cancellation check callback
+ *
+ * @param ctx User context passed to cancel_set_check()
+ *
+ * @return true if the current work should be abandoned
+ */
+typedef bool (*cancel_check_func_t)(void *ctx);
+
+/**
+ * @brief Install (or remove, with NULL) the cancellation check
+ *
+ * Must not race with cancel_requested(): install before starting the
+ * work. The callback may touch unsynchronized state (e.g. read stdin);
+ * it is never run by two threads at once.
+ *
+ * @param check Check callback
+ * @param ctx User context for the callback
+ */
+void cancel_set_check(cancel_check_func_t check, void *ctx);
+
+/**
+ * @brief Check whether the current work should be abandoned
+ *
+ * Once the callback reports cancellation the result stays true until
+ * cancel_reset(), so every stage unwinds consistently. Safe to call from
+ * worker threads (TIFF bands, multi-file workers); a thread that finds
+ * the callback running on another one returns the last known state.
+ *
+ * @return true if cancelled
+ */
+bool cancel_requested(void);
+
+/**
+ * @brief Clear the cancellation state before starting new work
+ */
+void cancel_reset(void);
+
+#endif /* IMGCAT2_CANCEL_H */
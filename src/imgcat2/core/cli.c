@@ -14,6 +14,7 @@
 #include "../decoders/decoder.h"
 #include "../terminal/terminal.h"
 #include "cli.h"
+#include "executor.h"
 
 /** Project version from CMake */
 #define VERSION_STRING "1.0.0"
@@ -22,12 +23,47 @@
 #define RESIZE_FACTOR_X 1
 #define RESIZE_FACTOR_Y 2
 
+/**
+ * @brief Initialize options with default values
+ */
+void cli_options_init(cli_options_t *opts)
+{
+	*opts = (cli_options_t) {
+		.input_file = NULL,
+		.input_files = NULL,
+		.input_count = 0,
+		.threads = 0,
+		.decode_threads = 0,
+		.grid = false,
+		.grid_columns = 0,
+		.view = false,
+		.interpolation = "lanczos",
+		.fit_mode = false,
+		.silent = true,
+		.fps = 15,
+		.animate = false,
+		.target_width = -1,
+		.target_height = -1,
+		.has_custom_dimensions = false,
+		.force_ansi = false,
+		.downscale = false,
+		.cache = false,
+		.info_mode = false,
+		.json_output = false,
+		.daemon = false,
+		.client = false,
+		.preview_server = false,
+		.origin_row = -1,
+		.origin_col = -1,
+	};
+}
+
 /**
  * @brief Print usage help message
  */
 void print_usage(const char *program_name)
 {
-	printf("Usage: %s [OPTIONS] [FILE]\n", program_name);
+	printf("Usage: %s [OPTIONS] [FILE...]\n", program_name);
 	printf("\n");
 	printf("Display images in the terminal using ANSI escape sequences and half-block characters.\n");
 	printf("\n");
@@ -47,15 +83,29 @@ void print_usage(const char *program_name)
 	printf("      --fps N               Animation FPS (1-15, default: 15)\n");
 	printf("  -a, --animate             Animate GIF frames\n");
 	printf("      --force-ansi          Force ANSI rendering (disable iTerm2 protocol)\n");
+	printf("      --downscale           Downscale to the display size and re-encode before\n");
+	printf("                            sending to iTerm2 when smaller (for remote sessions)\n");
+	printf("      --cache               Reuse renders from the on-disk cache ($XDG_CACHE_HOME/imgcat2)\n");
+	printf("      --daemon              Run as a render server on a Unix socket\n");
+	printf("      --client              Render through a running --daemon (falls back to local)\n");
+	printf("      --preview-server      Serve previewer requests from stdin (path, x, y, w, h)\n");
+	printf("  -T, --threads N           Worker threads for multiple files (default: one per CPU)\n");
+	printf("      --decode-threads N    Threads one image decode may use (HEIF/AVIF/JXL/TIFF)\n");
+	printf("  -g, --grid[=N]            Show all files as one labelled contact sheet\n");
+	printf("                            with N columns (default: fit to the terminal)\n");
+	printf("  -V, --view                Interactive viewer: arrows/hjkl pan, +/- zoom,\n");
+	printf("                            0 fit, 1 actual size, q quit\n");
 	printf("      --info                Output image metadata instead of rendering\n");
 	printf("      --json                Format --info output as JSON (single line)\n");
 	printf("\n");
 	printf("Arguments:\n");
-	printf("  FILE                      Input image file (omit or '-' for stdin)\n");
+	printf("  FILE...                   Input image files, shown in order (omit or '-' for stdin)\n");
 	printf("\n");
 	printf("Examples:\n");
 	printf("  %s image.png              Display PNG image\n", program_name);
 	printf("  %s -a animation.gif       Animate GIF\n", program_name);
+	printf("  %s *.jpg                  Display many images\n", program_name);
+	printf("  %s --grid *.jpg           Contact sheet of many images\n", program_name);
 	printf("  cat image.jpg | %s        Read from stdin\n", program_name);
 	printf("  %s --fps 10 anim.gif      Animate at 10 FPS\n", program_name);
 	printf("\n");
@@ -137,6 +187,15 @@ int parse_arguments(int argc, char **argv, cli_options_t *opts)
 		{ "width",         required_argument, 0, 'w' },
 		{ "height",        required_argument, 0, 'H' },
 		{ "force-ansi",    no_argument,       0, 'A' },
+		{ "downscale",     no_argument,       0, 'D' },
+		{ "cache",         no_argument,       0, 'C' },
+		{ "daemon",        no_argument,       0, 'd' },
+		{ "client",        no_argument,       0, 'c' },
+		{ "preview-server", no_argument,      0, 'p' },
+		{ "threads",       required_argument, 0, 'T' },
+		{ "decode-threads", required_argument, 0, 'X' },
+		{ "grid",          optional_argument, 0, 'g' },
+		{ "view",          no_argument,       0, 'V' },
 		{ "info",          no_argument,       0, 'I' },
 		{ "json",          no_argument,       0, 'J' },
 		{ 0,		       0,		         0, 0   },
@@ -146,7 +205,7 @@ int parse_arguments(int argc, char **argv, cli_options_t *opts)
 	int opt;
 	int option_index = 0;
 
-	while ((opt = getopt_long(argc, argv, "hb:i:frvaF:w:H:AIJ", long_options, &option_index)) != -1) {
+	while ((opt = getopt_long(argc, argv, "hb:i:frvaF:w:H:ADCdcpT:X:g::VIJ", long_options, &option_index)) != -1) {
 		switch (opt) {
 			case 'h': print_usage(argv[0]); return 1;
 			case 'b': print_version(); return 1;
@@ -157,6 +216,12 @@ int parse_arguments(int argc, char **argv, cli_options_t *opts)
 			case 'F': opts->fps = atoi(optarg); break;
 			case 'a': opts->animate = true; break;
 			case 'A': opts->force_ansi = true; break;
+			case 'D': opts->downscale = true; break;
+			case 'C': opts->cache = true; break;
+			case 'd': opts->daemon = true; break;
+			case 'c': opts->client = true; break;
+			case 'p': opts->preview_server = true; break;
+			case 'V': opts->view = true; break;
 			case 'I': opts->info_mode = true; break;
 			case 'J': opts->json_output = true; break;
 
@@ -170,6 +235,14 @@ int parse_arguments(int argc, char **argv, cli_options_t *opts)
 				opts->has_custom_dimensions = true;
 				break;
 
+			case 'T': opts->threads = atoi(optarg); break;
+			case 'X': opts->decode_threads = atoi(optarg); break;
+
+			case 'g':
+				opts->grid = true;
+				opts->grid_columns = optarg != NULL ? atoi(optarg) : 0;
+				break;
+
 			case '?':
 				/* getopt_long already printed error message */
 				fprintf(stderr, "Try '%s --help' for more information.\n", argv[0]);
@@ -179,8 +252,11 @@ int parse_arguments(int argc, char **argv, cli_options_t *opts)
 		}
 	}
 
-	/* Parse positional argument (input file) */
+	/* Parse positional arguments (input files) */
 	if (optind < argc) {
+		opts->input_files = &argv[optind];
+		opts->input_count = argc - optind;
+
 		/* Check if input is "-" (stdin) */
 		if (strcmp(argv[optind], "-") == 0) {
 			opts->input_file = NULL;
@@ -258,6 +334,39 @@ int validate_options(cli_options_t *opts)
 		}
 	}
 
+	/* Server and client modes exclude each other */
+	if ((int)opts->daemon + (int)opts->client + (int)opts->preview_server > 1) {
+		fprintf(stderr, "Error: --daemon, --client and --preview-server cannot be used together\n");
+		return -1;
+	}
+
+	/* Validate thread count */
+	if (opts->threads < 0 || opts->threads > EXECUTOR_MAX_THREADS) {
+		fprintf(stderr, "Error: Threads must be between 1 and %d (got %d)\n", EXECUTOR_MAX_THREADS, opts->threads);
+		return -1;
+	}
+
+	if (opts->decode_threads < 0 || opts->decode_threads > EXECUTOR_MAX_THREADS) {
+		fprintf(stderr, "Error: Decode threads must be between 0 and %d (got %d)\n", EXECUTOR_MAX_THREADS, opts->decode_threads);
+		return -1;
+	}
+
+	/* Validate contact sheet options */
+	if (opts->grid && opts->grid_columns < 0) {
+		fprintf(stderr, "Error: Grid columns must be positive (got %d)\n", opts->grid_columns);
+		return -1;
+
+	} else if (opts->grid && (opts->info_mode || opts->animate)) {
+		fprintf(stderr, "Error: --grid cannot be combined with --info or --animate\n");
+		return -1;
+	}
+
+	/* The viewer shows one image interactively */
+	if (opts->view && (opts->grid || opts->info_mode || opts->daemon || opts->client || opts->preview_server)) {
+		fprintf(stderr, "Error: --view cannot be combined with --grid, --info or server modes\n");
+		return -1;
+	}
+
 	/* Validate that --json is only used with --info */
 	if (opts->json_output && !opts->info_mode) {
 		fprintf(stderr, "Error: --json can only be used with --info\n");
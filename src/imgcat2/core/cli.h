@@ -12,6 +12,26 @@
 
 #include <stdbool.h>
 
+/**
+ * @struct cli_terminal_t
+ * @brief Detected terminal geometry and capabilities (internal options)
+ */
+typedef struct {
+	int rows;
+	int cols;
+	int width;
+	int height;
+
+	bool is_iterm2;
+	bool is_ghostty;
+	bool is_kitty;
+	bool is_wezterm;
+	bool is_konsole;
+	bool is_tmux;
+	bool is_remote;
+	bool has_kitty;
+} cli_terminal_t;
+
 /**
  * @struct cli_options_t
  * @brief Command-line options structure
@@ -20,6 +40,13 @@
  */
 typedef struct {
 	char *input_file; /**< Input file path, or NULL for stdin */
+	char **input_files; /**< All input file paths ("-" = stdin), or NULL */
+	int input_count; /**< Number of entries in input_files */
+	int threads; /**< Worker threads for multiple files (0 = one per CPU) */
+	int decode_threads; /**< Threads one image decode may use (0 = library default) */
+	bool grid; /**< true = show all files as one contact sheet */
+	int grid_columns; /**< Contact sheet columns (0 = automatic) */
+	bool view; /**< true = interactive pan/zoom viewer */
 	char *interpolation; /**< Interpolation method: lanczos, bilinear, nearest, cubic */
 	bool fit_mode; /**< true = fit to terminal, false = resize to exact dimensions */
 	bool silent; /**< true = suppress non-error messages */
@@ -29,26 +56,33 @@ typedef struct {
 	int target_height; /**< Target height in pixels (-1 = not specified) */
 	bool has_custom_dimensions; /**< true if -w or -h specified */
 	bool force_ansi; /**< true = force ANSI rendering (disable iTerm2 protocol) */
+	bool downscale; /**< true = downscale and re-encode images before sending to iTerm2 */
+	bool cache; /**< true = reuse and store renders in the on-disk cache */
 	bool info_mode; /**< true = output metadata instead of rendering */
 	bool json_output; /**< true = format output as JSON */
 
-	/* internal options */
-	struct {
-		int rows;
-		int cols;
-		int width;
-		int height;
+	bool daemon; /**< true = run as render server on a Unix socket */
+	bool client; /**< true = forward the request to a running render server */
+	bool preview_server; /**< true = serve previewer requests read from stdin */
 
-		bool is_iterm2;
-		bool is_ghostty;
-		bool is_kitty;
-		bool is_wezterm;
-		bool is_konsole;
-		bool is_tmux;
-		bool has_kitty;
-	} terminal;
+	/* internal options */
+	cli_terminal_t terminal;
+	int origin_row; /**< Placement row (0-based cell), -1 = at the cursor */
+	int origin_col; /**< Placement column (0-based cell), -1 = at the cursor */
+	unsigned int decode_box_width; /**< Size hint for reduced-resolution decoding (0 = full size) */
+	unsigned int decode_box_height; /**< Size hint for reduced-resolution decoding (0 = full size) */
 } cli_options_t;
 
+/**
+ * @brief Initialize options with default values
+ *
+ * Sets every option to its default. Terminal fields are zeroed and
+ * must be filled in by the caller (detection or a client request).
+ *
+ * @param opts Options structure to initialize
+ */
+void cli_options_init(cli_options_t *opts);
+
 /**
  * @brief Parse command-line arguments
  *
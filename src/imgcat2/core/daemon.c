@@ -0,0 +1,614 @@
+/**
+ * @file daemon.c
+ * @brief Resident render server and thin client implementation
+ *
+ * Wire format of a request (client to server):
+ * - daemon_request_t header, sent with SCM_RIGHTS carrying the client's
+ *   stdin, stdout and stderr
+ * - args_size bytes of NUL-terminated argv strings
+ * - cwd_size bytes of NUL-terminated working directory
+ * - env_size bytes of NUL-terminated NAME=value strings: the client's
+ *   values of the daemon_forwarded_env variables that are set
+ *
+ * The worker answers with a single int32_t exit code. Closing or
+ * half-closing the connection early (client interrupted) raises SIGINT
+ * in the worker through SIGIO, which ends animations gracefully.
+ */
+
+#define _GNU_SOURCE
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../decoders/decoder.h"
+#include "daemon.h"
+
+/**
+ * @struct daemon_request_t
+ * @brief Fixed-size request header
+ */
+typedef struct {
+	uint32_t magic; /**< DAEMON_MAGIC */
+	uint32_t version; /**< DAEMON_PROTOCOL_VERSION */
+	uint32_t argc; /**< Number of argv strings */
+	uint32_t args_size; /**< Size of the argv payload */
+	uint32_t cwd_size; /**< Size of the working directory payload */
+	uint32_t env_size; /**< Size of the environment payload (may be 0) */
+	cli_terminal_t terminal; /**< Client terminal geometry and capabilities */
+} daemon_request_t;
+
+/**
+ * Environment read while rendering (iTerm2 multipart support, Kitty temp
+ * files, cache directory). Workers take these from the client, not from
+ * the server's own environment.
+ */
+static const char *const daemon_forwarded_env[] = {
+	"TERM", "COLORTERM", "TERM_PROGRAM", "TERM_PROGRAM_VERSION", "LC_TERMINAL", "LC_TERMINAL_VERSION", "TMPDIR", "HOME", "XDG_CACHE_HOME",
+};
+
+/** Number of entries in daemon_forwarded_env */
+#define DAEMON_FORWARDED_ENV_COUNT (sizeof(daemon_forwarded_env) / sizeof(daemon_forwarded_env[0]))
+
+/** Set by the client's SIGINT handler */
+static volatile sig_atomic_t client_interrupted = 0;
+
+int daemon_socket_path(char *out, size_t size)
+{
+	int n;
+
+	const char *explicit_path = getenv("IMGCAT2_SOCKET");
+	const char *runtime_dir = getenv("XDG_RUNTIME_DIR");
+
+	if (explicit_path != NULL && explicit_path[0] != '\0') {
+		n = snprintf(out, size, "%s", explicit_path);
+
+	} else if (runtime_dir != NULL && runtime_dir[0] == '/') {
+		n = snprintf(out, size, "%s/imgcat2.sock", runtime_dir);
+
+	} else {
+		n = snprintf(out, size, "/tmp/imgcat2-%u.sock", (unsigned)getuid());
+	}
+
+	/* Must also fit into sockaddr_un.sun_path */
+	if (n < 0 || (size_t)n >= size || (size_t)n >= sizeof(((struct sockaddr_un *)0)->sun_path)) {
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Fill a Unix socket address for the server path
+ */
+static int daemon_address(struct sockaddr_un *addr)
+{
+	memset(addr, 0, sizeof(*addr));
+	addr->sun_family = AF_UNIX;
+
+	return daemon_socket_path(addr->sun_path, sizeof(addr->sun_path));
+}
+
+/**
+ * @brief Create a Unix stream socket that is not inherited across exec
+ *
+ * SOCK_CLOEXEC is Linux-only, so the flag is set separately.
+ *
+ * @return Socket, or -1 on error
+ */
+static int daemon_socket(void)
+{
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		return -1;
+	}
+
+	fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+#if defined(SO_NOSIGPIPE)
+	/* No MSG_NOSIGNAL on macOS: disable SIGPIPE on the socket instead */
+	int on = 1;
+	setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+
+	return fd;
+}
+
+/**
+ * @brief Write a whole buffer, retrying on short writes and EINTR
+ */
+static int daemon_write_all(int fd, const void *data, size_t size)
+{
+	const uint8_t *p = (const uint8_t *)data;
+
+	while (size > 0) {
+		ssize_t n = write(fd, p, size);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+
+		p += n;
+		size -= (size_t)n;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Read exactly size bytes
+ *
+ * @return 0 on success, -1 on error or early EOF
+ */
+static int daemon_read_all(int fd, void *data, size_t size)
+{
+	uint8_t *p = (uint8_t *)data;
+
+	while (size > 0) {
+		ssize_t n = read(fd, p, size);
+		if (n < 0 && errno == EINTR) {
+			continue;
+
+		} else if (n <= 0) {
+			return -1;
+		}
+
+		p += n;
+		size -= (size_t)n;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Check that the peer runs as the same user as the server
+ */
+static bool daemon_peer_allowed(int conn)
+{
+#if defined(SO_PEERCRED)
+	struct ucred cred;
+	socklen_t len = sizeof(cred);
+	if (getsockopt(conn, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) {
+		return false;
+	}
+	return cred.uid == getuid();
+#else
+	uid_t uid;
+	gid_t gid;
+	if (getpeereid(conn, &uid, &gid) != 0) {
+		return false;
+	}
+	return uid == getuid();
+#endif
+}
+
+/**
+ * @brief SIGIO handler in workers: the client went away
+ */
+static void daemon_worker_sigio(int sig)
+{
+	(void)sig;
+	raise(SIGINT);
+}
+
+/**
+ * @brief Close the client's standard streams received with a request
+ */
+static void daemon_close_fds(const int fds[3])
+{
+	for (int i = 0; i < 3; i++) {
+		close(fds[i]);
+	}
+}
+
+/**
+ * @brief Replace the forwarded variables with the client's values
+ *
+ * Variables the client did not send are removed, so the server's own
+ * values never leak into a render.
+ *
+ * @param env NUL-terminated NAME=value strings
+ * @param size Size of env in bytes
+ */
+static void daemon_apply_env(char *env, size_t size)
+{
+	for (size_t i = 0; i < DAEMON_FORWARDED_ENV_COUNT; i++) {
+		unsetenv(daemon_forwarded_env[i]);
+	}
+
+	for (char *p = env; p < env + size; p += strlen(p) + 1) {
+		char *eq = strchr(p, '=');
+		if (eq == NULL) {
+			continue;
+		}
+
+		*eq = '\0';
+		for (size_t i = 0; i < DAEMON_FORWARDED_ENV_COUNT; i++) {
+			if (strcmp(p, daemon_forwarded_env[i]) == 0) {
+				setenv(p, eq + 1, 1);
+				break;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Receive the request header and the client's standard streams
+ *
+ * @return 0 on success, -1 on error
+ */
+static int daemon_receive_header(int conn, daemon_request_t *req, int fds[3])
+{
+	union {
+		struct cmsghdr align;
+		char buf[CMSG_SPACE(sizeof(int) * 3)];
+	} control;
+
+	struct iovec iov = { .iov_base = req, .iov_len = sizeof(*req) };
+	struct msghdr msg = { 0 };
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buf;
+	msg.msg_controllen = sizeof(control.buf);
+
+	ssize_t n;
+	do {
+		n = recvmsg(conn, &msg, 0);
+	} while (n < 0 && errno == EINTR);
+
+	/* Nothing received: the control buffer was never filled in */
+	if (n <= 0) {
+		return -1;
+	}
+
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	if (cmsg == NULL || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len != CMSG_LEN(sizeof(int) * 3)) {
+		return -1;
+	}
+	memcpy(fds, CMSG_DATA(cmsg), sizeof(int) * 3);
+	for (int i = 0; i < 3; i++) {
+		fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+	}
+
+	/* The rest of the header may arrive separately */
+	if ((size_t)n > sizeof(*req) || daemon_read_all(conn, (uint8_t *)req + n, sizeof(*req) - (size_t)n) != 0) {
+		daemon_close_fds(fds);
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Serve one request in a forked worker
+ *
+ * @return Exit code of the render
+ */
+static int daemon_handle(int conn, daemon_run_func_t run)
+{
+	daemon_request_t req;
+	int fds[3];
+
+	if (daemon_receive_header(conn, &req, fds) != 0) {
+		return EXIT_FAILURE;
+	}
+
+	if (req.magic != DAEMON_MAGIC || req.version != DAEMON_PROTOCOL_VERSION || req.argc == 0 || req.argc > DAEMON_MAX_ARGS || req.args_size == 0 || req.args_size > DAEMON_MAX_PAYLOAD || req.cwd_size == 0 || req.cwd_size > DAEMON_MAX_PAYLOAD || req.env_size > DAEMON_MAX_PAYLOAD) {
+		daemon_close_fds(fds);
+		return EXIT_FAILURE;
+	}
+
+	size_t payload_size = (size_t)req.args_size + req.cwd_size + req.env_size;
+	char *payload = malloc(payload_size);
+	char **argv = calloc((size_t)req.argc + 1, sizeof(char *));
+	if (payload == NULL || argv == NULL || daemon_read_all(conn, payload, payload_size) != 0) {
+		free(payload);
+		free(argv);
+		daemon_close_fds(fds);
+		return EXIT_FAILURE;
+	}
+
+	/* Split argv; the payload must hold exactly argc strings */
+	char *cwd = payload + req.args_size;
+	uint32_t argc = 0;
+	for (char *p = payload; p < cwd && argc < req.argc; p += strlen(p) + 1) {
+		argv[argc++] = p;
+	}
+
+	char *env = cwd + req.cwd_size;
+	if (argc != req.argc || payload[req.args_size - 1] != '\0' || cwd[req.cwd_size - 1] != '\0' || (req.env_size > 0 && env[req.env_size - 1] != '\0') || chdir(cwd) != 0) {
+		free(payload);
+		free(argv);
+		daemon_close_fds(fds);
+		return EXIT_FAILURE;
+	}
+
+	daemon_apply_env(env, req.env_size);
+
+	/* Render into the client's terminal */
+	for (int i = 0; i < 3; i++) {
+		dup2(fds[i], i);
+		close(fds[i]);
+	}
+
+	/* Interrupt the render when the client disconnects */
+	signal(SIGIO, daemon_worker_sigio);
+	fcntl(conn, F_SETOWN, getpid());
+	fcntl(conn, F_SETFL, fcntl(conn, F_GETFL) | O_ASYNC);
+
+	cli_options_t opts;
+	cli_options_init(&opts);
+	opts.terminal = req.terminal;
+
+	optind = 1;
+	int exit_code;
+	if (parse_arguments((int)argc, argv, &opts) != 0) {
+		exit_code = EXIT_FAILURE;
+
+	} else if (validate_options(&opts) < 0) {
+		exit_code = EXIT_FAILURE;
+
+	} else {
+		exit_code = run(&opts);
+	}
+
+	fflush(stdout);
+	fflush(stderr);
+
+	free(argv);
+	free(payload);
+
+	return exit_code;
+}
+
+int daemon_serve(daemon_run_func_t run, const cli_options_t *opts)
+{
+	struct sockaddr_un addr;
+	if (daemon_address(&addr) != 0) {
+		fprintf(stderr, "Error: Daemon socket path too long\n");
+		return EXIT_FAILURE;
+	}
+
+	int fd = daemon_socket();
+	if (fd < 0) {
+		fprintf(stderr, "Error: Cannot create socket: %s\n", strerror(errno));
+		return EXIT_FAILURE;
+	}
+
+	/* Refuse to replace a live server; remove a stale socket */
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+		fprintf(stderr, "Error: A daemon is already listening on %s\n", addr.sun_path);
+		close(fd);
+		return EXIT_FAILURE;
+	}
+	unlink(addr.sun_path);
+
+	mode_t old_umask = umask(0077);
+	int bound = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+	umask(old_umask);
+
+	if (bound != 0 || listen(fd, 64) != 0) {
+		fprintf(stderr, "Error: Cannot listen on %s: %s\n", addr.sun_path, strerror(errno));
+		close(fd);
+		return EXIT_FAILURE;
+	}
+
+	/* Workers are reaped automatically; dead clients must not kill the server */
+	signal(SIGCHLD, SIG_IGN);
+	signal(SIGPIPE, SIG_IGN);
+
+	/* Shared warm state inherited by every worker */
+	decoder_registry_init(NULL);
+
+	if (!opts->silent) {
+		fprintf(stderr, "Listening on %s\n", addr.sun_path);
+	}
+
+	while (1) {
+		int conn = accept(fd, NULL, NULL);
+		if (conn < 0) {
+			if (errno == EINTR || errno == ECONNABORTED) {
+				continue;
+			}
+			fprintf(stderr, "Error: accept failed: %s\n", strerror(errno));
+			break;
+		}
+
+		if (!daemon_peer_allowed(conn)) {
+			close(conn);
+			continue;
+		}
+
+		pid_t pid = fork();
+		if (pid == 0) {
+			close(fd);
+			signal(SIGCHLD, SIG_DFL);
+			signal(SIGPIPE, SIG_DFL);
+
+			int32_t status = daemon_handle(conn, run);
+			daemon_write_all(conn, &status, sizeof(status));
+			_exit(EXIT_SUCCESS);
+
+		} else if (pid < 0) {
+			fprintf(stderr, "Error: fork failed: %s\n", strerror(errno));
+		}
+
+		close(conn);
+	}
+
+	close(fd);
+	unlink(addr.sun_path);
+	return EXIT_FAILURE;
+}
+
+/**
+ * @brief Client SIGINT handler: stop waiting and tell the worker
+ */
+static void daemon_client_sigint(int sig)
+{
+	(void)sig;
+	client_interrupted = 1;
+}
+
+int daemon_client(int argc, char **argv, const cli_options_t *opts, int *out_exit_code)
+{
+	struct sockaddr_un addr;
+	if (daemon_address(&addr) != 0) {
+		return -1;
+	}
+
+	int fd = daemon_socket();
+	if (fd < 0) {
+		return -1;
+	}
+
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+		close(fd);
+		return -1;
+	}
+
+	char cwd[PATH_MAX];
+	if (getcwd(cwd, sizeof(cwd)) == NULL) {
+		close(fd);
+		return -1;
+	}
+
+	/* Flatten argv, then the forwarded environment, into NUL-separated strings */
+	size_t args_size = 0;
+	for (int i = 0; i < argc; i++) {
+		args_size += strlen(argv[i]) + 1;
+	}
+
+	size_t env_size = 0;
+	for (size_t i = 0; i < DAEMON_FORWARDED_ENV_COUNT; i++) {
+		const char *value = getenv(daemon_forwarded_env[i]);
+		if (value != NULL) {
+			env_size += strlen(daemon_forwarded_env[i]) + strlen(value) + 2;
+		}
+	}
+
+	if (env_size > DAEMON_MAX_PAYLOAD) {
+		close(fd);
+		return -1;
+	}
+
+	char *args = malloc(args_size);
+	char *env = malloc(env_size > 0 ? env_size : 1);
+	if (args == NULL || env == NULL) {
+		free(args);
+		free(env);
+		close(fd);
+		return -1;
+	}
+
+	char *p = args;
+	for (int i = 0; i < argc; i++) {
+		size_t len = strlen(argv[i]) + 1;
+		memcpy(p, argv[i], len);
+		p += len;
+	}
+
+	p = env;
+	for (size_t i = 0; i < DAEMON_FORWARDED_ENV_COUNT; i++) {
+		const char *value = getenv(daemon_forwarded_env[i]);
+		if (value != NULL) {
+			p += sprintf(p, "%s=%s", daemon_forwarded_env[i], value) + 1;
+		}
+	}
+
+	daemon_request_t req = {
+		.magic = DAEMON_MAGIC,
+		.version = DAEMON_PROTOCOL_VERSION,
+		.argc = (uint32_t)argc,
+		.args_size = (uint32_t)args_size,
+		.cwd_size = (uint32_t)strlen(cwd) + 1,
+		.env_size = (uint32_t)env_size,
+		.terminal = opts->terminal,
+	};
+
+	/* Header together with our stdin, stdout and stderr */
+	int fds[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+	union {
+		struct cmsghdr align;
+		char buf[CMSG_SPACE(sizeof(fds))];
+	} control;
+	memset(&control, 0, sizeof(control));
+
+	struct iovec iov = { .iov_base = &req, .iov_len = sizeof(req) };
+	struct msghdr msg = { 0 };
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buf;
+	msg.msg_controllen = sizeof(control.buf);
+
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+	memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+	fflush(stdout);
+
+#if defined(MSG_NOSIGNAL)
+	ssize_t sent = sendmsg(fd, &msg, MSG_NOSIGNAL);
+#else
+	ssize_t sent = sendmsg(fd, &msg, 0);
+#endif
+	bool failed = sent < 0 || (size_t)sent != sizeof(req) || daemon_write_all(fd, args, args_size) != 0 || daemon_write_all(fd, cwd, req.cwd_size) != 0 || daemon_write_all(fd, env, env_size) != 0;
+	free(args);
+	free(env);
+	if (failed) {
+		close(fd);
+		return -1;
+	}
+
+	/* Wait for the exit code; Ctrl+C half-closes so the worker can finish */
+	struct sigaction sa = { 0 };
+	sa.sa_handler = daemon_client_sigint;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGINT, &sa, NULL);
+
+	int32_t status = 0;
+	size_t received = 0;
+	bool shut = false;
+	while (received < sizeof(status)) {
+		ssize_t n = read(fd, (uint8_t *)&status + received, sizeof(status) - received);
+		if (n > 0) {
+			received += (size_t)n;
+
+		} else if (n < 0 && errno == EINTR) {
+			if (client_interrupted && !shut) {
+				shutdown(fd, SHUT_WR);
+				shut = true;
+			}
+
+		} else {
+			break;
+		}
+	}
+
+	close(fd);
+
+	if (received == sizeof(status)) {
+		*out_exit_code = status;
+
+	} else {
+		*out_exit_code = client_interrupted ? 128 + SIGINT : EXIT_FAILURE;
+	}
+
+	return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file daemon.h
+ * @brief Resident render server and thin client over a Unix socket
+ *
+ * Preview scripts spawn imgcat2 for every file they show. With a server
+ * started by --daemon, --client invocations only detect the terminal and
+ * hand the request over: the client's argv, working directory, terminal
+ * geometry and render-relevant environment (TERM_PROGRAM_VERSION, TMPDIR,
+ * XDG_CACHE_HOME, ...) are sent over the socket, and its stdin, stdout and
+ * stderr are passed with SCM_RIGHTS. The server forks a pre-initialized
+ * worker per request, which renders straight into the client's terminal
+ * and reports the exit status back.
+ *
+ * Socket path: $IMGCAT2_SOCKET, else $XDG_RUNTIME_DIR/imgcat2.sock,
+ * else /tmp/imgcat2-<uid>.sock. Only connections from the same user
+ * are served.
+ */
+
+#ifndef IMGCAT2_DAEMON_H
+#define IMGCAT2_DAEMON_H
+
+#include <stddef.h>
+
+#include "cli.h"
+
+/** Request header magic ("IC2D") */
+#define DAEMON_MAGIC 0x49433244U
+
+/** Request protocol version */
+#define DAEMON_PROTOCOL_VERSION 2
+
+/** Maximum argument count accepted by the server */
+#define DAEMON_MAX_ARGS 256
+
+/** Maximum size of the argument or working directory payloads */
+#define DAEMON_MAX_PAYLOAD 65536
+
+/**
+ * @brief Render callback run by the server for each request
+ *
+ * @param opts Parsed and validated options of the request
+ *
+ * @return Process exit code reported to the client
+ */
+typedef int (*daemon_run_func_t)(cli_options_t *opts);
+
+/**
+ * @brief Resolve the server socket path
+ *
+ * @param out Output buffer
+ * @param size Output buffer size
+ *
+ * @return 0 on success, -1 if the path does not fit
+ */
+int daemon_socket_path(char *out, size_t size);
+
+/**
+ * @brief Run the render server
+ *
+ * Binds the socket and serves requests until terminated. Each request
+ * is handled in a forked worker that parses the client's arguments and
+ * calls run().
+ *
+ * @param run Render callback
+ * @param opts Server options (verbosity)
+ *
+ * @return Exit code on setup failure (does not return otherwise)
+ */
+int daemon_serve(daemon_run_func_t run, const cli_options_t *opts);
+
+/**
+ * @brief Forward this invocation to a running server
+ *
+ * @param argc Argument count from main()
+ * @param argv Argument vector from main()
+ * @param opts Options with detected terminal geometry
+ * @param out_exit_code Output parameter for the worker's exit code
+ *
+ * @return 0 if the request was served, -1 if no server is reachable
+ *         (the caller should render locally)
+ */
+int daemon_client(int argc, char **argv, const cli_options_t *opts, int *out_exit_code);
+
+#endif /* IMGCAT2_DAEMON_H */
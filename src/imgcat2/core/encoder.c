@@ -0,0 +1,213 @@
+/**
+ * @file encoder.c
+ * @brief Fast PNG and JPEG encoding implementation
+ *
+ * PNG output goes through libpng into a growing memory buffer, JPEG
+ * output through libjpeg's memory destination manager.
+ */
+
+/* clang-format off */
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <jpeglib.h>
+#include <png.h>
+/* clang-format on */
+
+#include "encoder.h"
+#include "pixel_ops.h"
+
+/**
+ * @brief Growing output buffer for the libpng write callback
+ */
+typedef struct {
+	uint8_t *data; /**< Encoded data */
+	size_t size; /**< Bytes written */
+	size_t capacity; /**< Allocated bytes */
+	bool failed; /**< Allocation failure */
+} encode_buffer_t;
+
+/**
+ * @brief libpng write callback appending to an encode_buffer_t
+ */
+static void encode_png_write(png_structp png_ptr, png_bytep data, png_size_t length)
+{
+	encode_buffer_t *buf = (encode_buffer_t *)png_get_io_ptr(png_ptr);
+
+	if (buf->size + length > buf->capacity) {
+		size_t capacity = buf->capacity * 2;
+		while (capacity < buf->size + length) {
+			capacity *= 2;
+		}
+
+		uint8_t *grown = realloc(buf->data, capacity);
+		if (grown == NULL) {
+			buf->failed = true;
+			png_error(png_ptr, "out of memory");
+		}
+
+		buf->data = grown;
+		buf->capacity = capacity;
+	}
+
+	memcpy(buf->data + buf->size, data, length);
+	buf->size += length;
+}
+
+/**
+ * @brief libpng flush callback (nothing to flush in memory)
+ */
+static void encode_png_flush(png_structp png_ptr)
+{
+	(void)png_ptr;
+}
+
+uint8_t *encode_png(const image_t *img, int level, size_t *out_size)
+{
+	if (img == NULL || img->pixels == NULL || out_size == NULL) {
+		fprintf(stderr, "encode_png: invalid parameters\n");
+		return NULL;
+	}
+
+	bool opaque = image_is_opaque(img);
+
+	/* Initial guess: a quarter of the raw size is typical for photos */
+	encode_buffer_t buf = { NULL, 0, (size_t)img->width * img->height + 4096, false };
+	buf.data = malloc(buf.capacity);
+	if (buf.data == NULL) {
+		fprintf(stderr, "encode_png: failed to allocate output buffer\n");
+		return NULL;
+	}
+
+	png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+	if (png_ptr == NULL) {
+		fprintf(stderr, "encode_png: failed to create PNG write struct\n");
+		free(buf.data);
+		return NULL;
+	}
+
+	png_infop info_ptr = png_create_info_struct(png_ptr);
+	if (info_ptr == NULL) {
+		fprintf(stderr, "encode_png: failed to create PNG info struct\n");
+		png_destroy_write_struct(&png_ptr, NULL);
+		free(buf.data);
+		return NULL;
+	}
+
+	if (setjmp(png_jmpbuf(png_ptr))) {
+		fprintf(stderr, "encode_png: libpng error%s\n", buf.failed ? " (out of memory)" : "");
+		png_destroy_write_struct(&png_ptr, &info_ptr);
+		free(buf.data);
+		return NULL;
+	}
+
+	png_set_write_fn(png_ptr, &buf, encode_png_write, encode_png_flush);
+
+	/* Speed over size: per-row choice among the cheap filters, fast deflate */
+	png_set_compression_level(png_ptr, level);
+#ifdef PNG_FAST_FILTERS
+	png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, PNG_FAST_FILTERS);
+#else
+	png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_NONE | PNG_FILTER_SUB | PNG_FILTER_UP);
+#endif
+
+	png_set_IHDR(png_ptr, info_ptr, img->width, img->height, 8, opaque ? PNG_COLOR_TYPE_RGB : PNG_COLOR_TYPE_RGB_ALPHA, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+	png_write_info(png_ptr, info_ptr);
+
+	/* RGB output from RGBA rows: libpng strips the filler byte */
+	if (opaque) {
+		png_set_filler(png_ptr, 0, PNG_FILLER_AFTER);
+	}
+
+	for (uint32_t y = 0; y < img->height; y++) {
+		png_write_row(png_ptr, image_row(img, y));
+	}
+
+	png_write_end(png_ptr, NULL);
+	png_destroy_write_struct(&png_ptr, &info_ptr);
+
+	*out_size = buf.size;
+	return buf.data;
+}
+
+/**
+ * @struct encode_jpeg_error_t
+ * @brief JPEG error manager with longjmp support
+ */
+typedef struct {
+	struct jpeg_error_mgr pub; /**< Public jpeg error manager */
+	jmp_buf setjmp_buffer; /**< longjmp buffer for error recovery */
+} encode_jpeg_error_t;
+
+/**
+ * @brief Custom JPEG error handler returning control to encode_jpeg()
+ */
+static void encode_jpeg_error_exit(j_common_ptr cinfo)
+{
+	encode_jpeg_error_t *err = (encode_jpeg_error_t *)cinfo->err;
+
+	char buffer[JMSG_LENGTH_MAX];
+	(*cinfo->err->format_message)(cinfo, buffer);
+	fprintf(stderr, "Error: libjpeg error: %s\n", buffer);
+
+	longjmp(err->setjmp_buffer, 1);
+}
+
+uint8_t *encode_jpeg(const image_t *img, int quality, size_t *out_size)
+{
+	if (img == NULL || img->pixels == NULL || out_size == NULL) {
+		fprintf(stderr, "encode_jpeg: invalid parameters\n");
+		return NULL;
+	}
+
+	/* One RGB row, converted from RGBA before each scanline write */
+	JSAMPLE *row = malloc((size_t)img->width * 3);
+	if (row == NULL) {
+		fprintf(stderr, "encode_jpeg: failed to allocate row buffer\n");
+		return NULL;
+	}
+
+	struct jpeg_compress_struct cinfo;
+	encode_jpeg_error_t jerr;
+	unsigned char *output = NULL;
+	unsigned long output_size = 0;
+
+	cinfo.err = jpeg_std_error(&jerr.pub);
+	jerr.pub.error_exit = encode_jpeg_error_exit;
+
+	if (setjmp(jerr.setjmp_buffer)) {
+		jpeg_destroy_compress(&cinfo);
+		free(output);
+		free(row);
+		return NULL;
+	}
+
+	jpeg_create_compress(&cinfo);
+	jpeg_mem_dest(&cinfo, &output, &output_size);
+
+	cinfo.image_width = img->width;
+	cinfo.image_height = img->height;
+	cinfo.input_components = 3;
+	cinfo.in_color_space = JCS_RGB;
+
+	jpeg_set_defaults(&cinfo);
+	jpeg_set_quality(&cinfo, quality, TRUE);
+	cinfo.dct_method = JDCT_IFAST;
+
+	jpeg_start_compress(&cinfo, TRUE);
+
+	while (cinfo.next_scanline < cinfo.image_height) {
+		pixel_rgba_to_rgb(image_row(img, cinfo.next_scanline), row, img->width);
+
+		JSAMPROW rows[1] = { row };
+		jpeg_write_scanlines(&cinfo, rows, 1);
+	}
+
+	jpeg_finish_compress(&cinfo);
+	jpeg_destroy_compress(&cinfo);
+	free(row);
+
+	*out_size = (size_t)output_size;
+	return output;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file encoder.h
+ * @brief Fast PNG and JPEG encoding of decoded images
+ *
+ * Re-encodes RGBA8888 images for terminal protocols that transmit
+ * compressed files (iTerm2 OSC 1337). Encoders favour speed over
+ * compression ratio: the output only has to be smaller than the
+ * original file, and it is produced on every invocation.
+ */
+
+#ifndef IMGCAT2_ENCODER_H
+#define IMGCAT2_ENCODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "image.h"
+
+/** Default zlib level for PNG encoding (fastest) */
+#define ENCODER_PNG_LEVEL 1
+
+/** Default JPEG quality */
+#define ENCODER_JPEG_QUALITY 85
+
+/**
+ * @brief Encode image as PNG
+ *
+ * Uses libpng with the given zlib level, letting it pick the NONE, SUB
+ * or UP filter per row (minimum sum of absolute differences). Opaque
+ * images (image_is_opaque()) are written as 8-bit RGB, others as RGBA.
+ *
+ * @param img Image to encode
+ * @param level zlib compression level (0-9)
+ * @param out_size Output parameter for encoded size in bytes
+ *
+ * @return Allocated PNG file data, or NULL on error
+ *
+ * @note Caller must free returned buffer with free()
+ */
+uint8_t *encode_png(const image_t *img, int level, size_t *out_size);
+
+/**
+ * @brief Encode image as baseline JPEG
+ *
+ * Uses libjpeg with the fast integer DCT. The alpha channel is
+ * dropped, so callers should only pass opaque images.
+ *
+ * @param img Image to encode
+ * @param quality JPEG quality (1-100)
+ * @param out_size Output parameter for encoded size in bytes
+ *
+ * @return Allocated JPEG file data, or NULL on error
+ *
+ * @note Caller must free returned buffer with free()
+ */
+uint8_t *encode_jpeg(const image_t *img, int quality, size_t *out_size);
+
+#endif /* IMGCAT2_ENCODER_H */
@@ -0,0 +1,212 @@
+/**
+ * @file executor.c
+ * @brief Ordered pipelined executor implementation
+ *
+ * Workers claim item indices in order from a shared counter, guarded by
+ * one mutex. Completion of an item and progress of emission are
+ * signalled with two condition variables.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include "executor.h"
+
+/**
+ * @brief Run both steps serially
+ */
+static void executor_run_serial(size_t count, executor_step_func_t prepare, executor_step_func_t emit, void *ctx)
+{
+	for (size_t i = 0; i < count; i++) {
+		prepare(i, ctx);
+		emit(i, ctx);
+	}
+}
+
+int executor_default_threads(void)
+{
+	long cpus;
+
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	cpus = (long)info.dwNumberOfProcessors;
+#else
+	cpus = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+	if (cpus < 1) {
+		return 1;
+
+	} else if (cpus > EXECUTOR_MAX_THREADS) {
+		return EXECUTOR_MAX_THREADS;
+	}
+
+	return (int)cpus;
+}
+
+#ifdef _WIN32
+
+int executor_task_threads(void)
+{
+	/* Items are prepared serially on the calling thread */
+	return executor_default_threads();
+}
+
+void executor_run(size_t count, int threads, size_t window, executor_step_func_t prepare, executor_step_func_t emit, void *ctx)
+{
+	(void)threads;
+	(void)window;
+
+	executor_run_serial(count, prepare, emit, ctx);
+}
+
+#else
+
+/**
+ * @brief Workers running alongside this one in its executor (0 = not a worker)
+ */
+static _Thread_local int t_worker_concurrency = 0;
+
+int executor_task_threads(void)
+{
+	int cpus = executor_default_threads();
+	if (t_worker_concurrency <= 1) {
+		return cpus;
+	}
+
+	int share = cpus / t_worker_concurrency;
+	return share > 1 ? share : 1;
+}
+
+/**
+ * @struct executor_t
+ * @brief Shared executor state
+ */
+typedef struct {
+	size_t count; /**< Number of items */
+	int concurrency; /**< Workers that can prepare items at the same time */
+	size_t window; /**< Maximum items prepared ahead of emission */
+	executor_step_func_t prepare; /**< Prepare step */
+	void *ctx; /**< User context */
+
+	pthread_mutex_t lock; /**< Guards the fields below */
+	pthread_cond_t prepared; /**< Signalled when an item is prepared */
+	pthread_cond_t emitted; /**< Signalled when emission advances */
+	size_t next; /**< Next item to claim */
+	size_t emit_index; /**< Item currently being emitted */
+	bool *done; /**< Per-item prepared flags */
+} executor_t;
+
+/**
+ * @brief Worker thread: claim and prepare items in order
+ */
+static void *executor_worker(void *arg)
+{
+	executor_t *ex = (executor_t *)arg;
+
+	t_worker_concurrency = ex->concurrency;
+
+	pthread_mutex_lock(&ex->lock);
+	while (1) {
+		while (ex->next < ex->count && ex->next >= ex->emit_index + ex->window) {
+			pthread_cond_wait(&ex->emitted, &ex->lock);
+		}
+
+		if (ex->next >= ex->count) {
+			break;
+		}
+
+		size_t index = ex->next++;
+		pthread_mutex_unlock(&ex->lock);
+
+		ex->prepare(index, ex->ctx);
+
+		pthread_mutex_lock(&ex->lock);
+		ex->done[index] = true;
+		pthread_cond_broadcast(&ex->prepared);
+	}
+	pthread_mutex_unlock(&ex->lock);
+
+	return NULL;
+}
+
+void executor_run(size_t count, int threads, size_t window, executor_step_func_t prepare, executor_step_func_t emit, void *ctx)
+{
+	if (threads > EXECUTOR_MAX_THREADS) {
+		threads = EXECUTOR_MAX_THREADS;
+	}
+
+	/* Nothing to overlap */
+	if (count <= 1 || threads < 1) {
+		executor_run_serial(count, prepare, emit, ctx);
+		return;
+	}
+
+	executor_t ex = {
+		.count = count,
+		.concurrency = (size_t)threads < count ? threads : (int)count,
+		.window = window > 0 ? window : 1,
+		.prepare = prepare,
+		.ctx = ctx,
+		.next = 0,
+		.emit_index = 0,
+		.done = calloc(count, sizeof(bool)),
+	};
+
+	if (ex.done == NULL) {
+		executor_run_serial(count, prepare, emit, ctx);
+		return;
+	}
+
+	pthread_mutex_init(&ex.lock, NULL);
+	pthread_cond_init(&ex.prepared, NULL);
+	pthread_cond_init(&ex.emitted, NULL);
+
+	pthread_t workers[EXECUTOR_MAX_THREADS];
+	int started = 0;
+	for (int i = 0; i < threads; i++) {
+		if (pthread_create(&workers[started], NULL, executor_worker, &ex) == 0) {
+			started++;
+		}
+	}
+
+	if (started == 0) {
+		/* No threads: the calling thread prepares each item itself */
+		executor_run_serial(count, prepare, emit, ctx);
+
+	} else {
+		for (size_t i = 0; i < count; i++) {
+			pthread_mutex_lock(&ex.lock);
+			while (!ex.done[i]) {
+				pthread_cond_wait(&ex.prepared, &ex.lock);
+			}
+			pthread_mutex_unlock(&ex.lock);
+
+			emit(i, ctx);
+
+			pthread_mutex_lock(&ex.lock);
+			ex.emit_index = i + 1;
+			pthread_cond_broadcast(&ex.emitted);
+			pthread_mutex_unlock(&ex.lock);
+		}
+
+		for (int i = 0; i < started; i++) {
+			pthread_join(workers[i], NULL);
+		}
+	}
+
+	pthread_cond_destroy(&ex.emitted);
+	pthread_cond_destroy(&ex.prepared);
+	pthread_mutex_destroy(&ex.lock);
+	free(ex.done);
+}
+
+#endif
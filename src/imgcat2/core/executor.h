@@ -0,0 +1,64 @@
+/**
+ * @file executor.h
+ * @brief Ordered pipelined executor for multi-file input
+ *
+ * Splits the work for each item into a prepare step (read, decode,
+ * scale) that runs on worker threads and an emit step (terminal output)
+ * that runs on the calling thread strictly in item order. Workers stay
+ * at most `window` items ahead of the item being emitted, which bounds
+ * the memory held by prepared but not yet written items.
+ */
+
+#ifndef IMGCAT2_EXECUTOR_H
+#define IMGCAT2_EXECUTOR_H
+
+#include <stddef.h>
+
+/** Maximum number of worker threads */
+#define EXECUTOR_MAX_THREADS 64
+
+/**
+ * @brief Per-item step callback
+ *
+ * @param index Item index
+ * @param ctx User context passed to executor_run()
+ */
+typedef void (*executor_step_func_t)(size_t index, void *ctx);
+
+/**
+ * @brief Number of worker threads to use by default
+ *
+ * @return Number of online CPUs, clamped to [1, EXECUTOR_MAX_THREADS]
+ */
+int executor_default_threads(void);
+
+/**
+ * @brief Threads one prepare step may use for its own parallelism
+ *
+ * On an executor worker, the CPUs are shared equally with the other
+ * workers of that executor (min(threads, count) of them), so nested
+ * parallel work (TIFF bands, libjxl) does not multiply into threads x
+ * CPUs. Elsewhere all CPUs are available.
+ *
+ * @return Thread count, at least 1
+ */
+int executor_task_threads(void);
+
+/**
+ * @brief Run prepare on workers and emit in order on the calling thread
+ *
+ * prepare(i) may run concurrently for different items and must only
+ * touch item i. emit(i) is called for i = 0 .. count-1 in order, each
+ * after prepare(i) has returned. Falls back to running both steps
+ * serially when threads are unavailable.
+ *
+ * @param count Number of items
+ * @param threads Number of worker threads (1..EXECUTOR_MAX_THREADS)
+ * @param window Maximum number of items prepared ahead of emission
+ * @param prepare Prepare step (worker threads)
+ * @param emit Emit step (calling thread)
+ * @param ctx User context for both steps
+ */
+void executor_run(size_t count, int threads, size_t window, executor_step_func_t prepare, executor_step_func_t emit, void *ctx);
+
+#endif /* IMGCAT2_EXECUTOR_H */
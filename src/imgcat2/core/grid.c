@@ -0,0 +1,625 @@
+/**
+ * @file grid.c
+ * @brief Contact sheet (--grid) composition and rendering
+ *
+ * Thumbnails go through the executor: workers read, decode (with a size
+ * hint, so JPEG uses DCT scaling) and scale each file into its tile box,
+ * and the calling thread blits them into the sheet in argument order.
+ * Pixel protocols get labels drawn into the sheet with a small embedded
+ * bitmap font; ANSI output prints them as text below each grid row.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../decoders/decoder.h"
+#include "../terminal/iterm2.h"
+#include "../terminal/kitty.h"
+#include "encoder.h"
+#include "executor.h"
+#include "grid.h"
+#include "pipeline.h"
+
+/** Label text color (light gray) */
+static const uint8_t s_label_color[4] = { 0xC8, 0xC8, 0xC8, 0xFF };
+
+/**
+ * 5x7 glyphs for printable ASCII (0x20-0x7E), one byte per row, top to
+ * bottom; bit 4 is the leftmost column.
+ */
+static const uint8_t s_font[95][GRID_GLYPH_HEIGHT] = {
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, /* ' ' */
+	{ 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 }, /* '!' */
+	{ 0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00 }, /* '"' */
+	{ 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A }, /* '#' */
+	{ 0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04 }, /* '$' */
+	{ 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 }, /* '%' */
+	{ 0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D }, /* '&' */
+	{ 0x04, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00 }, /* ''' */
+	{ 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 }, /* '(' */
+	{ 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 }, /* ')' */
+	{ 0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00 }, /* '*' */
+	{ 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 }, /* '+' */
+	{ 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 }, /* ',' */
+	{ 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 }, /* '-' */
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C }, /* '.' */
+	{ 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 }, /* '/' */
+	{ 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E }, /* '0' */
+	{ 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E }, /* '1' */
+	{ 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F }, /* '2' */
+	{ 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E }, /* '3' */
+	{ 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 }, /* '4' */
+	{ 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E }, /* '5' */
+	{ 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E }, /* '6' */
+	{ 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 }, /* '7' */
+	{ 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E }, /* '8' */
+	{ 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C }, /* '9' */
+	{ 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 }, /* ':' */
+	{ 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08 }, /* ';' */
+	{ 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 }, /* '<' */
+	{ 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 }, /* '=' */
+	{ 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 }, /* '>' */
+	{ 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 }, /* '?' */
+	{ 0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E }, /* '@' */
+	{ 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, /* 'A' */
+	{ 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E }, /* 'B' */
+	{ 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E }, /* 'C' */
+	{ 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C }, /* 'D' */
+	{ 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F }, /* 'E' */
+	{ 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 }, /* 'F' */
+	{ 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F }, /* 'G' */
+	{ 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, /* 'H' */
+	{ 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E }, /* 'I' */
+	{ 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C }, /* 'J' */
+	{ 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 }, /* 'K' */
+	{ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F }, /* 'L' */
+	{ 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 }, /* 'M' */
+	{ 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 }, /* 'N' */
+	{ 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, /* 'O' */
+	{ 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 }, /* 'P' */
+	{ 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D }, /* 'Q' */
+	{ 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 }, /* 'R' */
+	{ 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E }, /* 'S' */
+	{ 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, /* 'T' */
+	{ 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, /* 'U' */
+	{ 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 }, /* 'V' */
+	{ 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A }, /* 'W' */
+	{ 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 }, /* 'X' */
+	{ 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 }, /* 'Y' */
+	{ 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F }, /* 'Z' */
+	{ 0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E }, /* '[' */
+	{ 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00 }, /* '\\' */
+	{ 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E }, /* ']' */
+	{ 0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00 }, /* '^' */
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F }, /* '_' */
+	{ 0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00 }, /* '`' */
+	{ 0x00, 0x00, 0x0E, 0x01, 0x0F, 0x11, 0x0F }, /* 'a' */
+	{ 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1E }, /* 'b' */
+	{ 0x00, 0x00, 0x0E, 0x10, 0x10, 0x11, 0x0E }, /* 'c' */
+	{ 0x01, 0x01, 0x0D, 0x13, 0x11, 0x11, 0x0F }, /* 'd' */
+	{ 0x00, 0x00, 0x0E, 0x11, 0x1F, 0x10, 0x0E }, /* 'e' */
+	{ 0x06, 0x09, 0x08, 0x1C, 0x08, 0x08, 0x08 }, /* 'f' */
+	{ 0x00, 0x0F, 0x11, 0x11, 0x0F, 0x01, 0x0E }, /* 'g' */
+	{ 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11 }, /* 'h' */
+	{ 0x04, 0x00, 0x0C, 0x04, 0x04, 0x04, 0x0E }, /* 'i' */
+	{ 0x02, 0x00, 0x06, 0x02, 0x02, 0x12, 0x0C }, /* 'j' */
+	{ 0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12 }, /* 'k' */
+	{ 0x0C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E }, /* 'l' */
+	{ 0x00, 0x00, 0x1A, 0x15, 0x15, 0x11, 0x11 }, /* 'm' */
+	{ 0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11 }, /* 'n' */
+	{ 0x00, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E }, /* 'o' */
+	{ 0x00, 0x00, 0x1E, 0x11, 0x1E, 0x10, 0x10 }, /* 'p' */
+	{ 0x00, 0x00, 0x0D, 0x13, 0x0F, 0x01, 0x01 }, /* 'q' */
+	{ 0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10 }, /* 'r' */
+	{ 0x00, 0x00, 0x0E, 0x10, 0x0E, 0x01, 0x1E }, /* 's' */
+	{ 0x08, 0x08, 0x1C, 0x08, 0x08, 0x09, 0x06 }, /* 't' */
+	{ 0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0D }, /* 'u' */
+	{ 0x00, 0x00, 0x11, 0x11, 0x11, 0x0A, 0x04 }, /* 'v' */
+	{ 0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0A }, /* 'w' */
+	{ 0x00, 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11 }, /* 'x' */
+	{ 0x00, 0x00, 0x11, 0x11, 0x0F, 0x01, 0x0E }, /* 'y' */
+	{ 0x00, 0x00, 0x1F, 0x02, 0x04, 0x08, 0x1F }, /* 'z' */
+	{ 0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02 }, /* '{' */
+	{ 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, /* '|' */
+	{ 0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08 }, /* '}' */
+	{ 0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00 }, /* '~' */
+};
+
+/**
+ * @struct grid_tile_t
+ * @brief One thumbnail in flight
+ */
+typedef struct {
+	cli_options_t opts; /**< Per-file options (input file, size hint) */
+	image_t *thumb; /**< Thumbnail still to be blitted, or NULL */
+	bool placed; /**< Thumbnail was scaled straight into the sheet */
+} grid_tile_t;
+
+/**
+ * @struct grid_sheet_t
+ * @brief Contact sheet being composed
+ */
+typedef struct {
+	grid_layout_t layout; /**< Tile geometry */
+	image_t *sheet; /**< Composed image */
+	grid_tile_t *tiles; /**< Per-file state */
+	char **labels; /**< Label text per file */
+	bool text_labels; /**< true = print labels as text (ANSI) */
+	uint32_t font_scale; /**< Bitmap label magnification */
+	int failures; /**< Files that could not be shown */
+} grid_sheet_t;
+
+/**
+ * @brief Tile height for a column count, or 0 if the tiles get too small
+ */
+static uint32_t grid_tile_rows(size_t count, uint32_t columns, uint32_t tile_cols, uint32_t avail_rows, uint32_t cell_width, uint32_t cell_height, uint32_t label_rows, bool *fits)
+{
+	/* Square tiles in pixels */
+	uint32_t square = (tile_cols * cell_width + cell_height / 2) / cell_height;
+	if (square == 0) {
+		square = 1;
+	}
+
+	uint32_t grid_rows = (uint32_t)((count + columns - 1) / columns);
+	uint32_t per_row = avail_rows / grid_rows;
+
+	*fits = per_row > label_rows;
+	if (!*fits) {
+		return avail_rows > label_rows && square > avail_rows - label_rows ? avail_rows - label_rows : square;
+	}
+
+	uint32_t tile_rows = per_row - label_rows;
+	return tile_rows < square ? tile_rows : square;
+}
+
+int grid_layout(size_t count, int columns, uint32_t term_cols, uint32_t term_rows, uint32_t cell_width, uint32_t cell_height, uint32_t label_rows, grid_layout_t *out)
+{
+	if (count == 0 || columns < 0 || term_cols == 0 || term_rows == 0 || cell_width == 0 || cell_height == 0 || out == NULL) {
+		return -1;
+	}
+
+	/* Leave one row for the prompt */
+	uint32_t avail_rows = term_rows > 1 ? term_rows - 1 : 1;
+	uint32_t max_columns = (term_cols + GRID_GAP_CELLS) / (1 + GRID_GAP_CELLS);
+	bool fits;
+
+	uint32_t best_columns = 0, best_rows = 0;
+	uint64_t best_score = 0;
+
+	if (columns > 0) {
+		best_columns = (uint32_t)columns < max_columns ? (uint32_t)columns : max_columns;
+
+	} else {
+		/* Largest tiles (by their shorter pixel side) that fit on screen */
+		uint32_t limit = count < max_columns ? (uint32_t)count : max_columns;
+		uint32_t smallest = 1;
+
+		for (uint32_t n = 1; n <= limit; n++) {
+			uint32_t tile_cols = (term_cols - (n - 1) * GRID_GAP_CELLS) / n;
+			if (tile_cols < GRID_MIN_TILE_CELLS && n > 1) {
+				break;
+			}
+			smallest = n;
+
+			uint32_t tile_rows = grid_tile_rows(count, n, tile_cols, avail_rows, cell_width, cell_height, label_rows, &fits);
+			if (!fits || tile_rows == 0) {
+				continue;
+			}
+
+			uint64_t width_px = (uint64_t)tile_cols * cell_width;
+			uint64_t height_px = (uint64_t)tile_rows * cell_height;
+			uint64_t score = width_px < height_px ? width_px : height_px;
+			if (score > best_score) {
+				best_score = score;
+				best_columns = n;
+				best_rows = tile_rows;
+			}
+		}
+
+		/* Nothing fits: smallest tiles, the sheet scrolls */
+		if (best_columns == 0) {
+			best_columns = smallest;
+		}
+	}
+
+	uint32_t tile_cols = (term_cols - (best_columns - 1) * GRID_GAP_CELLS) / best_columns;
+	if (best_rows == 0) {
+		best_rows = grid_tile_rows(count, best_columns, tile_cols, avail_rows, cell_width, cell_height, label_rows, &fits);
+	}
+
+	*out = (grid_layout_t) {
+		.columns = best_columns,
+		.rows = (uint32_t)((count + best_columns - 1) / best_columns),
+		.tile_cols = tile_cols > 0 ? tile_cols : 1,
+		.tile_rows = best_rows > 0 ? best_rows : 1,
+		.label_rows = label_rows,
+		.cell_width = cell_width,
+		.cell_height = cell_height,
+	};
+
+	return 0;
+}
+
+size_t grid_label(const char *path, size_t max_chars, char *out, size_t out_size)
+{
+	if (out == NULL || out_size == 0) {
+		return 0;
+	}
+
+	const char *name = path != NULL ? path : "(stdin)";
+	const char *slash = strrchr(name, '/');
+	if (slash != NULL && slash[1] != '\0') {
+		name = slash + 1;
+	}
+
+	/* Count characters (UTF-8 lead bytes) */
+	size_t chars = 0;
+	for (const char *p = name; *p != '\0'; p++) {
+		chars += ((unsigned char)*p & 0xC0) != 0x80;
+	}
+
+	bool truncate = chars > max_chars;
+	size_t keep = truncate ? (max_chars > 3 ? max_chars - 3 : 0) : chars;
+
+	size_t len = 0, width = 0;
+	for (const char *p = name; *p != '\0'; p++) {
+		unsigned char c = (unsigned char)*p;
+		bool lead = (c & 0xC0) != 0x80;
+
+		if (lead && width == keep) {
+			break;
+		}
+
+		/* Keep multibyte sequences whole */
+		size_t need = 1;
+		if (lead && c >= 0x80) {
+			need = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+		}
+		if (lead && len + need >= out_size) {
+			break;
+		}
+
+		/* Never pass control characters to the terminal */
+		out[len++] = (c < 0x20 || c == 0x7F) ? '?' : (char)c;
+		width += lead;
+	}
+
+	if (truncate) {
+		for (size_t i = 0; i < 3 && width < max_chars && len + 1 < out_size; i++) {
+			out[len++] = '.';
+			width++;
+		}
+	}
+
+	out[len] = '\0';
+	return width;
+}
+
+void grid_draw_text(image_t *img, uint32_t x, uint32_t y, uint32_t scale, const char *text, const uint8_t rgba[4])
+{
+	if (img == NULL || img->pixels == NULL || text == NULL || scale == 0) {
+		return;
+	}
+
+	uint64_t origin = x;
+	for (const unsigned char *p = (const unsigned char *)text; *p != '\0'; p++) {
+		/* One glyph per character; skip UTF-8 continuation bytes */
+		if ((*p & 0xC0) == 0x80) {
+			continue;
+		}
+
+		unsigned int c = *p >= 0x20 && *p < 0x7F ? *p : '?';
+		const uint8_t *glyph = s_font[c - 0x20];
+
+		for (uint32_t row = 0; row < GRID_GLYPH_HEIGHT * scale; row++) {
+			uint64_t py = (uint64_t)y + row;
+			if (py >= img->height) {
+				break;
+			}
+
+			uint8_t bits = glyph[row / scale];
+			for (uint32_t col = 0; col < GRID_GLYPH_WIDTH * scale; col++) {
+				uint64_t px = origin + col;
+				if (px >= img->width) {
+					break;
+				}
+
+				if (bits & (0x10 >> (col / scale))) {
+					memcpy(image_get_pixel(img, (uint32_t)px, (uint32_t)py), rgba, 4);
+				}
+			}
+		}
+
+		origin += (uint64_t)(GRID_GLYPH_WIDTH + 1) * scale;
+		if (origin >= img->width) {
+			break;
+		}
+	}
+}
+
+/**
+ * @brief Top-left corner of a tile in the sheet
+ */
+static void grid_tile_origin(const grid_layout_t *layout, size_t index, uint32_t *x, uint32_t *y)
+{
+	*x = (uint32_t)(index % layout->columns) * (layout->tile_cols + GRID_GAP_CELLS) * layout->cell_width;
+	*y = (uint32_t)(index / layout->columns) * (layout->tile_rows + layout->label_rows) * layout->cell_height;
+}
+
+/**
+ * @brief View of the sheet area a width x height thumbnail is centered in
+ */
+static image_t *grid_tile_view(const grid_sheet_t *grid, size_t index, uint32_t width, uint32_t height)
+{
+	const grid_layout_t *layout = &grid->layout;
+	uint32_t x, y;
+	grid_tile_origin(layout, index, &x, &y);
+
+	uint32_t tile_width = layout->tile_cols * layout->cell_width;
+	uint32_t tile_height = layout->tile_rows * layout->cell_height;
+	return image_view(grid->sheet, x + (tile_width - width) / 2, y + (tile_height - height) / 2, width, height);
+}
+
+/**
+ * @brief Read, decode and scale one thumbnail (worker threads)
+ *
+ * Downscaled thumbnails are written straight into their tile through a
+ * view of the sheet; tiles never overlap, so workers need no locking.
+ */
+static void grid_prepare(size_t index, void *ctx)
+{
+	grid_sheet_t *grid = (grid_sheet_t *)ctx;
+	grid_tile_t *tile = &grid->tiles[index];
+	uint32_t box_width = tile->opts.decode_box_width;
+	uint32_t box_height = tile->opts.decode_box_height;
+
+	uint8_t *buffer = NULL;
+	size_t size = 0;
+	bool mapped = false;
+	if (pipeline_read_mapped(&tile->opts, &buffer, &size, &mapped) < 0) {
+		return;
+	}
+
+	image_t **frames = NULL;
+	int frame_count = 0;
+	if (pipeline_decode(&tile->opts, buffer, size, &frames, &frame_count) == 0) {
+		image_t *frame = frames[0];
+
+		/* Only ever scale down */
+		uint32_t width, height;
+		if ((frame->width > box_width || frame->height > box_height) && image_fit_size(frame->width, frame->height, box_width, box_height, &width, &height)) {
+			image_t *view = grid_tile_view(grid, index, width, height);
+			tile->placed = view != NULL && image_scale_into(frame, view) == 0;
+			image_destroy(view);
+
+		} else {
+			tile->thumb = frame;
+			frames[0] = NULL;
+		}
+
+		decoder_free_frames(frames, frame_count);
+	}
+
+	pipeline_release(buffer, size, mapped);
+}
+
+/**
+ * @brief Blit a thumbnail and its label into the sheet (calling thread)
+ */
+static void grid_emit(size_t index, void *ctx)
+{
+	grid_sheet_t *grid = (grid_sheet_t *)ctx;
+	const grid_layout_t *layout = &grid->layout;
+	grid_tile_t *tile = &grid->tiles[index];
+	image_t *sheet = grid->sheet;
+
+	uint32_t tile_width = layout->tile_cols * layout->cell_width;
+	uint32_t tile_height = layout->tile_rows * layout->cell_height;
+	uint32_t x, y;
+	grid_tile_origin(layout, index, &x, &y);
+
+	/* Thumbnails that needed no scaling are copied in, centered */
+	image_t *thumb = tile->thumb;
+	if (thumb != NULL) {
+		image_t *view = grid_tile_view(grid, index, thumb->width, thumb->height);
+		tile->placed = view != NULL && image_convert_into(thumb, view) == 0;
+
+		image_destroy(view);
+		image_destroy(thumb);
+		tile->thumb = NULL;
+	}
+
+	if (!tile->placed) {
+		grid->failures++;
+	}
+
+	/* Label, centered under the tile */
+	size_t max_chars = grid->text_labels ? layout->tile_cols : tile_width / ((GRID_GLYPH_WIDTH + 1) * grid->font_scale);
+	char label[256];
+	size_t width = grid_label(tile->opts.input_file, max_chars, label, sizeof(label));
+
+	if (grid->text_labels) {
+		grid->labels[index] = strdup(label);
+
+	} else {
+		uint32_t text_width = (uint32_t)width * (GRID_GLYPH_WIDTH + 1) * grid->font_scale;
+		uint32_t label_height = layout->label_rows * layout->cell_height;
+		uint32_t text_height = GRID_GLYPH_HEIGHT * grid->font_scale;
+		uint32_t tx = x + (text_width < tile_width ? (tile_width - text_width) / 2 : 0);
+		uint32_t ty = y + tile_height + (text_height < label_height ? (label_height - text_height) / 2 : 0);
+
+		grid_draw_text(sheet, tx, ty, grid->font_scale, label, s_label_color);
+	}
+}
+
+/**
+ * @brief Render the sheet through ANSI, one grid row at a time
+ *
+ * Each row of tiles is shown through a view into the sheet and followed
+ * by a line of labels.
+ */
+static int grid_output_ansi(const grid_sheet_t *grid, const cli_options_t *opts)
+{
+	const grid_layout_t *layout = &grid->layout;
+	size_t count = (size_t)opts->input_count;
+	uint32_t band_height = layout->tile_rows * layout->cell_height;
+	uint32_t row_stride = (layout->tile_rows + layout->label_rows) * layout->cell_height;
+
+	for (uint32_t row = 0; row < layout->rows; row++) {
+		image_t *band = image_view(grid->sheet, 0, row * row_stride, grid->sheet->width, band_height);
+		if (band == NULL) {
+			return -1;
+		}
+
+		image_t *frames[1] = { band };
+		int result = pipeline_render(frames, 1, opts);
+		image_destroy(band);
+		if (result < 0) {
+			return -1;
+		}
+
+		for (uint32_t col = 0; col < layout->columns; col++) {
+			size_t index = (size_t)row * layout->columns + col;
+			if (index >= count) {
+				break;
+			}
+
+			/* Center the label under the tile */
+			const char *label = grid->labels[index] != NULL ? grid->labels[index] : "";
+			size_t width = 0;
+			for (const char *p = label; *p != '\0'; p++) {
+				width += ((unsigned char)*p & 0xC0) != 0x80;
+			}
+
+			size_t left = width < layout->tile_cols ? (layout->tile_cols - width) / 2 : 0;
+			size_t right = layout->tile_cols - width - left + (col + 1 < layout->columns ? GRID_GAP_CELLS : 0);
+			printf("%*s%s%*s", (int)left, "", label, (int)right, "");
+		}
+		printf("\n");
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Render the sheet through Kitty or iTerm2 in one transfer
+ */
+static int grid_output_pixels(grid_sheet_t *grid, const cli_options_t *opts)
+{
+	image_t *sheet = grid->sheet;
+
+	if (opts->terminal.is_iterm2) {
+		size_t png_size = 0;
+		uint8_t *png = encode_png(sheet, ENCODER_PNG_LEVEL, &png_size);
+		if (png == NULL) {
+			return -1;
+		}
+
+		/* Exact pixel size; no filename for the composite */
+		cli_options_t sheet_opts = *opts;
+		sheet_opts.input_file = NULL;
+		sheet_opts.fit_mode = false;
+
+		int result = iterm2_render(png, png_size, &sheet_opts, (int)sheet->width, (int)sheet->height);
+		free(png);
+		return result;
+	}
+
+	image_t **frames = malloc(sizeof(image_t *));
+	if (frames == NULL) {
+		return -1;
+	}
+	frames[0] = sheet;
+	grid->sheet = NULL;
+
+	int result = kitty_render(frames, 1, opts);
+	decoder_free_frames(frames, 1);
+
+	return result < 0 ? -1 : 0;
+}
+
+int grid_render(cli_options_t *opts)
+{
+	if (opts == NULL) {
+		return EXIT_FAILURE;
+	}
+
+	size_t count = opts->input_count > 0 ? (size_t)opts->input_count : 1;
+	bool pixels = !opts->force_ansi && (opts->terminal.is_iterm2 || opts->terminal.has_kitty) && opts->terminal.cols > 0 && opts->terminal.rows > 0;
+
+	grid_sheet_t grid = {
+		.text_labels = !pixels,
+		.font_scale = 1,
+	};
+
+	/* Cells in sheet pixels: terminal pixels, or half blocks for ANSI */
+	uint32_t cell_width = 1, cell_height = 2;
+	if (pixels) {
+		cell_width = (uint32_t)(opts->terminal.width / opts->terminal.cols);
+		cell_height = (uint32_t)(opts->terminal.height / opts->terminal.rows);
+		grid.font_scale = cell_height >= 20 ? cell_height / 10 : 1;
+	}
+
+	if (grid_layout(count, opts->grid_columns, (uint32_t)opts->terminal.cols, (uint32_t)opts->terminal.rows, cell_width, cell_height, 1, &grid.layout) < 0) {
+		fprintf(stderr, "Error: Cannot lay out %zu images on a %dx%d terminal\n", count, opts->terminal.cols, opts->terminal.rows);
+		return EXIT_FAILURE;
+	}
+
+	const grid_layout_t *layout = &grid.layout;
+	uint64_t sheet_width = ((uint64_t)layout->columns * layout->tile_cols + (uint64_t)(layout->columns - 1) * GRID_GAP_CELLS) * cell_width;
+	uint64_t sheet_height = (uint64_t)layout->rows * (layout->tile_rows + layout->label_rows) * cell_height;
+
+	if (sheet_width > IMAGE_MAX_DIMENSION || sheet_height > IMAGE_MAX_DIMENSION || sheet_width * sheet_height > IMAGE_MAX_PIXELS) {
+		fprintf(stderr, "Error: Contact sheet of %zu images would be too large (%llux%llu); use fewer files\n", count, (unsigned long long)sheet_width, (unsigned long long)sheet_height);
+		return EXIT_FAILURE;
+	}
+
+	if (!opts->silent) {
+		fprintf(stderr, "Grid: %ux%u tiles of %ux%u cells, sheet %llux%llu pixels\n", layout->columns, layout->rows, layout->tile_cols, layout->tile_rows, (unsigned long long)sheet_width, (unsigned long long)sheet_height);
+	}
+
+	/* Transparent background */
+	grid.sheet = image_create((uint32_t)sheet_width, (uint32_t)sheet_height);
+	grid.tiles = calloc(count, sizeof(grid_tile_t));
+	grid.labels = calloc(count, sizeof(char *));
+	if (grid.sheet == NULL || grid.tiles == NULL || grid.labels == NULL) {
+		fprintf(stderr, "Error: Failed to allocate contact sheet\n");
+		image_destroy(grid.sheet);
+		free(grid.tiles);
+		free(grid.labels);
+		return EXIT_FAILURE;
+	}
+
+	/* Decode just large enough for the tile */
+	for (size_t i = 0; i < count; i++) {
+		grid.tiles[i].opts = *opts;
+		grid.tiles[i].opts.decode_box_width = layout->tile_cols * cell_width;
+		grid.tiles[i].opts.decode_box_height = layout->tile_rows * cell_height;
+		if (opts->input_count > 0) {
+			grid.tiles[i].opts.input_file = strcmp(opts->input_files[i], "-") == 0 ? NULL : opts->input_files[i];
+		}
+	}
+
+	decoder_registry_init(opts);
+
+	int threads = opts->threads > 0 ? opts->threads : executor_default_threads();
+	executor_run(count, threads, (size_t)threads * 2, grid_prepare, grid_emit, &grid);
+
+	int result = pixels ? grid_output_pixels(&grid, opts) : grid_output_ansi(&grid, opts);
+	if (result < 0) {
+		fprintf(stderr, "Error: Failed to render contact sheet\n");
+	}
+
+	fflush(stdout);
+
+	for (size_t i = 0; i < count; i++) {
+		free(grid.labels[i]);
+	}
+	free(grid.labels);
+	free(grid.tiles);
+	image_destroy(grid.sheet);
+
+	return result == 0 && grid.failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
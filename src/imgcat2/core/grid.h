@@ -0,0 +1,110 @@
+/**
+ * @file grid.h
+ * @brief Contact sheet (--grid) composition and rendering
+ *
+ * Tiles every input file into one labelled image. Thumbnails are read,
+ * decoded at reduced resolution where the decoder supports it and scaled
+ * on worker threads, then blitted into a single sheet that is rendered
+ * once through Kitty or iTerm2. ANSI output shows the same sheet one
+ * grid row at a time so the labels can be written as terminal text.
+ */
+
+#ifndef IMGCAT2_GRID_H
+#define IMGCAT2_GRID_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cli.h"
+#include "image.h"
+
+/** Smallest tile width in terminal cells chosen by the automatic layout */
+#define GRID_MIN_TILE_CELLS 8
+
+/** Gap between tiles in terminal cells */
+#define GRID_GAP_CELLS 1
+
+/** Glyph size of the embedded label font in pixels */
+#define GRID_GLYPH_WIDTH 5
+#define GRID_GLYPH_HEIGHT 7
+
+/**
+ * @struct grid_layout_t
+ * @brief Contact sheet geometry
+ *
+ * Tiles are sized in terminal cells so that every protocol lines up with
+ * the text grid; cell_width x cell_height converts cells to sheet pixels.
+ */
+typedef struct {
+	uint32_t columns; /**< Tiles per row */
+	uint32_t rows; /**< Rows of tiles */
+	uint32_t tile_cols; /**< Tile width in cells */
+	uint32_t tile_rows; /**< Tile height in cells */
+	uint32_t label_rows; /**< Label band below each tile in cells */
+	uint32_t cell_width; /**< Pixels per cell horizontally */
+	uint32_t cell_height; /**< Pixels per cell vertically */
+} grid_layout_t;
+
+/**
+ * @brief Compute the tile layout for a contact sheet
+ *
+ * With columns == 0 the column count giving the largest square-ish tiles
+ * that still fit the terminal height is chosen. When no layout fits, the
+ * smallest tiles (GRID_MIN_TILE_CELLS wide) are used and the sheet
+ * scrolls.
+ *
+ * @param count Number of images
+ * @param columns Requested tiles per row (0 = automatic)
+ * @param term_cols Terminal width in cells
+ * @param term_rows Terminal height in cells
+ * @param cell_width Pixels per cell horizontally
+ * @param cell_height Pixels per cell vertically
+ * @param label_rows Cells reserved below each tile for its label
+ * @param out Output layout
+ *
+ * @return 0 on success, -1 on invalid parameters
+ */
+int grid_layout(size_t count, int columns, uint32_t term_cols, uint32_t term_rows, uint32_t cell_width, uint32_t cell_height, uint32_t label_rows, grid_layout_t *out);
+
+/**
+ * @brief Build the label shown under a tile
+ *
+ * Takes the basename of path, replaces control characters and truncates
+ * it to max_chars characters, ending in "..." when shortened. Multibyte
+ * UTF-8 sequences are kept whole and count as one character.
+ *
+ * @param path File path (NULL = standard input)
+ * @param max_chars Maximum label width in characters
+ * @param out Output buffer
+ * @param out_size Output buffer size
+ *
+ * @return Label width in characters
+ */
+size_t grid_label(const char *path, size_t max_chars, char *out, size_t out_size);
+
+/**
+ * @brief Draw ASCII text into an image with the embedded 5x7 font
+ *
+ * Each glyph takes (GRID_GLYPH_WIDTH + 1) * scale pixels horizontally.
+ * Characters outside printable ASCII are drawn as '?'. Pixels falling
+ * outside the image are clipped.
+ *
+ * @param img Target image
+ * @param x Left edge in pixels
+ * @param y Top edge in pixels
+ * @param scale Integer glyph magnification (>= 1)
+ * @param text Text to draw
+ * @param rgba Text color
+ */
+void grid_draw_text(image_t *img, uint32_t x, uint32_t y, uint32_t scale, const char *text, const uint8_t rgba[4]);
+
+/**
+ * @brief Compose and render a contact sheet of every input file
+ *
+ * @param opts Parsed options (input files, terminal, threads)
+ *
+ * @return Process exit code (failure if any file could not be shown)
+ */
+int grid_render(cli_options_t *opts);
+
+#endif /* IMGCAT2_GRID_H */
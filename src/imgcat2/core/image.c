@@ -11,6 +11,7 @@
 /* STB image resize implementation */
 #define STB_IMAGE_RESIZE_IMPLEMENTATION
 #include "image.h"
+#include "pixel_ops.h"
 #include "stb_image_resize2.h"
 
 bool image_calculate_size(uint32_t width, uint32_t height, size_t *out_size)
@@ -44,7 +45,10 @@ bool image_calculate_size(uint32_t width, uint32_t height, size_t *out_size)
 	return true;
 }
 
-image_t *image_create(uint32_t width, uint32_t height)
+/**
+ * @brief Allocate an image, optionally zeroing the pixels
+ */
+static image_t *image_alloc(uint32_t width, uint32_t height, image_format_t format, bool zero)
 {
 	/* Validate dimensions and calculate size */
 	size_t byte_count;
@@ -53,6 +57,10 @@ image_t *image_create(uint32_t width, uint32_t height)
 		return NULL;
 	}
 
+	/* Bytes for formats other than RGBA8 (pixel count is bounded above) */
+	size_t bpp = image_format_bpp(format);
+	byte_count = byte_count / 4 * bpp;
+
 	/* Allocate image structure */
 	image_t *img = malloc(sizeof(image_t));
 	if (img == NULL) {
@@ -60,8 +68,8 @@ image_t *image_create(uint32_t width, uint32_t height)
 		return NULL;
 	}
 
-	/* Allocate pixel buffer (initialized to zero - transparent black) */
-	img->pixels = calloc(byte_count, 1);
+	/* Allocate pixel buffer (zeroed = transparent black) */
+	img->pixels = zero ? calloc(byte_count, 1) : malloc(byte_count);
 	if (img->pixels == NULL) {
 		fprintf(stderr, "image_create: failed to allocate %zu bytes for pixels\n", byte_count);
 		free(img);
@@ -71,6 +79,94 @@ image_t *image_create(uint32_t width, uint32_t height)
 	/* Initialize fields */
 	img->width = width;
 	img->height = height;
+	img->stride = (size_t)width * bpp;
+	img->format = format;
+	img->opaque = !image_format_has_alpha(format);
+	img->release = NULL;
+	img->release_ctx = NULL;
+	img->parent = NULL;
+
+	return img;
+}
+
+image_t *image_create(uint32_t width, uint32_t height)
+{
+	return image_alloc(width, height, IMAGE_FORMAT_RGBA8, true);
+}
+
+image_t *image_create_uninit(uint32_t width, uint32_t height)
+{
+	return image_alloc(width, height, IMAGE_FORMAT_RGBA8, false);
+}
+
+image_t *image_create_format(uint32_t width, uint32_t height, image_format_t format)
+{
+	return image_alloc(width, height, format, false);
+}
+
+image_t *image_adopt(uint32_t width, uint32_t height, image_format_t format, uint8_t *pixels, size_t stride, image_release_func_t release, void *release_ctx)
+{
+	size_t byte_count;
+	if (pixels == NULL || !image_calculate_size(width, height, &byte_count)) {
+		fprintf(stderr, "image_adopt: invalid buffer or dimensions %u×%u\n", width, height);
+		return NULL;
+	}
+
+	size_t row_size = (size_t)width * image_format_bpp(format);
+	if (stride == 0) {
+		stride = row_size;
+
+	} else if (stride < row_size) {
+		fprintf(stderr, "image_adopt: stride %zu too small for width %u\n", stride, width);
+		return NULL;
+	}
+
+	image_t *img = malloc(sizeof(image_t));
+	if (img == NULL) {
+		fprintf(stderr, "image_adopt: failed to allocate image_t\n");
+		return NULL;
+	}
+
+	*img = (image_t) {
+		.width = width,
+		.height = height,
+		.pixels = pixels,
+		.stride = stride,
+		.format = format,
+		.opaque = !image_format_has_alpha(format),
+		.release = release,
+		.release_ctx = release_ctx,
+		.parent = NULL,
+	};
+
+	return img;
+}
+
+image_t *image_view(const image_t *parent, uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+{
+	if (parent == NULL || parent->pixels == NULL || width == 0 || height == 0 || x > parent->width || y > parent->height || width > parent->width - x || height > parent->height - y) {
+		fprintf(stderr, "image_view: invalid rectangle %u×%u at %u,%u\n", width, height, x, y);
+		return NULL;
+	}
+
+	image_t *img = malloc(sizeof(image_t));
+	if (img == NULL) {
+		fprintf(stderr, "image_view: failed to allocate image_t\n");
+		return NULL;
+	}
+
+	/* Share the parent's rows; a view of a view borrows from the owner */
+	*img = (image_t) {
+		.width = width,
+		.height = height,
+		.pixels = image_get_pixel(parent, x, y),
+		.stride = parent->stride,
+		.format = parent->format,
+		.opaque = parent->opaque,
+		.release = NULL,
+		.release_ctx = NULL,
+		.parent = parent->parent != NULL ? parent->parent : parent,
+	};
 
 	return img;
 }
@@ -81,9 +177,14 @@ void image_destroy(image_t *img)
 		return;
 	}
 
-	/* Free pixel buffer */
-	if (img->pixels != NULL) {
-		free(img->pixels);
+	/* Free pixel buffer, through its owner for adopted buffers */
+	if (img->pixels != NULL && img->parent == NULL) {
+		if (img->release != NULL) {
+			img->release(img->release_ctx, img->pixels);
+
+		} else {
+			free(img->pixels);
+		}
 		img->pixels = NULL;
 	}
 
@@ -91,19 +192,77 @@ void image_destroy(image_t *img)
 	free(img);
 }
 
-image_t *image_scale_fit(const image_t *src, uint32_t target_width, uint32_t target_height)
+/**
+ * @brief Check that every alpha byte of a run of RGBA pixels is 255
+ */
+static bool image_alpha_opaque(const uint8_t *p, size_t pixel_count)
 {
-	if (src == NULL || src->pixels == NULL) {
-		fprintf(stderr, "image_scale_fit: invalid source image\n");
-		return NULL;
+	/* Two RGBA pixels per 64-bit word; alpha is byte 3 of each pixel */
+	const uint64_t alpha_mask = 0xFF000000FF000000ULL;
+	const size_t block_words = 64;
 
-	} else if (target_width == 0 || target_height == 0) {
-		fprintf(stderr, "image_scale_fit: invalid target dimensions %u×%u\n", target_width, target_height);
-		return NULL;
+	size_t words = pixel_count / 2;
+
+	size_t i = 0;
+	while (i < words) {
+		size_t n = words - i < block_words ? words - i : block_words;
+		uint64_t acc = ~0ULL;
+
+		for (size_t j = 0; j < n; j++) {
+			uint64_t w;
+			memcpy(&w, p + (i + j) * 8, sizeof(w));
+			acc &= w;
+		}
+
+		if ((acc & alpha_mask) != alpha_mask) {
+			return false;
+		}
+		i += n;
+	}
+
+	/* Odd pixel count: check the last pixel */
+	if (pixel_count & 1) {
+		return p[(pixel_count - 1) * 4 + 3] == 255;
+	}
+
+	return true;
+}
+
+bool image_is_opaque(const image_t *img)
+{
+	if (img == NULL || img->pixels == NULL) {
+		return false;
+	}
+
+	if (img->opaque) {
+		return true;
+
+	} else if (img->format != IMAGE_FORMAT_RGBA8) {
+		/* Only RGBA8 alpha is scanned */
+		return !image_format_has_alpha(img->format);
+	}
+
+	/* Padded rows: check row by row */
+	if (!image_is_packed(img)) {
+		for (uint32_t y = 0; y < img->height; y++) {
+			if (!image_alpha_opaque(image_row(img, y), img->width)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	return image_alpha_opaque(img->pixels, (size_t)img->width * img->height);
+}
+
+bool image_fit_size(uint32_t width, uint32_t height, uint32_t target_width, uint32_t target_height, uint32_t *out_width, uint32_t *out_height)
+{
+	if (width == 0 || height == 0 || target_width == 0 || target_height == 0) {
+		return false;
 	}
 
 	/* Calculate aspect ratio */
-	float src_aspect = (float)src->width / (float)src->height;
+	float src_aspect = (float)width / (float)height;
 	float target_aspect = (float)target_width / (float)target_height;
 
 	/* Calculate fit dimensions (maintain aspect ratio) */
@@ -128,29 +287,176 @@ image_t *image_scale_fit(const image_t *src, uint32_t target_width, uint32_t tar
 		}
 	}
 
-	/* Validate new dimensions */
 	if (new_width == 0 || new_height == 0) {
-		fprintf(stderr, "image_scale_fit: calculated dimensions are invalid %u×%u\n", new_width, new_height);
+		return false;
+	}
+
+	*out_width = new_width;
+	*out_height = new_height;
+	return true;
+}
+
+/**
+ * @brief Convert one row of pixels to RGBA8
+ */
+static void image_convert_row(image_format_t format, const uint8_t *src, uint8_t *dst, uint32_t width)
+{
+	switch (format) {
+		case IMAGE_FORMAT_RGB8:
+			pixel_rgb_to_rgba(src, dst, width);
+			break;
+
+		case IMAGE_FORMAT_GRAY8:
+			pixel_gray_to_rgba(src, dst, width);
+			break;
+
+		case IMAGE_FORMAT_RGBA16:
+			for (size_t i = 0; i < (size_t)width * 4; i++) {
+				uint16_t v;
+				memcpy(&v, src + i * 2, sizeof(v));
+				dst[i] = (uint8_t)(v >> 8);
+			}
+			break;
+
+		case IMAGE_FORMAT_RGBF:
+			/* Simple tone mapping: clamp to [0.0, 1.0] then scale to [0, 255] */
+			for (uint32_t x = 0; x < width; x++) {
+				for (int c = 0; c < 3; c++) {
+					float v;
+					memcpy(&v, src + ((size_t)x * 3 + c) * sizeof(float), sizeof(v));
+					v = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+					dst[x * 4 + c] = (uint8_t)(v * 255.0f);
+				}
+				dst[x * 4 + 3] = 255;
+			}
+			break;
+
+		default:
+			memcpy(dst, src, (size_t)width * 4);
+			break;
+	}
+}
+
+/**
+ * @brief Resample an image without changing its pixel format
+ *
+ * Writes dst_width × dst_height pixels in src->format into out.
+ */
+static bool image_resample_native(const image_t *src, uint8_t *out, uint32_t dst_width, uint32_t dst_height, size_t out_stride)
+{
+	int in_stride = (int)src->stride;
+
+	switch (src->format) {
+		case IMAGE_FORMAT_RGB8:
+			return stbir_resize_uint8_srgb(src->pixels, src->width, src->height, in_stride, out, dst_width, dst_height, (int)out_stride, STBIR_RGB) != NULL;
+
+		case IMAGE_FORMAT_GRAY8:
+			return stbir_resize_uint8_srgb(src->pixels, src->width, src->height, in_stride, out, dst_width, dst_height, (int)out_stride, STBIR_1CHANNEL) != NULL;
+
+		case IMAGE_FORMAT_RGBA16:
+			return stbir_resize(src->pixels, src->width, src->height, in_stride, out, dst_width, dst_height, (int)out_stride, STBIR_RGBA, STBIR_TYPE_UINT16, STBIR_EDGE_CLAMP, STBIR_FILTER_DEFAULT) != NULL;
+
+		case IMAGE_FORMAT_RGBF:
+			return stbir_resize(src->pixels, src->width, src->height, in_stride, out, dst_width, dst_height, (int)out_stride, STBIR_RGB, STBIR_TYPE_FLOAT, STBIR_EDGE_CLAMP, STBIR_FILTER_DEFAULT) != NULL;
+
+		default:
+			return stbir_resize_uint8_srgb(src->pixels, src->width, src->height, in_stride, out, dst_width, dst_height, (int)out_stride, STBIR_RGBA) != NULL;
+	}
+}
+
+int image_scale_into(const image_t *src, image_t *dst)
+{
+	if (src == NULL || src->pixels == NULL || dst == NULL || dst->pixels == NULL || dst->format != IMAGE_FORMAT_RGBA8) {
+		fprintf(stderr, "image_scale_into: invalid image\n");
+		return -1;
+	}
+
+	/* Resize using stb_image_resize2 (SRGB colorspace for natural results) */
+	if (src->format == IMAGE_FORMAT_RGBA8) {
+		if (!image_resample_native(src, dst->pixels, dst->width, dst->height, dst->stride)) {
+			fprintf(stderr, "image_scale_into: stbir_resize failed\n");
+			return -1;
+		}
+		return 0;
+	}
+
+	/* Other formats: resample natively, then convert the smaller result */
+	size_t row_size = (size_t)dst->width * image_format_bpp(src->format);
+	uint8_t *native = malloc(row_size * dst->height);
+	if (native == NULL) {
+		fprintf(stderr, "image_scale_into: failed to allocate %zu bytes\n", row_size * dst->height);
+		return -1;
+	}
+
+	if (!image_resample_native(src, native, dst->width, dst->height, row_size)) {
+		fprintf(stderr, "image_scale_into: stbir_resize failed\n");
+		free(native);
+		return -1;
+	}
+
+	for (uint32_t y = 0; y < dst->height; y++) {
+		image_convert_row(src->format, native + (size_t)y * row_size, image_row(dst, y), dst->width);
+	}
+
+	free(native);
+	return 0;
+}
+
+int image_convert_into(const image_t *src, image_t *dst)
+{
+	if (src == NULL || src->pixels == NULL || dst == NULL || dst->pixels == NULL || dst->format != IMAGE_FORMAT_RGBA8 || src->width != dst->width || src->height != dst->height) {
+		fprintf(stderr, "image_convert_into: invalid image\n");
+		return -1;
+	}
+
+	for (uint32_t y = 0; y < src->height; y++) {
+		image_convert_row(src->format, image_row(src, y), image_row(dst, y), src->width);
+	}
+
+	return 0;
+}
+
+image_t *image_convert_rgba8(const image_t *src)
+{
+	if (src == NULL || src->pixels == NULL) {
+		fprintf(stderr, "image_convert_rgba8: invalid source image\n");
 		return NULL;
 	}
 
-	/* Create output image */
-	image_t *dst = image_create(new_width, new_height);
+	image_t *dst = image_create_uninit(src->width, src->height);
 	if (dst == NULL) {
-		fprintf(stderr, "image_scale_fit: failed to create output image\n");
 		return NULL;
 	}
 
-	/* Resize using stb_image_resize2 (SRGB colorspace for natural results) */
-	if (!stbir_resize_uint8_srgb(src->pixels, src->width, src->height, 0, dst->pixels, new_width, new_height, 0, STBIR_RGBA)) {
-		fprintf(stderr, "image_scale_fit: stbir_resize failed\n");
+	if (image_convert_into(src, dst) < 0) {
 		image_destroy(dst);
 		return NULL;
 	}
 
+	dst->opaque = src->opaque;
 	return dst;
 }
 
+image_t *image_scale_fit(const image_t *src, uint32_t target_width, uint32_t target_height)
+{
+	if (src == NULL || src->pixels == NULL) {
+		fprintf(stderr, "image_scale_fit: invalid source image\n");
+		return NULL;
+
+	} else if (target_width == 0 || target_height == 0) {
+		fprintf(stderr, "image_scale_fit: invalid target dimensions %u×%u\n", target_width, target_height);
+		return NULL;
+	}
+
+	uint32_t new_width, new_height;
+	if (!image_fit_size(src->width, src->height, target_width, target_height, &new_width, &new_height)) {
+		fprintf(stderr, "image_scale_fit: calculated dimensions are invalid\n");
+		return NULL;
+	}
+
+	return image_scale_resize(src, new_width, new_height);
+}
+
 image_t *image_scale_resize(const image_t *src, uint32_t target_width, uint32_t target_height)
 {
 	if (src == NULL || src->pixels == NULL) {
@@ -163,20 +469,21 @@ image_t *image_scale_resize(const image_t *src, uint32_t target_width, uint32_t
 		return NULL;
 	}
 
-	/* Create output image with exact dimensions (no aspect ratio preservation) */
-	image_t *dst = image_create(target_width, target_height);
+	/* Create output image (fully written by the resizer) */
+	image_t *dst = image_create_uninit(target_width, target_height);
 	if (dst == NULL) {
 		fprintf(stderr, "image_scale_resize: failed to create output image\n");
 		return NULL;
 	}
 
-	/* Resize using stb_image_resize2 (SRGB colorspace) */
-	if (!stbir_resize_uint8_srgb(src->pixels, src->width, src->height, 0, dst->pixels, target_width, target_height, 0, STBIR_RGBA)) {
-		fprintf(stderr, "image_scale_resize: stbir_resize failed\n");
+	if (image_scale_into(src, dst) < 0) {
 		image_destroy(dst);
 		return NULL;
 	}
 
+	/* Resampling opaque pixels cannot introduce transparency */
+	dst->opaque = src->opaque;
+
 	return dst;
 }
 
@@ -187,21 +494,16 @@ image_t *convert_rgb_to_rgba(const uint8_t *rgb, uint32_t width, uint32_t height
 		return NULL;
 	}
 
-	/* Create RGBA image */
-	image_t *img = image_create(width, height);
+	/* Create RGBA image (every pixel is written below) */
+	image_t *img = image_create_uninit(width, height);
 	if (img == NULL) {
 		fprintf(stderr, "convert_rgb_to_rgba: failed to create image\n");
 		return NULL;
 	}
 
 	/* Convert RGB to RGBA (add alpha=255) */
-	size_t pixel_count = (size_t)width * (size_t)height;
-	for (size_t i = 0; i < pixel_count; i++) {
-		img->pixels[i * 4 + 0] = rgb[i * 3 + 0]; /* R */
-		img->pixels[i * 4 + 1] = rgb[i * 3 + 1]; /* G */
-		img->pixels[i * 4 + 2] = rgb[i * 3 + 2]; /* B */
-		img->pixels[i * 4 + 3] = 255; /* A (opaque) */
-	}
+	pixel_rgb_to_rgba(rgb, img->pixels, (size_t)width * (size_t)height);
+	img->opaque = true;
 
 	return img;
 }
@@ -213,22 +515,16 @@ image_t *convert_grayscale_to_rgba(const uint8_t *gray, uint32_t width, uint32_t
 		return NULL;
 	}
 
-	/* Create RGBA image */
-	image_t *img = image_create(width, height);
+	/* Create RGBA image (every pixel is written below) */
+	image_t *img = image_create_uninit(width, height);
 	if (img == NULL) {
 		fprintf(stderr, "convert_grayscale_to_rgba: failed to create image\n");
 		return NULL;
 	}
 
 	/* Convert grayscale to RGBA (replicate gray to R,G,B; alpha=255) */
-	size_t pixel_count = (size_t)width * (size_t)height;
-	for (size_t i = 0; i < pixel_count; i++) {
-		uint8_t gray_value = gray[i];
-		img->pixels[i * 4 + 0] = gray_value; /* R */
-		img->pixels[i * 4 + 1] = gray_value; /* G */
-		img->pixels[i * 4 + 2] = gray_value; /* B */
-		img->pixels[i * 4 + 3] = 255; /* A (opaque) */
-	}
+	pixel_gray_to_rgba(gray, img->pixels, (size_t)width * (size_t)height);
+	img->opaque = true;
 
 	return img;
 }
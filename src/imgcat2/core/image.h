@@ -27,20 +27,93 @@
 /** Maximum file size for input (50MB) */
 #define IMAGE_MAX_FILE_SIZE 52428800UL
 
+/** Maximum file size for memory-mapped input (16GB, 50MB on 32-bit hosts) */
+#if SIZE_MAX > 0xFFFFFFFFUL
+#define IMAGE_MAX_MAPPED_FILE_SIZE 17179869184ULL
+#else
+#define IMAGE_MAX_MAPPED_FILE_SIZE IMAGE_MAX_FILE_SIZE
+#endif
+
 /** @} */
 
+/**
+ * @brief Pixel formats an image can be stored in
+ *
+ * Decoders may hand over their native layout; scaling converts to RGBA8
+ * at the target size. Renderers, encoders and the pixel accessors'
+ * callers work on RGBA8 images only.
+ */
+typedef enum {
+	IMAGE_FORMAT_RGBA8 = 0, /**< R, G, B, A bytes */
+	IMAGE_FORMAT_RGB8, /**< R, G, B bytes (opaque) */
+	IMAGE_FORMAT_GRAY8, /**< One luminance byte (opaque) */
+	IMAGE_FORMAT_RGBA16, /**< R, G, B, A native-endian 16-bit words */
+	IMAGE_FORMAT_RGBF, /**< R, G, B floats, 1.0 = full intensity (opaque) */
+} image_format_t;
+
+/**
+ * @brief Bytes per pixel of a pixel format
+ *
+ * @param format Pixel format
+ * @return Size of one pixel in bytes
+ */
+static inline size_t image_format_bpp(image_format_t format)
+{
+	switch (format) {
+		case IMAGE_FORMAT_RGB8:
+			return 3;
+		case IMAGE_FORMAT_GRAY8:
+			return 1;
+		case IMAGE_FORMAT_RGBA16:
+			return 8;
+		case IMAGE_FORMAT_RGBF:
+			return 12;
+		default:
+			return 4;
+	}
+}
+
+/**
+ * @brief Check whether a pixel format has an alpha channel
+ *
+ * @param format Pixel format
+ * @return true for RGBA8 and RGBA16
+ */
+static inline bool image_format_has_alpha(image_format_t format)
+{
+	return format == IMAGE_FORMAT_RGBA8 || format == IMAGE_FORMAT_RGBA16;
+}
+
+/**
+ * @brief Release callback for adopted pixel buffers
+ *
+ * @param ctx Context given to image_adopt()
+ * @param pixels The adopted pixel buffer
+ */
+typedef void (*image_release_func_t)(void *ctx, uint8_t *pixels);
+
 /**
  * @struct image_t
- * @brief RGBA8888 image representation
+ * @brief Image representation (RGBA8888 unless format says otherwise)
  *
  * Memory layout: row-major, top-to-bottom
- * Pixel format: R, G, B, A (4 bytes per pixel)
- * Offset calculation: pixels[(y * width + x) * 4 + channel]
+ * Pixel format: R, G, B, A (4 bytes per pixel) for IMAGE_FORMAT_RGBA8
+ * Offset calculation: pixels[y * stride + x * image_format_bpp(format) + channel]
+ *
+ * Rows may be padded (stride > width * 4), e.g. for library planes with
+ * aligned rows or for views into a larger image. Images created by
+ * image_create() are tightly packed.
  */
-typedef struct {
+typedef struct image_s {
 	uint32_t width; /**< Image width in pixels */
 	uint32_t height; /**< Image height in pixels */
-	uint8_t *pixels; /**< RGBA8888 pixel data: width × height × 4 bytes */
+	uint8_t *pixels; /**< Pixel data: height rows of stride bytes */
+	size_t stride; /**< Bytes from one row to the next (>= width × bytes per pixel) */
+	image_format_t format; /**< Pixel format */
+	bool opaque; /**< true if every alpha value is known to be 255 */
+	image_release_func_t release; /**< Frees adopted pixels, NULL = free() */
+	void *release_ctx; /**< Context for release */
+	const struct image_s *parent; /**< Image a view borrows its pixels from, or NULL */
 } image_t;
 
 /**
@@ -58,10 +131,104 @@ typedef struct {
  */
 image_t *image_create(uint32_t width, uint32_t height);
 
+/**
+ * @brief Create an image without clearing the pixel buffer
+ *
+ * Same as image_create() but the pixels are left uninitialized, for
+ * decoders and converters that overwrite every byte anyway.
+ *
+ * @param width Image width in pixels
+ * @param height Image height in pixels
+ * @return Pointer to allocated image_t, or NULL on failure
+ *
+ * @note Caller must free with image_destroy()
+ */
+image_t *image_create_uninit(uint32_t width, uint32_t height);
+
+/**
+ * @brief Create an image in a given pixel format without clearing it
+ *
+ * For decoders that write their native layout (gray, RGB, 16-bit,
+ * float) straight into the image. Formats without alpha are marked
+ * opaque.
+ *
+ * @param width Image width in pixels
+ * @param height Image height in pixels
+ * @param format Pixel format
+ * @return Pointer to allocated image_t, or NULL on failure
+ *
+ * @note Caller must free with image_destroy()
+ */
+image_t *image_create_format(uint32_t width, uint32_t height, image_format_t format);
+
+/**
+ * @brief Wrap an existing pixel buffer without copying it
+ *
+ * The image takes ownership of pixels: image_destroy() calls
+ * release(release_ctx, pixels), or free(pixels) if release is NULL.
+ * Lets decoders hand over a library-allocated buffer (stb_image, libwebp,
+ * libheif) instead of copying it into a new one.
+ *
+ * @param width Image width in pixels
+ * @param height Image height in pixels
+ * @param format Pixel format of the buffer
+ * @param pixels Buffer of height rows of stride bytes
+ * @param stride Bytes per row (0 = tightly packed)
+ * @param release Release callback, or NULL for free()
+ * @param release_ctx Context passed to release
+ * @return Pointer to allocated image_t, or NULL on failure
+ *
+ * @note On failure the buffer is NOT released; the caller still owns it
+ */
+image_t *image_adopt(uint32_t width, uint32_t height, image_format_t format, uint8_t *pixels, size_t stride, image_release_func_t release, void *release_ctx);
+
+/**
+ * @brief Create a view of a rectangle of another image
+ *
+ * The view shares the parent's pixels and stride, so crops and tiles need
+ * no copy; writes through the view change the parent. Views of views
+ * refer to the outermost image.
+ *
+ * @param parent Image to view (must outlive the view)
+ * @param x Left edge of the rectangle
+ * @param y Top edge of the rectangle
+ * @param width Rectangle width (> 0)
+ * @param height Rectangle height (> 0)
+ * @return Pointer to allocated image_t, or NULL if the rectangle does not
+ *         fit into parent or allocation fails
+ *
+ * @note Caller must free with image_destroy(), which leaves the pixels alone
+ */
+image_t *image_view(const image_t *parent, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+
+/**
+ * @brief Check whether an image's rows are stored without padding
+ *
+ * @param img Image to check
+ * @return true if stride == width × bytes per pixel
+ */
+static inline bool image_is_packed(const image_t *img)
+{
+	return img->stride == (size_t)img->width * image_format_bpp(img->format);
+}
+
+/**
+ * @brief Get pointer to the first pixel of a row
+ *
+ * @param img Image
+ * @param y Row (0-based, not bounds checked)
+ * @return Pointer to the row's first R byte
+ */
+static inline uint8_t *image_row(const image_t *img, uint32_t y)
+{
+	return img->pixels + (size_t)y * img->stride;
+}
+
 /**
  * @brief Destroy an image and free all resources
  *
- * Frees the pixel buffer and image structure. NULL-safe.
+ * Frees (or releases, for adopted buffers) the pixel buffer and the
+ * image structure. Views only free the structure. NULL-safe.
  *
  * @param img Image to destroy (can be NULL)
  */
@@ -71,7 +238,7 @@ void image_destroy(image_t *img);
  * @brief Get pointer to pixel at specified coordinates
  *
  * Returns a pointer to the first byte (R channel) of the pixel at (x, y).
- * The pixel data is laid out as [R, G, B, A].
+ * The pixel data is laid out as [R, G, B, A] for RGBA8 images.
  *
  * @param img Image to access
  * @param x X coordinate (0-based)
@@ -85,7 +252,7 @@ static inline uint8_t *image_get_pixel(const image_t *img, uint32_t x, uint32_t
 	if (img == NULL || x >= img->width || y >= img->height) {
 		return NULL;
 	}
-	return &img->pixels[(y * img->width + x) * 4];
+	return &img->pixels[(size_t)y * img->stride + (size_t)x * image_format_bpp(img->format)];
 }
 
 /**
@@ -101,6 +268,8 @@ static inline uint8_t *image_get_pixel(const image_t *img, uint32_t x, uint32_t
  * @param b Blue channel (0-255)
  * @param a Alpha channel (0-255, 0=transparent, 255=opaque)
  * @return true if successful, false if coordinates out of bounds
+ *
+ * @note RGBA8 images only
  */
 static inline bool image_set_pixel(image_t *img, uint32_t x, uint32_t y, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
 {
@@ -127,6 +296,71 @@ static inline bool image_set_pixel(image_t *img, uint32_t x, uint32_t y, uint8_t
  */
 bool image_calculate_size(uint32_t width, uint32_t height, size_t *out_size);
 
+/**
+ * @brief Check whether every pixel of an image is fully opaque
+ *
+ * Returns the decoder-provided opaque flag when set, otherwise scans the
+ * alpha channel. The scan ANDs pixels together in fixed-size blocks so
+ * the compiler can vectorize it, and stops at the first block that
+ * contains a non-opaque pixel. Formats without alpha are always opaque;
+ * RGBA16 images are only when flagged.
+ *
+ * @param img Image to check
+ *
+ * @return true if all alpha values are 255, false otherwise
+ */
+bool image_is_opaque(const image_t *img);
+
+/**
+ * @brief Compute the largest size with the same aspect ratio that fits a box
+ *
+ * @param width Source width
+ * @param height Source height
+ * @param target_width Box width
+ * @param target_height Box height
+ * @param out_width Fitted width
+ * @param out_height Fitted height
+ * @return true on success, false for zero sizes
+ */
+bool image_fit_size(uint32_t width, uint32_t height, uint32_t target_width, uint32_t target_height, uint32_t *out_width, uint32_t *out_height);
+
+/**
+ * @brief Scale an image into an existing image of any size
+ *
+ * Fills dst completely, ignoring aspect ratio. dst may be a view, so a
+ * thumbnail can be scaled straight into its place in a larger image.
+ * Sources in other formats are resampled in their own format and only
+ * the result is converted to RGBA8, so conversion runs at the target
+ * resolution.
+ *
+ * @param src Source image (any format)
+ * @param dst Destination image (RGBA8, its size is the target size)
+ * @return 0 on success, -1 on error
+ */
+int image_scale_into(const image_t *src, image_t *dst);
+
+/**
+ * @brief Convert an image into an RGBA8 image of the same size
+ *
+ * Gray and RGB gain an opaque alpha channel, 16-bit channels keep their
+ * high byte and float channels are clamped to [0, 1].
+ *
+ * @param src Source image (any format)
+ * @param dst Destination image (RGBA8, same size as src, may be a view)
+ * @return 0 on success, -1 on error
+ */
+int image_convert_into(const image_t *src, image_t *dst);
+
+/**
+ * @brief Convert an image to a new RGBA8 image
+ *
+ * @param src Source image (any format)
+ * @return New RGBA8 image, or NULL on error
+ *
+ * @note Caller must free with image_destroy()
+ */
+image_t *image_convert_rgba8(const image_t *src);
+
 /**
  * @brief Scale image to fit within target dimensions (maintain aspect ratio)
  *
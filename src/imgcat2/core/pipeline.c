@@ -21,7 +21,9 @@
 #include "../decoders/decoder.h"
 #include "../decoders/magic.h"
 #include "../terminal/terminal.h"
+#include "cancel.h"
 #include "cli.h"
+#include "encoder.h"
 #include "image.h"
 #include "pipeline.h"
 
@@ -34,6 +36,9 @@ static void usleep(unsigned int microseconds)
 	Sleep(microseconds / 1000);
 }
 #else
+#include <sys/mman.h>
+
+#include <fcntl.h>
 #include <unistd.h>
 #endif
 
@@ -113,6 +118,53 @@ static bool validate_path_safe(const char *path, char *canonical_out)
 	return true;
 }
 
+/**
+ * @brief Validate an input file before reading or mapping it
+ *
+ * Resolves the path, checks it is a non-empty regular file within
+ * max_size and returns its canonical path and size.
+ *
+ * @param path File path to validate
+ * @param canonical_out Output buffer for canonical path (PATH_MAX bytes)
+ * @param out_size Output parameter for file size
+ * @param max_size Largest accepted file size in bytes
+ * @return true if the file can be read, false otherwise
+ */
+static bool stat_file_secure(const char *path, char *canonical_out, size_t *out_size, unsigned long long max_size)
+{
+	// Validate path security
+	if (!validate_path_safe(path, canonical_out)) {
+		return false;
+	}
+
+	// Get file size with stat
+	struct stat st;
+	if (stat(canonical_out, &st) != 0) {
+		fprintf(stderr, "Error: Cannot stat file '%s': %s\n", canonical_out, strerror(errno));
+		return false;
+	}
+
+	// Check if regular file
+	if (!S_ISREG(st.st_mode)) {
+		fprintf(stderr, "Error: Not a regular file: %s\n", canonical_out);
+		return false;
+	}
+
+	// Validate file size
+	if (st.st_size <= 0) {
+		fprintf(stderr, "Error: File is empty: %s\n", canonical_out);
+		return false;
+	}
+
+	if ((unsigned long long)st.st_size > max_size) {
+		fprintf(stderr, "Error: File too large (%lld bytes, max %llu bytes): %s\n", (long long)st.st_size, max_size, canonical_out);
+		return false;
+	}
+
+	*out_size = (size_t)st.st_size;
+	return true;
+}
+
 /**
  * @brief Read file with path traversal protection and size limits
  *
@@ -139,33 +191,9 @@ bool read_file_secure(const char *path, uint8_t **out_data, size_t *out_size)
 	*out_data = NULL;
 	*out_size = 0;
 
-	// Validate path security
 	char canonical_path[PATH_MAX];
-	if (!validate_path_safe(path, canonical_path)) {
-		return false;
-	}
-
-	// Get file size with stat
-	struct stat st;
-	if (stat(canonical_path, &st) != 0) {
-		fprintf(stderr, "Error: Cannot stat file '%s': %s\n", canonical_path, strerror(errno));
-		return false;
-	}
-
-	// Check if regular file
-	if (!S_ISREG(st.st_mode)) {
-		fprintf(stderr, "Error: Not a regular file: %s\n", canonical_path);
-		return false;
-	}
-
-	// Validate file size
-	if (st.st_size <= 0) {
-		fprintf(stderr, "Error: File is empty: %s\n", canonical_path);
-		return false;
-	}
-
-	if ((size_t)st.st_size > IMAGE_MAX_FILE_SIZE) {
-		fprintf(stderr, "Error: File too large (%lld bytes, max %lu bytes): %s\n", (long long)st.st_size, (unsigned long)IMAGE_MAX_FILE_SIZE, canonical_path);
+	size_t file_size = 0;
+	if (!stat_file_secure(path, canonical_path, &file_size, IMAGE_MAX_FILE_SIZE)) {
 		return false;
 	}
 
@@ -177,7 +205,6 @@ bool read_file_secure(const char *path, uint8_t **out_data, size_t *out_size)
 	}
 
 	// Allocate buffer for file content
-	size_t file_size = (size_t)st.st_size;
 	uint8_t *buffer = (uint8_t *)malloc(file_size);
 	if (buffer == NULL) {
 		fprintf(stderr, "Error: Failed to allocate %lu bytes for file: %s\n", (unsigned long)file_size, strerror(errno));
@@ -201,6 +228,60 @@ bool read_file_secure(const char *path, uint8_t **out_data, size_t *out_size)
 	return true;
 }
 
+#ifndef _WIN32
+/**
+ * @brief Map file read-only with the same checks as read_file_secure()
+ */
+bool map_file_secure(const char *path, uint8_t **out_data, size_t *out_size)
+{
+	if (path == NULL || out_data == NULL || out_size == NULL) {
+		fprintf(stderr, "Error: Invalid parameters to map_file_secure\n");
+		return false;
+	}
+
+	// Initialize outputs
+	*out_data = NULL;
+	*out_size = 0;
+
+	char canonical_path[PATH_MAX];
+	size_t file_size = 0;
+	if (!stat_file_secure(path, canonical_path, &file_size, IMAGE_MAX_MAPPED_FILE_SIZE)) {
+		return false;
+	}
+
+	int fd = open(canonical_path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		fprintf(stderr, "Error: Cannot open file '%s': %s\n", canonical_path, strerror(errno));
+		return false;
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	void *map = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (map == MAP_FAILED) {
+		fprintf(stderr, "Error: Cannot map file '%s': %s\n", canonical_path, strerror(errno));
+		return false;
+	}
+
+	// Only TIFF is read piecewise; everything else keeps the regular input
+	// limit, before any passthrough, cache hashing or decoding touches it
+	if (file_size > IMAGE_MAX_FILE_SIZE && detect_mime_type(map, file_size) != MIME_TIFF) {
+		fprintf(stderr, "Error: File too large (%zu bytes, max %lu bytes): %s\n", file_size, (unsigned long)IMAGE_MAX_FILE_SIZE, canonical_path);
+		munmap(map, file_size);
+		return false;
+	}
+
+	// Inputs are consumed front to back (decoders, base64 streaming);
+	// larger ones are only read where a decoder seeks (TIFF tiles)
+	madvise(map, file_size, file_size > IMAGE_MAX_FILE_SIZE ? MADV_RANDOM : MADV_SEQUENTIAL);
+
+	*out_data = (uint8_t *)map;
+	*out_size = file_size;
+	return true;
+}
+#endif
+
 /**
  * @brief Read from stdin with size limits (pipe support)
  *
@@ -393,21 +474,22 @@ target_dimensions_t calculate_target_terminal_dimensions(uint32_t cols, uint32_t
  * 2. Only width specified: calculate height from aspect ratio
  * 3. Only height specified: calculate width from aspect ratio
  *
- * @param src Source image for aspect ratio calculation
+ * @param src_width Source width for aspect ratio calculation
+ * @param src_height Source height for aspect ratio calculation
  * @param target_width Target width (-1 if not specified)
  * @param target_height Target height (-1 if not specified)
  * @param out_dims Output dimensions
  * @return true on success, false on error
  */
-static bool calculate_custom_dimensions(const image_t *src, int target_width, int target_height, target_dimensions_t *out_dims)
+static bool calculate_custom_dimensions(uint32_t src_width, uint32_t src_height, int target_width, int target_height, target_dimensions_t *out_dims)
 {
-	if (src == NULL || src->width == 0 || src->height == 0 || out_dims == NULL) {
+	if (src_width == 0 || src_height == 0 || out_dims == NULL) {
 		fprintf(stderr, "calculate_custom_dimensions: invalid parameters\n");
 		return false;
 	}
 
 	/* Calculate aspect ratio */
-	float src_aspect = (float)src->width / (float)src->height;
+	float src_aspect = (float)src_width / (float)src_height;
 	uint32_t final_width, final_height;
 
 	if (target_width > 0 && target_height > 0) {
@@ -464,6 +546,54 @@ int pipeline_read(const cli_options_t *opts, uint8_t **out_data, size_t *out_siz
 	return success ? 0 : -1;
 }
 
+/**
+ * @brief Read input, mapping regular files instead of copying them
+ */
+int pipeline_read_mapped(const cli_options_t *opts, uint8_t **out_data, size_t *out_size, bool *out_mapped)
+{
+	if (opts == NULL || out_data == NULL || out_size == NULL || out_mapped == NULL) {
+		fprintf(stderr, "pipeline_read_mapped: invalid parameters\n");
+		return -1;
+	}
+
+	*out_mapped = false;
+
+#ifndef _WIN32
+	if (opts->input_file != NULL) {
+		if (!map_file_secure(opts->input_file, out_data, out_size)) {
+			return -1;
+		}
+
+		*out_mapped = true;
+		return 0;
+	}
+#endif
+
+	return pipeline_read(opts, out_data, out_size);
+}
+
+/**
+ * @brief Release a buffer returned by pipeline_read_mapped()
+ */
+void pipeline_release(uint8_t *data, size_t size, bool mapped)
+{
+	if (data == NULL) {
+		return;
+	}
+
+#ifndef _WIN32
+	if (mapped) {
+		munmap(data, size);
+		return;
+	}
+#else
+	(void)size;
+	(void)mapped;
+#endif
+
+	free(data);
+}
+
 /**
  * @brief Decode image with MIME type detection
  */
@@ -484,7 +614,9 @@ int pipeline_decode(cli_options_t *opts, const uint8_t *buffer, size_t size, ima
 	/* Decode with registry */
 	image_t **frames = decoder_decode(opts, buffer, size, mime, out_frame_count);
 	if (frames == NULL || *out_frame_count <= 0) {
-		fprintf(stderr, "pipeline_decode: failed to decode image\n");
+		if (!cancel_requested()) {
+			fprintf(stderr, "pipeline_decode: failed to decode image\n");
+		}
 		return -1;
 	}
 
@@ -493,12 +625,12 @@ int pipeline_decode(cli_options_t *opts, const uint8_t *buffer, size_t size, ima
 }
 
 /**
- * @brief Scale images to terminal dimensions
+ * @brief Calculate output dimensions for an image of the given size
  */
-int pipeline_scale(image_t **frames, int frame_count, const cli_options_t *opts, image_t ***out_scaled)
+int pipeline_target_dimensions(const cli_options_t *opts, uint32_t img_width, uint32_t img_height, target_dimensions_t *out_target)
 {
-	if (frames == NULL || frame_count <= 0 || opts == NULL || out_scaled == NULL) {
-		fprintf(stderr, "pipeline_scale: invalid parameters\n");
+	if (opts == NULL || img_width == 0 || img_height == 0 || out_target == NULL) {
+		fprintf(stderr, "pipeline_target_dimensions: invalid parameters\n");
 		return -1;
 	}
 
@@ -510,8 +642,8 @@ int pipeline_scale(image_t **frames, int frame_count, const cli_options_t *opts,
 
 	if (opts->has_custom_dimensions) {
 		/* Custom dimensions take priority over fit/resize */
-		if (!calculate_custom_dimensions(frames[0], opts->target_width, opts->target_height, &target)) {
-			fprintf(stderr, "pipeline_scale: failed to calculate custom dimensions\n");
+		if (!calculate_custom_dimensions(img_width, img_height, opts->target_width, opts->target_height, &target)) {
+			fprintf(stderr, "pipeline_target_dimensions: failed to calculate custom dimensions\n");
 			return -1;
 		}
 
@@ -528,9 +660,8 @@ int pipeline_scale(image_t **frames, int frame_count, const cli_options_t *opts,
 		}
 
 	} else if (opts->terminal.has_kitty && !opts->force_ansi) {
-		uint32_t img_height = frames[0]->height;
 		uint32_t half_terminal_height = opts->terminal.height / 2;
-		float aspect = (float)frames[0]->width / (float)frames[0]->height;
+		float aspect = (float)img_width / (float)img_height;
 
 		if (img_height > half_terminal_height) {
 			uint32_t max_height = 0;
@@ -560,16 +691,71 @@ int pipeline_scale(image_t **frames, int frame_count, const cli_options_t *opts,
 
 		} else {
 			/* Image fits within half terminal height - use original size */
-			calculate_custom_dimensions(frames[0], frames[0]->width, frames[0]->height, &target);
+			calculate_custom_dimensions(img_width, img_height, img_width, img_height, &target);
 		}
 
 	} else {
 		/* Default: terminal-aware scaling with aspect ratio */
-		target = calculate_target_terminal_dimensions(cols, rows, opts->terminal.width, opts->terminal.height, frames[0]->width, frames[0]->height, opts->fit_mode);
+		target = calculate_target_terminal_dimensions(cols, rows, opts->terminal.width, opts->terminal.height, img_width, img_height, opts->fit_mode);
 	}
 
 	if (target.width == 0 || target.height == 0) {
-		fprintf(stderr, "pipeline_scale: invalid target dimensions\n");
+		fprintf(stderr, "pipeline_target_dimensions: invalid target dimensions\n");
+		return -1;
+	}
+
+	*out_target = target;
+	return 0;
+}
+
+/**
+ * @brief Set the decode size hint for rendering to the terminal
+ */
+void pipeline_set_decode_box(cli_options_t *opts)
+{
+	if (opts == NULL) {
+		return;
+	}
+
+	opts->decode_box_width = 0;
+	opts->decode_box_height = 0;
+
+	if (opts->has_custom_dimensions) {
+		/* Stretching to both -w and -H needs every source pixel */
+		if (opts->target_width > 0 && opts->target_height > 0) {
+			return;
+		}
+
+		/* The other side follows the aspect ratio */
+		opts->decode_box_width = opts->target_width > 0 ? (unsigned int)opts->target_width : IMAGE_MAX_DIMENSION;
+		opts->decode_box_height = opts->target_height > 0 ? (unsigned int)opts->target_height : IMAGE_MAX_DIMENSION;
+
+	} else if (opts->terminal.has_kitty && !opts->force_ansi) {
+		/* Kitty images never get taller than the terminal; width follows the aspect ratio */
+		if (opts->terminal.height > 0) {
+			opts->decode_box_width = IMAGE_MAX_DIMENSION;
+			opts->decode_box_height = (unsigned int)opts->terminal.height;
+		}
+
+	} else if (opts->terminal.cols > 0 && opts->terminal.rows > 1) {
+		/* Half blocks, bounded like calculate_target_terminal_dimensions() */
+		opts->decode_box_width = opts->terminal.cols < 1000 ? (unsigned int)opts->terminal.cols : 1000;
+		opts->decode_box_height = (unsigned int)opts->terminal.rows * 2 - 2;
+	}
+}
+
+/**
+ * @brief Scale images to terminal dimensions
+ */
+int pipeline_scale(image_t **frames, int frame_count, const cli_options_t *opts, image_t ***out_scaled)
+{
+	if (frames == NULL || frame_count <= 0 || opts == NULL || out_scaled == NULL) {
+		fprintf(stderr, "pipeline_scale: invalid parameters\n");
+		return -1;
+	}
+
+	target_dimensions_t target = { 0, 0 };
+	if (pipeline_target_dimensions(opts, frames[0]->width, frames[0]->height, &target) < 0) {
 		return -1;
 	}
 
@@ -610,15 +796,56 @@ int pipeline_scale(image_t **frames, int frame_count, const cli_options_t *opts,
 	return 0;
 }
 
+/**
+ * @brief Write frame lines to stdout
+ *
+ * Lines are written as generated, or placed at opts->origin_row and
+ * opts->origin_col with one cursor move per line (without the trailing
+ * newline, so a frame at the bottom of the screen does not scroll).
+ * Stops early when the work is cancelled.
+ *
+ * @param lines Frame lines from generate_frame_ansi()
+ * @param line_count Number of lines
+ * @param opts CLI options (placement)
+ * @return 0 on success, -1 on error or cancellation
+ */
+static int write_frame_lines(char **lines, size_t line_count, const cli_options_t *opts)
+{
+	bool positioned = opts->origin_row >= 0 && opts->origin_col >= 0;
+
+	for (size_t i = 0; i < line_count; i++) {
+		if (i % CANCEL_ROW_BATCH == 0 && cancel_requested()) {
+			return -1;
+		}
+
+		size_t len = strlen(lines[i]);
+		if (positioned) {
+			char move[32];
+			int move_len = snprintf(move, sizeof(move), ANSI_CURSOR_POSITION, opts->origin_row + (int)i + 1, opts->origin_col + 1);
+			if (write(STDOUT_FILENO, move, (size_t)move_len) < 0) {
+				return -1;
+			}
+			len--;
+		}
+
+		if (write(STDOUT_FILENO, lines[i], len) < 0) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
 /**
  * @brief Render single static frame
  *
  * Renders a single frame to the terminal with cursor control.
  *
  * @param frame Image frame to render
+ * @param opts CLI options (placement)
  * @return 0 on success, -1 on error
  */
-static int render_static_frame(image_t *frame)
+static int render_static_frame(image_t *frame, const cli_options_t *opts)
 {
 	if (frame == NULL) {
 		fprintf(stderr, "render_static_frame: invalid frame\n");
@@ -637,11 +864,7 @@ static int render_static_frame(image_t *frame)
 	ansi_cursor_hide();
 
 	/* Output lines to stdout */
-	for (size_t i = 0; i < line_count; i++) {
-		if (write(STDOUT_FILENO, lines[i], strlen(lines[i])) < 0) {
-			return -1;
-		}
-	}
+	int result = write_frame_lines(lines, line_count, opts);
 
 	/* Show cursor and reset */
 	ansi_cursor_show();
@@ -649,7 +872,7 @@ static int render_static_frame(image_t *frame)
 
 	/* Cleanup */
 	free_frame_lines(lines, line_count);
-	return 0;
+	return result;
 }
 
 /**
@@ -712,19 +935,27 @@ static int render_animated(image_t **frames, int frame_count, const cli_options_
 	bool first_iteration = true;
 	while (*running) {
 		for (int frame_idx = 0; frame_idx < frame_count; frame_idx++) {
-			/* Check running flag */
-			if (!*running) {
+			/* Check running flag (and whether a newer request superseded us) */
+			if (!*running || cancel_requested()) {
+				*running = 0;
 				break;
 			}
 
-			/* Move cursor up if not first iteration */
-			if (!first_iteration) {
-				ansi_cursor_up(frame_height + (opts->silent ? 0 : 1));
-			}
+			if (opts->origin_row >= 0 && opts->origin_col >= 0) {
+				/* Placed frame: redraw in place */
+				fflush(stdout);
+				write_frame_lines(all_lines[frame_idx], all_line_counts[frame_idx], opts);
 
-			/* Print frame lines */
-			for (size_t line_idx = 0; line_idx < all_line_counts[frame_idx]; line_idx++) {
-				printf("%s", all_lines[frame_idx][line_idx]);
+			} else {
+				/* Move cursor up if not first iteration */
+				if (!first_iteration) {
+					ansi_cursor_up(frame_height + (opts->silent ? 0 : 1));
+				}
+
+				/* Print frame lines */
+				for (size_t line_idx = 0; line_idx < all_line_counts[frame_idx]; line_idx++) {
+					printf("%s", all_lines[frame_idx][line_idx]);
+				}
 			}
 
 			/* Print control message if not silent */
@@ -747,8 +978,10 @@ static int render_animated(image_t **frames, int frame_count, const cli_options_
 	terminal_enable_echo(echo_state);
 	ansi_reset();
 
-	/* Print newline after animation */
-	printf("\n");
+	/* Print newline after animation (placed frames keep the cursor) */
+	if (opts->origin_row < 0 || opts->origin_col < 0) {
+		printf("\n");
+	}
 
 	/* Cleanup all generated frames */
 	for (int i = 0; i < frame_count; i++) {
@@ -774,7 +1007,135 @@ int pipeline_render(image_t **frames, int frame_count, const cli_options_t *opts
 		return render_animated(frames, frame_count, opts);
 	}
 
-	return render_static_frame(frames[0]);
+	return render_static_frame(frames[0], opts);
+}
+
+/**
+ * @brief Decode, fit to the display box and re-encode an image for iTerm2
+ *
+ * Decodes the image, scales it down to the pixel box iTerm2 will
+ * display it in (derived from the terminal pixel size and the same
+ * sizing rules iterm2_render() passes to the terminal), and re-encodes
+ * it. Encode cost is therefore bounded by the terminal size.
+ *
+ * In downscale mode (convert == false) JPEG sources are re-encoded as
+ * JPEG and everything else as fast PNG, and NULL is returned when there
+ * is nothing to gain: animations, images already at display size, or
+ * results not smaller than the original. In convert mode the image is
+ * always encoded as lossless PNG (first frame of animations, or NULL for
+ * multi-frame input with --animate), so formats iTerm2 cannot decode
+ * itself can still be shown natively.
+ *
+ * @param buffer Original file data
+ * @param buffer_size Original file size
+ * @param opts CLI options (terminal size, sizing flags)
+ * @param convert true to always produce a PNG
+ * @param out_size Output parameter for re-encoded size
+ *
+ * @return Re-encoded file data (caller must free), or NULL
+ */
+static uint8_t *iterm2_reencode(const uint8_t *buffer, size_t buffer_size, const cli_options_t *opts, bool convert, size_t *out_size)
+{
+	if (opts->terminal.width <= 0 || opts->terminal.height <= 0) {
+		return NULL;
+	}
+
+	mime_type_t mime = detect_mime_type(buffer, buffer_size);
+	if (mime == MIME_GIF && !convert) {
+		/* Keep animations intact */
+		return NULL;
+	}
+
+	cli_options_t decode_opts = *opts;
+	image_t **frames = NULL;
+	int frame_count = 0;
+	if (pipeline_decode(&decode_opts, buffer, buffer_size, &frames, &frame_count) < 0) {
+		return NULL;
+	}
+
+	/* A PNG holds one frame: --animate plays sequences as ANSI instead */
+	if (convert && opts->animate && frame_count > 1) {
+		if (!opts->silent) {
+			fprintf(stderr, "Animated input (%d frames), not converting to PNG\n", frame_count);
+		}
+		decoder_free_frames(frames, frame_count);
+		return NULL;
+	}
+
+	image_t *frame = frames[0];
+	uint8_t *encoded = NULL;
+
+	/* Display box in terminal pixels, matching iterm2_render() sizing */
+	target_dimensions_t box = { 0, 0 };
+	bool exact = false;
+
+	if (opts->fit_mode) {
+		box.width = (uint32_t)opts->terminal.width * 9 / 10;
+		box.height = (uint32_t)opts->terminal.height * 9 / 10;
+
+	} else if (opts->target_width == -1 && opts->target_height == -1) {
+		box.width = (uint32_t)opts->terminal.width;
+		box.height = (uint32_t)opts->terminal.height / 2;
+
+	} else if (!calculate_custom_dimensions(frame->width, frame->height, opts->target_width, opts->target_height, &box)) {
+		box.width = 0;
+
+	} else {
+		exact = opts->target_width > 0 && opts->target_height > 0;
+	}
+
+	bool fits = frame->width <= box.width && frame->height <= box.height;
+
+	if (!convert && (frame_count != 1 || box.width == 0 || box.height == 0 || fits)) {
+		/* Animated, unknown box, or already at display size */
+		decoder_free_frames(frames, frame_count);
+		return NULL;
+	}
+
+	/* Only ever scale down; the terminal handles enlarging */
+	image_t *scaled = NULL;
+	if (box.width > 0 && box.height > 0 && !fits) {
+		scaled = exact ? image_scale_resize(frame, box.width, box.height) : image_scale_fit(frame, box.width, box.height);
+		if (scaled == NULL) {
+			decoder_free_frames(frames, frame_count);
+			return NULL;
+		}
+	}
+
+	/* Encoders take RGBA8 */
+	if (scaled == NULL && frame->format != IMAGE_FORMAT_RGBA8) {
+		scaled = image_convert_rgba8(frame);
+		if (scaled == NULL) {
+			decoder_free_frames(frames, frame_count);
+			return NULL;
+		}
+	}
+
+	const image_t *source = scaled != NULL ? scaled : frame;
+
+	size_t encoded_size = 0;
+	if (mime == MIME_JPEG && !convert) {
+		encoded = encode_jpeg(source, ENCODER_JPEG_QUALITY, &encoded_size);
+
+	} else {
+		encoded = encode_png(source, ENCODER_PNG_LEVEL, &encoded_size);
+	}
+
+	if (!opts->silent && encoded != NULL) {
+		fprintf(stderr, "Re-encoded %ux%u as %s: %zu -> %zu bytes\n", source->width, source->height, (mime == MIME_JPEG && !convert) ? "JPEG" : "PNG", buffer_size, encoded_size);
+	}
+
+	image_destroy(scaled);
+	decoder_free_frames(frames, frame_count);
+
+	if (encoded != NULL && !convert && encoded_size >= buffer_size) {
+		/* Not worth it: the original is smaller */
+		free(encoded);
+		return NULL;
+	}
+
+	*out_size = encoded_size;
+	return encoded;
 }
 
 /**
@@ -792,7 +1153,72 @@ int pipeline_render_iterm2(const uint8_t *buffer, size_t buffer_size, const cli_
 	int target_width = opts->target_width;
 	int target_height = opts->target_height;
 
+	/* Optionally send a smaller, display-sized copy instead */
+	if (opts->downscale) {
+		size_t encoded_size = 0;
+		uint8_t *encoded = iterm2_reencode(buffer, buffer_size, opts, false, &encoded_size);
+		if (encoded != NULL) {
+			int result = iterm2_render(encoded, encoded_size, opts, target_width, target_height);
+			free(encoded);
+			return result;
+		}
+	}
+
 	/* Render using iTerm2 protocol with sizing parameters */
 	/* Note: iTerm2 uses original image size by default unless dimensions specified */
 	return iterm2_render(buffer, buffer_size, opts, target_width, target_height);
 }
+
+/**
+ * @brief Render a format iTerm2 cannot decode by converting it to PNG
+ */
+int pipeline_render_iterm2_converted(const uint8_t *buffer, size_t buffer_size, const cli_options_t *opts)
+{
+	/* Validate inputs */
+	if (buffer == NULL || buffer_size == 0 || opts == NULL) {
+		fprintf(stderr, "pipeline_render_iterm2_converted: invalid parameters\n");
+		return -1;
+	}
+
+	size_t encoded_size = 0;
+	uint8_t *encoded = iterm2_reencode(buffer, buffer_size, opts, true, &encoded_size);
+	if (encoded == NULL) {
+		return -1;
+	}
+
+	int result = iterm2_render(encoded, encoded_size, opts, opts->target_width, opts->target_height);
+	free(encoded);
+
+	return result;
+}
+
+/**
+ * @brief Render a PNG file using Kitty graphics protocol passthrough
+ */
+int pipeline_render_kitty_png(const uint8_t *buffer, size_t buffer_size, const cli_options_t *opts)
+{
+	/* Validate inputs: signature (8) + IHDR length/type (8) + width/height (8) */
+	if (buffer == NULL || buffer_size < 24 || opts == NULL) {
+		fprintf(stderr, "pipeline_render_kitty_png: invalid parameters\n");
+		return -1;
+	}
+
+	/* IHDR is always the first chunk; dimensions are big-endian */
+	if (memcmp(buffer + 12, "IHDR", 4) != 0) {
+		return -1;
+	}
+
+	uint32_t width = ((uint32_t)buffer[16] << 24) | ((uint32_t)buffer[17] << 16) | ((uint32_t)buffer[18] << 8) | buffer[19];
+	uint32_t height = ((uint32_t)buffer[20] << 24) | ((uint32_t)buffer[21] << 16) | ((uint32_t)buffer[22] << 8) | buffer[23];
+
+	if (width == 0 || height == 0 || width > IMAGE_MAX_DIMENSION || height > IMAGE_MAX_DIMENSION) {
+		return -1;
+	}
+
+	target_dimensions_t target = { 0, 0 };
+	if (pipeline_target_dimensions(opts, width, height, &target) < 0) {
+		return -1;
+	}
+
+	return kitty_render_png(buffer, buffer_size, opts, width, height, target.width, target.height);
+}
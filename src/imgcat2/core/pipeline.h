@@ -45,6 +45,28 @@
  */
 bool read_file_secure(const char *path, uint8_t **out_data, size_t *out_size);
 
+#ifndef _WIN32
+/**
+ * @brief Map file read-only with path traversal protection and size limits
+ *
+ * Performs the same validation as read_file_secure() but maps the file
+ * with mmap() instead of copying it, so large inputs are paged in on
+ * demand and never duplicated in memory. TIFF files up to
+ * IMAGE_MAX_MAPPED_FILE_SIZE are accepted, since they are read piecewise;
+ * every other format is rejected above IMAGE_MAX_FILE_SIZE right after
+ * mapping, so no caller (passthrough, cache, decoder) sees it.
+ *
+ * @param path File path to map
+ * @param out_data Output parameter for the mapping (release with munmap())
+ * @param out_size Output parameter for file size in bytes
+ *
+ * @return true on success, false on error
+ *
+ * @note The mapping is private and read-only
+ */
+bool map_file_secure(const char *path, uint8_t **out_data, size_t *out_size);
+#endif
+
 /**
  * @brief Read from stdin with size limits (pipe support)
  *
@@ -124,6 +146,33 @@ target_dimensions_t calculate_target_terminal_dimensions(uint32_t cols, uint32_t
  */
 int pipeline_read(const cli_options_t *opts, uint8_t **out_data, size_t *out_size);
 
+/**
+ * @brief Read input, memory-mapping regular files where supported
+ *
+ * Like pipeline_read(), but input files are mapped with
+ * map_file_secure() instead of being copied. Stdin (and all input on
+ * Windows) is still read into a heap buffer.
+ *
+ * @param opts CLI options structure
+ * @param out_data Output parameter for input data
+ * @param out_size Output parameter for data size
+ * @param out_mapped Output parameter, true if *out_data is a mapping
+ *
+ * @return 0 on success, -1 on error
+ *
+ * @note Release the buffer with pipeline_release()
+ */
+int pipeline_read_mapped(const cli_options_t *opts, uint8_t **out_data, size_t *out_size, bool *out_mapped);
+
+/**
+ * @brief Release a buffer returned by pipeline_read_mapped()
+ *
+ * @param data Input data (NULL is ignored)
+ * @param size Data size in bytes
+ * @param mapped Mapping flag returned by pipeline_read_mapped()
+ */
+void pipeline_release(uint8_t *data, size_t size, bool mapped);
+
 /**
  * @brief Decode image with MIME type detection
  *
@@ -140,6 +189,38 @@ int pipeline_read(const cli_options_t *opts, uint8_t **out_data, size_t *out_siz
  */
 int pipeline_decode(cli_options_t *opts, const uint8_t *buffer, size_t size, image_t ***out_frames, int *out_frame_count);
 
+/**
+ * @brief Calculate output dimensions for an image of the given size
+ *
+ * Applies the same sizing rules as pipeline_scale() (custom -w/-H,
+ * Kitty pixel sizing, or ANSI cell sizing) without needing decoded
+ * pixels, so passthrough renderers can size images from header data.
+ *
+ * @param opts CLI options (fit_mode, custom dimensions, terminal)
+ * @param img_width Source image width in pixels
+ * @param img_height Source image height in pixels
+ * @param out_target Output parameter for target dimensions
+ *
+ * @return 0 on success, -1 on error
+ */
+int pipeline_target_dimensions(const cli_options_t *opts, uint32_t img_width, uint32_t img_height, target_dimensions_t *out_target);
+
+/**
+ * @brief Set the decode size hint for rendering to the terminal
+ *
+ * Stores in opts->decode_box_width/height the largest box
+ * pipeline_target_dimensions() can fit any image into, so that
+ * pipeline_decode() lets decoders produce a reduced image (thumbnails,
+ * pyramid levels, DCT scaling) that still covers the final size.
+ * Stretching with both -w and -H needs the full image and clears the
+ * hint.
+ *
+ * @param opts CLI options (custom dimensions, terminal); box updated in place
+ *
+ * @note Leave the hint unset where full resolution is needed (--info, --view)
+ */
+void pipeline_set_decode_box(cli_options_t *opts);
+
 /**
  * @brief Scale images to terminal dimensions
  *
@@ -184,7 +265,45 @@ int pipeline_render(image_t **frames, int frame_count, const cli_options_t *opts
  *
  * @note Only call when terminal_is_iterm2() returns true
  * @note Automatically falls back to ANSI if rendering fails
+ * @note With opts->downscale, images larger than their display box are
+ *       decoded, scaled and re-encoded (JPEG or fast PNG) and the copy
+ *       is sent instead when it is smaller than the original
  */
 int pipeline_render_iterm2(const uint8_t *buffer, size_t buffer_size, const cli_options_t *opts);
 
+/**
+ * @brief Render any decodable format through the iTerm2 protocol
+ *
+ * For formats iTerm2 cannot decode itself (HEIF, AVIF, JPEG XL, RAW,
+ * SVG, QOI, ...): decodes the image, scales it down to its on-screen
+ * pixel box and sends it as a fast lossless PNG. Animated inputs are
+ * shown as their first frame, unless --animate is set: then multi-frame
+ * inputs are not converted and -1 is returned, so the caller plays them
+ * as ANSI animation.
+ *
+ * @param buffer Raw image file data
+ * @param buffer_size Size of data in bytes
+ * @param opts CLI options (terminal size and sizing flags)
+ *
+ * @return 0 on success, -1 on error (caller falls back to ANSI)
+ */
+int pipeline_render_iterm2_converted(const uint8_t *buffer, size_t buffer_size, const cli_options_t *opts);
+
+/**
+ * @brief Render a PNG file using Kitty graphics protocol passthrough
+ *
+ * Sends the original PNG bytes with f=100 and lets the terminal decode
+ * and scale them. Target size is computed from the IHDR dimensions with
+ * pipeline_target_dimensions() and expressed as c=/r= cell counts.
+ *
+ * @param buffer Raw PNG file data
+ * @param buffer_size Size of data in bytes
+ * @param opts CLI options (sizing, terminal, input file)
+ *
+ * @return 0 on success, -1 on error (caller falls back to decoding)
+ *
+ * @note Only call when the Kitty protocol is in use and the data is PNG
+ */
+int pipeline_render_kitty_png(const uint8_t *buffer, size_t buffer_size, const cli_options_t *opts);
+
 #endif /* IMGCAT2_PIPELINE_H */
@@ -0,0 +1,518 @@
+/**
+ * @file pixel_ops.c
+ * @brief Pixel layout conversion kernels with runtime CPU dispatch
+ */
+
+#include <string.h>
+
+#include "pixel_ops.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PIXEL_OPS_X86 1
+#include <immintrin.h>
+#define PIXEL_TARGET(isa) __attribute__((target(isa)))
+#elif defined(__ARM_NEON)
+#define PIXEL_OPS_NEON 1
+#include <arm_neon.h>
+#endif
+
+/**
+ * @brief Row conversion kernel
+ */
+typedef void (*pixel_kernel_func_t)(const uint8_t *src, uint8_t *dst, size_t count);
+
+/**
+ * @struct pixel_ops_t
+ * @brief One set of kernels
+ */
+typedef struct {
+	pixel_isa_t isa; /**< Instruction set */
+	pixel_kernel_func_t rgb_to_rgba; /**< RGB -> RGBA */
+	pixel_kernel_func_t bgr_to_rgba; /**< BGR -> RGBA */
+	pixel_kernel_func_t gray_to_rgba; /**< Gray -> RGBA */
+	pixel_kernel_func_t bgra_to_rgba; /**< BGRA -> RGBA */
+	pixel_kernel_func_t rgba_to_rgb; /**< RGBA -> RGB */
+} pixel_ops_t;
+
+/* ==== Scalar kernels (also handle the tails of the SIMD kernels) ==== */
+
+static void scalar_rgb_to_rgba(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		dst[i * 4 + 0] = src[i * 3 + 0];
+		dst[i * 4 + 1] = src[i * 3 + 1];
+		dst[i * 4 + 2] = src[i * 3 + 2];
+		dst[i * 4 + 3] = 255;
+	}
+}
+
+static void scalar_bgr_to_rgba(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		dst[i * 4 + 0] = src[i * 3 + 2];
+		dst[i * 4 + 1] = src[i * 3 + 1];
+		dst[i * 4 + 2] = src[i * 3 + 0];
+		dst[i * 4 + 3] = 255;
+	}
+}
+
+static void scalar_gray_to_rgba(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		dst[i * 4 + 0] = src[i];
+		dst[i * 4 + 1] = src[i];
+		dst[i * 4 + 2] = src[i];
+		dst[i * 4 + 3] = 255;
+	}
+}
+
+static void scalar_bgra_to_rgba(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		/* Read the whole pixel first: src and dst may be the same */
+		uint8_t b = src[i * 4 + 0];
+		uint8_t g = src[i * 4 + 1];
+		uint8_t r = src[i * 4 + 2];
+		uint8_t a = src[i * 4 + 3];
+
+		dst[i * 4 + 0] = r;
+		dst[i * 4 + 1] = g;
+		dst[i * 4 + 2] = b;
+		dst[i * 4 + 3] = a;
+	}
+}
+
+static void scalar_rgba_to_rgb(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		dst[i * 3 + 0] = src[i * 4 + 0];
+		dst[i * 3 + 1] = src[i * 4 + 1];
+		dst[i * 3 + 2] = src[i * 4 + 2];
+	}
+}
+
+static const pixel_ops_t s_scalar_ops = {
+	.isa = PIXEL_ISA_SCALAR,
+	.rgb_to_rgba = scalar_rgb_to_rgba,
+	.bgr_to_rgba = scalar_bgr_to_rgba,
+	.gray_to_rgba = scalar_gray_to_rgba,
+	.bgra_to_rgba = scalar_bgra_to_rgba,
+	.rgba_to_rgb = scalar_rgba_to_rgb,
+};
+
+#ifdef PIXEL_OPS_X86
+
+/* ==== SSSE3 kernels: 16 pixels per iteration through pshufb ==== */
+
+/**
+ * @brief Expand 3-byte pixels to RGBA, reordering them with mask
+ */
+PIXEL_TARGET("ssse3")
+static inline size_t ssse3_expand3(const uint8_t *src, uint8_t *dst, size_t count, __m128i mask)
+{
+	const __m128i alpha = _mm_set1_epi32((int)0xFF000000u);
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		const uint8_t *s = src + i * 3;
+		uint8_t *d = dst + i * 4;
+
+		__m128i a = _mm_loadu_si128((const __m128i *)s);
+		__m128i b = _mm_loadu_si128((const __m128i *)(s + 16));
+		__m128i c = _mm_loadu_si128((const __m128i *)(s + 32));
+
+		/* Four pixels (12 bytes) at the start of each register */
+		__m128i p0 = a;
+		__m128i p1 = _mm_alignr_epi8(b, a, 12);
+		__m128i p2 = _mm_alignr_epi8(c, b, 8);
+		__m128i p3 = _mm_srli_si128(c, 4);
+
+		_mm_storeu_si128((__m128i *)d, _mm_or_si128(_mm_shuffle_epi8(p0, mask), alpha));
+		_mm_storeu_si128((__m128i *)(d + 16), _mm_or_si128(_mm_shuffle_epi8(p1, mask), alpha));
+		_mm_storeu_si128((__m128i *)(d + 32), _mm_or_si128(_mm_shuffle_epi8(p2, mask), alpha));
+		_mm_storeu_si128((__m128i *)(d + 48), _mm_or_si128(_mm_shuffle_epi8(p3, mask), alpha));
+	}
+
+	return i;
+}
+
+PIXEL_TARGET("ssse3")
+static void ssse3_rgb_to_rgba(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	const __m128i mask = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	size_t i = ssse3_expand3(src, dst, count, mask);
+	scalar_rgb_to_rgba(src + i * 3, dst + i * 4, count - i);
+}
+
+PIXEL_TARGET("ssse3")
+static void ssse3_bgr_to_rgba(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	const __m128i mask = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+	size_t i = ssse3_expand3(src, dst, count, mask);
+	scalar_bgr_to_rgba(src + i * 3, dst + i * 4, count - i);
+}
+
+PIXEL_TARGET("ssse3")
+static void ssse3_gray_to_rgba(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	const __m128i ff = _mm_set1_epi8(-1);
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		__m128i g = _mm_loadu_si128((const __m128i *)(src + i));
+		uint8_t *d = dst + i * 4;
+
+		/* g g pairs and g 0xFF pairs, interleaved into g g g 0xFF */
+		__m128i gg_lo = _mm_unpacklo_epi8(g, g);
+		__m128i gg_hi = _mm_unpackhi_epi8(g, g);
+		__m128i ga_lo = _mm_unpacklo_epi8(g, ff);
+		__m128i ga_hi = _mm_unpackhi_epi8(g, ff);
+
+		_mm_storeu_si128((__m128i *)d, _mm_unpacklo_epi16(gg_lo, ga_lo));
+		_mm_storeu_si128((__m128i *)(d + 16), _mm_unpackhi_epi16(gg_lo, ga_lo));
+		_mm_storeu_si128((__m128i *)(d + 32), _mm_unpacklo_epi16(gg_hi, ga_hi));
+		_mm_storeu_si128((__m128i *)(d + 48), _mm_unpackhi_epi16(gg_hi, ga_hi));
+	}
+
+	scalar_gray_to_rgba(src + i, dst + i * 4, count - i);
+}
+
+PIXEL_TARGET("ssse3")
+static void ssse3_bgra_to_rgba(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	const __m128i mask = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(src + i * 4));
+		_mm_storeu_si128((__m128i *)(dst + i * 4), _mm_shuffle_epi8(v, mask));
+	}
+
+	scalar_bgra_to_rgba(src + i * 4, dst + i * 4, count - i);
+}
+
+PIXEL_TARGET("ssse3")
+static void ssse3_rgba_to_rgb(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	const __m128i mask = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		const uint8_t *s = src + i * 4;
+		uint8_t *d = dst + i * 3;
+
+		/* Four pixels packed into the low 12 bytes of each register */
+		__m128i p0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)s), mask);
+		__m128i p1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(s + 16)), mask);
+		__m128i p2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(s + 32)), mask);
+		__m128i p3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(s + 48)), mask);
+
+		_mm_storeu_si128((__m128i *)d, _mm_or_si128(p0, _mm_slli_si128(p1, 12)));
+		_mm_storeu_si128((__m128i *)(d + 16), _mm_or_si128(_mm_srli_si128(p1, 4), _mm_slli_si128(p2, 8)));
+		_mm_storeu_si128((__m128i *)(d + 32), _mm_or_si128(_mm_srli_si128(p2, 8), _mm_slli_si128(p3, 4)));
+	}
+
+	scalar_rgba_to_rgb(src + i * 4, dst + i * 3, count - i);
+}
+
+static const pixel_ops_t s_ssse3_ops = {
+	.isa = PIXEL_ISA_SSSE3,
+	.rgb_to_rgba = ssse3_rgb_to_rgba,
+	.bgr_to_rgba = ssse3_bgr_to_rgba,
+	.gray_to_rgba = ssse3_gray_to_rgba,
+	.bgra_to_rgba = ssse3_bgra_to_rgba,
+	.rgba_to_rgb = ssse3_rgba_to_rgb,
+};
+
+/* ==== AVX2 kernels: 32-byte shuffles, pshufb works per 128-bit lane ==== */
+
+/**
+ * @brief Expand 3-byte pixels to RGBA, reordering them with mask
+ *
+ * Each lane gets four pixels from its own 16-byte load; the second load
+ * of the last iteration reads 4 bytes past its pixels, so the loop
+ * leaves at least 18 pixels for it.
+ */
+PIXEL_TARGET("avx2")
+static inline size_t avx2_expand3(const uint8_t *src, uint8_t *dst, size_t count, __m256i mask)
+{
+	const __m256i alpha = _mm256_set1_epi32((int)0xFF000000u);
+
+	size_t i = 0;
+	for (; i + 18 <= count; i += 16) {
+		const uint8_t *s = src + i * 3;
+		uint8_t *d = dst + i * 4;
+
+		__m256i lo = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)s)), _mm_loadu_si128((const __m128i *)(s + 12)), 1);
+		__m256i hi = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(s + 24))), _mm_loadu_si128((const __m128i *)(s + 36)), 1);
+
+		_mm256_storeu_si256((__m256i *)d, _mm256_or_si256(_mm256_shuffle_epi8(lo, mask), alpha));
+		_mm256_storeu_si256((__m256i *)(d + 32), _mm256_or_si256(_mm256_shuffle_epi8(hi, mask), alpha));
+	}
+
+	return i;
+}
+
+PIXEL_TARGET("avx2")
+static void avx2_rgb_to_rgba(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	const __m256i mask = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	size_t i = avx2_expand3(src, dst, count, mask);
+	scalar_rgb_to_rgba(src + i * 3, dst + i * 4, count - i);
+}
+
+PIXEL_TARGET("avx2")
+static void avx2_bgr_to_rgba(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	const __m256i mask = _mm256_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+	size_t i = avx2_expand3(src, dst, count, mask);
+	scalar_bgr_to_rgba(src + i * 3, dst + i * 4, count - i);
+}
+
+PIXEL_TARGET("avx2")
+static void avx2_gray_to_rgba(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	/* 16 gray bytes in both lanes; each shuffle spreads 8 of them */
+	const __m256i lo_mask = _mm256_setr_epi8(0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1, 4, 4, 4, -1, 5, 5, 5, -1, 6, 6, 6, -1, 7, 7, 7, -1);
+	const __m256i hi_mask = _mm256_setr_epi8(8, 8, 8, -1, 9, 9, 9, -1, 10, 10, 10, -1, 11, 11, 11, -1, 12, 12, 12, -1, 13, 13, 13, -1, 14, 14, 14, -1, 15, 15, 15, -1);
+	const __m256i alpha = _mm256_set1_epi32((int)0xFF000000u);
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		__m256i g = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(src + i)));
+		uint8_t *d = dst + i * 4;
+
+		_mm256_storeu_si256((__m256i *)d, _mm256_or_si256(_mm256_shuffle_epi8(g, lo_mask), alpha));
+		_mm256_storeu_si256((__m256i *)(d + 32), _mm256_or_si256(_mm256_shuffle_epi8(g, hi_mask), alpha));
+	}
+
+	scalar_gray_to_rgba(src + i, dst + i * 4, count - i);
+}
+
+PIXEL_TARGET("avx2")
+static void avx2_bgra_to_rgba(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	const __m256i mask = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)(src + i * 4));
+		_mm256_storeu_si256((__m256i *)(dst + i * 4), _mm256_shuffle_epi8(v, mask));
+	}
+
+	scalar_bgra_to_rgba(src + i * 4, dst + i * 4, count - i);
+}
+
+/* Packing to RGB crosses lanes; the SSSE3 kernel is used under AVX2 too */
+static const pixel_ops_t s_avx2_ops = {
+	.isa = PIXEL_ISA_AVX2,
+	.rgb_to_rgba = avx2_rgb_to_rgba,
+	.bgr_to_rgba = avx2_bgr_to_rgba,
+	.gray_to_rgba = avx2_gray_to_rgba,
+	.bgra_to_rgba = avx2_bgra_to_rgba,
+	.rgba_to_rgb = ssse3_rgba_to_rgb,
+};
+
+#endif /* PIXEL_OPS_X86 */
+
+#ifdef PIXEL_OPS_NEON
+
+/* ==== NEON kernels: structured loads and stores, 16 pixels per iteration ==== */
+
+static void neon_rgb_to_rgba(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		uint8x16x3_t v = vld3q_u8(src + i * 3);
+		uint8x16x4_t out = { { v.val[0], v.val[1], v.val[2], vdupq_n_u8(255) } };
+		vst4q_u8(dst + i * 4, out);
+	}
+
+	scalar_rgb_to_rgba(src + i * 3, dst + i * 4, count - i);
+}
+
+static void neon_bgr_to_rgba(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		uint8x16x3_t v = vld3q_u8(src + i * 3);
+		uint8x16x4_t out = { { v.val[2], v.val[1], v.val[0], vdupq_n_u8(255) } };
+		vst4q_u8(dst + i * 4, out);
+	}
+
+	scalar_bgr_to_rgba(src + i * 3, dst + i * 4, count - i);
+}
+
+static void neon_gray_to_rgba(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		uint8x16_t g = vld1q_u8(src + i);
+		uint8x16x4_t out = { { g, g, g, vdupq_n_u8(255) } };
+		vst4q_u8(dst + i * 4, out);
+	}
+
+	scalar_gray_to_rgba(src + i, dst + i * 4, count - i);
+}
+
+static void neon_bgra_to_rgba(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		uint8x16x4_t v = vld4q_u8(src + i * 4);
+		uint8x16_t b = v.val[0];
+		v.val[0] = v.val[2];
+		v.val[2] = b;
+		vst4q_u8(dst + i * 4, v);
+	}
+
+	scalar_bgra_to_rgba(src + i * 4, dst + i * 4, count - i);
+}
+
+static void neon_rgba_to_rgb(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		uint8x16x4_t v = vld4q_u8(src + i * 4);
+		uint8x16x3_t out = { { v.val[0], v.val[1], v.val[2] } };
+		vst3q_u8(dst + i * 3, out);
+	}
+
+	scalar_rgba_to_rgb(src + i * 4, dst + i * 3, count - i);
+}
+
+static const pixel_ops_t s_neon_ops = {
+	.isa = PIXEL_ISA_NEON,
+	.rgb_to_rgba = neon_rgb_to_rgba,
+	.bgr_to_rgba = neon_bgr_to_rgba,
+	.gray_to_rgba = neon_gray_to_rgba,
+	.bgra_to_rgba = neon_bgra_to_rgba,
+	.rgba_to_rgb = neon_rgba_to_rgb,
+};
+
+#endif /* PIXEL_OPS_NEON */
+
+/* Scalar until pixel_ops_init() runs */
+static const pixel_ops_t *s_ops = &s_scalar_ops;
+
+pixel_isa_t pixel_ops_detect(void)
+{
+#if defined(PIXEL_OPS_X86)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return PIXEL_ISA_AVX2;
+
+	} else if (__builtin_cpu_supports("ssse3")) {
+		return PIXEL_ISA_SSSE3;
+	}
+	return PIXEL_ISA_SCALAR;
+#elif defined(PIXEL_OPS_NEON)
+	return PIXEL_ISA_NEON;
+#else
+	return PIXEL_ISA_SCALAR;
+#endif
+}
+
+bool pixel_ops_select(pixel_isa_t isa)
+{
+	pixel_isa_t best = pixel_ops_detect();
+
+	switch (isa) {
+		case PIXEL_ISA_SCALAR:
+			s_ops = &s_scalar_ops;
+			return true;
+
+#ifdef PIXEL_OPS_X86
+		case PIXEL_ISA_SSSE3:
+			if (best != PIXEL_ISA_SSSE3 && best != PIXEL_ISA_AVX2) {
+				return false;
+			}
+			s_ops = &s_ssse3_ops;
+			return true;
+
+		case PIXEL_ISA_AVX2:
+			if (best != PIXEL_ISA_AVX2) {
+				return false;
+			}
+			s_ops = &s_avx2_ops;
+			return true;
+#endif
+
+#ifdef PIXEL_OPS_NEON
+		case PIXEL_ISA_NEON:
+			s_ops = &s_neon_ops;
+			return true;
+#endif
+
+		default:
+			(void)best;
+			return false;
+	}
+}
+
+void pixel_ops_init(void)
+{
+	pixel_ops_select(pixel_ops_detect());
+}
+
+pixel_isa_t pixel_ops_active(void)
+{
+	return s_ops->isa;
+}
+
+const char *pixel_isa_name(pixel_isa_t isa)
+{
+	switch (isa) {
+		case PIXEL_ISA_SSSE3:
+			return "ssse3";
+		case PIXEL_ISA_AVX2:
+			return "avx2";
+		case PIXEL_ISA_NEON:
+			return "neon";
+		default:
+			return "scalar";
+	}
+}
+
+void pixel_rgb_to_rgba(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	s_ops->rgb_to_rgba(src, dst, count);
+}
+
+void pixel_bgr_to_rgba(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	s_ops->bgr_to_rgba(src, dst, count);
+}
+
+void pixel_gray_to_rgba(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	s_ops->gray_to_rgba(src, dst, count);
+}
+
+void pixel_bgra_to_rgba(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	s_ops->bgra_to_rgba(src, dst, count);
+}
+
+void pixel_rgba_to_rgb(const uint8_t *src, uint8_t *dst, size_t count)
+{
+	s_ops->rgba_to_rgb(src, dst, count);
+}
+
+void pixel_abgr32_to_rgba(const uint32_t *src, uint8_t *dst, size_t count)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	/* Words are stored R, G, B, A already */
+	if ((const void *)src != (const void *)dst) {
+		memcpy(dst, src, count * 4);
+	}
+#else
+	for (size_t i = 0; i < count; i++) {
+		uint32_t abgr = src[i];
+		dst[i * 4 + 0] = (uint8_t)(abgr & 0xFF);
+		dst[i * 4 + 1] = (uint8_t)((abgr >> 8) & 0xFF);
+		dst[i * 4 + 2] = (uint8_t)((abgr >> 16) & 0xFF);
+		dst[i * 4 + 3] = (uint8_t)(abgr >> 24);
+	}
+#endif
+}
@@ -0,0 +1,126 @@
+/**
+ * @file pixel_ops.h
+ * @brief Pixel layout conversion kernels with runtime CPU dispatch
+ *
+ * Expands and swizzles rows of pixels between the layouts decoders
+ * produce (gray, RGB, BGR, BGRA) and RGBA8888. Each kernel has a scalar
+ * version and SSSE3/AVX2 (x86, chosen through CPUID) or NEON (ARM)
+ * versions; pixel_ops_init() picks the best set once at startup.
+ * Until then the scalar kernels are used, so calling a kernel is always
+ * safe.
+ */
+
+#ifndef IMGCAT2_PIXEL_OPS_H
+#define IMGCAT2_PIXEL_OPS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Instruction set a kernel set is written for
+ */
+typedef enum {
+	PIXEL_ISA_SCALAR = 0, /**< Portable C */
+	PIXEL_ISA_SSSE3, /**< x86 SSSE3 (pshufb) */
+	PIXEL_ISA_AVX2, /**< x86 AVX2 */
+	PIXEL_ISA_NEON, /**< ARM NEON */
+} pixel_isa_t;
+
+/**
+ * @brief Select the fastest kernels the CPU supports
+ *
+ * Call once before starting threads; kernels read the selection without
+ * locking.
+ */
+void pixel_ops_init(void);
+
+/**
+ * @brief Best instruction set supported by this CPU and build
+ *
+ * @return Detected instruction set
+ */
+pixel_isa_t pixel_ops_detect(void);
+
+/**
+ * @brief Use the kernels for a specific instruction set
+ *
+ * @param isa Instruction set to use
+ * @return true on success, false if the CPU or build does not support it
+ */
+bool pixel_ops_select(pixel_isa_t isa);
+
+/**
+ * @brief Instruction set of the kernels in use
+ *
+ * @return Active instruction set
+ */
+pixel_isa_t pixel_ops_active(void);
+
+/**
+ * @brief Human readable instruction set name
+ *
+ * @param isa Instruction set
+ * @return Static name string ("scalar", "ssse3", "avx2", "neon")
+ */
+const char *pixel_isa_name(pixel_isa_t isa);
+
+/**
+ * @brief Expand RGB to RGBA with opaque alpha
+ *
+ * @param src count × 3 bytes
+ * @param dst count × 4 bytes (must not overlap src)
+ * @param count Number of pixels
+ */
+void pixel_rgb_to_rgba(const uint8_t *src, uint8_t *dst, size_t count);
+
+/**
+ * @brief Expand BGR to RGBA with opaque alpha
+ *
+ * @param src count × 3 bytes
+ * @param dst count × 4 bytes (must not overlap src)
+ * @param count Number of pixels
+ */
+void pixel_bgr_to_rgba(const uint8_t *src, uint8_t *dst, size_t count);
+
+/**
+ * @brief Expand gray to RGBA with opaque alpha
+ *
+ * @param src count bytes
+ * @param dst count × 4 bytes (must not overlap src)
+ * @param count Number of pixels
+ */
+void pixel_gray_to_rgba(const uint8_t *src, uint8_t *dst, size_t count);
+
+/**
+ * @brief Swap the red and blue channels of BGRA pixels
+ *
+ * @param src count × 4 bytes
+ * @param dst count × 4 bytes (may be the same buffer as src)
+ * @param count Number of pixels
+ */
+void pixel_bgra_to_rgba(const uint8_t *src, uint8_t *dst, size_t count);
+
+/**
+ * @brief Drop the alpha channel of RGBA pixels
+ *
+ * @param src count × 4 bytes
+ * @param dst count × 3 bytes (must not overlap src)
+ * @param count Number of pixels
+ */
+void pixel_rgba_to_rgb(const uint8_t *src, uint8_t *dst, size_t count);
+
+/**
+ * @brief Unpack 32-bit words holding A, B, G, R from high to low byte
+ *
+ * This is libtiff's TIFFReadRGBA* raster layout. On little-endian CPUs
+ * the bytes already are R, G, B, A and nothing is moved when src and
+ * dst are the same buffer.
+ *
+ * @param src count words
+ * @param dst count × 4 bytes (may be the same buffer as src)
+ * @param count Number of pixels
+ */
+void pixel_abgr32_to_rgba(const uint32_t *src, uint8_t *dst, size_t count);
+
+#endif /* IMGCAT2_PIXEL_OPS_H */
@@ -0,0 +1,264 @@
+/**
+ * @file preview.c
+ * @brief Long-running previewer coprocess implementation
+ *
+ * Requests are read with read(2) into a private buffer rather than
+ * through stdio, so poll(2) on stdin reliably tells whether a newer
+ * request is waiting. That check is installed as the cancellation
+ * callback while a request renders.
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../ansi/ansi.h"
+#include "../terminal/kitty.h"
+#include "cancel.h"
+#include "preview.h"
+
+/**
+ * @struct preview_reader_t
+ * @brief Request line buffer over stdin
+ */
+typedef struct {
+	char buf[PREVIEW_LINE_MAX * 2]; /**< Pending input */
+	size_t len; /**< Bytes in buf */
+	bool eof; /**< stdin reached end of file or failed */
+} preview_reader_t;
+
+/**
+ * @brief Read available input into the buffer
+ *
+ * @param reader Reader state
+ * @param block true to wait for input, false to only take what is ready
+ */
+static void preview_fill(preview_reader_t *reader, bool block)
+{
+	while (!reader->eof) {
+		if (!block) {
+			struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+			if (poll(&pfd, 1, 0) <= 0) {
+				return;
+			}
+		}
+
+		/* A full buffer without a newline is an overlong line: drop it */
+		if (reader->len == sizeof(reader->buf)) {
+			reader->len = 0;
+		}
+
+		ssize_t n = read(STDIN_FILENO, reader->buf + reader->len, sizeof(reader->buf) - reader->len);
+		if (n < 0 && errno == EINTR) {
+			continue;
+
+		} else if (n <= 0) {
+			reader->eof = true;
+			return;
+		}
+
+		reader->len += (size_t)n;
+		if (block) {
+			return;
+		}
+	}
+}
+
+/**
+ * @brief Take the newest complete line, discarding older ones
+ *
+ * @param reader Reader state
+ * @param out Output buffer (PREVIEW_LINE_MAX bytes)
+ *
+ * @return true if a line was taken
+ */
+static bool preview_take_latest(preview_reader_t *reader, char *out)
+{
+	char *last = NULL;
+	for (size_t i = reader->len; i > 0; i--) {
+		if (reader->buf[i - 1] == '\n') {
+			last = reader->buf + i - 1;
+			break;
+		}
+	}
+
+	if (last == NULL) {
+		return false;
+	}
+
+	char *start = last;
+	while (start > reader->buf && start[-1] != '\n') {
+		start--;
+	}
+
+	size_t line_len = (size_t)(last - start);
+	if (line_len > 0 && start[line_len - 1] == '\r') {
+		line_len--;
+	}
+
+	bool fits = line_len < PREVIEW_LINE_MAX;
+	if (fits) {
+		memcpy(out, start, line_len);
+		out[line_len] = '\0';
+	}
+
+	/* Keep a partial line following the taken one */
+	size_t consumed = (size_t)(last + 1 - reader->buf);
+	memmove(reader->buf, last + 1, reader->len - consumed);
+	reader->len -= consumed;
+
+	return fits;
+}
+
+/**
+ * @brief Cancellation check: has a newer request arrived?
+ *
+ * Any pending input counts, even a partial line. End of input does not
+ * cancel, so the last request is always completed.
+ */
+static bool preview_superseded(void *ctx)
+{
+	preview_reader_t *reader = (preview_reader_t *)ctx;
+	if (reader->len == 0) {
+		preview_fill(reader, false);
+	}
+
+	return reader->len > 0;
+}
+
+/**
+ * @brief Parse a non-negative decimal field
+ */
+static int preview_parse_int(const char *field, int *out)
+{
+	char *end;
+	errno = 0;
+	long value = strtol(field, &end, 10);
+	if (end == field || *end != '\0' || errno != 0 || value < 0 || value > 100000) {
+		return -1;
+	}
+
+	*out = (int)value;
+	return 0;
+}
+
+int preview_parse_request(char *line, preview_request_t *req)
+{
+	char *fields[5];
+	int count = 0;
+
+	fields[count++] = line;
+	for (char *p = line; *p != '\0'; p++) {
+		if (*p == '\t') {
+			if (count == 5) {
+				return -1;
+			}
+			*p = '\0';
+			fields[count++] = p + 1;
+		}
+	}
+
+	*req = (preview_request_t) { .path = fields[0] };
+
+	if (count == 1) {
+		return 0;
+
+	} else if (count != 5) {
+		return -1;
+	}
+
+	if (preview_parse_int(fields[1], &req->x) < 0 || preview_parse_int(fields[2], &req->y) < 0 || preview_parse_int(fields[3], &req->width) < 0 || preview_parse_int(fields[4], &req->height) < 0 || req->width == 0 || req->height == 0) {
+		return -1;
+	}
+
+	req->placed = true;
+	return 0;
+}
+
+/**
+ * @brief Remove the previous preview from the screen
+ */
+static void preview_clear(const cli_options_t *opts, const preview_request_t *last)
+{
+	if (opts->terminal.has_kitty && !opts->force_ansi) {
+		kitty_clear(opts);
+	}
+
+	if (last->placed) {
+		ansi_clear_area(last->y, last->x, last->width, last->height);
+	}
+}
+
+int preview_serve(preview_run_func_t run, const cli_options_t *opts)
+{
+	static preview_reader_t reader;
+	static char line[PREVIEW_LINE_MAX];
+	static char last_path[PREVIEW_LINE_MAX];
+
+	preview_request_t last = { .path = last_path };
+
+	/* Cell size in pixels, to size each preview area */
+	int cell_width = opts->terminal.cols > 0 ? opts->terminal.width / opts->terminal.cols : 0;
+	int cell_height = opts->terminal.rows > 0 ? opts->terminal.height / opts->terminal.rows : 0;
+
+	cancel_set_check(preview_superseded, &reader);
+
+	while (1) {
+		/* Wait for a complete line, then collapse everything queued */
+		while (memchr(reader.buf, '\n', reader.len) == NULL && !reader.eof) {
+			preview_fill(&reader, true);
+		}
+		preview_fill(&reader, false);
+
+		if (!preview_take_latest(&reader, line)) {
+			if (reader.eof) {
+				break;
+			}
+			continue;
+		}
+
+		preview_request_t req;
+		if (preview_parse_request(line, &req) < 0) {
+			if (!opts->silent) {
+				fprintf(stderr, "Warning: Ignoring malformed preview request\n");
+			}
+			continue;
+		}
+
+		preview_clear(opts, &last);
+
+		last = req;
+		snprintf(last_path, sizeof(last_path), "%s", req.path);
+		last.path = last_path;
+
+		if (req.path[0] == '\0') {
+			continue;
+		}
+
+		cli_options_t req_opts = *opts;
+		req_opts.input_file = req.path;
+		req_opts.fit_mode = true;
+
+		if (req.placed) {
+			req_opts.origin_row = req.y;
+			req_opts.origin_col = req.x;
+			req_opts.terminal.cols = req.width;
+			req_opts.terminal.rows = req.height;
+			req_opts.terminal.width = req.width * cell_width;
+			req_opts.terminal.height = req.height * cell_height;
+			ansi_cursor_move(req.y, req.x);
+		}
+
+		cancel_reset();
+		run(&req_opts);
+		fflush(stdout);
+	}
+
+	cancel_set_check(NULL, NULL);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file preview.h
+ * @brief Long-running previewer coprocess (--preview-server)
+ *
+ * File managers call their previewer on every cursor move. In preview
+ * server mode imgcat2 stays running and reads one request per line on
+ * stdin:
+ *
+ *     <path> TAB <x> TAB <y> TAB <w> TAB <h> LF
+ *
+ * x and y are the 0-based cell of the top-left corner of the preview
+ * area, w and h its size in cells. A line with only a path renders at
+ * the cursor with the terminal's size; an empty path clears the last
+ * preview.
+ *
+ * Requests are latest-wins: queued requests are collapsed to the newest
+ * one, and a request arriving while one is being rendered cancels the
+ * in-flight work at the next stage boundary or row batch (see cancel.h).
+ */
+
+#ifndef IMGCAT2_PREVIEW_H
+#define IMGCAT2_PREVIEW_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cli.h"
+
+/** Maximum length of a request line */
+#define PREVIEW_LINE_MAX 4096
+
+/**
+ * @struct preview_request_t
+ * @brief A parsed preview request
+ */
+typedef struct {
+	char *path; /**< Image path (empty = clear only) */
+	bool placed; /**< true if x, y, w, h were given */
+	int x; /**< Left column (0-based cells) */
+	int y; /**< Top row (0-based cells) */
+	int width; /**< Width in cells */
+	int height; /**< Height in cells */
+} preview_request_t;
+
+/**
+ * @brief Render callback run for each request
+ *
+ * @param opts Options of the request (input file, placement, geometry)
+ *
+ * @return Exit code of the render (ignored by the server)
+ */
+typedef int (*preview_run_func_t)(cli_options_t *opts);
+
+/**
+ * @brief Parse a request line
+ *
+ * Splits the line in place on tabs; req->path points into line.
+ *
+ * @param line Request line without the trailing newline (modified)
+ * @param req Output request
+ *
+ * @return 0 on success, -1 if the line is malformed
+ */
+int preview_parse_request(char *line, preview_request_t *req);
+
+/**
+ * @brief Serve preview requests from stdin until EOF
+ *
+ * @param run Render callback
+ * @param opts Base options (terminal, sizing and rendering flags)
+ *
+ * @return EXIT_SUCCESS once stdin is closed
+ */
+int preview_serve(preview_run_func_t run, const cli_options_t *opts);
+
+#endif /* IMGCAT2_PREVIEW_H */
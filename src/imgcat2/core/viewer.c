@@ -0,0 +1,746 @@
+/**
+ * @file viewer.c
+ * @brief Interactive pan/zoom viewer implementation
+ *
+ * The viewport is an image_t of cols x text_rows*2 pixels kept between
+ * redraws. Each output pixel maps to one pixel of the pyramid level
+ * picked for the zoom, through per-column and per-row index tables, so
+ * sampling costs one lookup per visible pixel regardless of image size.
+ * Terminal output is assembled in one buffer and written per update.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "../ansi/ansi.h"
+#include "../ansi/escape.h"
+#include "../decoders/decoder.h"
+#include "../terminal/terminal.h"
+#include "pipeline.h"
+#include "viewer.h"
+
+/** Widest viewport in cells (keeps lines within MAX_LINE_BUFFER_SIZE) */
+#define VIEWER_MAX_COLS 1000
+
+/** Alternate screen and cursor control */
+#define VIEWER_ENTER "\x1B[?1049h\x1B[?25l\x1B[2J"
+#define VIEWER_LEAVE "\x1B[0m\x1B[?25h\x1B[?1049l"
+
+/** Set the scroll region to rows 1..N, scroll up / down N lines, reset */
+#define VIEWER_SCROLL_REGION "\x1B[1;%ur"
+#define VIEWER_SCROLL_UP "\x1B[%uS"
+#define VIEWER_SCROLL_DOWN "\x1B[%uT"
+#define VIEWER_SCROLL_RESET "\x1B[r"
+
+/** Set by signal handlers, checked by the input loop */
+static volatile sig_atomic_t s_resized = 0;
+static volatile sig_atomic_t s_quit = 0;
+
+/**
+ * @struct viewer_t
+ * @brief Viewer state
+ */
+typedef struct {
+	const image_t *image; /**< Original image */
+	viewer_pyramid_t pyramid; /**< Reduced copies for zoomed-out views */
+	image_t *view; /**< Sampled viewport pixels */
+	uint32_t cols; /**< Viewport width in cells (= pixels) */
+	uint32_t text_rows; /**< Viewport height in cells (pixels / 2) */
+	double zoom; /**< Output pixels per image pixel */
+	double fit_zoom; /**< Zoom showing the whole image */
+	int64_t origin_x; /**< Zoomed-image x of the viewport's left edge */
+	int64_t origin_y; /**< Zoomed-image y of the viewport's top edge */
+	char label[64]; /**< File name for the status line */
+	char *out; /**< Pending terminal output */
+	size_t out_len; /**< Bytes in out */
+	size_t out_cap; /**< Capacity of out */
+	char line[MAX_LINE_BUFFER_SIZE]; /**< Scratch line for generate_line_ansi() */
+} viewer_t;
+
+int viewer_pyramid_build(const image_t *img, uint32_t min_width, uint32_t min_height, viewer_pyramid_t *out)
+{
+	if (img == NULL || img->pixels == NULL || out == NULL) {
+		return -1;
+	}
+
+	out->levels[0] = img;
+	out->count = 1;
+
+	if (viewer_pyramid_extend(out, min_width, min_height) < 0) {
+		viewer_pyramid_free(out);
+		return -1;
+	}
+
+	return 0;
+}
+
+int viewer_pyramid_extend(viewer_pyramid_t *pyramid, uint32_t min_width, uint32_t min_height)
+{
+	if (pyramid == NULL || pyramid->count == 0) {
+		return -1;
+	}
+
+	const image_t *prev = pyramid->levels[pyramid->count - 1];
+	while (pyramid->count < VIEWER_MAX_LEVELS && (prev->width > min_width || prev->height > min_height) && (prev->width > 1 || prev->height > 1)) {
+		uint32_t width = (prev->width + 1) / 2;
+		uint32_t height = (prev->height + 1) / 2;
+
+		image_t *level = image_create(width, height);
+		if (level == NULL) {
+			return -1;
+		}
+
+		/* 2x2 box filter, edge pixels repeated for odd sizes */
+		for (uint32_t y = 0; y < height; y++) {
+			const uint8_t *row0 = image_row(prev, 2 * y);
+			const uint8_t *row1 = image_row(prev, 2 * y + 1 < prev->height ? 2 * y + 1 : 2 * y);
+			uint8_t *dst = image_row(level, y);
+
+			for (uint32_t x = 0; x < width; x++) {
+				size_t x0 = (size_t)(2 * x) * 4;
+				size_t x1 = (size_t)(2 * x + 1 < prev->width ? 2 * x + 1 : 2 * x) * 4;
+
+				for (int c = 0; c < 4; c++) {
+					dst[x * 4 + c] = (uint8_t)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+				}
+			}
+		}
+
+		level->opaque = prev->opaque;
+		pyramid->levels[pyramid->count++] = level;
+		prev = level;
+	}
+
+	return 0;
+}
+
+void viewer_pyramid_free(viewer_pyramid_t *pyramid)
+{
+	if (pyramid == NULL) {
+		return;
+	}
+
+	for (int i = 1; i < pyramid->count; i++) {
+		image_destroy((image_t *)pyramid->levels[i]);
+		pyramid->levels[i] = NULL;
+	}
+
+	pyramid->count = pyramid->count > 0 ? 1 : 0;
+}
+
+int viewer_level_for_zoom(const viewer_pyramid_t *pyramid, double zoom)
+{
+	int level = 0;
+
+	while (level + 1 < pyramid->count && zoom * (double)(1u << (level + 1)) <= 1.0 + 1e-9) {
+		level++;
+	}
+
+	return level;
+}
+
+/**
+ * @brief Zoomed size of the image along one axis
+ */
+static int64_t viewer_zoomed(uint32_t size, double zoom)
+{
+	int64_t zoomed = (int64_t)floor((double)size * zoom);
+	return zoomed > 0 ? zoomed : 1;
+}
+
+/**
+ * @brief Build the output-to-level index table for one axis
+ *
+ * Entries for positions outside the zoomed image are set to -1.
+ */
+static void viewer_index_map(int32_t *map, uint32_t first, uint32_t last, int64_t origin, int64_t zoomed, uint32_t level_size)
+{
+	double factor = (double)level_size / (double)zoomed;
+
+	for (uint32_t i = first; i < last; i++) {
+		int64_t z = origin + (int64_t)i;
+		if (z < 0 || z >= zoomed) {
+			map[i - first] = -1;
+			continue;
+		}
+
+		int64_t index = (int64_t)(((double)z + 0.5) * factor);
+		map[i - first] = (int32_t)(index < (int64_t)level_size ? index : (int64_t)level_size - 1);
+	}
+}
+
+void viewer_sample(const viewer_pyramid_t *pyramid, double zoom, int64_t origin_x, int64_t origin_y, image_t *out, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1)
+{
+	if (pyramid == NULL || pyramid->count == 0 || out == NULL || x0 >= x1 || y0 >= y1) {
+		return;
+	}
+
+	x1 = x1 < out->width ? x1 : out->width;
+	y1 = y1 < out->height ? y1 : out->height;
+	if (x0 >= x1 || y0 >= y1) {
+		return;
+	}
+
+	const image_t *image = pyramid->levels[0];
+	const image_t *level = pyramid->levels[viewer_level_for_zoom(pyramid, zoom)];
+
+	int32_t *columns = malloc(sizeof(int32_t) * (x1 - x0));
+	if (columns == NULL) {
+		return;
+	}
+	viewer_index_map(columns, x0, x1, origin_x, viewer_zoomed(image->width, zoom), level->width);
+
+	int64_t zoomed_height = viewer_zoomed(image->height, zoom);
+
+	for (uint32_t y = y0; y < y1; y++) {
+		int32_t row;
+		viewer_index_map(&row, y, y + 1, origin_y, zoomed_height, level->height);
+
+		uint8_t *dst = image_row(out, y) + (size_t)x0 * 4;
+		if (row < 0) {
+			memset(dst, 0, (size_t)(x1 - x0) * 4);
+			continue;
+		}
+
+		const uint8_t *src = image_row(level, (uint32_t)row);
+		for (uint32_t x = 0; x < x1 - x0; x++) {
+			if (columns[x] < 0) {
+				memset(&dst[x * 4], 0, 4);
+
+			} else {
+				memcpy(&dst[x * 4], &src[(size_t)columns[x] * 4], 4);
+			}
+		}
+	}
+
+	free(columns);
+}
+
+/**
+ * @brief Append bytes to the pending output
+ */
+static void viewer_append(viewer_t *viewer, const char *data, size_t len)
+{
+	if (viewer->out_len + len > viewer->out_cap) {
+		size_t cap = viewer->out_cap > 0 ? viewer->out_cap : 65536;
+		while (cap < viewer->out_len + len) {
+			cap *= 2;
+		}
+
+		char *out = realloc(viewer->out, cap);
+		if (out == NULL) {
+			return;
+		}
+		viewer->out = out;
+		viewer->out_cap = cap;
+	}
+
+	memcpy(viewer->out + viewer->out_len, data, len);
+	viewer->out_len += len;
+}
+
+/**
+ * @brief Append formatted text to the pending output
+ */
+static void viewer_appendf(viewer_t *viewer, const char *format, unsigned int a, unsigned int b)
+{
+	char buf[64];
+	int len = snprintf(buf, sizeof(buf), format, a, b);
+	if (len > 0) {
+		viewer_append(viewer, buf, (size_t)len < sizeof(buf) ? (size_t)len : sizeof(buf) - 1);
+	}
+}
+
+/**
+ * @brief Write the pending output to the terminal
+ */
+static void viewer_flush(viewer_t *viewer)
+{
+	size_t done = 0;
+	while (done < viewer->out_len) {
+		ssize_t n = write(STDOUT_FILENO, viewer->out + done, viewer->out_len - done);
+		if (n < 0 && errno == EINTR) {
+			continue;
+
+		} else if (n <= 0) {
+			break;
+		}
+		done += (size_t)n;
+	}
+
+	viewer->out_len = 0;
+}
+
+/**
+ * @brief Queue text rows [first, last) of the viewport
+ */
+static void viewer_emit_rows(viewer_t *viewer, uint32_t first, uint32_t last)
+{
+	for (uint32_t row = first; row < last; row++) {
+		if (generate_line_ansi(viewer->view, row * 2, viewer->line) == NULL) {
+			continue;
+		}
+
+		/* Lines end in a newline; positioning replaces it */
+		size_t len = strlen(viewer->line);
+		viewer_appendf(viewer, ANSI_CURSOR_POSITION, row + 1, 1);
+		viewer_append(viewer, viewer->line, len > 0 ? len - 1 : 0);
+	}
+}
+
+/**
+ * @brief Queue the status line below the viewport
+ */
+static void viewer_emit_status(viewer_t *viewer)
+{
+	char status[256];
+	int len = snprintf(status, sizeof(status), " %s  %ux%u  %.0f%%  [arrows/hjkl pan, +/- zoom, 0 fit, 1 100%%, q quit]", viewer->label, viewer->image->width, viewer->image->height, viewer->zoom * 100.0);
+	if (len < 0) {
+		return;
+	}
+
+	size_t width = (size_t)len < sizeof(status) ? (size_t)len : sizeof(status) - 1;
+	if (width > viewer->cols) {
+		width = viewer->cols;
+	}
+
+	viewer_appendf(viewer, ANSI_CURSOR_POSITION, viewer->text_rows + 1, 1);
+	viewer_append(viewer, ANSI_RESET "\x1B[2K\x1B[7m", strlen(ANSI_RESET "\x1B[2K\x1B[7m"));
+	viewer_append(viewer, status, width);
+	viewer_append(viewer, ANSI_RESET, strlen(ANSI_RESET));
+}
+
+/**
+ * @brief Keep the viewport on the image, centering images smaller than it
+ */
+static void viewer_clamp(viewer_t *viewer)
+{
+	int64_t width = viewer->view->width, height = viewer->view->height;
+	int64_t zoomed_width = viewer_zoomed(viewer->image->width, viewer->zoom);
+	int64_t zoomed_height = viewer_zoomed(viewer->image->height, viewer->zoom);
+
+	if (zoomed_width <= width) {
+		viewer->origin_x = -(width - zoomed_width) / 2;
+
+	} else if (viewer->origin_x < 0) {
+		viewer->origin_x = 0;
+
+	} else if (viewer->origin_x > zoomed_width - width) {
+		viewer->origin_x = zoomed_width - width;
+	}
+
+	if (zoomed_height <= height) {
+		viewer->origin_y = -(height - zoomed_height) / 2;
+
+	} else if (viewer->origin_y < 0) {
+		viewer->origin_y = 0;
+
+	} else if (viewer->origin_y > zoomed_height - height) {
+		viewer->origin_y = zoomed_height - height;
+	}
+}
+
+/**
+ * @brief Sample and write the whole viewport
+ */
+static void viewer_redraw(viewer_t *viewer)
+{
+	viewer_sample(&viewer->pyramid, viewer->zoom, viewer->origin_x, viewer->origin_y, viewer->view, 0, 0, viewer->view->width, viewer->view->height);
+	viewer_emit_rows(viewer, 0, viewer->text_rows);
+	viewer_emit_status(viewer);
+	viewer_flush(viewer);
+}
+
+/**
+ * @brief Move the viewport, touching only newly exposed pixels
+ *
+ * Vertical moves by whole text rows scroll the terminal region and
+ * write only the new rows. Horizontal moves shift the sampled pixels
+ * and sample only the new columns; every row is written again since
+ * terminals have no portable horizontal scroll.
+ */
+static void viewer_pan(viewer_t *viewer, int64_t dx, int64_t dy)
+{
+	int64_t old_x = viewer->origin_x, old_y = viewer->origin_y;
+	viewer->origin_x += dx;
+	viewer->origin_y += dy;
+	viewer_clamp(viewer);
+
+	dx = viewer->origin_x - old_x;
+	dy = viewer->origin_y - old_y;
+	if (dx == 0 && dy == 0) {
+		return;
+	}
+
+	image_t *view = viewer->view;
+	int64_t width = view->width, height = view->height;
+	size_t stride = view->stride;
+
+	/* Too far (or not whole text rows): nothing to reuse */
+	if (dx <= -width || dx >= width || dy <= -height || dy >= height || dy % 2 != 0) {
+		viewer_redraw(viewer);
+		return;
+	}
+
+	if (dx != 0) {
+		uint32_t shift = (uint32_t)(dx > 0 ? dx : -dx);
+		for (uint32_t y = 0; y < view->height; y++) {
+			uint8_t *row = image_row(view, y);
+			if (dx > 0) {
+				memmove(row, row + (size_t)shift * 4, (size_t)(view->width - shift) * 4);
+
+			} else {
+				memmove(row + (size_t)shift * 4, row, (size_t)(view->width - shift) * 4);
+			}
+		}
+
+		uint32_t x0 = dx > 0 ? view->width - shift : 0;
+		viewer_sample(&viewer->pyramid, viewer->zoom, viewer->origin_x, viewer->origin_y, view, x0, 0, x0 + shift, view->height);
+	}
+
+	if (dy != 0) {
+		uint32_t shift = (uint32_t)(dy > 0 ? dy : -dy);
+		if (dy > 0) {
+			memmove(view->pixels, view->pixels + (size_t)shift * stride, (size_t)(view->height - shift) * stride);
+
+		} else {
+			memmove(view->pixels + (size_t)shift * stride, view->pixels, (size_t)(view->height - shift) * stride);
+		}
+
+		uint32_t y0 = dy > 0 ? view->height - shift : 0;
+		viewer_sample(&viewer->pyramid, viewer->zoom, viewer->origin_x, viewer->origin_y, view, 0, y0, view->width, y0 + shift);
+	}
+
+	if (dx != 0) {
+		viewer_emit_rows(viewer, 0, viewer->text_rows);
+
+	} else {
+		uint32_t lines = (uint32_t)(dy > 0 ? dy : -dy) / 2;
+		viewer_appendf(viewer, VIEWER_SCROLL_REGION, viewer->text_rows, 0);
+		viewer_appendf(viewer, dy > 0 ? VIEWER_SCROLL_UP : VIEWER_SCROLL_DOWN, lines, 0);
+		viewer_append(viewer, VIEWER_SCROLL_RESET, strlen(VIEWER_SCROLL_RESET));
+
+		if (dy > 0) {
+			viewer_emit_rows(viewer, viewer->text_rows - lines, viewer->text_rows);
+
+		} else {
+			viewer_emit_rows(viewer, 0, lines);
+		}
+	}
+
+	viewer_emit_status(viewer);
+	viewer_flush(viewer);
+}
+
+/**
+ * @brief Change the zoom, keeping the viewport center in place
+ */
+static void viewer_zoom(viewer_t *viewer, double zoom)
+{
+	double min_zoom = viewer->fit_zoom < 1.0 ? viewer->fit_zoom : 1.0;
+	zoom = zoom < min_zoom ? min_zoom : zoom > VIEWER_MAX_ZOOM ? VIEWER_MAX_ZOOM : zoom;
+
+	double center_x = ((double)viewer->origin_x + viewer->view->width / 2.0) / viewer->zoom;
+	double center_y = ((double)viewer->origin_y + viewer->view->height / 2.0) / viewer->zoom;
+
+	viewer->zoom = zoom;
+	viewer->origin_x = (int64_t)llround(center_x * zoom - viewer->view->width / 2.0);
+	viewer->origin_y = (int64_t)llround(center_y * zoom - viewer->view->height / 2.0);
+	viewer_clamp(viewer);
+	viewer_redraw(viewer);
+}
+
+/**
+ * @brief Size the viewport to the terminal
+ *
+ * Extends the pyramid (once built) when a smaller viewport fits the
+ * image at a zoom below its smallest level.
+ *
+ * @return 0 on success, -1 on error
+ */
+static int viewer_resize(viewer_t *viewer)
+{
+	int rows = 0, cols = 0;
+	if (terminal_get_size(&rows, &cols) < 0 || rows < 2 || cols < 1) {
+		rows = DEFAULT_TERM_ROWS;
+		cols = DEFAULT_TERM_COLS;
+	}
+
+	viewer->cols = (uint32_t)cols < VIEWER_MAX_COLS ? (uint32_t)cols : VIEWER_MAX_COLS;
+	viewer->text_rows = (uint32_t)rows - 1;
+
+	image_t *view = image_create(viewer->cols, viewer->text_rows * 2);
+	if (view == NULL) {
+		return -1;
+	}
+	image_destroy(viewer->view);
+	viewer->view = view;
+
+	double fit_x = (double)view->width / viewer->image->width;
+	double fit_y = (double)view->height / viewer->image->height;
+	viewer->fit_zoom = fit_x < fit_y ? fit_x : fit_y;
+	if (viewer->fit_zoom > 1.0) {
+		viewer->fit_zoom = 1.0;
+	}
+
+	/* Out of memory leaves a shallower pyramid, which still samples correctly */
+	if (viewer->pyramid.count > 0) {
+		viewer_pyramid_extend(&viewer->pyramid, view->width, view->height);
+	}
+
+	return 0;
+}
+
+static void viewer_on_resize(int sig)
+{
+	(void)sig;
+	s_resized = 1;
+}
+
+static void viewer_on_quit(int sig)
+{
+	(void)sig;
+	s_quit = 1;
+}
+
+/**
+ * @brief Handle every key in one chunk of keyboard input
+ *
+ * Held or fast-typed keys arrive several to a read; each one is applied
+ * in order. Escape sequences are consumed whole (only arrows act on
+ * the view), a lone Esc quits.
+ *
+ * @return false to quit
+ */
+static bool viewer_key(viewer_t *viewer, const unsigned char *key, size_t len)
+{
+	int64_t step_x = viewer->cols / 8 > 2 ? viewer->cols / 8 : 2;
+	int64_t step_y = 2 * (viewer->text_rows / 8 > 1 ? viewer->text_rows / 8 : 1);
+	int64_t page_x = viewer->cols / 2 > 2 ? viewer->cols / 2 : 2;
+	int64_t page_y = 2 * (viewer->text_rows / 2 > 1 ? viewer->text_rows / 2 : 1);
+
+	size_t i = 0;
+	while (i < len) {
+		/* Escape sequences: ESC [ <parameters> X or ESC O X (arrows end in A-D) */
+		if (key[i] == 0x1B && i + 1 < len && (key[i + 1] == '[' || key[i + 1] == 'O')) {
+			size_t end = i + 2;
+			while (key[i + 1] == '[' && end < len && key[end] >= 0x20 && key[end] <= 0x3F) {
+				end++;
+			}
+
+			/* Split across reads: drop the rest */
+			if (end >= len) {
+				break;
+			}
+
+			switch (key[end]) {
+				case 'A': viewer_pan(viewer, 0, -step_y); break;
+				case 'B': viewer_pan(viewer, 0, step_y); break;
+				case 'C': viewer_pan(viewer, step_x, 0); break;
+				case 'D': viewer_pan(viewer, -step_x, 0); break;
+				default: break;
+			}
+
+			i = end + 1;
+			continue;
+		}
+
+		switch (key[i]) {
+			case 'q':
+			case 0x03: /* Ctrl+C */
+			case 0x1B: return false;
+
+			case 'k': viewer_pan(viewer, 0, -step_y); break;
+			case 'j': viewer_pan(viewer, 0, step_y); break;
+			case 'l': viewer_pan(viewer, step_x, 0); break;
+			case 'h': viewer_pan(viewer, -step_x, 0); break;
+			case 'K': viewer_pan(viewer, 0, -page_y); break;
+			case 'J': viewer_pan(viewer, 0, page_y); break;
+			case 'L': viewer_pan(viewer, page_x, 0); break;
+			case 'H': viewer_pan(viewer, -page_x, 0); break;
+
+			case '+':
+			case '=': viewer_zoom(viewer, viewer->zoom * VIEWER_ZOOM_STEP); break;
+			case '-': viewer_zoom(viewer, viewer->zoom / VIEWER_ZOOM_STEP); break;
+			case '0': viewer_zoom(viewer, viewer->fit_zoom); break;
+			case '1': viewer_zoom(viewer, 1.0); break;
+
+			default: break;
+		}
+
+		i++;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Interactive loop on an initialized viewer
+ */
+static int viewer_loop(viewer_t *viewer, int tty)
+{
+	struct termios saved, raw;
+	if (tcgetattr(tty, &saved) < 0) {
+		fprintf(stderr, "Error: Failed to get terminal attributes: %s\n", strerror(errno));
+		return -1;
+	}
+
+	/* Raw keys; Ctrl+C arrives as a byte so the screen is always restored */
+	raw = saved;
+	raw.c_lflag &= ~(tcflag_t)(ECHO | ICANON | ISIG | IEXTEN);
+	raw.c_iflag &= ~(tcflag_t)(IXON | ICRNL);
+	raw.c_cc[VMIN] = 1;
+	raw.c_cc[VTIME] = 0;
+	if (tcsetattr(tty, TCSANOW, &raw) < 0) {
+		fprintf(stderr, "Error: Failed to set terminal attributes: %s\n", strerror(errno));
+		return -1;
+	}
+
+	struct sigaction sa = { 0 };
+	struct sigaction old_winch, old_term, old_hup;
+	sa.sa_handler = viewer_on_resize;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGWINCH, &sa, &old_winch);
+	sa.sa_handler = viewer_on_quit;
+	sigaction(SIGTERM, &sa, &old_term);
+	sigaction(SIGHUP, &sa, &old_hup);
+
+	viewer_append(viewer, VIEWER_ENTER, strlen(VIEWER_ENTER));
+	viewer_redraw(viewer);
+
+	int result = 0;
+	while (!s_quit) {
+		if (s_resized) {
+			s_resized = 0;
+			if (viewer_resize(viewer) < 0) {
+				result = -1;
+				break;
+			}
+
+			viewer_clamp(viewer);
+			viewer_append(viewer, "\x1B[2J", 4);
+			viewer_redraw(viewer);
+		}
+
+		struct pollfd pfd = { .fd = tty, .events = POLLIN };
+		if (poll(&pfd, 1, -1) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			result = -1;
+			break;
+		}
+
+		unsigned char key[32];
+		ssize_t n = read(tty, key, sizeof(key));
+		if (n < 0 && errno == EINTR) {
+			continue;
+
+		} else if (n <= 0 || !viewer_key(viewer, key, (size_t)n)) {
+			break;
+		}
+	}
+
+	viewer_append(viewer, VIEWER_LEAVE, strlen(VIEWER_LEAVE));
+	viewer_flush(viewer);
+
+	tcsetattr(tty, TCSANOW, &saved);
+	sigaction(SIGWINCH, &old_winch, NULL);
+	sigaction(SIGTERM, &old_term, NULL);
+	sigaction(SIGHUP, &old_hup, NULL);
+
+	return result;
+}
+
+int viewer_run(cli_options_t *opts)
+{
+	if (opts == NULL) {
+		return EXIT_FAILURE;
+	}
+
+	if (!terminal_is_tty(STDOUT_FILENO)) {
+		fprintf(stderr, "Error: --view needs a terminal on standard output\n");
+		return EXIT_FAILURE;
+	}
+
+	/* Keys come from the terminal even when the image is piped in */
+	int tty = opts->input_file != NULL && terminal_is_tty(STDIN_FILENO) ? STDIN_FILENO : open("/dev/tty", O_RDONLY | O_CLOEXEC);
+	if (tty < 0) {
+		fprintf(stderr, "Error: --view needs a terminal for keyboard input\n");
+		return EXIT_FAILURE;
+	}
+
+	/* Decode the full image once */
+	uint8_t *buffer = NULL;
+	size_t size = 0;
+	bool mapped = false;
+	image_t **frames = NULL;
+	int frame_count = 0;
+
+	decoder_registry_init(opts);
+	if (pipeline_read_mapped(opts, &buffer, &size, &mapped) < 0 || pipeline_decode(opts, buffer, size, &frames, &frame_count) < 0) {
+		fprintf(stderr, "Error: Failed to load image\n");
+		pipeline_release(buffer, size, mapped);
+		if (tty != STDIN_FILENO) {
+			close(tty);
+		}
+		return EXIT_FAILURE;
+	}
+	pipeline_release(buffer, size, mapped);
+
+	/* The pyramid and sampling work on RGBA8 */
+	if (frames[0]->format != IMAGE_FORMAT_RGBA8) {
+		image_t *rgba = image_convert_rgba8(frames[0]);
+		if (rgba == NULL) {
+			fprintf(stderr, "Error: Failed to convert image\n");
+			decoder_free_frames(frames, frame_count);
+			if (tty != STDIN_FILENO) {
+				close(tty);
+			}
+			return EXIT_FAILURE;
+		}
+		image_destroy(frames[0]);
+		frames[0] = rgba;
+	}
+
+	viewer_t *viewer = calloc(1, sizeof(viewer_t));
+	int result = -1;
+
+	if (viewer != NULL) {
+		viewer->image = frames[0];
+		const char *name = opts->input_file != NULL ? opts->input_file : "(stdin)";
+		const char *slash = strrchr(name, '/');
+		snprintf(viewer->label, sizeof(viewer->label), "%s", slash != NULL && slash[1] != '\0' ? slash + 1 : name);
+
+		if (viewer_resize(viewer) == 0 && viewer_pyramid_build(viewer->image, viewer->view->width, viewer->view->height, &viewer->pyramid) == 0) {
+			if (!opts->silent) {
+				fprintf(stderr, "Built %d pyramid levels for %ux%u\n", viewer->pyramid.count, viewer->image->width, viewer->image->height);
+			}
+
+			viewer->zoom = viewer->fit_zoom;
+			viewer_clamp(viewer);
+			result = viewer_loop(viewer, tty);
+			viewer_pyramid_free(&viewer->pyramid);
+		}
+
+		image_destroy(viewer->view);
+		free(viewer->out);
+		free(viewer);
+	}
+
+	decoder_free_frames(frames, frame_count);
+	if (tty != STDIN_FILENO) {
+		close(tty);
+	}
+
+	return result == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
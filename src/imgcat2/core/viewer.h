@@ -0,0 +1,125 @@
+/**
+ * @file viewer.h
+ * @brief Interactive pan/zoom viewer for large images (--view)
+ *
+ * Shows one image on the alternate screen with half-block ANSI output.
+ * A mip pyramid (each level half the size of the previous one) is built
+ * once after decoding; every redraw samples only the visible viewport
+ * from the level closest to the current zoom. Panning shifts the
+ * already sampled viewport and samples only the newly exposed rows or
+ * columns; vertical pans also scroll the terminal so only the new text
+ * rows are written.
+ *
+ * Keys: arrows or hjkl pan, HJKL pan by half a screen, + and - zoom,
+ * 0 fits the image, 1 shows it at 100%, q or Esc quits.
+ */
+
+#ifndef IMGCAT2_VIEWER_H
+#define IMGCAT2_VIEWER_H
+
+#include <stdint.h>
+
+#include "cli.h"
+#include "image.h"
+
+/** Maximum number of pyramid levels */
+#define VIEWER_MAX_LEVELS 16
+
+/** Zoom step factor for + and - */
+#define VIEWER_ZOOM_STEP 1.41421356
+
+/** Largest magnification (output pixels per image pixel) */
+#define VIEWER_MAX_ZOOM 16.0
+
+/**
+ * @struct viewer_pyramid_t
+ * @brief Mip pyramid of an image
+ *
+ * levels[0] is the original image (borrowed, not freed); levels[i] is
+ * levels[i - 1] reduced by a 2x2 box filter.
+ */
+typedef struct {
+	const image_t *levels[VIEWER_MAX_LEVELS]; /**< Pyramid levels, largest first */
+	int count; /**< Number of levels */
+} viewer_pyramid_t;
+
+/**
+ * @brief Build a mip pyramid
+ *
+ * Halves the image until it fits into min_width x min_height (the
+ * smallest viewport it will be shown in) or VIEWER_MAX_LEVELS is reached.
+ *
+ * @param img Source image (becomes level 0, must outlive the pyramid)
+ * @param min_width Width at which reduction stops
+ * @param min_height Height at which reduction stops
+ * @param out Output pyramid
+ *
+ * @return 0 on success, -1 on error
+ */
+int viewer_pyramid_build(const image_t *img, uint32_t min_width, uint32_t min_height, viewer_pyramid_t *out);
+
+/**
+ * @brief Add levels to a pyramid for a smaller viewport
+ *
+ * Keeps halving the smallest level until it fits into min_width x
+ * min_height or VIEWER_MAX_LEVELS is reached; existing levels are kept.
+ * Used when the terminal shrinks below the size the pyramid was built
+ * for.
+ *
+ * @param pyramid Pyramid from viewer_pyramid_build()
+ * @param min_width Width at which reduction stops
+ * @param min_height Height at which reduction stops
+ *
+ * @return 0 on success, -1 on error (the levels built so far are kept)
+ */
+int viewer_pyramid_extend(viewer_pyramid_t *pyramid, uint32_t min_width, uint32_t min_height);
+
+/**
+ * @brief Free the reduced levels of a pyramid
+ *
+ * @param pyramid Pyramid to free (level 0 is left alone)
+ */
+void viewer_pyramid_free(viewer_pyramid_t *pyramid);
+
+/**
+ * @brief Pick the pyramid level to sample for a zoom factor
+ *
+ * Returns the smallest level that still has at least one pixel per
+ * output pixel, so sampling never magnifies a reduced level.
+ *
+ * @param pyramid Pyramid
+ * @param zoom Output pixels per original image pixel
+ *
+ * @return Level index
+ */
+int viewer_level_for_zoom(const viewer_pyramid_t *pyramid, double zoom);
+
+/**
+ * @brief Sample part of the viewport from the pyramid
+ *
+ * Fills the rectangle [x0, x1) x [y0, y1) of out, where out pixel (x, y)
+ * shows zoomed image pixel (origin_x + x, origin_y + y). Pixels outside
+ * the image become transparent.
+ *
+ * @param pyramid Pyramid
+ * @param zoom Output pixels per original image pixel
+ * @param origin_x Zoomed-image x coordinate of the viewport's left edge
+ * @param origin_y Zoomed-image y coordinate of the viewport's top edge
+ * @param out Viewport image
+ * @param x0 First column to fill
+ * @param y0 First row to fill
+ * @param x1 Column after the last one to fill
+ * @param y1 Row after the last one to fill
+ */
+void viewer_sample(const viewer_pyramid_t *pyramid, double zoom, int64_t origin_x, int64_t origin_y, image_t *out, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1);
+
+/**
+ * @brief Run the interactive viewer on the first input file
+ *
+ * @param opts Parsed options (input file, interpolation is ignored)
+ *
+ * @return Process exit code
+ */
+int viewer_run(cli_options_t *opts);
+
+#endif /* IMGCAT2_VIEWER_H */
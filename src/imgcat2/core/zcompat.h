@@ -0,0 +1,32 @@
+/**
+ * @file zcompat.h
+ * @brief zlib / zlib-ng deflate compatibility layer
+ *
+ * The build links either zlib-ng (native API, zng_ prefixed) or classic
+ * zlib. This header maps the small subset of the deflate API used by
+ * imgcat2 onto whichever library was found at configure time.
+ */
+
+#ifndef IMGCAT2_ZCOMPAT_H
+#define IMGCAT2_ZCOMPAT_H
+
+#ifdef HAVE_ZLIB_NG
+#include <zlib-ng.h>
+
+typedef zng_stream z_stream_t;
+
+#define z_deflate_init zng_deflateInit
+#define z_deflate zng_deflate
+#define z_deflate_end zng_deflateEnd
+
+#else
+#include <zlib.h>
+
+typedef z_stream z_stream_t;
+
+#define z_deflate_init deflateInit
+#define z_deflate deflate
+#define z_deflate_end deflateEnd
+#endif
+
+#endif /* IMGCAT2_ZCOMPAT_H */
@@ -7,6 +7,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "../core/cancel.h"
+#include "../core/executor.h"
 #include "decoder.h"
 
 /**
@@ -19,10 +21,12 @@
 
 #ifdef HAVE_LIBPNG
 extern image_t **decode_png(const uint8_t *data, size_t len, int *frame_count);
+extern image_t **decode_png_hinted(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height);
 #endif
 
 #ifdef HAVE_LIBJPEG
 extern image_t **decode_jpeg(const uint8_t *data, size_t len, int *frame_count);
+extern image_t **decode_jpeg_hinted(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height);
 #endif
 
 #ifdef HAVE_GIFLIB
@@ -32,15 +36,19 @@ extern image_t **decode_gif_animated(const uint8_t *data, size_t len, int *frame
 
 #ifdef HAVE_WEBP
 extern image_t **decode_webp(const uint8_t *data, size_t len, int *frame_count);
+extern image_t **decode_webp_hinted(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height);
 #endif
 
 #ifdef HAVE_HEIF
 extern image_t **decode_heif(const uint8_t *data, size_t len, int *frame_count);
+extern image_t **decode_heif_hinted(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height);
 extern image_t **decode_avif(const uint8_t *data, size_t len, int *frame_count);
+extern image_t **decode_avif_hinted(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height);
 #endif
 
 #ifdef HAVE_TIFF
 extern image_t **decode_tiff(const uint8_t *data, size_t len, int *frame_count);
+extern image_t **decode_tiff_hinted(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height);
 #endif
 
 #ifdef HAVE_RAW
@@ -49,6 +57,7 @@ extern image_t **decode_raw(const uint8_t *data, size_t len, int *frame_count);
 
 #ifdef HAVE_JXL
 extern image_t **decode_jxl(const uint8_t *data, size_t len, int *frame_count);
+extern image_t **decode_jxl_hinted(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height);
 #endif
 
 /* SVG decoders */
@@ -98,62 +107,62 @@ static image_t **decode_svg(const uint8_t *data, size_t len, int *frame_count)
  */
 static const decoder_t s_decoder_registry[] = {
 #ifdef HAVE_LIBPNG
-	{ MIME_PNG,  "PNG (libpng)",         decode_png          },
+	{ MIME_PNG,  "PNG (libpng)",         decode_png,          decode_png_hinted   },
 #else
-	{ MIME_PNG, "PNG (stb_image)", decode_stb },
+	{ MIME_PNG,  "PNG (stb_image)",      decode_stb,          NULL                },
 #endif
 
 #ifdef HAVE_LIBJPEG
-	{ MIME_JPEG, "JPEG (libjpeg-turbo)", decode_jpeg         },
+	{ MIME_JPEG, "JPEG (libjpeg-turbo)", decode_jpeg,         decode_jpeg_hinted  },
 #else
-	{ MIME_JPEG, "JPEG (stb_image)", decode_stb },
+	{ MIME_JPEG, "JPEG (stb_image)",     decode_stb,          NULL                },
 #endif
 
 #ifdef HAVE_GIFLIB
-	{ MIME_GIF,  "GIF (giflib)",         decode_gif_animated },
+	{ MIME_GIF,  "GIF (giflib)",         decode_gif_animated, NULL                },
 #endif
 
 #ifdef HAVE_WEBP
-	{ MIME_WEBP, "WebP (libwebp)",       decode_webp         },
+	{ MIME_WEBP, "WebP (libwebp)",       decode_webp,         decode_webp_hinted  },
 #endif
 
 #ifdef HAVE_HEIF
-	{ MIME_HEIF, "HEIF (libheif)",       decode_heif         },
-	{ MIME_AVIF, "AVIF (libheif)",       decode_avif         },
+	{ MIME_HEIF, "HEIF (libheif)",       decode_heif,         decode_heif_hinted  },
+	{ MIME_AVIF, "AVIF (libheif)",       decode_avif,         decode_avif_hinted  },
 #endif
 
 #ifdef HAVE_TIFF
-	{ MIME_TIFF, "TIFF (libtiff)",       decode_tiff         },
+	{ MIME_TIFF, "TIFF (libtiff)",       decode_tiff,         decode_tiff_hinted  },
 #endif
 
 #ifdef HAVE_RAW
-	{ MIME_RAW,  "RAW (libraw)",         decode_raw          },
+	{ MIME_RAW,  "RAW (libraw)",         decode_raw,          NULL                },
 #endif
 
 #ifdef HAVE_JXL
-	{ MIME_JXL,  "JXL (libjxl)",         decode_jxl          },
+	{ MIME_JXL,  "JXL (libjxl)",         decode_jxl,          decode_jxl_hinted   },
 #endif
 
 /* SVG format */
 #ifdef HAVE_RESVG
-	{ MIME_SVG,  "SVG (resvg)",          decode_svg          },
+	{ MIME_SVG,  "SVG (resvg)",          decode_svg,          NULL                },
 #else
-	{ MIME_SVG, "SVG (nanosvg)",         decode_svg          },
+	{ MIME_SVG,  "SVG (nanosvg)",        decode_svg,          NULL                },
 #endif
 
 	/* QOI format */
-	{ MIME_QOI,  "QOI (header-only)",    decode_qoi          },
+	{ MIME_QOI,  "QOI (header-only)",    decode_qoi,          NULL                },
 
 	/* ICO/CUR formats */
-	{ MIME_ICO,  "ICO (custom)",         decode_ico          },
-	{ MIME_CUR,  "CUR (custom)",         decode_ico          },
+	{ MIME_ICO,  "ICO (custom)",         decode_ico,          NULL                },
+	{ MIME_CUR,  "CUR (custom)",         decode_ico,          NULL                },
 
 	/* STB-supported formats */
-	{ MIME_BMP,  "BMP (stb_image)",      decode_stb          },
-	{ MIME_TGA,  "TGA (stb_image)",      decode_stb          },
-	{ MIME_PSD,  "PSD (stb_image)",      decode_stb          },
-	{ MIME_HDR,  "HDR (stb_image)",      decode_stb          },
-	{ MIME_PNM,  "PNM (stb_image)",      decode_stb          },
+	{ MIME_BMP,  "BMP (stb_image)",      decode_stb,          NULL                },
+	{ MIME_TGA,  "TGA (stb_image)",      decode_stb,          NULL                },
+	{ MIME_PSD,  "PSD (stb_image)",      decode_stb,          NULL                },
+	{ MIME_HDR,  "HDR (stb_image)",      decode_stb,          NULL                },
+	{ MIME_PNM,  "PNM (stb_image)",      decode_stb,          NULL                },
 };
 
 /**
@@ -162,6 +171,11 @@ static const decoder_t s_decoder_registry[] = {
 const decoder_t *g_decoder_registry = NULL;
 size_t g_decoder_count = 0;
 
+/**
+ * @brief Threads a single decode may use (0 = library default)
+ */
+static int s_decode_threads = 0;
+
 /**
  * @brief Initialize decoder registry
  *
@@ -170,6 +184,10 @@ size_t g_decoder_count = 0;
  */
 void decoder_registry_init(cli_options_t *opts)
 {
+	if (opts != NULL) {
+		s_decode_threads = opts->decode_threads;
+	}
+
 	if (g_decoder_registry != NULL) {
 		// Already initialized
 		return;
@@ -186,6 +204,55 @@ void decoder_registry_init(cli_options_t *opts)
 	}
 }
 
+/**
+ * @brief Threads a single decode may use
+ */
+int decoder_decode_threads(void)
+{
+	return s_decode_threads;
+}
+
+/**
+ * @brief Threads a decode should split its own work into
+ */
+int decoder_parallel_threads(void)
+{
+	return s_decode_threads > 0 ? s_decode_threads : executor_task_threads();
+}
+
+/**
+ * @brief Pick a power-of-two reduction factor for a size hint
+ */
+uint32_t decoder_hint_scale(uint32_t width, uint32_t height, uint32_t box_width, uint32_t box_height, uint32_t max_denominator)
+{
+	if (width == 0 || height == 0 || box_width == 0 || box_height == 0) {
+		return 1;
+	}
+
+	/* Size of the image fitted into the box (never enlarged) */
+	double fit = (double)box_width / width;
+	if ((double)box_height / height < fit) {
+		fit = (double)box_height / height;
+	}
+	if (fit > 1.0) {
+		fit = 1.0;
+	}
+
+	uint32_t fit_width = (uint32_t)(width * fit);
+	uint32_t fit_height = (uint32_t)(height * fit);
+
+	uint32_t denominator = 1;
+	while (denominator * 2 <= max_denominator) {
+		uint32_t next = denominator * 2;
+		if ((width + next - 1) / next < fit_width || (height + next - 1) / next < fit_height) {
+			break;
+		}
+		denominator = next;
+	}
+
+	return denominator;
+}
+
 /**
  * @brief Find decoder by MIME type
  *
@@ -234,14 +301,29 @@ image_t **decoder_decode(cli_options_t *opts, const uint8_t *data, size_t len, m
 		return NULL;
 	}
 
+	// Only TIFF reads large mapped inputs piecewise (tiles, pyramid levels)
+	if (len > IMAGE_MAX_FILE_SIZE && mime != MIME_TIFF) {
+		fprintf(stderr, "Error: Input too large for %s (%zu bytes, max %lu bytes)\n", mime_type_name(mime), len, (unsigned long)IMAGE_MAX_FILE_SIZE);
+		return NULL;
+	}
+
 	if (opts != NULL && !opts->silent) {
 		fprintf(stderr, "Decoding %zu bytes with decoder: %s\n", len, decoder->name);
 	}
 
-	// Call decoder function
-	image_t **frames = decoder->decode(data, len, frame_count);
+	// Call decoder function, at reduced resolution when a size hint is set
+	image_t **frames;
+	if (opts != NULL && opts->decode_box_width > 0 && opts->decode_box_height > 0 && decoder->decode_hinted != NULL) {
+		frames = decoder->decode_hinted(data, len, frame_count, opts->decode_box_width, opts->decode_box_height);
+
+	} else {
+		frames = decoder->decode(data, len, frame_count);
+	}
 	if (frames == NULL) {
-		fprintf(stderr, "Error: Decoder '%s' failed to decode image\n", decoder->name);
+		// Cancelled decodes are not errors
+		if (!cancel_requested()) {
+			fprintf(stderr, "Error: Decoder '%s' failed to decode image\n", decoder->name);
+		}
 		return NULL;
 	}
 
@@ -29,9 +29,28 @@
  * @note Caller must free returned array with decoder_free_frames()
  * @note For static images, frame_count = 1
  * @note For animated images (e.g., GIF), frame_count = N
+ * @note Frames may be in any image_format_t; scaling converts them to RGBA8
  */
 typedef image_t **(*decode_func_t)(const uint8_t *data, size_t len, int *frame_count);
 
+/**
+ * @typedef decode_hinted_func_t
+ * @brief Reduced-resolution decoder function pointer type
+ *
+ * Decodes at the smallest resolution the format can produce cheaply
+ * (e.g. JPEG DCT scaling) that still covers the image fitted into
+ * box_width x box_height. The result may be larger than the box and is
+ * scaled by the caller as usual.
+ *
+ * @param data Raw image file data
+ * @param len Length of data in bytes
+ * @param frame_count Output: number of frames decoded
+ * @param box_width Width of the box the image will be fitted into
+ * @param box_height Height of the box the image will be fitted into
+ * @return Array of image_t* frames, or NULL on error
+ */
+typedef image_t **(*decode_hinted_func_t)(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height);
+
 /**
  * @struct decoder_t
  * @brief Decoder registry entry
@@ -42,6 +61,7 @@ typedef struct {
 	mime_type_t mime_type; /**< MIME type this decoder handles */
 	const char *name; /**< Human-readable format name (e.g., "PNG", "JPEG") */
 	decode_func_t decode; /**< Decoder function pointer */
+	decode_hinted_func_t decode_hinted; /**< Reduced-resolution decoder, or NULL */
 } decoder_t;
 
 /**
@@ -71,12 +91,50 @@ extern size_t g_decoder_count;
  * 3. GIF: decode_gif (giflib) if HAVE_GIFLIB, else not supported
  * 4. BMP, TGA, PSD, HDR, PNM: decode_stb (stb_image always available)
  *
- * @param opts CLI options structure (currently unused, reserved for future use)
+ * @param opts CLI options structure (decode thread count; may be NULL)
  *
  * @note This function is idempotent (safe to call multiple times)
  */
 void decoder_registry_init(cli_options_t *opts);
 
+/**
+ * @brief Threads a single image decode may use
+ *
+ * Set from --decode-threads by decoder_registry_init(). Decoders whose
+ * libraries decode tiles in parallel (libheif, libjxl) pass it on; the
+ * TIFF decoder splits large levels into that many bands.
+ *
+ * @return Thread count, or 0 for the decoder default
+ */
+int decoder_decode_threads(void);
+
+/**
+ * @brief Threads a decode should split its own work into
+ *
+ * --decode-threads when set; otherwise this decode's share of the CPUs
+ * from executor_task_threads(): all of them for a single image, fewer
+ * on a multi-file or grid worker.
+ *
+ * @return Thread count, at least 1
+ */
+int decoder_parallel_threads(void);
+
+/**
+ * @brief Pick a power-of-two reduction factor for a size hint
+ *
+ * Returns the largest denominator d (1, 2, 4, ... up to max_denominator)
+ * for which the image decoded at 1/d still covers its fit into the box,
+ * so that scaling the reduced image down never has to enlarge it.
+ *
+ * @param width Native image width
+ * @param height Native image height
+ * @param box_width Box width (0 = no hint)
+ * @param box_height Box height (0 = no hint)
+ * @param max_denominator Largest reduction the format supports
+ * @return Reduction denominator (1 = full resolution)
+ */
+uint32_t decoder_hint_scale(uint32_t width, uint32_t height, uint32_t box_width, uint32_t box_height, uint32_t max_denominator);
+
 /**
  * @brief Find decoder by MIME type
  *
@@ -20,6 +20,94 @@
 /** Maximum number of HEIF frames to decode (prevents DoS) */
 #define MAX_HEIF_FRAMES 200
 
+/**
+ * @brief Release callback for pixel planes adopted from a heif_image
+ */
+static void heif_release_pixels(void *ctx, uint8_t *pixels)
+{
+	(void)pixels;
+	heif_image_release((struct heif_image *)ctx);
+}
+
+/**
+ * @brief Turn a decoded heif_image into an image_t
+ *
+ * Takes ownership of img. The RGBA plane is adopted as is, keeping the
+ * library's row stride, and released together with the image_t.
+ *
+ * @return New image, or NULL on error (img is released either way)
+ */
+static image_t *heif_wrap_image(struct heif_image *img, uint8_t *plane, int width, int height, int stride)
+{
+	image_t *output = image_adopt((uint32_t)width, (uint32_t)height, IMAGE_FORMAT_RGBA8, plane, (size_t)stride, heif_release_pixels, img);
+	if (output == NULL) {
+		heif_image_release(img);
+	}
+	return output;
+}
+
+/**
+ * @brief Pick the smallest embedded thumbnail that covers a box
+ *
+ * Camera files usually carry a thumbnail item that is already larger
+ * than a terminal render; decoding it skips the full-resolution (often
+ * tiled) primary image.
+ *
+ * @param primary Primary image handle
+ * @param box_width Width of the box the image will be fitted into (0 = none)
+ * @param box_height Height of the box the image will be fitted into (0 = none)
+ * @return Thumbnail handle (caller releases it), or NULL to decode the primary image
+ */
+static struct heif_image_handle *heif_select_thumbnail(const struct heif_image_handle *primary, uint32_t box_width, uint32_t box_height)
+{
+	uint32_t width = (uint32_t)heif_image_handle_get_width(primary);
+	uint32_t height = (uint32_t)heif_image_handle_get_height(primary);
+
+	// Only worth it when the primary image gets scaled down
+	uint32_t fit_width, fit_height;
+	if (box_width == 0 || box_height == 0 || (width <= box_width && height <= box_height) || !image_fit_size(width, height, box_width, box_height, &fit_width, &fit_height)) {
+		return NULL;
+	}
+
+	int count = heif_image_handle_get_number_of_thumbnails(primary);
+	if (count <= 0) {
+		return NULL;
+	}
+
+	heif_item_id *ids = (heif_item_id *)malloc(sizeof(heif_item_id) * count);
+	if (ids == NULL) {
+		return NULL;
+	}
+	count = heif_image_handle_get_list_of_thumbnail_IDs(primary, ids, count);
+
+	struct heif_image_handle *best = NULL;
+	uint64_t best_area = 0;
+	for (int i = 0; i < count; i++) {
+		struct heif_image_handle *thumbnail = NULL;
+		if (heif_image_handle_get_thumbnail(primary, ids[i], &thumbnail).code != heif_error_Ok) {
+			continue;
+		}
+
+		uint32_t thumb_width = (uint32_t)heif_image_handle_get_width(thumbnail);
+		uint32_t thumb_height = (uint32_t)heif_image_handle_get_height(thumbnail);
+		uint64_t area = (uint64_t)thumb_width * thumb_height;
+
+		if (thumb_width >= fit_width && thumb_height >= fit_height && (best == NULL || area < best_area)) {
+			if (best != NULL) {
+				heif_image_handle_release(best);
+			}
+			best = thumbnail;
+			best_area = area;
+
+		} else {
+			heif_image_handle_release(thumbnail);
+		}
+	}
+
+	free(ids);
+	return best;
+}
+
 /**
  * @brief Check if HEIF is an image sequence (has multiple images)
  *
@@ -72,11 +160,14 @@ bool heif_is_animated(const uint8_t *data, size_t len)
  * @param data Raw HEIF file data
  * @param len Length of data in bytes
  * @param frame_count Output: always 1 (single frame)
+ * @param box_width Box width the image will be fitted into (0 = full resolution)
+ * @param box_height Box height the image will be fitted into (0 = full resolution)
  * @return Array with single image_t*, or NULL on error
  *
  * @note Output format is RGBA8888
+ * @note With a box, the smallest embedded thumbnail covering it is decoded instead
  */
-static image_t **decode_heif_static(const uint8_t *data, size_t len, int *frame_count)
+static image_t **decode_heif_static(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height)
 {
 	if (data == NULL || len == 0 || frame_count == NULL) {
 		fprintf(stderr, "Error: Invalid parameters to decode_heif_static\n");
@@ -93,6 +184,11 @@ static image_t **decode_heif_static(const uint8_t *data, size_t len, int *frame_
 		return NULL;
 	}
 
+	// Decode tiles on as many threads as configured (--decode-threads)
+	if (decoder_decode_threads() > 0) {
+		heif_context_set_max_decoding_threads(ctx, decoder_decode_threads());
+	}
+
 	// Read from memory
 	struct heif_error err = heif_context_read_from_memory_without_copy(ctx, data, len, NULL);
 	if (err.code != heif_error_Ok) {
@@ -110,6 +206,13 @@ static image_t **decode_heif_static(const uint8_t *data, size_t len, int *frame_
 		return NULL;
 	}
 
+	// Prefer a thumbnail when it already covers the display size
+	struct heif_image_handle *thumbnail = heif_select_thumbnail(handle, box_width, box_height);
+	if (thumbnail != NULL) {
+		heif_image_handle_release(handle);
+		handle = thumbnail;
+	}
+
 	// Decode image to RGBA
 	struct heif_image *img = NULL;
 	err = heif_decode_image(handle, &img, heif_colorspace_RGB, heif_chroma_interleaved_RGBA, NULL);
@@ -126,7 +229,7 @@ static image_t **decode_heif_static(const uint8_t *data, size_t len, int *frame_
 
 	// Get RGBA plane
 	int stride = 0;
-	const uint8_t *plane = heif_image_get_plane_readonly(img, heif_channel_interleaved, &stride);
+	uint8_t *plane = heif_image_get_plane(img, heif_channel_interleaved, &stride);
 	if (plane == NULL) {
 		fprintf(stderr, "Error: Failed to get HEIF image plane\n");
 		heif_image_release(img);
@@ -135,28 +238,18 @@ static image_t **decode_heif_static(const uint8_t *data, size_t len, int *frame_
 		return NULL;
 	}
 
-	// Create image_t structure
-	image_t *output = image_create((uint32_t)width, (uint32_t)height);
+	// Adopt the decoded plane
+	image_t *output = heif_wrap_image(img, plane, width, height, stride);
+
+	// Cleanup HEIF resources (the decoded image lives on in output)
+	heif_image_handle_release(handle);
+	heif_context_free(ctx);
+
 	if (output == NULL) {
 		fprintf(stderr, "Error: Failed to create image_t structure\n");
-		heif_image_release(img);
-		heif_image_handle_release(handle);
-		heif_context_free(ctx);
 		return NULL;
 	}
 
-	// Copy pixels row-by-row (handle stride != width*4)
-	for (int y = 0; y < height; y++) {
-		const uint8_t *src_row = plane + y * stride;
-		uint8_t *dst_row = output->pixels + y * width * 4;
-		memcpy(dst_row, src_row, width * 4);
-	}
-
-	// Cleanup HEIF resources
-	heif_image_release(img);
-	heif_image_handle_release(handle);
-	heif_context_free(ctx);
-
 	// Allocate frames array (single frame)
 	image_t **frames = (image_t **)malloc(sizeof(image_t *));
 	if (frames == NULL) {
@@ -203,6 +296,11 @@ static image_t **decode_heif_animated(const uint8_t *data, size_t len, int *fram
 		return NULL;
 	}
 
+	// Decode tiles on as many threads as configured (--decode-threads)
+	if (decoder_decode_threads() > 0) {
+		heif_context_set_max_decoding_threads(ctx, decoder_decode_threads());
+	}
+
 	// Read from memory
 	struct heif_error err = heif_context_read_from_memory_without_copy(ctx, data, len, NULL);
 	if (err.code != heif_error_Ok) {
@@ -280,7 +378,7 @@ static image_t **decode_heif_animated(const uint8_t *data, size_t len, int *fram
 
 		// Get RGBA plane
 		int stride = 0;
-		const uint8_t *plane = heif_image_get_plane_readonly(img, heif_channel_interleaved, &stride);
+		uint8_t *plane = heif_image_get_plane(img, heif_channel_interleaved, &stride);
 		if (plane == NULL) {
 			fprintf(stderr, "Error: Failed to get HEIF image plane %d\n", i);
 			heif_image_release(img);
@@ -288,25 +386,13 @@ static image_t **decode_heif_animated(const uint8_t *data, size_t len, int *fram
 			goto cleanup_error;
 		}
 
-		// Create output frame
-		frames[i] = image_create((uint32_t)width, (uint32_t)height);
+		// Create output frame (adopts the decoded plane or copies it)
+		frames[i] = heif_wrap_image(img, plane, width, height, stride);
+		heif_image_handle_release(handle);
 		if (frames[i] == NULL) {
 			fprintf(stderr, "Error: Failed to create output frame %d\n", i);
-			heif_image_release(img);
-			heif_image_handle_release(handle);
 			goto cleanup_error;
 		}
-
-		// Copy pixels row-by-row (handle stride != width*4)
-		for (int y = 0; y < height; y++) {
-			const uint8_t *src_row = plane + y * stride;
-			uint8_t *dst_row = frames[i]->pixels + y * width * 4;
-			memcpy(dst_row, src_row, width * 4);
-		}
-
-		// Release this image's resources
-		heif_image_release(img);
-		heif_image_handle_release(handle);
 	}
 
 	// Cleanup
@@ -361,5 +447,37 @@ image_t **decode_heif(const uint8_t *data, size_t len, int *frame_count)
 		return decode_heif_animated(data, len, frame_count);
 	}
 
-	return decode_heif_static(data, len, frame_count);
+	return decode_heif_static(data, len, frame_count, 0, 0);
+}
+
+/**
+ * @brief Decode HEIF image, from a thumbnail when it covers a box
+ *
+ * Static images are decoded from the smallest embedded thumbnail that
+ * still covers their fit into box_width x box_height (falling back to
+ * the primary image); sequences are decoded as by decode_heif().
+ * Single-file and grid output both pass the box, so a phone photo
+ * with an embedded thumbnail usually never decodes its primary image.
+ *
+ * @param data Raw HEIF file data
+ * @param len Length of data in bytes
+ * @param frame_count Output: number of frames decoded
+ * @param box_width Width of the box the image will be fitted into
+ * @param box_height Height of the box the image will be fitted into
+ * @return Array of image_t* frames, or NULL on error
+ */
+image_t **decode_heif_hinted(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height)
+{
+	if (data == NULL || len == 0 || frame_count == NULL) {
+		fprintf(stderr, "Error: Invalid parameters to decode_heif\n");
+		return NULL;
+	}
+
+	*frame_count = 0;
+
+	if (heif_is_animated(data, len)) {
+		return decode_heif_animated(data, len, frame_count);
+	}
+
+	return decode_heif_static(data, len, frame_count, box_width, box_height);
 }
@@ -14,6 +14,7 @@
 #include <string.h>
 /* clang-format on */
 
+#include "../core/pixel_ops.h"
 #include "decoder.h"
 
 /* ICO directory structures */
@@ -180,19 +181,7 @@ static void decode_dib_32bit(image_t *img, const uint8_t *pixels, uint32_t width
 	for (uint32_t y = 0; y < height; y++) {
 		// Bottom-up to top-down
 		const uint8_t *src = pixels + ((height - 1 - y) * row_stride);
-		uint8_t *dst = img->pixels + (y * width * 4);
-
-		for (uint32_t x = 0; x < width; x++) {
-			uint8_t b = *src++;
-			uint8_t g = *src++;
-			uint8_t r = *src++;
-			uint8_t a = *src++;
-
-			*dst++ = r;
-			*dst++ = g;
-			*dst++ = b;
-			*dst++ = a;
-		}
+		pixel_bgra_to_rgba(src, img->pixels + (y * width * 4), width);
 	}
 }
 
@@ -208,20 +197,9 @@ static void decode_dib_32bit(image_t *img, const uint8_t *pixels, uint32_t width
 static void decode_dib_24bit(image_t *img, const uint8_t *pixels, uint32_t width, uint32_t height, uint32_t row_stride)
 {
 	for (uint32_t y = 0; y < height; y++) {
-		// Bottom-up to top-down
+		// Bottom-up to top-down; opaque (AND mask applies later)
 		const uint8_t *src = pixels + ((height - 1 - y) * row_stride);
-		uint8_t *dst = img->pixels + (y * width * 4);
-
-		for (uint32_t x = 0; x < width; x++) {
-			uint8_t b = *src++;
-			uint8_t g = *src++;
-			uint8_t r = *src++;
-
-			*dst++ = r;
-			*dst++ = g;
-			*dst++ = b;
-			*dst++ = 255; // Opaque (AND mask applies later)
-		}
+		pixel_bgr_to_rgba(src, img->pixels + (y * width * 4), width);
 	}
 }
 
@@ -2,7 +2,7 @@
  * @file decoder_jpeg.c
  * @brief JPEG decoder implementation using libjpeg-turbo
  *
- * Decodes JPEG images (baseline, progressive) to RGBA8888 format.
+ * Decodes JPEG images (baseline, progressive) to native RGB or grayscale.
  * Uses libjpeg-turbo for high-performance JPEG decoding.
  */
 
@@ -15,6 +15,7 @@
 #include <jpeglib.h>
 /* clang-format on */
 
+#include "../core/cancel.h"
 #include "decoder.h"
 
 /**
@@ -49,20 +50,21 @@ static void jpeg_error_exit(j_common_ptr cinfo)
 }
 
 /**
- * @brief Decode JPEG image using libjpeg-turbo
+ * @brief Decode a JPEG, optionally at reduced resolution
  *
- * Decodes baseline and progressive JPEG images to RGBA8888 format.
- * Converts RGB output from libjpeg to RGBA by adding alpha=255.
+ * With a box set, libjpeg's DCT scaling decodes at 1/2, 1/4 or 1/8 size
+ * as long as the result still covers the image fitted into the box, and
+ * the faster integer IDCT and plain upsampling are used since the output
+ * is downscaled anyway.
  *
  * @param data Raw JPEG file data
  * @param len Length of data in bytes
  * @param frame_count Output: always 1 (JPEG is static)
+ * @param box_width Target box width (0 = full resolution)
+ * @param box_height Target box height (0 = full resolution)
  * @return Array with single image_t*, or NULL on error
- *
- * @note JPEG does not support animation or alpha channel
- * @note Alpha channel is added (opaque, 255) during RGB→RGBA conversion
  */
-image_t **decode_jpeg(const uint8_t *data, size_t len, int *frame_count)
+static image_t **decode_jpeg_scaled(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height)
 {
 	if (data == NULL || len == 0 || frame_count == NULL) {
 		fprintf(stderr, "Error: Invalid parameters to decode_jpeg\n");
@@ -99,8 +101,18 @@ image_t **decode_jpeg(const uint8_t *data, size_t len, int *frame_count)
 		return NULL;
 	}
 
-	// Set output format to RGB (3 channels)
-	cinfo.out_color_space = JCS_RGB;
+	// Output the native layout: grayscale stays gray, everything else RGB
+	bool gray = cinfo.jpeg_color_space == JCS_GRAYSCALE;
+	cinfo.out_color_space = gray ? JCS_GRAYSCALE : JCS_RGB;
+
+	// Decode at reduced size when the caller only needs a small image
+	uint32_t denominator = decoder_hint_scale(cinfo.image_width, cinfo.image_height, box_width, box_height, 8);
+	if (denominator > 1) {
+		cinfo.scale_num = 1;
+		cinfo.scale_denom = denominator;
+		cinfo.dct_method = JDCT_IFAST;
+		cinfo.do_fancy_upsampling = FALSE;
+	}
 
 	// Start decompression
 	if (!jpeg_start_decompress(&cinfo)) {
@@ -112,60 +124,45 @@ image_t **decode_jpeg(const uint8_t *data, size_t len, int *frame_count)
 	// Get output dimensions
 	uint32_t width = cinfo.output_width;
 	uint32_t height = cinfo.output_height;
-	int channels = cinfo.output_components; // Should be 3 for RGB
+	int channels = cinfo.output_components; // 1 for gray, 3 for RGB
 
-	if (channels != 3) {
-		fprintf(stderr, "Error: Unexpected JPEG output channels: %d (expected 3)\n", channels);
+	if (channels != (gray ? 1 : 3)) {
+		fprintf(stderr, "Error: Unexpected JPEG output channels: %d (expected %d)\n", channels, gray ? 1 : 3);
 		jpeg_destroy_decompress(&cinfo);
 		return NULL;
 	}
 
-	// Create image_t structure for RGBA output
-	image_t *img = image_create(width, height);
+	// Create image_t in the output layout; scaling converts it to RGBA
+	image_t *img = image_create_format(width, height, gray ? IMAGE_FORMAT_GRAY8 : IMAGE_FORMAT_RGB8);
 	if (img == NULL) {
 		fprintf(stderr, "Error: Failed to create image_t structure\n");
 		jpeg_destroy_decompress(&cinfo);
 		return NULL;
 	}
 
-	// Allocate row buffer for RGB scanline (libjpeg outputs RGB)
-	size_t row_stride = width * channels; // RGB: 3 bytes per pixel
-	uint8_t *row_buffer = (uint8_t *)malloc(row_stride);
-	if (row_buffer == NULL) {
-		fprintf(stderr, "Error: Failed to allocate JPEG row buffer\n");
-		image_destroy(img);
-		jpeg_destroy_decompress(&cinfo);
-		return NULL;
-	}
-
-	// Read scanlines and convert RGB to RGBA
-	JSAMPROW row_pointer[1];
-	row_pointer[0] = row_buffer;
-
+	// Read scanlines straight into the image rows
 	uint32_t y = 0;
 	while (cinfo.output_scanline < cinfo.output_height) {
-		// Read one scanline (RGB)
-		if (jpeg_read_scanlines(&cinfo, row_pointer, 1) != 1) {
-			fprintf(stderr, "Error: Failed to read JPEG scanline %u\n", y);
-			free(row_buffer);
+		// Abandon stale work (preview server superseded the request)
+		if (y % CANCEL_ROW_BATCH == 0 && cancel_requested()) {
 			image_destroy(img);
 			jpeg_destroy_decompress(&cinfo);
 			return NULL;
 		}
 
-		// Convert RGB to RGBA (add alpha=255)
-		for (uint32_t x = 0; x < width; x++) {
-			uint8_t r = row_buffer[x * 3 + 0];
-			uint8_t g = row_buffer[x * 3 + 1];
-			uint8_t b = row_buffer[x * 3 + 2];
-			image_set_pixel(img, x, y, r, g, b, 255);
+		JSAMPROW row_pointer[1] = { image_row(img, y) };
+		if (jpeg_read_scanlines(&cinfo, row_pointer, 1) != 1) {
+			fprintf(stderr, "Error: Failed to read JPEG scanline %u\n", y);
+			image_destroy(img);
+			jpeg_destroy_decompress(&cinfo);
+			return NULL;
 		}
 
 		y++;
 	}
 
-	// Free row buffer
-	free(row_buffer);
+	// JPEG has no alpha channel
+	img->opaque = true;
 
 	// Finish decompression
 	if (!jpeg_finish_decompress(&cinfo)) {
@@ -186,7 +183,41 @@ image_t **decode_jpeg(const uint8_t *data, size_t len, int *frame_count)
 	frames[0] = img;
 	*frame_count = 1;
 
-	// fprintf(stderr, "JPEG decoded: %ux%u, RGB→RGBA\n", width, height);
+	// fprintf(stderr, "JPEG decoded: %ux%u, %s\n", width, height, gray ? "gray" : "RGB");
 
 	return frames;
 }
+
+/**
+ * @brief Decode JPEG image using libjpeg-turbo
+ *
+ * Decodes baseline and progressive JPEG images into an IMAGE_FORMAT_RGB8
+ * image (IMAGE_FORMAT_GRAY8 for grayscale files); RGBA conversion
+ * happens once, after scaling.
+ *
+ * @param data Raw JPEG file data
+ * @param len Length of data in bytes
+ * @param frame_count Output: always 1 (JPEG is static)
+ * @return Array with single image_t*, or NULL on error
+ *
+ * @note JPEG does not support animation or alpha channel
+ */
+image_t **decode_jpeg(const uint8_t *data, size_t len, int *frame_count)
+{
+	return decode_jpeg_scaled(data, len, frame_count, 0, 0);
+}
+
+/**
+ * @brief Decode JPEG image at the smallest DCT scale covering a box
+ *
+ * @param data Raw JPEG file data
+ * @param len Length of data in bytes
+ * @param frame_count Output: always 1 (JPEG is static)
+ * @param box_width Width of the box the image will be fitted into
+ * @param box_height Height of the box the image will be fitted into
+ * @return Array with single image_t*, or NULL on error
+ */
+image_t **decode_jpeg_hinted(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height)
+{
+	return decode_jpeg_scaled(data, len, frame_count, box_width, box_height);
+}
@@ -13,159 +13,140 @@
 #include <stdlib.h>
 #include <string.h>
 #include <jxl/decode.h>
+#include <jxl/thread_parallel_runner.h>
 /* clang-format on */
 
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
 #include "decoder.h"
 
 /** Maximum number of JXL frames to decode (prevents DoS) */
 #define MAX_JXL_FRAMES 200
 
+/** Coarsest progressive pass libjxl can flush (DC = 1/8 resolution) */
+#define JXL_DC_RATIO 8
+
 /**
- * @brief Get basic info from JXL image (dimensions and frame count)
- *
- * @param data Raw JXL file data
- * @param len Length of data in bytes
- * @param width Output: image width
- * @param height Output: image height
- * @param num_frames Output: number of frames
- * @return Number of frames on success, -1 on error
+ * @struct jxl_runner_t
+ * @brief Thread pool runner kept by one decoding thread
  */
-static int jxl_get_info(const uint8_t *data, size_t len, uint32_t *width, uint32_t *height, int *num_frames);
+typedef struct {
+	void *runner; /**< JxlThreadParallelRunner, or NULL */
+	size_t threads; /**< Worker threads of runner */
+} jxl_runner_t;
 
 /**
- * @brief Decode static (single-frame) JXL image
+ * @brief Get the thread pool runner of the calling thread
  *
- * @param data Raw JXL file data
- * @param len Length of data in bytes
- * @param frame_count Output: number of frames decoded (always 1)
- * @return Array of 1 image_t*, or NULL on error
+ * Sized by decoder_parallel_threads(): --decode-threads when set,
+ * otherwise this thread's share of the CPUs (all of them for a single
+ * image, fewer on multi-file and grid workers). The runner is created
+ * on first use and reused by later decodes on the same thread; it is
+ * destroyed when the thread exits.
+ *
+ * @return Runner (owned by the thread, do not destroy), or NULL to
+ *         decode on the calling thread
  */
-static image_t **decode_jxl_static(const uint8_t *data, size_t len, int *frame_count);
+static void *jxl_thread_runner(void);
 
 /**
- * @brief Decode animated (multi-frame) JXL image
+ * @brief Decode all frames of a JXL image in a single pass
+ *
+ * Static images that only need to cover box_width x box_height stop at
+ * the first progressive pass detailed enough for it (the 1/8 DC image,
+ * upsampled by libjxl); the output keeps the full image dimensions.
  *
  * @param data Raw JXL file data
  * @param len Length of data in bytes
  * @param frame_count Output: number of frames decoded
- * @param num_frames Expected number of frames
+ * @param box_width Box width the image will be fitted into (0 = full detail)
+ * @param box_height Box height the image will be fitted into (0 = full detail)
  * @return Array of image_t* frames, or NULL on error
  */
-static image_t **decode_jxl_animated(const uint8_t *data, size_t len, int *frame_count, int num_frames);
+static image_t **decode_jxl_frames(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height);
 
-static int jxl_get_info(const uint8_t *data, size_t len, uint32_t *width, uint32_t *height, int *num_frames)
+#ifndef _WIN32
+/** Per-thread jxl_runner_t */
+static pthread_key_t s_runner_key;
+static pthread_once_t s_runner_once = PTHREAD_ONCE_INIT;
+static bool s_runner_key_ok = false;
+
+/**
+ * @brief Destroy a thread's runner when the thread exits
+ */
+static void jxl_runner_free(void *ptr)
 {
-	if (data == NULL || len == 0 || width == NULL || height == NULL || num_frames == NULL) {
-		return -1;
+	jxl_runner_t *slot = (jxl_runner_t *)ptr;
+	if (slot->runner != NULL) {
+		JxlThreadParallelRunnerDestroy(slot->runner);
 	}
+	free(slot);
+}
 
-	*num_frames = 0;
-
-	// Create decoder
-	JxlDecoder *dec = JxlDecoderCreate(NULL);
-	if (dec == NULL) {
-		fprintf(stderr, "Error: Failed to create JXL decoder\n");
-		return -1;
-	}
+static void jxl_runner_key_init(void)
+{
+	s_runner_key_ok = pthread_key_create(&s_runner_key, jxl_runner_free) == 0;
+}
+#endif
 
-	// Subscribe to events
-	if (JxlDecoderSubscribeEvents(dec, JXL_DEC_BASIC_INFO | JXL_DEC_FRAME) != JXL_DEC_SUCCESS) {
-		fprintf(stderr, "Error: Failed to subscribe to JXL decoder events\n");
-		JxlDecoderDestroy(dec);
-		return -1;
+static void *jxl_thread_runner(void)
+{
+	size_t threads = (size_t)decoder_parallel_threads();
+	if (threads <= 1) {
+		return NULL;
 	}
 
-	// Set input data
-	if (JxlDecoderSetInput(dec, data, len) != JXL_DEC_SUCCESS) {
-		fprintf(stderr, "Error: Failed to set JXL decoder input\n");
-		JxlDecoderDestroy(dec);
-		return -1;
+#ifdef _WIN32
+	// Decodes run one at a time on the main thread
+	static jxl_runner_t s_slot = { NULL, 0 };
+	jxl_runner_t *slot = &s_slot;
+#else
+	pthread_once(&s_runner_once, jxl_runner_key_init);
+	if (!s_runner_key_ok) {
+		return NULL;
 	}
 
-	// Close input to signal all data is available
-	JxlDecoderCloseInput(dec);
-
-	bool basic_info_received = false;
-	int frame_count = 0;
-
-	// Event loop
-	while (true) {
-		JxlDecoderStatus status = JxlDecoderProcessInput(dec);
-
-		if (status == JXL_DEC_BASIC_INFO) {
-			// Get basic info
-			JxlBasicInfo info;
-			if (JxlDecoderGetBasicInfo(dec, &info) != JXL_DEC_SUCCESS) {
-				fprintf(stderr, "Error: Failed to get JXL basic info\n");
-				JxlDecoderDestroy(dec);
-				return -1;
-			}
-
-			*width = info.xsize;
-			*height = info.ysize;
-
-			// Validate dimensions
-			if (*width > IMAGE_MAX_DIMENSION || *height > IMAGE_MAX_DIMENSION) {
-				fprintf(stderr, "Error: JXL dimensions exceed maximum: %ux%u\n", *width, *height);
-				JxlDecoderDestroy(dec);
-				return -1;
-			}
-
-			if (*width == 0 || *height == 0) {
-				fprintf(stderr, "Error: JXL has invalid dimensions: %ux%u\n", *width, *height);
-				JxlDecoderDestroy(dec);
-				return -1;
-			}
-
-			basic_info_received = true;
-		} else if (status == JXL_DEC_FRAME) {
-			// Count frames
-			frame_count++;
-
-			// Enforce frame limit
-			if (frame_count > MAX_JXL_FRAMES) {
-				fprintf(stderr, "Error: JXL frame count exceeds maximum (%d)\n", MAX_JXL_FRAMES);
-				JxlDecoderDestroy(dec);
-				return -1;
-			}
-		} else if (status == JXL_DEC_SUCCESS) {
-			// All frames processed
-			break;
-		} else if (status == JXL_DEC_ERROR) {
-			// Decoding error
-			fprintf(stderr, "Error: JXL decoder error\n");
-			JxlDecoderDestroy(dec);
-			return -1;
-		} else {
-			// Unexpected status
-			fprintf(stderr, "Error: Unexpected JXL decoder status: %d\n", status);
-			JxlDecoderDestroy(dec);
-			return -1;
+	jxl_runner_t *slot = (jxl_runner_t *)pthread_getspecific(s_runner_key);
+	if (slot == NULL) {
+		slot = (jxl_runner_t *)calloc(1, sizeof(jxl_runner_t));
+		if (slot == NULL || pthread_setspecific(s_runner_key, slot) != 0) {
+			free(slot);
+			return NULL;
 		}
 	}
+#endif
 
-	// Cleanup
-	JxlDecoderDestroy(dec);
+	// Same thread, different share (a new executor): resize the pool
+	if (slot->runner != NULL && slot->threads != threads) {
+		JxlThreadParallelRunnerDestroy(slot->runner);
+		slot->runner = NULL;
+	}
 
-	if (!basic_info_received || frame_count == 0) {
-		fprintf(stderr, "Error: No frames found in JXL image\n");
-		return -1;
+	if (slot->runner == NULL) {
+		slot->runner = JxlThreadParallelRunnerCreate(NULL, threads);
+		slot->threads = slot->runner != NULL ? threads : 0;
 	}
 
-	*num_frames = frame_count;
-	return frame_count;
+	return slot->runner;
 }
 
-static image_t **decode_jxl_static(const uint8_t *data, size_t len, int *frame_count)
+static image_t **decode_jxl_frames(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height)
 {
 	if (data == NULL || len == 0 || frame_count == NULL) {
-		fprintf(stderr, "Error: Invalid parameters to decode_jxl_static\n");
+		fprintf(stderr, "Error: Invalid parameters to decode_jxl_frames\n");
 		return NULL;
 	}
 
 	// Initialize output
 	*frame_count = 0;
 
+	image_t **frames = NULL;
+	int capacity = 0;
+	int count = 0;
+	void *runner = NULL;
+
 	// Create decoder
 	JxlDecoder *dec = JxlDecoderCreate(NULL);
 	if (dec == NULL) {
@@ -173,18 +154,30 @@ static image_t **decode_jxl_static(const uint8_t *data, size_t len, int *frame_c
 		return NULL;
 	}
 
+	// Decode groups in parallel (single-threaded if no runner)
+	runner = jxl_thread_runner();
+	if (runner != NULL && JxlDecoderSetParallelRunner(dec, JxlThreadParallelRunner, runner) != JXL_DEC_SUCCESS) {
+		fprintf(stderr, "Error: Failed to set JXL parallel runner\n");
+		goto cleanup_error;
+	}
+
 	// Subscribe to events (NEED_IMAGE_OUT_BUFFER is a status, not an event to subscribe to)
-	if (JxlDecoderSubscribeEvents(dec, JXL_DEC_BASIC_INFO | JXL_DEC_FULL_IMAGE) != JXL_DEC_SUCCESS) {
+	bool progressive = box_width > 0 && box_height > 0;
+	int events = JXL_DEC_BASIC_INFO | JXL_DEC_FULL_IMAGE | (progressive ? JXL_DEC_FRAME_PROGRESSION : 0);
+	if (JxlDecoderSubscribeEvents(dec, events) != JXL_DEC_SUCCESS) {
 		fprintf(stderr, "Error: Failed to subscribe to JXL decoder events\n");
-		JxlDecoderDestroy(dec);
-		return NULL;
+		goto cleanup_error;
+	}
+
+	// Report the DC pass so it can be flushed when it is detailed enough
+	if (progressive && JxlDecoderSetProgressiveDetail(dec, kDC) != JXL_DEC_SUCCESS) {
+		progressive = false;
 	}
 
 	// Set input data
 	if (JxlDecoderSetInput(dec, data, len) != JXL_DEC_SUCCESS) {
 		fprintf(stderr, "Error: Failed to set JXL decoder input\n");
-		JxlDecoderDestroy(dec);
-		return NULL;
+		goto cleanup_error;
 	}
 
 	// Close input
@@ -198,12 +191,14 @@ static image_t **decode_jxl_static(const uint8_t *data, size_t len, int *frame_c
 		.align = 0,
 	};
 
-	image_t *output = NULL;
 	uint32_t width = 0;
 	uint32_t height = 0;
+	uint32_t reduction = 1;
+	bool animated = false;
+	bool done = false;
 
 	// Event loop
-	while (true) {
+	while (!done) {
 		JxlDecoderStatus status = JxlDecoderProcessInput(dec);
 
 		if (status == JXL_DEC_BASIC_INFO) {
@@ -216,6 +211,7 @@ static image_t **decode_jxl_static(const uint8_t *data, size_t len, int *frame_c
 
 			width = info.xsize;
 			height = info.ysize;
+			animated = info.have_animation;
 
 			// Validate dimensions
 			if (width > IMAGE_MAX_DIMENSION || height > IMAGE_MAX_DIMENSION) {
@@ -228,242 +224,110 @@ static image_t **decode_jxl_static(const uint8_t *data, size_t len, int *frame_c
 				goto cleanup_error;
 			}
 
-			// Create image_t
-			output = image_create(width, height);
-			if (output == NULL) {
-				fprintf(stderr, "Error: Failed to create image_t structure\n");
-				goto cleanup_error;
+			// Animation frames are always decoded in full
+			if (progressive && !animated) {
+				reduction = decoder_hint_scale(width, height, box_width, box_height, JXL_DC_RATIO);
 			}
+
 		} else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER) {
-			// Ensure we have basic info first
-			if (output == NULL) {
+			// Ensure we have basic info
+			if (width == 0 || height == 0) {
 				fprintf(stderr, "Error: JXL buffer requested before basic info\n");
 				goto cleanup_error;
 			}
 
-			// Query buffer size
-			size_t buffer_size;
-			if (JxlDecoderImageOutBufferSize(dec, &format, &buffer_size) != JXL_DEC_SUCCESS) {
-				fprintf(stderr, "Error: Failed to query JXL buffer size\n");
-				goto cleanup_error;
-			}
-
-			// Verify buffer size matches our allocation
-			if (buffer_size != width * height * 4) {
-				fprintf(stderr, "Error: JXL buffer size mismatch: expected %zu, got %zu\n", (size_t)(width * height * 4), buffer_size);
-				goto cleanup_error;
-			}
-
-			// Set output buffer
-			if (JxlDecoderSetImageOutBuffer(dec, &format, output->pixels, buffer_size) != JXL_DEC_SUCCESS) {
-				fprintf(stderr, "Error: Failed to set JXL output buffer\n");
-				goto cleanup_error;
-			}
-		} else if (status == JXL_DEC_FULL_IMAGE) {
-			// Pixels are ready
-			break;
-		} else if (status == JXL_DEC_SUCCESS) {
-			// All done
-			break;
-		} else if (status == JXL_DEC_ERROR) {
-			fprintf(stderr, "Error: JXL decoder error\n");
-			goto cleanup_error;
-		} else {
-			fprintf(stderr, "Error: Unexpected JXL decoder status: %d\n", status);
-			goto cleanup_error;
-		}
-	}
-
-	// Cleanup decoder
-	JxlDecoderDestroy(dec);
-
-	// Allocate frames array (single frame)
-	image_t **frames = (image_t **)malloc(sizeof(image_t *));
-	if (frames == NULL) {
-		fprintf(stderr, "Error: Failed to allocate frames array\n");
-		image_destroy(output);
-		return NULL;
-	}
-
-	frames[0] = output;
-	*frame_count = 1;
-
-	return frames;
-
-cleanup_error:
-	JxlDecoderDestroy(dec);
-	if (output != NULL) {
-		image_destroy(output);
-	}
-	return NULL;
-}
-
-static image_t **decode_jxl_animated(const uint8_t *data, size_t len, int *frame_count, int num_frames)
-{
-	if (data == NULL || len == 0 || frame_count == NULL || num_frames <= 0) {
-		fprintf(stderr, "Error: Invalid parameters to decode_jxl_animated\n");
-		return NULL;
-	}
-
-	// Initialize output
-	*frame_count = 0;
-
-	// Allocate frames array
-	image_t **frames = (image_t **)malloc(sizeof(image_t *) * num_frames);
-	if (frames == NULL) {
-		fprintf(stderr, "Error: Failed to allocate frames array\n");
-		return NULL;
-	}
-
-	// Initialize frames to NULL for cleanup
-	for (int i = 0; i < num_frames; i++) {
-		frames[i] = NULL;
-	}
-
-	// Create decoder
-	JxlDecoder *dec = JxlDecoderCreate(NULL);
-	if (dec == NULL) {
-		fprintf(stderr, "Error: Failed to create JXL decoder\n");
-		free(frames);
-		return NULL;
-	}
-
-	// Subscribe to events (NEED_IMAGE_OUT_BUFFER is a status, not an event to subscribe to)
-	if (JxlDecoderSubscribeEvents(dec, JXL_DEC_BASIC_INFO | JXL_DEC_FRAME | JXL_DEC_FULL_IMAGE) != JXL_DEC_SUCCESS) {
-		fprintf(stderr, "Error: Failed to subscribe to JXL decoder events\n");
-		JxlDecoderDestroy(dec);
-		free(frames);
-		return NULL;
-	}
-
-	// Set input data
-	if (JxlDecoderSetInput(dec, data, len) != JXL_DEC_SUCCESS) {
-		fprintf(stderr, "Error: Failed to set JXL decoder input\n");
-		JxlDecoderDestroy(dec);
-		free(frames);
-		return NULL;
-	}
-
-	// Close input
-	JxlDecoderCloseInput(dec);
-
-	// Define pixel format: RGBA8888
-	JxlPixelFormat format = {
-		.num_channels = 4,
-		.data_type = JXL_TYPE_UINT8,
-		.endianness = JXL_NATIVE_ENDIAN,
-		.align = 0,
-	};
-
-	uint32_t width = 0;
-	uint32_t height = 0;
-	int current_frame = 0;
-	bool basic_info_received = false;
-
-	// Event loop
-	while (true) {
-		JxlDecoderStatus status = JxlDecoderProcessInput(dec);
-
-		if (status == JXL_DEC_BASIC_INFO) {
-			// Get dimensions (only once)
-			JxlBasicInfo info;
-			if (JxlDecoderGetBasicInfo(dec, &info) != JXL_DEC_SUCCESS) {
-				fprintf(stderr, "Error: Failed to get JXL basic info\n");
-				goto cleanup_error;
-			}
-
-			width = info.xsize;
-			height = info.ysize;
-
-			// Validate dimensions
-			if (width > IMAGE_MAX_DIMENSION || height > IMAGE_MAX_DIMENSION) {
-				fprintf(stderr, "Error: JXL dimensions exceed maximum: %ux%u\n", width, height);
-				goto cleanup_error;
-			}
-
-			if (width == 0 || height == 0) {
-				fprintf(stderr, "Error: JXL has invalid dimensions: %ux%u\n", width, height);
+			// Enforce frame limit
+			if (count >= MAX_JXL_FRAMES) {
+				fprintf(stderr, "Error: JXL frame count exceeds maximum (%d)\n", MAX_JXL_FRAMES);
 				goto cleanup_error;
 			}
 
-			basic_info_received = true;
-		} else if (status == JXL_DEC_FRAME) {
-			// Start of new frame
-			if (current_frame >= num_frames) {
-				fprintf(stderr, "Error: JXL frame count mismatch: expected %d, got more\n", num_frames);
-				goto cleanup_error;
-			}
-		} else if (status == JXL_DEC_NEED_IMAGE_OUT_BUFFER) {
-			// Ensure we have basic info
-			if (!basic_info_received) {
-				fprintf(stderr, "Error: JXL buffer requested before basic info\n");
-				goto cleanup_error;
+			// Grow frames array
+			if (count == capacity) {
+				int new_capacity = animated ? (capacity > 0 ? capacity * 2 : 8) : 1;
+				if (new_capacity > MAX_JXL_FRAMES) {
+					new_capacity = MAX_JXL_FRAMES;
+				}
+
+				image_t **grown = (image_t **)realloc(frames, sizeof(image_t *) * new_capacity);
+				if (grown == NULL) {
+					fprintf(stderr, "Error: Failed to allocate frames array\n");
+					goto cleanup_error;
+				}
+				frames = grown;
+				capacity = new_capacity;
 			}
 
-			// Allocate image_t for current frame
-			frames[current_frame] = image_create(width, height);
-			if (frames[current_frame] == NULL) {
-				fprintf(stderr, "Error: Failed to create frame %d\n", current_frame);
+			// Allocate image_t for current frame (full size even when stopping at DC:
+			// libjxl only writes whole-image buffers and upsamples the flushed pass)
+			frames[count] = image_create(width, height);
+			if (frames[count] == NULL) {
+				fprintf(stderr, "Error: Failed to create frame %d\n", count);
 				goto cleanup_error;
 			}
+			count++;
 
 			// Query buffer size
 			size_t buffer_size;
 			if (JxlDecoderImageOutBufferSize(dec, &format, &buffer_size) != JXL_DEC_SUCCESS) {
-				fprintf(stderr, "Error: Failed to query JXL buffer size for frame %d\n", current_frame);
+				fprintf(stderr, "Error: Failed to query JXL buffer size for frame %d\n", count - 1);
 				goto cleanup_error;
 			}
 
 			// Verify buffer size
-			if (buffer_size != width * height * 4) {
-				fprintf(stderr, "Error: JXL buffer size mismatch for frame %d: expected %zu, got %zu\n", current_frame, (size_t)(width * height * 4), buffer_size);
+			if (buffer_size != (size_t)width * height * 4) {
+				fprintf(stderr, "Error: JXL buffer size mismatch for frame %d: expected %zu, got %zu\n", count - 1, (size_t)width * height * 4, buffer_size);
 				goto cleanup_error;
 			}
 
 			// Set output buffer
-			if (JxlDecoderSetImageOutBuffer(dec, &format, frames[current_frame]->pixels, buffer_size) != JXL_DEC_SUCCESS) {
-				fprintf(stderr, "Error: Failed to set JXL output buffer for frame %d\n", current_frame);
+			if (JxlDecoderSetImageOutBuffer(dec, &format, frames[count - 1]->pixels, buffer_size) != JXL_DEC_SUCCESS) {
+				fprintf(stderr, "Error: Failed to set JXL output buffer for frame %d\n", count - 1);
 				goto cleanup_error;
 			}
+
+		} else if (status == JXL_DEC_FRAME_PROGRESSION) {
+			// Stop once the decoded detail covers the target size
+			size_t ratio = JxlDecoderGetIntendedDownsamplingRatio(dec);
+			if (ratio > 1 && ratio <= reduction && JxlDecoderFlushImage(dec) == JXL_DEC_SUCCESS) {
+				done = true;
+			}
+
 		} else if (status == JXL_DEC_FULL_IMAGE) {
-			// Current frame complete
-			current_frame++;
+			// Still images have exactly one displayed frame
+			done = !animated;
+
 		} else if (status == JXL_DEC_SUCCESS) {
 			// All frames decoded
-			break;
+			done = true;
+
 		} else if (status == JXL_DEC_ERROR) {
 			fprintf(stderr, "Error: JXL decoder error\n");
 			goto cleanup_error;
+
 		} else {
 			fprintf(stderr, "Error: Unexpected JXL decoder status: %d\n", status);
 			goto cleanup_error;
 		}
 	}
 
-	// Cleanup decoder
+	// Cleanup decoder (the runner stays with the thread)
 	JxlDecoderDestroy(dec);
 
-	// Verify we got all frames
-	if (current_frame != num_frames) {
-		fprintf(stderr, "Error: JXL frame count mismatch: expected %d, got %d\n", num_frames, current_frame);
-		// Cleanup allocated frames
-		for (int i = 0; i < num_frames; i++) {
-			if (frames[i] != NULL) {
-				image_destroy(frames[i]);
-			}
-		}
+	if (count == 0) {
+		fprintf(stderr, "Error: No frames found in JXL image\n");
 		free(frames);
 		return NULL;
 	}
 
-	*frame_count = num_frames;
+	*frame_count = count;
 
 	return frames;
 
 cleanup_error:
 	JxlDecoderDestroy(dec);
 	// Cleanup on error
-	for (int i = 0; i < num_frames; i++) {
+	for (int i = 0; i < count; i++) {
 		if (frames[i] != NULL) {
 			image_destroy(frames[i]);
 		}
@@ -479,24 +343,30 @@ image_t **decode_jxl(const uint8_t *data, size_t len, int *frame_count)
 		return NULL;
 	}
 
-	// Initialize output
-	*frame_count = 0;
-
-	// Get basic info (dimensions and frame count)
-	uint32_t width = 0;
-	uint32_t height = 0;
-	int num_frames = 0;
+	return decode_jxl_frames(data, len, frame_count, 0, 0);
+}
 
-	int result = jxl_get_info(data, len, &width, &height, &num_frames);
-	if (result == -1) {
-		// Error already printed by jxl_get_info
+/**
+ * @brief Decode JXL image with only the detail a box needs
+ *
+ * Like decode_jxl(), but a still image whose fit into box_width x
+ * box_height is at least 8 times smaller is taken from the DC pass
+ * without decoding the remaining passes. This saves decode time, not
+ * memory: the frame is still allocated at full size.
+ *
+ * @param data Raw JXL file data
+ * @param len Length of data in bytes
+ * @param frame_count Output: number of frames decoded
+ * @param box_width Width of the box the image will be fitted into
+ * @param box_height Height of the box the image will be fitted into
+ * @return Array of image_t* frames, or NULL on error
+ */
+image_t **decode_jxl_hinted(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height)
+{
+	if (data == NULL || len == 0 || frame_count == NULL) {
+		fprintf(stderr, "Error: Invalid parameters to decode_jxl\n");
 		return NULL;
 	}
 
-	// Route to appropriate decoder
-	if (num_frames == 1) {
-		return decode_jxl_static(data, len, frame_count);
-	} else {
-		return decode_jxl_animated(data, len, frame_count, num_frames);
-	}
+	return decode_jxl_frames(data, len, frame_count, box_width, box_height);
 }
@@ -13,6 +13,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "../core/cancel.h"
 #include "decoder.h"
 
 /**
@@ -20,6 +21,13 @@
  */
 #define MAX_PNG_FRAMES 200
 
+/**
+ * @brief Largest reduction of the streaming downscaler
+ *
+ * A 64x64 box of alpha-weighted 8-bit samples still sums within uint32_t.
+ */
+#define PNG_MAX_REDUCTION 64
+
 /**
  * @brief Memory reader context for libpng
  */
@@ -29,7 +37,6 @@ typedef struct {
 	size_t offset; /**< Current read offset */
 } png_mem_reader;
 
-#ifdef PNG_APNG_SUPPORTED
 /**
  * @brief Custom read function for libpng to read from memory
  *
@@ -59,6 +66,7 @@ static void png_read_func(png_structp png_ptr, png_bytep data, size_t length)
 	reader->offset += length;
 }
 
+#ifdef PNG_APNG_SUPPORTED
 /**
  * @brief Check if PNG is animated (APNG format)
  *
@@ -519,44 +527,29 @@ static image_t **decode_png_static(const uint8_t *data, size_t len, int *frame_c
 		return NULL;
 	}
 
-	// Allocate temporary buffer for decoded pixels
-	uint8_t *buffer = (uint8_t *)malloc(buffer_size);
-	if (buffer == NULL) {
-		fprintf(stderr, "Error: Failed to allocate PNG decode buffer (%zu bytes)\n", buffer_size);
+	// Create image_t structure; libpng writes every byte of it
+	image_t *img = image_create_uninit(image.width, image.height);
+	if (img == NULL || buffer_size != (size_t)image.width * (size_t)image.height * 4) {
+		fprintf(stderr, "Error: Failed to create image_t structure\n");
+		image_destroy(img);
 		png_image_free(&image);
 		return NULL;
 	}
 
-	// Finish reading and decode
+	// Finish reading and decode straight into the image
 	// Parameters:
 	// - image: png_image structure
 	// - NULL: no background color
-	// - buffer: output buffer
+	// - img->pixels: output buffer
 	// - 0: row stride (0 = automatic)
 	// - NULL: no colormap
-	if (png_image_finish_read(&image, NULL, buffer, 0, NULL) == 0) {
+	if (png_image_finish_read(&image, NULL, img->pixels, 0, NULL) == 0) {
 		fprintf(stderr, "Error: libpng failed to decode PNG: %s\n", image.message);
-		free(buffer);
-		png_image_free(&image);
-		return NULL;
-	}
-
-	// Create image_t structure
-	image_t *img = image_create(image.width, image.height);
-	if (img == NULL) {
-		fprintf(stderr, "Error: Failed to create image_t structure\n");
-		free(buffer);
+		image_destroy(img);
 		png_image_free(&image);
 		return NULL;
 	}
 
-	// Copy pixel data to image_t
-	size_t pixel_count = (size_t)image.width * (size_t)image.height * 4;
-	memcpy(img->pixels, buffer, pixel_count);
-
-	// Free temporary buffer
-	free(buffer);
-
 	// Cleanup png_image structure
 	png_image_free(&image);
 
@@ -576,6 +569,272 @@ static image_t **decode_png_static(const uint8_t *data, size_t len, int *frame_c
 	return frames;
 }
 
+/**
+ * @brief Add one decoded RGBA row to the box filter sums
+ *
+ * Colors are weighted by alpha so transparent pixels do not bleed
+ * their (meaningless) color into the average.
+ *
+ * @param row Source row (width RGBA pixels)
+ * @param width Source width
+ * @param factor Box size
+ * @param sums Per output pixel sums: R*A, G*A, B*A, A
+ */
+static void png_box_accumulate(const uint8_t *row, uint32_t width, uint32_t factor, uint32_t *sums)
+{
+	for (uint32_t x = 0; x < width; x += factor) {
+		uint32_t end = (x + factor < width) ? x + factor : width;
+		uint32_t r = 0, g = 0, b = 0, a = 0;
+
+		for (uint32_t i = x; i < end; i++) {
+			const uint8_t *p = row + (size_t)i * 4;
+			r += (uint32_t)p[0] * p[3];
+			g += (uint32_t)p[1] * p[3];
+			b += (uint32_t)p[2] * p[3];
+			a += p[3];
+		}
+
+		sums[0] += r;
+		sums[1] += g;
+		sums[2] += b;
+		sums[3] += a;
+		sums += 4;
+	}
+}
+
+/**
+ * @brief Turn box filter sums into one output row and clear them
+ *
+ * @param sums Per output pixel sums from png_box_accumulate()
+ * @param width Source width
+ * @param factor Box size
+ * @param rows Source rows summed (factor, or fewer at the bottom edge)
+ * @param dst Output row
+ */
+static void png_box_emit(uint32_t *sums, uint32_t width, uint32_t factor, uint32_t rows, uint8_t *dst)
+{
+	for (uint32_t x = 0; x < width; x += factor) {
+		uint32_t columns = (x + factor < width) ? factor : width - x;
+		uint32_t count = columns * rows;
+		uint32_t a = sums[3];
+
+		if (a == 0) {
+			memset(dst, 0, 4);
+
+		} else {
+			dst[0] = (uint8_t)((sums[0] + a / 2) / a);
+			dst[1] = (uint8_t)((sums[1] + a / 2) / a);
+			dst[2] = (uint8_t)((sums[2] + a / 2) / a);
+			dst[3] = (uint8_t)((a + count / 2) / count);
+		}
+
+		memset(sums, 0, 4 * sizeof(uint32_t));
+		sums += 4;
+		dst += 4;
+	}
+}
+
+/**
+ * @brief Read a non-interlaced image, box-filtering it by factor
+ *
+ * @param png_ptr PNG read structure (transforms set up for RGBA8888)
+ * @param width Source width
+ * @param height Source height
+ * @param factor Reduction factor
+ * @param row Buffer for one source row
+ * @param sums Zeroed per output pixel sums
+ * @param img Output image (ceil(width / factor) x ceil(height / factor))
+ * @return true on success, false if cancelled
+ */
+static bool png_read_boxed(png_structp png_ptr, uint32_t width, uint32_t height, uint32_t factor, uint8_t *row, uint32_t *sums, image_t *img)
+{
+	for (uint32_t y = 0; y < height; y++) {
+		/* Abandon stale work (preview server superseded the request) */
+		if (y % CANCEL_ROW_BATCH == 0 && cancel_requested()) {
+			return false;
+		}
+
+		png_read_row(png_ptr, row, NULL);
+		png_box_accumulate(row, width, factor, sums);
+
+		if ((y + 1) % factor == 0 || y + 1 == height) {
+			png_box_emit(sums, width, factor, y % factor + 1, image_row(img, y / factor));
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Assemble a reduced image from the first Adam7 passes only
+ *
+ * Pass 1 alone holds every 8th pixel of every 8th row, passes 1-3 every
+ * 4th and passes 1-5 every 2nd. Every pixel of those passes lands on
+ * the reduced grid, so pass rows are scattered straight into img and
+ * the remaining passes are never inflated.
+ *
+ * @param png_ptr PNG read structure (no interlace handling, RGBA8888)
+ * @param width Source width
+ * @param height Source height
+ * @param factor Reduction factor (2, 4 or 8)
+ * @param row Buffer for one pass row
+ * @param img Output image (ceil(width / factor) x ceil(height / factor))
+ * @return true on success, false if cancelled
+ */
+static bool png_read_adam7(png_structp png_ptr, uint32_t width, uint32_t height, uint32_t factor, uint8_t *row, image_t *img)
+{
+	int passes = (factor == 8) ? 1 : (factor == 4) ? 3 : 5;
+
+	for (int pass = 0; pass < passes; pass++) {
+		uint32_t pass_cols = PNG_PASS_COLS(width, pass);
+		uint32_t pass_rows = PNG_PASS_ROWS(height, pass);
+
+		/* libpng skips empty passes */
+		if (pass_cols == 0 || pass_rows == 0) {
+			continue;
+		}
+
+		for (uint32_t j = 0; j < pass_rows; j++) {
+			if (j % CANCEL_ROW_BATCH == 0 && cancel_requested()) {
+				return false;
+			}
+
+			png_read_row(png_ptr, row, NULL);
+
+			uint8_t *dst = image_row(img, PNG_ROW_FROM_PASS_ROW(j, pass) / factor);
+			for (uint32_t i = 0; i < pass_cols; i++) {
+				memcpy(dst + (size_t)(PNG_COL_FROM_PASS_COL(i, pass) / factor) * 4, row + (size_t)i * 4, 4);
+			}
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Decode a static PNG at reduced resolution while reading
+ *
+ * Reduces by the largest power of two that still covers the fit into
+ * the box; the caller's resampler does the final, exact scaling. Only
+ * one source row and the reduced image are ever allocated:
+ *
+ * - Non-interlaced files are read row by row with png_read_row() and
+ *   folded into a running alpha-weighted box filter (up to
+ *   PNG_MAX_REDUCTION).
+ * - Interlaced files are reduced by 8, 4 or 2 by decoding only the
+ *   Adam7 passes that hold that grid; decoding stops there, so the rest
+ *   of the file is never inflated.
+ *
+ * Images that need no reduction are handed to decode_png_static().
+ *
+ * @param data Raw PNG file data
+ * @param len Length of data in bytes
+ * @param frame_count Output: always 1
+ * @param box_width Width of the box the image will be fitted into
+ * @param box_height Height of the box the image will be fitted into
+ * @return Array with single image_t*, or NULL on error
+ */
+static image_t **decode_png_streamed(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height)
+{
+	png_mem_reader reader = { data, len, 0 };
+
+	png_structp png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+	if (png_ptr == NULL) {
+		fprintf(stderr, "Error: Failed to create PNG read struct\n");
+		return NULL;
+	}
+
+	png_infop info_ptr = png_create_info_struct(png_ptr);
+	if (info_ptr == NULL) {
+		fprintf(stderr, "Error: Failed to create PNG info struct\n");
+		png_destroy_read_struct(&png_ptr, NULL, NULL);
+		return NULL;
+	}
+
+	if (setjmp(png_jmpbuf(png_ptr))) {
+		fprintf(stderr, "Error: PNG decoding error\n");
+		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+		return NULL;
+	}
+
+	png_set_read_fn(png_ptr, &reader, png_read_func);
+	png_read_info(png_ptr, info_ptr);
+
+	uint32_t width = png_get_image_width(png_ptr, info_ptr);
+	uint32_t height = png_get_image_height(png_ptr, info_ptr);
+	int color_type = png_get_color_type(png_ptr, info_ptr);
+	bool has_alpha = (color_type & PNG_COLOR_MASK_ALPHA) || png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS);
+	bool interlaced = png_get_interlace_type(png_ptr, info_ptr) != PNG_INTERLACE_NONE;
+
+	uint32_t factor = decoder_hint_scale(width, height, box_width, box_height, interlaced ? 8 : PNG_MAX_REDUCTION);
+	if (factor == 1) {
+		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+		return decode_png_static(data, len, frame_count);
+	}
+
+	/* Normalize to RGBA8888 (palette, low bit depths and tRNS expanded) */
+	png_set_expand(png_ptr);
+	png_set_scale_16(png_ptr);
+	png_set_gray_to_rgb(png_ptr);
+	if (!(color_type & PNG_COLOR_MASK_ALPHA)) {
+		png_set_add_alpha(png_ptr, 0xFF, PNG_FILLER_AFTER);
+	}
+
+	/* Encode to sRGB like the simplified API does */
+	double file_gamma;
+	if (png_get_gAMA(png_ptr, info_ptr, &file_gamma)) {
+		png_set_gamma(png_ptr, PNG_DEFAULT_sRGB, file_gamma);
+	}
+	png_read_update_info(png_ptr, info_ptr);
+
+	if (png_get_rowbytes(png_ptr, info_ptr) != (size_t)width * 4) {
+		fprintf(stderr, "Error: Unexpected PNG row size\n");
+		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+		return NULL;
+	}
+
+	uint32_t out_width = (width + factor - 1) / factor;
+	uint32_t out_height = (height + factor - 1) / factor;
+
+	uint8_t *row = (uint8_t *)malloc((size_t)width * 4);
+	uint32_t *sums = (uint32_t *)calloc((size_t)out_width * 4, sizeof(uint32_t));
+	image_t *img = image_create_uninit(out_width, out_height);
+	image_t **frames = (image_t **)malloc(sizeof(image_t *));
+	if (row == NULL || sums == NULL || img == NULL || frames == NULL) {
+		fprintf(stderr, "Error: Failed to allocate PNG buffers\n");
+		goto cleanup_error;
+	}
+
+	/* Errors from here on must also release the buffers */
+	if (setjmp(png_jmpbuf(png_ptr))) {
+		fprintf(stderr, "Error: PNG decoding error\n");
+		goto cleanup_error;
+	}
+
+	bool done = interlaced ? png_read_adam7(png_ptr, width, height, factor, row, img) : png_read_boxed(png_ptr, width, height, factor, row, sums, img);
+	if (!done) {
+		goto cleanup_error;
+	}
+
+	img->opaque = !has_alpha;
+
+	free(sums);
+	free(row);
+	png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+
+	frames[0] = img;
+	*frame_count = 1;
+	return frames;
+
+cleanup_error:
+	free(frames);
+	image_destroy(img);
+	free(sums);
+	free(row);
+	png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+	return NULL;
+}
+
 /**
  * @brief Decode PNG image (router function for static/animated)
  *
@@ -610,3 +869,37 @@ image_t **decode_png(const uint8_t *data, size_t len, int *frame_count)
 
 	return decode_png_static(data, len, frame_count);
 }
+
+/**
+ * @brief Decode PNG image, reducing it while reading when a box is given
+ *
+ * Static PNGs much larger than the box are reduced while reading (see
+ * decode_png_streamed()): non-interlaced files through a box filter,
+ * interlaced ones by decoding only the first Adam7 passes. Peak memory
+ * is the reduced image instead of the full-size one. Everything else
+ * is decoded as by decode_png().
+ *
+ * @param data Raw PNG file data
+ * @param len Length of data in bytes
+ * @param frame_count Output: number of frames decoded
+ * @param box_width Width of the box the image will be fitted into
+ * @param box_height Height of the box the image will be fitted into
+ * @return Array of image_t* frames, or NULL on error
+ */
+image_t **decode_png_hinted(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height)
+{
+	if (data == NULL || len == 0 || frame_count == NULL) {
+		fprintf(stderr, "Error: Invalid parameters to decode_png\n");
+		return NULL;
+	}
+
+	*frame_count = 0;
+
+#ifdef PNG_APNG_SUPPORTED
+	if (png_is_animated(data, len)) {
+		return decode_png_animated(data, len, frame_count);
+	}
+#endif /* PNG_APNG_SUPPORTED */
+
+	return decode_png_streamed(data, len, frame_count, box_width, box_height);
+}
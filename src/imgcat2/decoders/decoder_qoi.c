@@ -52,20 +52,16 @@ static image_t **decode_qoi_static(const uint8_t *data, size_t len, int *frame_c
 		return NULL;
 	}
 
-	// Create image_t structure
-	image_t *output = image_create((uint32_t)desc.width, (uint32_t)desc.height);
+	// Adopt the decoder buffer (QOI returns RGBA8888 from malloc())
+	image_t *output = image_adopt((uint32_t)desc.width, (uint32_t)desc.height, IMAGE_FORMAT_RGBA8, pixels, 0, NULL, NULL);
 	if (output == NULL) {
 		fprintf(stderr, "Error: Failed to create image_t structure\n");
 		free(pixels);
 		return NULL;
 	}
 
-	// Copy pixels (QOI already returns RGBA8888, same as our format)
-	size_t pixel_size = (size_t)desc.width * (size_t)desc.height * 4;
-	memcpy(output->pixels, pixels, pixel_size);
-
-	// Free QOI decoder buffer
-	free(pixels);
+	// QOI header says whether the source had an alpha channel
+	output->opaque = (desc.channels == 3);
 
 	// Allocate frames array (single frame)
 	image_t **frames = (image_t **)malloc(sizeof(image_t *));
@@ -2,7 +2,7 @@
  * @file decoder_raw.c
  * @brief RAW image decoder implementation using libraw
  *
- * Decodes camera RAW images (CR2, NEF, ARW, DNG, RAF, ORF, RW2, etc.) to RGBA8888 format.
+ * Decodes camera RAW images (CR2, NEF, ARW, DNG, RAF, ORF, RW2, etc.) to RGB.
  * Supports 100+ RAW formats via LibRAW library.
  */
 
@@ -17,10 +17,19 @@
 
 #include "decoder.h"
 
+/**
+ * @brief Release callback for pixels adopted from a LibRAW memory image
+ */
+static void raw_release_pixels(void *ctx, uint8_t *pixels)
+{
+	(void)pixels;
+	libraw_dcraw_clear_mem((libraw_processed_image_t *)ctx);
+}
+
 /**
  * @brief Decode static RAW image (single frame)
  *
- * Decodes a RAW camera image to RGBA8888 format.
+ * Decodes a RAW camera image to IMAGE_FORMAT_RGB8.
  * RAW files are always single-frame (no animation support).
  *
  * @param data Raw RAW file data
@@ -28,7 +37,7 @@
  * @param frame_count Output: always 1 (single frame)
  * @return Array with single image_t*, or NULL on error
  *
- * @note Output format is RGBA8888
+ * @note Output format is LibRAW's 8-bit RGB bitmap, adopted without copying
  * @note Processing parameters: sRGB color space, camera white balance, AHD demosaicing
  */
 static image_t **decode_raw_static(const uint8_t *data, size_t len, int *frame_count)
@@ -92,31 +101,24 @@ static image_t **decode_raw_static(const uint8_t *data, size_t len, int *frame_c
 		return NULL;
 	}
 
-	// Create image_t structure
-	image_t *output = image_create(processed->width, processed->height);
-	if (output == NULL) {
-		fprintf(stderr, "Error: Failed to create image_t structure\n");
+	// 8-bit RGB bitmap (the default output_bps and colors)
+	if (processed->type != LIBRAW_IMAGE_BITMAP || processed->colors != 3 || processed->bits != 8) {
+		fprintf(stderr, "Error: Unexpected RAW output: %d colors, %d bits\n", processed->colors, processed->bits);
 		libraw_dcraw_clear_mem(processed);
 		libraw_close(raw);
 		return NULL;
 	}
 
-	// Convert RGB to RGBA8888
-	// LibRAW returns RGB (3 bytes/pixel), we need RGBA8888 (4 bytes/pixel)
-	const uint8_t *src = processed->data;
-	uint8_t *dst = output->pixels;
-
-	for (int y = 0; y < (int)processed->height; y++) {
-		for (int x = 0; x < (int)processed->width; x++) {
-			*dst++ = *src++; // R
-			*dst++ = *src++; // G
-			*dst++ = *src++; // B
-			*dst++ = 0xFF; // A (fully opaque)
-		}
+	// Adopt LibRAW's RGB buffer as is; scaling converts it to RGBA
+	image_t *output = image_adopt(processed->width, processed->height, IMAGE_FORMAT_RGB8, processed->data, 0, raw_release_pixels, processed);
+	if (output == NULL) {
+		fprintf(stderr, "Error: Failed to create image_t structure\n");
+		libraw_dcraw_clear_mem(processed);
+		libraw_close(raw);
+		return NULL;
 	}
 
-	// Cleanup LibRAW resources
-	libraw_dcraw_clear_mem(processed);
+	// Cleanup LibRAW resources (the processed image lives on)
 	libraw_close(raw);
 
 	// Allocate frames array (single frame)
@@ -17,6 +17,15 @@
 #define STBI_FAILURE_USERMSG /* Use custom error messages */
 #include "stb_image.h"
 
+/**
+ * @brief Release callback for pixel buffers adopted from stb_image
+ */
+static void stb_release_pixels(void *ctx, uint8_t *pixels)
+{
+	(void)ctx;
+	stbi_image_free(pixels);
+}
+
 /**
  * @brief Decode image using stb_image (fallback decoder)
  *
@@ -29,7 +38,7 @@
  * @return Array with single image_t*, or NULL on error
  *
  * @note STB only supports static images (no animation)
- * @note Returns RGBA8888 format (4 channels, 8 bits per channel)
+ * @note Returns gray, RGB or RGBA (8 or 16 bits per channel) as stored
  */
 image_t **decode_stb(const uint8_t *data, size_t len, int *frame_count)
 {
@@ -41,9 +50,22 @@ image_t **decode_stb(const uint8_t *data, size_t len, int *frame_count)
 	// Initialize output
 	*frame_count = 0;
 
-	// Decode with stb_image
+	// Keep gray and RGB sources (e.g. 24-bit BMP, PGM) in their own layout;
+	// 16-bit sources (PNM, PSD) keep their precision until scaling
 	int width, height, channels;
-	uint8_t *pixels = stbi_load_from_memory(data, (int)len, &width, &height, &channels, 4);
+	int req_channels = 4;
+	image_format_t format = IMAGE_FORMAT_RGBA8;
+	bool wide = stbi_is_16_bit_from_memory(data, (int)len) != 0;
+
+	if (wide) {
+		format = IMAGE_FORMAT_RGBA16;
+
+	} else if (stbi_info_from_memory(data, (int)len, &width, &height, &channels) && (channels == 1 || channels == 3)) {
+		req_channels = channels;
+		format = channels == 1 ? IMAGE_FORMAT_GRAY8 : IMAGE_FORMAT_RGB8;
+	}
+
+	uint8_t *pixels = wide ? (uint8_t *)stbi_load_16_from_memory(data, (int)len, &width, &height, &channels, 4) : stbi_load_from_memory(data, (int)len, &width, &height, &channels, req_channels);
 	if (pixels == NULL) {
 		fprintf(stderr, "Error: stb_image failed to decode: %s\n", stbi_failure_reason());
 		return NULL;
@@ -56,20 +78,16 @@ image_t **decode_stb(const uint8_t *data, size_t len, int *frame_count)
 		return NULL;
 	}
 
-	// Create image_t structure
-	image_t *img = image_create((uint32_t)width, (uint32_t)height);
+	// Adopt the stb_image buffer in the layout we requested
+	image_t *img = image_adopt((uint32_t)width, (uint32_t)height, format, pixels, 0, stb_release_pixels, NULL);
 	if (img == NULL) {
 		fprintf(stderr, "Error: Failed to create image_t structure\n");
 		stbi_image_free(pixels);
 		return NULL;
 	}
 
-	// Copy pixel data (stb_image returns RGBA8888 when we request 4 channels)
-	size_t pixel_count = (size_t)width * (size_t)height * 4;
-	memcpy(img->pixels, pixels, pixel_count);
-
-	// Free stb_image buffer
-	stbi_image_free(pixels);
+	// Gray and RGB sources expanded to RGBA carry no alpha channel
+	img->opaque = img->opaque || channels == 1 || channels == 3;
 
 	// Allocate frames array (single frame)
 	image_t **frames = (image_t **)malloc(sizeof(image_t *));
@@ -138,8 +156,8 @@ image_t **decode_psd(const uint8_t *data, size_t len, int *frame_count)
 /**
  * @brief Decode HDR (Radiance RGBE) image using stb_image
  *
- * Decodes HDR images with tone mapping to convert float RGB to RGBA8888.
- * Uses simple clamping tone mapping.
+ * Hands over the float RGB pixels as IMAGE_FORMAT_RGBF; simple clamping
+ * tone mapping to RGBA8888 runs at the scaled size.
  *
  * @param data Raw HDR file data
  * @param len Length of data in bytes
@@ -174,57 +192,14 @@ image_t **decode_hdr(const uint8_t *data, size_t len, int *frame_count)
 		return NULL;
 	}
 
-	// Create image_t structure
-	image_t *img = image_create((uint32_t)width, (uint32_t)height);
+	// Adopt the float RGB buffer; tone mapping happens after scaling
+	image_t *img = image_adopt((uint32_t)width, (uint32_t)height, IMAGE_FORMAT_RGBF, (uint8_t *)pixels_float, 0, stb_release_pixels, NULL);
 	if (img == NULL) {
 		fprintf(stderr, "Error: Failed to create image_t structure\n");
 		stbi_image_free(pixels_float);
 		return NULL;
 	}
 
-	// Tone mapping: convert float RGB [0.0, inf] to RGBA8888 [0, 255]
-	// Simple clamping: clamp [0.0, 1.0] then scale to [0, 255]
-	size_t pixel_count = (size_t)width * (size_t)height;
-	for (size_t i = 0; i < pixel_count; i++) {
-		float r = pixels_float[i * 3 + 0];
-		float g = pixels_float[i * 3 + 1];
-		float b = pixels_float[i * 3 + 2];
-
-		// Clamp to [0.0, 1.0]
-		if (r < 0.0f) {
-			r = 0.0f;
-		}
-		if (r > 1.0f) {
-			r = 1.0f;
-		}
-		if (g < 0.0f) {
-			g = 0.0f;
-		}
-		if (g > 1.0f) {
-			g = 1.0f;
-		}
-		if (b < 0.0f) {
-			b = 0.0f;
-		}
-		if (b > 1.0f) {
-			b = 1.0f;
-		}
-
-		// Convert to [0, 255]
-		uint8_t r8 = (uint8_t)(r * 255.0f);
-		uint8_t g8 = (uint8_t)(g * 255.0f);
-		uint8_t b8 = (uint8_t)(b * 255.0f);
-
-		// Set pixel (alpha = 255)
-		img->pixels[i * 4 + 0] = r8;
-		img->pixels[i * 4 + 1] = g8;
-		img->pixels[i * 4 + 2] = b8;
-		img->pixels[i * 4 + 3] = 255;
-	}
-
-	// Free stb_image float buffer
-	stbi_image_free(pixels_float);
-
 	// Allocate frames array (single frame)
 	image_t **frames = (image_t **)malloc(sizeof(image_t *));
 	if (frames == NULL) {
@@ -236,7 +211,7 @@ image_t **decode_hdr(const uint8_t *data, size_t len, int *frame_count)
 	frames[0] = img;
 	*frame_count = 1;
 
-	// fprintf(stderr, "HDR decoded: %ux%u, tone-mapped to RGBA8888\n", (uint32_t)width, (uint32_t)height);
+	// fprintf(stderr, "HDR decoded: %ux%u, float RGB\n", (uint32_t)width, (uint32_t)height);
 
 	return frames;
 }
@@ -4,6 +4,12 @@
  *
  * Decodes TIFF images (both single-page and multi-page) to RGBA8888 format.
  * Handles all TIFF format variations including CMYK, YCbCr, palette, etc.
+ *
+ * Pyramidal files (SubIFDs or reduced-resolution directories) are read
+ * from the smallest level that covers the display size. Levels are
+ * decoded tile by tile (or strip by strip) in bands of output rows on
+ * worker threads, box-filtered down when still larger than needed, so
+ * the full-resolution raster of multi-gigabyte slides is never built.
  */
 
 /* clang-format off */
@@ -16,10 +22,22 @@
 /* clang-format on */
 
 #include "decoder.h"
+#include "../core/cancel.h"
+#include "../core/executor.h"
+#include "../core/pixel_ops.h"
 
 /** Maximum number of TIFF frames to decode (prevents DoS) */
 #define MAX_TIFF_FRAMES 200
 
+/** Maximum resolution levels (full image, SubIFDs, reduced images) per page */
+#define MAX_TIFF_LEVELS 32
+
+/** Largest box filter reduction applied while reading a level */
+#define TIFF_MAX_REDUCTION 64
+
+/** Smallest level (in pixels) worth splitting across threads */
+#define TIFF_PARALLEL_MIN_PIXELS (1u << 22)
+
 /**
  * @brief Memory-based I/O context for libtiff
  *
@@ -133,79 +151,406 @@ static toff_t tiff_size_proc(thandle_t handle)
 }
 
 /**
- * @brief Check if TIFF has multiple pages
+ * @brief One resolution level of a TIFF page
+ */
+typedef struct {
+	toff_t offset; /**< Directory offset (for TIFFSetSubDirectory) */
+	uint32_t width; /**< Level width */
+	uint32_t height; /**< Level height */
+} tiff_level_t;
+
+/**
+ * @brief Shared state for decoding one level in bands of output rows
+ */
+typedef struct {
+	const uint8_t *data; /**< TIFF file data */
+	size_t len; /**< Length of data in bytes */
+	toff_t offset; /**< Directory offset of the level */
+	uint32_t width; /**< Level width */
+	uint32_t height; /**< Level height */
+	bool tiled; /**< true = tiles, false = strips */
+	uint32_t block_width; /**< Tile width (level width for strips) */
+	uint32_t block_height; /**< Tile height, or rows per strip */
+	uint32_t factor; /**< Box filter reduction (1 = none) */
+	uint32_t band_rows; /**< Output rows per band */
+	image_t *img; /**< Output image */
+	bool *failed; /**< Per-band failure flags */
+} tiff_band_job_t;
+
+/**
+ * @brief Open a TIFF held in memory
  *
- * Quickly checks if a TIFF file contains multiple directories (pages)
- * without fully decoding the image data. Useful for determining whether
- * to use static or multi-page decoder.
+ * @param mem Memory I/O context (must outlive the handle)
+ * @return TIFF handle, or NULL if the data is not a readable TIFF
+ */
+static TIFF *tiff_open_memory(tiff_memory_t *mem)
+{
+	return TIFFClientOpen("memory", "r", (thandle_t)mem, tiff_read_proc, tiff_write_proc, tiff_seek_proc, tiff_close_proc, tiff_size_proc, NULL, NULL);
+}
+
+/**
+ * @brief Release callback for pixels adopted from a libtiff raster
+ */
+static void tiff_release_raster(void *ctx, uint8_t *pixels)
+{
+	(void)ctx;
+	_TIFFfree(pixels);
+}
+
+/**
+ * @brief Turn a TIFFReadRGBAImage raster into an RGBA8 image_t
  *
- * @param data Raw TIFF file data
- * @param len Size of data in bytes
- * @return true if TIFF has multiple pages, false otherwise or on error
+ * Converts the ABGR words in place (nothing to do on little-endian
+ * CPUs) and adopts the raster, so no second pixel buffer is allocated.
  *
- * @note Returns false if data is invalid or not a TIFF
- * @note Does not validate that pages are decodable, only checks count
+ * @param raster Raster from _TIFFmalloc (owned by the image on success)
+ * @param width Image width
+ * @param height Image height
+ * @return Image, or NULL on error (raster is left to the caller)
  */
-static bool tiff_is_multipage(const uint8_t *data, size_t len)
+static image_t *tiff_adopt_raster(uint32_t *raster, uint32_t width, uint32_t height)
 {
-	if (data == NULL || len == 0) {
-		return false;
-	}
+	pixel_abgr32_to_rgba(raster, (uint8_t *)raster, (size_t)width * height);
 
-	tiff_memory_t mem = { data, len, 0 };
+	return image_adopt(width, height, IMAGE_FORMAT_RGBA8, (uint8_t *)raster, 0, tiff_release_raster, NULL);
+}
 
-	TIFF *tif = TIFFClientOpen("memory", "r", (thandle_t)&mem, tiff_read_proc, tiff_write_proc, tiff_seek_proc, tiff_close_proc, tiff_size_proc, NULL, NULL);
-	if (tif == NULL) {
-		return false;
+/**
+ * @brief Get the size of the current directory's image
+ *
+ * @param tif TIFF handle
+ * @param width Output: image width
+ * @param height Output: image height
+ * @return true if both dimensions are present and non-zero
+ */
+static bool tiff_get_size(TIFF *tif, uint32_t *width, uint32_t *height)
+{
+	*width = 0;
+	*height = 0;
+
+	return TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, width) && TIFFGetField(tif, TIFFTAG_IMAGELENGTH, height) && *width > 0 && *height > 0;
+}
+
+/**
+ * @brief Check if the current directory is a reduced-resolution copy
+ *
+ * @param tif TIFF handle
+ * @return true if the directory is flagged FILETYPE_REDUCEDIMAGE
+ */
+static bool tiff_is_reduced(TIFF *tif)
+{
+	uint32_t subfile_type = 0;
+	TIFFGetFieldDefaulted(tif, TIFFTAG_SUBFILETYPE, &subfile_type);
+
+	return (subfile_type & FILETYPE_REDUCEDIMAGE) != 0;
+}
+
+/**
+ * @brief Check if an image size is within the image_t resource limits
+ */
+static bool tiff_within_limits(uint32_t width, uint32_t height)
+{
+	return width <= IMAGE_MAX_DIMENSION && height <= IMAGE_MAX_DIMENSION && (uint64_t)width * height <= IMAGE_MAX_PIXELS;
+}
+
+/**
+ * @brief List the resolution levels of the page in directory dir
+ *
+ * Level 0 is the page itself, followed by its SubIFDs and by the
+ * directories right after it that are flagged as reduced images.
+ *
+ * @param tif TIFF handle, positioned at directory dir (moved on return)
+ * @param dir Directory index of the page
+ * @param levels Output: up to MAX_TIFF_LEVELS levels
+ * @return Number of levels, or 0 if the page has no valid size
+ */
+static int tiff_list_levels(TIFF *tif, tdir_t dir, tiff_level_t *levels)
+{
+	int count = 0;
+
+	uint32_t width, height;
+	if (!tiff_get_size(tif, &width, &height)) {
+		return 0;
+	}
+	levels[count++] = (tiff_level_t) { TIFFCurrentDirOffset(tif), width, height };
+
+	// SubIFD offsets belong to the directory, copy them before moving
+	uint16_t sub_count = 0;
+	toff_t *sub_offsets = NULL;
+	toff_t subs[MAX_TIFF_LEVELS];
+	int subs_count = 0;
+	if (TIFFGetField(tif, TIFFTAG_SUBIFD, &sub_count, &sub_offsets) && sub_offsets != NULL) {
+		for (uint16_t i = 0; i < sub_count && subs_count < MAX_TIFF_LEVELS - 1; i++) {
+			subs[subs_count++] = sub_offsets[i];
+		}
 	}
 
-	tdir_t dir_count = TIFFNumberOfDirectories(tif);
+	for (int i = 0; i < subs_count && count < MAX_TIFF_LEVELS; i++) {
+		if (TIFFSetSubDirectory(tif, subs[i]) && tiff_get_size(tif, &width, &height)) {
+			levels[count++] = (tiff_level_t) { subs[i], width, height };
+		}
+	}
 
-	TIFFClose(tif);
+	// Older pyramids store the reduced images as the following directories
+	if (TIFFSetDirectory(tif, dir)) {
+		while (count < MAX_TIFF_LEVELS && TIFFReadDirectory(tif) && tiff_is_reduced(tif)) {
+			if (tiff_get_size(tif, &width, &height)) {
+				levels[count++] = (tiff_level_t) { TIFFCurrentDirOffset(tif), width, height };
+			}
+		}
+	}
 
-	return dir_count > 1;
+	return count;
 }
 
 /**
- * @brief Decode static TIFF image (single page)
+ * @brief Pick the resolution level to decode
  *
- * Decodes a single-page TIFF image to RGBA8888 format.
- * For multi-page TIFF files, use decode_tiff_multipage().
+ * With a box, this is the smallest level that still covers the full
+ * image fitted into the box. Without one, it is the largest level within
+ * the image limits (or the smallest level if none is).
  *
- * @param data Raw TIFF file data
- * @param len Length of data in bytes
- * @param frame_count Output: always 1 (single frame)
- * @return Array with single image_t*, or NULL on error
+ * @param levels Levels from tiff_list_levels()
+ * @param count Number of levels
+ * @param box_width Width of the box the image will be fitted into (0 = none)
+ * @param box_height Height of the box the image will be fitted into (0 = none)
+ * @return Index into levels
+ */
+static int tiff_select_level(const tiff_level_t *levels, int count, uint32_t box_width, uint32_t box_height)
+{
+	int best = 0;
+
+	if (box_width > 0 && box_height > 0) {
+		// Size of the full image fitted into the box (never enlarged)
+		double fit = (double)box_width / levels[0].width;
+		if ((double)box_height / levels[0].height < fit) {
+			fit = (double)box_height / levels[0].height;
+		}
+		if (fit > 1.0) {
+			fit = 1.0;
+		}
+
+		uint32_t fit_width = (uint32_t)(levels[0].width * fit);
+		uint32_t fit_height = (uint32_t)(levels[0].height * fit);
+
+		for (int i = 1; i < count; i++) {
+			uint64_t area = (uint64_t)levels[i].width * levels[i].height;
+			if (levels[i].width >= fit_width && levels[i].height >= fit_height && area < (uint64_t)levels[best].width * levels[best].height) {
+				best = i;
+			}
+		}
+		return best;
+	}
+
+	bool found = tiff_within_limits(levels[0].width, levels[0].height);
+	for (int i = 1; i < count; i++) {
+		uint64_t area = (uint64_t)levels[i].width * levels[i].height;
+		uint64_t best_area = (uint64_t)levels[best].width * levels[best].height;
+
+		if (tiff_within_limits(levels[i].width, levels[i].height)) {
+			if (!found || area > best_area) {
+				best = i;
+				found = true;
+			}
+
+		} else if (!found && area < best_area) {
+			best = i;
+		}
+	}
+
+	return best;
+}
+
+/**
+ * @brief Add decoded RGBA pixels to the box filter sums of one output row
  *
- * @note Output format is RGBA8888
- * @note Handles all TIFF format variations (CMYK, YCbCr, palette, etc.)
+ * Colors are weighted by alpha so transparent pixels do not bleed
+ * their (meaningless) color into the average.
+ *
+ * @param src Source pixels (count RGBA pixels)
+ * @param x Level column of the first pixel
+ * @param count Number of pixels
+ * @param factor Box size
+ * @param sums Per output pixel sums for the output row: R*A, G*A, B*A, A
  */
-static image_t **decode_tiff_static(const uint8_t *data, size_t len, int *frame_count)
+static void tiff_box_accumulate(const uint8_t *src, uint32_t x, uint32_t count, uint32_t factor, uint32_t *sums)
 {
-	if (data == NULL || len == 0 || frame_count == NULL) {
-		fprintf(stderr, "Error: Invalid parameters to decode_tiff_static\n");
-		return NULL;
+	for (uint32_t i = 0; i < count; i++) {
+		const uint8_t *p = src + (size_t)i * 4;
+		uint32_t *sum = sums + (size_t)((x + i) / factor) * 4;
+
+		sum[0] += (uint32_t)p[0] * p[3];
+		sum[1] += (uint32_t)p[1] * p[3];
+		sum[2] += (uint32_t)p[2] * p[3];
+		sum[3] += p[3];
 	}
+}
 
-	*frame_count = 0;
+/**
+ * @brief Turn box filter sums into one output row
+ *
+ * @param sums Per output pixel sums from tiff_box_accumulate()
+ * @param width Level width
+ * @param factor Box size
+ * @param rows Level rows summed (factor, or fewer at the bottom edge)
+ * @param dst Output row
+ */
+static void tiff_box_emit(const uint32_t *sums, uint32_t width, uint32_t factor, uint32_t rows, uint8_t *dst)
+{
+	for (uint32_t x = 0; x < width; x += factor) {
+		uint32_t columns = (x + factor < width) ? factor : width - x;
+		uint32_t count = columns * rows;
+		uint32_t a = sums[3];
+
+		if (a == 0) {
+			memset(dst, 0, 4);
+
+		} else {
+			dst[0] = (uint8_t)((sums[0] + a / 2) / a);
+			dst[1] = (uint8_t)((sums[1] + a / 2) / a);
+			dst[2] = (uint8_t)((sums[2] + a / 2) / a);
+			dst[3] = (uint8_t)((a + count / 2) / count);
+		}
 
-	tiff_memory_t mem = { data, len, 0 };
+		sums += 4;
+		dst += 4;
+	}
+}
 
-	TIFF *tif = TIFFClientOpen("memory", "r", (thandle_t)&mem, tiff_read_proc, tiff_write_proc, tiff_seek_proc, tiff_close_proc, tiff_size_proc, NULL, NULL);
+/**
+ * @brief Decode one band of output rows (executor prepare step)
+ *
+ * libtiff handles are not thread safe, so every band reads the level
+ * through its own handle. Blocks straddling two bands are decoded by
+ * both.
+ *
+ * @param index Band index
+ * @param ctx Band job (tiff_band_job_t*)
+ */
+static void tiff_decode_band(size_t index, void *ctx)
+{
+	tiff_band_job_t *job = (tiff_band_job_t *)ctx;
+	image_t *img = job->img;
+	uint32_t factor = job->factor;
+	uint32_t bw = job->block_width;
+	uint32_t bh = job->block_height;
+
+	// Output rows of this band and the level rows they cover
+	uint32_t out_top = (uint32_t)index * job->band_rows;
+	uint32_t out_bottom = (out_top + job->band_rows < img->height) ? out_top + job->band_rows : img->height;
+	uint32_t top = out_top * factor;
+	uint32_t bottom = ((uint64_t)out_bottom * factor < job->height) ? out_bottom * factor : job->height;
+
+	job->failed[index] = true;
+
+	tiff_memory_t mem = { job->data, job->len, 0 };
+	TIFF *tif = tiff_open_memory(&mem);
 	if (tif == NULL) {
-		fprintf(stderr, "Error: Failed to open TIFF\n");
-		return NULL;
+		return;
 	}
 
-	uint32_t width, height;
-	TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
-	TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
+	uint32_t *block = NULL;
+	uint32_t *sums = NULL;
+
+	if (!TIFFSetSubDirectory(tif, job->offset)) {
+		goto done;
+	}
+
+	block = (uint32_t *)_TIFFmalloc((tmsize_t)bw * bh * sizeof(uint32_t));
+	if (block == NULL) {
+		goto done;
+	}
+
+	if (factor > 1) {
+		sums = (uint32_t *)calloc((size_t)(out_bottom - out_top) * img->width * 4, sizeof(uint32_t));
+		if (sums == NULL) {
+			goto done;
+		}
+	}
+
+	for (uint32_t y = top - top % bh; y < bottom; y += bh) {
+		uint32_t rows = (y + bh < job->height) ? bh : job->height - y;
+
+		for (uint32_t x = 0; x < job->width; x += bw) {
+			if (cancel_requested()) {
+				goto done;
+			}
+
+			int ok = job->tiled ? TIFFReadRGBATile(tif, x, y, block) : TIFFReadRGBAStrip(tif, y, block);
+			if (!ok) {
+				goto done;
+			}
+
+			// Tiles are padded to the full tile height, strips are not
+			uint32_t block_rows = job->tiled ? bh : rows;
+			uint32_t columns = (x + bw < job->width) ? bw : job->width - x;
+			pixel_abgr32_to_rgba(block, (uint8_t *)block, (size_t)bw * block_rows);
+
+			// Rows come bottom-up
+			for (uint32_t r = 0; r < rows; r++) {
+				uint32_t level_y = y + r;
+				if (level_y < top || level_y >= bottom) {
+					continue;
+				}
+
+				const uint8_t *src = (const uint8_t *)(block + (size_t)(block_rows - 1 - r) * bw);
+				if (factor == 1) {
+					memcpy(image_row(img, level_y) + (size_t)x * 4, src, (size_t)columns * 4);
+
+				} else {
+					tiff_box_accumulate(src, x, columns, factor, sums + (size_t)(level_y / factor - out_top) * img->width * 4);
+				}
+			}
+		}
+	}
+
+	if (factor > 1) {
+		for (uint32_t out_y = out_top; out_y < out_bottom; out_y++) {
+			uint32_t rows = (out_y * factor + factor < job->height) ? factor : job->height - out_y * factor;
+			tiff_box_emit(sums + (size_t)(out_y - out_top) * img->width * 4, job->width, factor, rows, image_row(img, out_y));
+		}
+	}
+
+	job->failed[index] = false;
+
+done:
+	free(sums);
+	if (block != NULL) {
+		_TIFFfree(block);
+	}
+	TIFFClose(tif);
+}
+
+/**
+ * @brief Executor emit step (bands write straight into the image)
+ */
+static void tiff_band_done(size_t index, void *ctx)
+{
+	(void)index;
+	(void)ctx;
+}
+
+/**
+ * @brief Decode the current directory into one full-size raster
+ *
+ * Fallback for orientations the block readers cannot place.
+ *
+ * @param tif TIFF handle positioned at the level
+ * @param width Level width
+ * @param height Level height
+ * @return RGBA8 image, or NULL on error
+ */
+static image_t *tiff_read_raster(TIFF *tif, uint32_t width, uint32_t height)
+{
+	if (!tiff_within_limits(width, height)) {
+		fprintf(stderr, "Error: TIFF dimensions exceed maximum: %ux%u\n", width, height);
+		return NULL;
+	}
 
 	// Allocate raster buffer (ABGR format)
-	uint32_t *raster = (uint32_t *)_TIFFmalloc(width * height * sizeof(uint32_t));
+	uint32_t *raster = (uint32_t *)_TIFFmalloc((tmsize_t)width * height * sizeof(uint32_t));
 	if (raster == NULL) {
 		fprintf(stderr, "Error: Failed to allocate raster buffer\n");
-		TIFFClose(tif);
 		return NULL;
 	}
 
@@ -213,63 +558,158 @@ static image_t **decode_tiff_static(const uint8_t *data, size_t len, int *frame_
 	if (!TIFFReadRGBAImageOriented(tif, width, height, raster, ORIENTATION_TOPLEFT, 0)) {
 		fprintf(stderr, "Error: Failed to read TIFF image\n");
 		_TIFFfree(raster);
-		TIFFClose(tif);
 		return NULL;
 	}
 
-	// Create image_t
-	image_t *img = image_create(width, height);
+	// Convert ABGR to RGBA in place and adopt the raster as image_t
+	image_t *img = tiff_adopt_raster(raster, width, height);
 	if (img == NULL) {
 		fprintf(stderr, "Error: Failed to create image_t\n");
 		_TIFFfree(raster);
-		TIFFClose(tif);
 		return NULL;
 	}
 
-	// Convert ABGR to RGBA (libtiff returns ABGR packed in uint32_t)
-	for (uint32_t i = 0; i < width * height; i++) {
-		uint32_t abgr = raster[i];
-		img->pixels[i * 4 + 0] = TIFFGetR(abgr);
-		img->pixels[i * 4 + 1] = TIFFGetG(abgr);
-		img->pixels[i * 4 + 2] = TIFFGetB(abgr);
-		img->pixels[i * 4 + 3] = TIFFGetA(abgr);
+	return img;
+}
+
+/**
+ * @brief Decode one resolution level, box-filtered to fit a box
+ *
+ * @param tif TIFF handle (moved to the level)
+ * @param data Raw TIFF file data
+ * @param len Length of data in bytes
+ * @param level Level to decode
+ * @param box_width Width of the box the image will be fitted into (0 = none)
+ * @param box_height Height of the box the image will be fitted into (0 = none)
+ * @return RGBA8 image, or NULL on error
+ *
+ * @note Levels beyond the image limits are reduced until they fit
+ */
+static image_t *tiff_decode_level(TIFF *tif, const uint8_t *data, size_t len, const tiff_level_t *level, uint32_t box_width, uint32_t box_height)
+{
+	if (!TIFFSetSubDirectory(tif, level->offset)) {
+		fprintf(stderr, "Error: Failed to read TIFF directory\n");
+		return NULL;
 	}
 
-	_TIFFfree(raster);
-	TIFFClose(tif);
+	// Blocks are placed top-down, so only the usual orientation can be split
+	uint16_t orientation = ORIENTATION_TOPLEFT;
+	TIFFGetFieldDefaulted(tif, TIFFTAG_ORIENTATION, &orientation);
+
+	char message[1024];
+	if (orientation != ORIENTATION_TOPLEFT || !TIFFRGBAImageOK(tif, message)) {
+		return tiff_read_raster(tif, level->width, level->height);
+	}
+
+	tiff_band_job_t job = {
+		.data = data,
+		.len = len,
+		.offset = level->offset,
+		.width = level->width,
+		.height = level->height,
+		.tiled = TIFFIsTiled(tif) != 0,
+	};
 
-	// Allocate frames array
-	image_t **frames = (image_t **)malloc(sizeof(image_t *));
-	if (frames == NULL) {
-		fprintf(stderr, "Error: Failed to allocate frames array\n");
-		image_destroy(img);
+	if (job.tiled) {
+		TIFFGetField(tif, TIFFTAG_TILEWIDTH, &job.block_width);
+		TIFFGetField(tif, TIFFTAG_TILELENGTH, &job.block_height);
+
+	} else {
+		job.block_width = job.width;
+		TIFFGetFieldDefaulted(tif, TIFFTAG_ROWSPERSTRIP, &job.block_height);
+		if (job.block_height > job.height) {
+			job.block_height = job.height;
+		}
+	}
+
+	if (job.block_width == 0 || job.block_height == 0 || (uint64_t)job.block_width * job.block_height > IMAGE_MAX_PIXELS) {
+		fprintf(stderr, "Error: Unsupported TIFF block size: %ux%u\n", job.block_width, job.block_height);
 		return NULL;
 	}
 
-	frames[0] = img;
-	*frame_count = 1;
-	return frames;
+	// Reduce to the box, and further if the level exceeds the image limits
+	job.factor = decoder_hint_scale(job.width, job.height, box_width, box_height, TIFF_MAX_REDUCTION);
+	while (job.factor < TIFF_MAX_REDUCTION && !tiff_within_limits((job.width + job.factor - 1) / job.factor, (job.height + job.factor - 1) / job.factor)) {
+		job.factor *= 2;
+	}
+
+	uint32_t out_width = (job.width + job.factor - 1) / job.factor;
+	uint32_t out_height = (job.height + job.factor - 1) / job.factor;
+	if (!tiff_within_limits(out_width, out_height)) {
+		fprintf(stderr, "Error: TIFF dimensions exceed maximum: %ux%u\n", job.width, job.height);
+		return NULL;
+	}
+
+	job.img = image_create_uninit(out_width, out_height);
+	if (job.img == NULL) {
+		fprintf(stderr, "Error: Failed to create image_t\n");
+		return NULL;
+	}
+
+	// One band per thread (one on busy multi-file workers), rounded to whole block rows where possible
+	int threads = decoder_parallel_threads();
+	if ((uint64_t)job.width * job.height < TIFF_PARALLEL_MIN_PIXELS) {
+		threads = 1;
+	}
+	uint32_t block_rows = (job.height + job.block_height - 1) / job.block_height;
+	uint32_t bands = (uint32_t)threads;
+	if (bands > block_rows) {
+		bands = block_rows;
+	}
+
+	uint32_t rows_per_block = job.block_height / job.factor > 0 ? job.block_height / job.factor : 1;
+	job.band_rows = (out_height + bands - 1) / bands;
+	job.band_rows = (job.band_rows + rows_per_block - 1) / rows_per_block * rows_per_block;
+	bands = (out_height + job.band_rows - 1) / job.band_rows;
+
+	job.failed = (bool *)calloc(bands, sizeof(bool));
+	if (job.failed == NULL) {
+		fprintf(stderr, "Error: Failed to allocate TIFF band state\n");
+		image_destroy(job.img);
+		return NULL;
+	}
+
+	executor_run(bands, threads, bands, tiff_decode_band, tiff_band_done, &job);
+
+	bool failed = false;
+	for (uint32_t i = 0; i < bands; i++) {
+		failed = failed || job.failed[i];
+	}
+	free(job.failed);
+
+	if (failed) {
+		// Cancelled decodes are not errors
+		if (!cancel_requested()) {
+			fprintf(stderr, "Error: Failed to read TIFF %s\n", job.tiled ? "tiles" : "strips");
+		}
+		image_destroy(job.img);
+		return NULL;
+	}
+
+	return job.img;
 }
 
 /**
- * @brief Decode multi-page TIFF with all pages
+ * @brief Decode all pages of a TIFF, each from its best resolution level
  *
- * Decodes all pages in a multi-page TIFF file.
- * Each page is decoded independently.
+ * Each directory is a page, except reduced-resolution directories,
+ * which belong to the page before them.
  *
  * @param data Raw TIFF file data
  * @param len Length of data in bytes
  * @param frame_count Output: number of frames decoded
+ * @param box_width Width of the box the image will be fitted into (0 = none)
+ * @param box_height Height of the box the image will be fitted into (0 = none)
  * @return Array of image_t* frames, or NULL on error
  *
  * @note Maximum MAX_TIFF_FRAMES frames (200) to prevent DoS
  * @note TIFF pages have no timing info - uniform frame rate
  * @note Output format is RGBA8888
  */
-static image_t **decode_tiff_multipage(const uint8_t *data, size_t len, int *frame_count)
+static image_t **decode_tiff_pages(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height)
 {
 	if (data == NULL || len == 0 || frame_count == NULL) {
-		fprintf(stderr, "Error: Invalid parameters to decode_tiff_multipage\n");
+		fprintf(stderr, "Error: Invalid parameters to decode_tiff_pages\n");
 		return NULL;
 	}
 
@@ -277,90 +717,76 @@ static image_t **decode_tiff_multipage(const uint8_t *data, size_t len, int *fra
 
 	tiff_memory_t mem = { data, len, 0 };
 
-	TIFF *tif = TIFFClientOpen("memory", "r", (thandle_t)&mem, tiff_read_proc, tiff_write_proc, tiff_seek_proc, tiff_close_proc, tiff_size_proc, NULL, NULL);
+	TIFF *tif = tiff_open_memory(&mem);
 	if (tif == NULL) {
 		fprintf(stderr, "Error: Failed to open TIFF\n");
 		return NULL;
 	}
 
 	tdir_t num_dirs = TIFFNumberOfDirectories(tif);
-	if (num_dirs == 0) {
-		fprintf(stderr, "Error: TIFF has no pages\n");
-		TIFFClose(tif);
-		return NULL;
-	}
 
-	// Enforce MAX_TIFF_FRAMES limit
-	int num_frames = (int)num_dirs;
-	if (num_frames > MAX_TIFF_FRAMES) {
-		fprintf(stderr, "Warning: TIFF has %d pages, limiting to %d\n", num_frames, MAX_TIFF_FRAMES);
-		num_frames = MAX_TIFF_FRAMES;
-	}
+	image_t **frames = NULL;
+	int capacity = 0;
+	int count = 0;
 
-	// Allocate frames array
-	image_t **frames = (image_t **)malloc(sizeof(image_t *) * num_frames);
-	if (frames == NULL) {
-		fprintf(stderr, "Error: Failed to allocate frames array\n");
-		TIFFClose(tif);
-		return NULL;
-	}
-
-	// Initialize to NULL for cleanup safety
-	for (int i = 0; i < num_frames; i++) {
-		frames[i] = NULL;
-	}
-
-	// Decode each directory
-	for (int i = 0; i < num_frames; i++) {
-		if (!TIFFSetDirectory(tif, (tdir_t)i)) {
-			fprintf(stderr, "Error: Failed to set TIFF directory %d\n", i);
+	for (tdir_t dir = 0; dir < num_dirs; dir++) {
+		if (!TIFFSetDirectory(tif, dir)) {
+			fprintf(stderr, "Error: Failed to set TIFF directory %u\n", (unsigned int)dir);
 			goto cleanup_error;
 		}
 
-		uint32_t width, height;
-		TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
-		TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
-
-		uint32_t *raster = (uint32_t *)_TIFFmalloc(width * height * sizeof(uint32_t));
-		if (raster == NULL) {
-			fprintf(stderr, "Error: Failed to allocate raster for page %d\n", i);
-			goto cleanup_error;
+		// Reduced-resolution images are levels of the page before them
+		if (tiff_is_reduced(tif)) {
+			continue;
 		}
 
-		if (!TIFFReadRGBAImageOriented(tif, width, height, raster, ORIENTATION_TOPLEFT, 0)) {
-			fprintf(stderr, "Error: Failed to read TIFF page %d\n", i);
-			_TIFFfree(raster);
-			goto cleanup_error;
+		// Enforce MAX_TIFF_FRAMES limit
+		if (count == MAX_TIFF_FRAMES) {
+			fprintf(stderr, "Warning: TIFF has more than %d pages, limiting to %d\n", MAX_TIFF_FRAMES, MAX_TIFF_FRAMES);
+			break;
 		}
 
-		frames[i] = image_create(width, height);
-		if (frames[i] == NULL) {
-			fprintf(stderr, "Error: Failed to create image_t for page %d\n", i);
-			_TIFFfree(raster);
+		tiff_level_t levels[MAX_TIFF_LEVELS];
+		int level_count = tiff_list_levels(tif, dir, levels);
+		if (level_count == 0) {
+			fprintf(stderr, "Error: TIFF page %d has invalid dimensions\n", count);
 			goto cleanup_error;
 		}
 
-		// Convert ABGR to RGBA
-		for (uint32_t j = 0; j < width * height; j++) {
-			uint32_t abgr = raster[j];
-			frames[i]->pixels[j * 4 + 0] = TIFFGetR(abgr);
-			frames[i]->pixels[j * 4 + 1] = TIFFGetG(abgr);
-			frames[i]->pixels[j * 4 + 2] = TIFFGetB(abgr);
-			frames[i]->pixels[j * 4 + 3] = TIFFGetA(abgr);
+		// Grow frames array
+		if (count == capacity) {
+			int new_capacity = capacity > 0 ? capacity * 2 : 1;
+			image_t **grown = (image_t **)realloc(frames, sizeof(image_t *) * new_capacity);
+			if (grown == NULL) {
+				fprintf(stderr, "Error: Failed to allocate frames array\n");
+				goto cleanup_error;
+			}
+			frames = grown;
+			capacity = new_capacity;
 		}
 
-		_TIFFfree(raster);
+		int level = tiff_select_level(levels, level_count, box_width, box_height);
+		frames[count] = tiff_decode_level(tif, data, len, &levels[level], box_width, box_height);
+		if (frames[count] == NULL) {
+			goto cleanup_error;
+		}
+		count++;
 	}
 
 	TIFFClose(tif);
-	*frame_count = num_frames;
+
+	if (count == 0) {
+		fprintf(stderr, "Error: TIFF has no pages\n");
+		free(frames);
+		return NULL;
+	}
+
+	*frame_count = count;
 	return frames;
 
 cleanup_error:
-	for (int i = 0; i < num_frames; i++) {
-		if (frames[i] != NULL) {
-			image_destroy(frames[i]);
-		}
+	for (int i = 0; i < count; i++) {
+		image_destroy(frames[i]);
 	}
 	free(frames);
 	TIFFClose(tif);
@@ -370,8 +796,10 @@ cleanup_error:
 /**
  * @brief Decode TIFF image (static or multi-page)
  *
- * Main entry point for TIFF decoding. Automatically detects if the image
- * is multi-page and routes to the appropriate decoder function.
+ * Full resolution entry point (--info, --view, stretching with -w and
+ * -H). Every page is decoded at full resolution (or the largest pyramid
+ * level within the image limits); terminal output goes through
+ * decode_tiff_hinted() instead.
  *
  * @param data Raw TIFF file data
  * @param len Length of data in bytes
@@ -390,11 +818,31 @@ image_t **decode_tiff(const uint8_t *data, size_t len, int *frame_count)
 		return NULL;
 	}
 
-	*frame_count = 0;
+	return decode_tiff_pages(data, len, frame_count, 0, 0);
+}
 
-	if (tiff_is_multipage(data, len)) {
-		return decode_tiff_multipage(data, len, frame_count);
-	} else {
-		return decode_tiff_static(data, len, frame_count);
+/**
+ * @brief Decode TIFF image from the smallest level covering a box
+ *
+ * Like decode_tiff(), but every page is read from the smallest pyramid
+ * level that covers its fit into box_width x box_height and box-filtered
+ * down by up to TIFF_MAX_REDUCTION while its tiles are decoded. Used for
+ * every render to the terminal, with the box from
+ * pipeline_set_decode_box().
+ *
+ * @param data Raw TIFF file data
+ * @param len Length of data in bytes
+ * @param frame_count Output: number of frames decoded
+ * @param box_width Width of the box the image will be fitted into
+ * @param box_height Height of the box the image will be fitted into
+ * @return Array of image_t* frames, or NULL on error
+ */
+image_t **decode_tiff_hinted(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height)
+{
+	if (data == NULL || len == 0 || frame_count == NULL) {
+		fprintf(stderr, "Error: Invalid parameters to decode_tiff\n");
+		return NULL;
 	}
+
+	return decode_tiff_pages(data, len, frame_count, box_width, box_height);
 }
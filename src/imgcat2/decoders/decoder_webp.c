@@ -7,6 +7,7 @@
  */
 
 /* clang-format off */
+#include <math.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
@@ -24,17 +25,23 @@
 /**
  * @brief Decode static WebP image (single frame)
  *
- * Decodes a static WebP image to RGBA8888 format.
+ * Uses libwebp's advanced API: decodes straight into the image_t
+ * buffer (no copy), filters with libwebp's worker thread, and when a
+ * box is given lets libwebp's rescaler produce the image at its fit
+ * into the box instead of full size. Images without alpha are decoded
+ * as IMAGE_FORMAT_RGB8.
  * For animated WebP images, use decode_webp_animated().
  *
  * @param data Raw WebP file data
  * @param len Length of data in bytes
  * @param frame_count Output: always 1 (single frame)
+ * @param box_width Box width to fit into (0 = full resolution)
+ * @param box_height Box height to fit into (0 = full resolution)
  * @return Array with single image_t*, or NULL on error
  *
- * @note Output format is RGBA8888
+ * @note Output format is RGBA8888, or RGB888 for opaque images
  */
-static image_t **decode_webp_static(const uint8_t *data, size_t len, int *frame_count)
+static image_t **decode_webp_static(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height)
 {
 	if (data == NULL || len == 0 || frame_count == NULL) {
 		fprintf(stderr, "Error: Invalid parameters to decode_webp_static\n");
@@ -44,29 +51,59 @@ static image_t **decode_webp_static(const uint8_t *data, size_t len, int *frame_
 	// Initialize output
 	*frame_count = 0;
 
-	// Decode WebP to RGBA
-	int width = 0;
-	int height = 0;
-	uint8_t *pixels = WebPDecodeRGBA(data, len, &width, &height);
-	if (pixels == NULL) {
-		fprintf(stderr, "Error: Failed to decode WebP image\n");
+	WebPDecoderConfig config;
+	if (!WebPInitDecoderConfig(&config)) {
+		fprintf(stderr, "Error: libwebp version mismatch\n");
 		return NULL;
 	}
 
-	// Create image_t structure
-	image_t *img = image_create((uint32_t)width, (uint32_t)height);
+	if (WebPGetFeatures(data, len, &config.input) != VP8_STATUS_OK) {
+		fprintf(stderr, "Error: Failed to read WebP header\n");
+		return NULL;
+	}
+
+	uint32_t width = (uint32_t)config.input.width;
+	uint32_t height = (uint32_t)config.input.height;
+
+	// Let libwebp scale down to the fit into the box (rounded up, so the caller never enlarges)
+	if (box_width > 0 && box_height > 0 && (width > box_width || height > box_height)) {
+		double fit = (double)box_width / width;
+		if ((double)box_height / height < fit) {
+			fit = (double)box_height / height;
+		}
+
+		width = (uint32_t)ceil(width * fit);
+		height = (uint32_t)ceil(height * fit);
+		width = width > 0 ? width : 1;
+		height = height > 0 ? height : 1;
+
+		config.options.use_scaling = 1;
+		config.options.scaled_width = (int)width;
+		config.options.scaled_height = (int)height;
+	}
+	config.options.use_threads = 1;
+
+	// Decode straight into the image rows
+	bool has_alpha = config.input.has_alpha != 0;
+	image_t *img = image_create_format(width, height, has_alpha ? IMAGE_FORMAT_RGBA8 : IMAGE_FORMAT_RGB8);
 	if (img == NULL) {
 		fprintf(stderr, "Error: Failed to create image_t structure\n");
-		WebPFree(pixels);
 		return NULL;
 	}
 
-	// Copy pixels to image_t (WebP returns RGBA8888, same as our format)
-	size_t pixel_size = (size_t)width * (size_t)height * 4;
-	memcpy(img->pixels, pixels, pixel_size);
+	config.output.colorspace = has_alpha ? MODE_RGBA : MODE_RGB;
+	config.output.is_external_memory = 1;
+	config.output.u.RGBA.rgba = img->pixels;
+	config.output.u.RGBA.stride = (int)img->stride;
+	config.output.u.RGBA.size = img->stride * img->height;
 
-	// Free WebP decoder buffer
-	WebPFree(pixels);
+	VP8StatusCode status = WebPDecode(data, len, &config);
+	WebPFreeDecBuffer(&config.output);
+	if (status != VP8_STATUS_OK) {
+		fprintf(stderr, "Error: Failed to decode WebP image (status %d)\n", (int)status);
+		image_destroy(img);
+		return NULL;
+	}
 
 	// Allocate frames array (single frame)
 	image_t **frames = (image_t **)malloc(sizeof(image_t *));
@@ -273,5 +310,34 @@ image_t **decode_webp(const uint8_t *data, size_t len, int *frame_count)
 		return decode_webp_animated(data, len, frame_count);
 	}
 
-	return decode_webp_static(data, len, frame_count);
+	return decode_webp_static(data, len, frame_count, 0, 0);
+}
+
+/**
+ * @brief Decode WebP image, scaled by libwebp to fit a box
+ *
+ * Static images are decoded at their fit into box_width x box_height;
+ * animations are decoded as by decode_webp().
+ *
+ * @param data Raw WebP file data
+ * @param len Length of data in bytes
+ * @param frame_count Output: number of frames decoded
+ * @param box_width Width of the box the image will be fitted into
+ * @param box_height Height of the box the image will be fitted into
+ * @return Array of image_t* frames, or NULL on error
+ */
+image_t **decode_webp_hinted(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height)
+{
+	if (data == NULL || len == 0 || frame_count == NULL) {
+		fprintf(stderr, "Error: Invalid parameters to decode_webp\n");
+		return NULL;
+	}
+
+	*frame_count = 0;
+
+	if (webp_is_animated(data, len)) {
+		return decode_webp_animated(data, len, frame_count);
+	}
+
+	return decode_webp_static(data, len, frame_count, box_width, box_height);
 }
@@ -10,164 +10,299 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "core/base64.h"
+#include "core/cache.h"
+#include "core/cancel.h"
 #include "core/cli.h"
+#include "core/executor.h"
+#include "core/grid.h"
+#ifndef _WIN32
+#include "core/daemon.h"
+#include "core/preview.h"
+#include "core/viewer.h"
+#endif
 #include "core/image.h"
 #include "core/metadata.h"
 #include "core/pipeline.h"
+#include "core/pixel_ops.h"
 #include "decoders/decoder.h"
 #include "decoders/magic.h"
 #include "terminal/terminal.h"
 
 /**
- * @brief Main program entry point
+ * @brief Detect terminal geometry and capabilities
+ *
+ * @param terminal Output terminal description
  */
-int main(int argc, char **argv)
+static void detect_terminal(cli_terminal_t *terminal)
 {
-	int exit_code = EXIT_FAILURE;
-
-	/* Initialize CLI options with defaults */
-	cli_options_t opts = {
-		.input_file = NULL,
-		.interpolation = "lanczos",
-		.fit_mode = false,
-		.silent = true,
-		.fps = 15,
-		.animate = false,
-		.target_width = -1,
-		.target_height = -1,
-		.has_custom_dimensions = false,
-		.force_ansi = false,
-		.info_mode = false,
-		.json_output = false,
-
-		.terminal = {
-			.rows = 0,
-			.cols = 0,
-			.width = 0,
-			.height = 0,
-			.is_iterm2 = terminal_is_iterm2(),
-			.is_ghostty = terminal_is_ghostty(),
-			.is_kitty = terminal_is_kitty(),
-			.is_wezterm = terminal_is_wezterm(),
-			.is_konsole = terminal_is_konsole(),
-			.is_tmux = terminal_is_tmux(),
-
-			.has_kitty = terminal_is_ghostty() || terminal_is_kitty() || terminal_is_wezterm() || terminal_is_konsole(),
-		},
+	*terminal = (cli_terminal_t) {
+		.rows = 0,
+		.cols = 0,
+		.width = 0,
+		.height = 0,
+		.is_iterm2 = terminal_is_iterm2(),
+		.is_ghostty = terminal_is_ghostty(),
+		.is_kitty = terminal_is_kitty(),
+		.is_wezterm = terminal_is_wezterm(),
+		.is_konsole = terminal_is_konsole(),
+		.is_tmux = terminal_is_tmux(),
+		.is_remote = terminal_is_remote(),
+
+		.has_kitty = terminal_is_ghostty() || terminal_is_kitty() || terminal_is_wezterm() || terminal_is_konsole(),
 	};
 
-	terminal_get_pixels(&opts.terminal.width, &opts.terminal.height);
-	if (terminal_get_size(&opts.terminal.rows, &opts.terminal.cols) < 0) {
+	terminal_get_pixels(&terminal->width, &terminal->height);
+	if (terminal_get_size(&terminal->rows, &terminal->cols) < 0) {
 		fprintf(stderr, "Warning: Failed to get terminal size, using defaults\n");
-		opts.terminal.rows = DEFAULT_TERM_ROWS;
-		opts.terminal.cols = DEFAULT_TERM_COLS;
+		terminal->rows = DEFAULT_TERM_ROWS;
+		terminal->cols = DEFAULT_TERM_COLS;
 	}
+}
 
-	/* Parse command-line arguments */
-	if (parse_arguments(argc, argv, &opts) != 0) {
-		return EXIT_FAILURE;
+/**
+ * @struct render_job_t
+ * @brief One input file moving through the pipeline
+ */
+typedef struct {
+	cli_options_t opts; /**< Per-file options (protocol fallbacks modify them) */
+	uint8_t *buffer; /**< Input file data */
+	size_t buffer_size; /**< Input size in bytes */
+	bool buffer_mapped; /**< true if buffer is a file mapping */
+	cache_entry_t *cache_entry; /**< Render cache slot, or NULL if not cached */
+	bool decoded; /**< true once decoding and scaling were attempted */
+	image_t **frames; /**< Decoded frames (kept for --info only) */
+	image_t **scaled_frames; /**< Frames scaled for the terminal */
+	int frame_count; /**< Number of frames */
+	int exit_code; /**< Result of the job */
+} render_job_t;
 
-		/* Validate options */
-	} else if (validate_options(&opts) < 0) {
-		return EXIT_FAILURE;
-	}
+/**
+ * @brief Decode and scale a job's input (STEP 2 and 3)
+ *
+ * Runs once per job, on a worker thread ahead of time or lazily when
+ * a protocol passthrough falls back to decoding.
+ *
+ * @param job Job with input data
+ *
+ * @return 0 on success, -1 on error
+ */
+static int job_decode(render_job_t *job)
+{
+	cli_options_t *opts = &job->opts;
 
-	if (!opts.silent) {
-		const char *terminal_type = opts.terminal.is_iterm2 ? "iTerm2" :
-			opts.terminal.is_ghostty ? "Ghostty" :
-			opts.terminal.is_kitty ? "Kitty" :
-			opts.terminal.is_wezterm ? "WezTerm" :
-			opts.terminal.is_konsole ? "Konsole" :
-			"ANSI";
+	if (job->decoded) {
+		return job->scaled_frames != NULL || (opts->info_mode && job->frames != NULL) ? 0 : -1;
+	}
+	job->decoded = true;
 
-		fprintf(stderr, "Terminal size: %dx%d (%dx%d) pixels, is %s\n", opts.terminal.width, opts.terminal.height, opts.terminal.cols, opts.terminal.rows, terminal_type);
+	/* STEP 2: Decode image with MIME detection (--info reports the full size) */
+	if (!opts->info_mode) {
+		pipeline_set_decode_box(opts);
 	}
 
-	if (opts.terminal.width == 0 || opts.terminal.height == 0) {
-		opts.force_ansi = true;
-		if (!opts.silent) {
-			fprintf(stderr, "Warning: Terminal pixel size unknown, forcing ANSI rendering\n");
+	if (pipeline_decode(opts, job->buffer, job->buffer_size, &job->frames, &job->frame_count) < 0) {
+		if (!cancel_requested()) {
+			fprintf(stderr, "Error: Failed to decode image\n");
 		}
+		return -1;
+	}
+
+	if (!opts->silent) {
+		fprintf(stderr, "Decoded %d frame(s)\n", job->frame_count);
+	}
+
+	/* --info only needs the decoded frames */
+	if (opts->info_mode) {
+		return 0;
+	}
+
+	/* STEP 3: Scale images to terminal dimensions */
+	if (cancel_requested()) {
+		return -1;
+
+	} else if (pipeline_scale(job->frames, job->frame_count, opts, &job->scaled_frames) < 0) {
+		fprintf(stderr, "Error: Failed to scale images\n");
+		return -1;
+	}
+
+	if (!opts->silent) {
+		fprintf(stderr, "Scaled to %ux%u pixels\n", job->scaled_frames[0]->width, job->scaled_frames[0]->height);
 	}
 
-	/* Initialize decoder registry */
-	decoder_registry_init(&opts);
+	/* Only the scaled frames are rendered; drop the full-size ones early */
+	for (int i = 0; i < job->frame_count; i++) {
+		image_destroy(job->frames[i]);
+	}
+	free(job->frames);
+	job->frames = NULL;
+
+	return 0;
+}
 
-	/* Pipeline variables */
-	uint8_t *buffer = NULL;
-	size_t buffer_size = 0;
-	image_t **frames = NULL;
-	int frame_count = 0;
-	image_t **scaled_frames = NULL;
+/**
+ * @brief Read the input and do the CPU-heavy work (worker threads)
+ *
+ * Reads the file (STEP 1), checks the render cache, settles the Kitty
+ * fallback and decodes and scales unless the file will be passed
+ * through to the terminal as is. Writes nothing to stdout.
+ *
+ * @param job Job to prepare
+ */
+static void job_prepare(render_job_t *job)
+{
+	cli_options_t *opts = &job->opts;
+	job->exit_code = EXIT_FAILURE;
 
 	/* STEP 1: Read input (file or stdin) */
-	if (pipeline_read(&opts, &buffer, &buffer_size) < 0) {
+	if (pipeline_read_mapped(opts, &job->buffer, &job->buffer_size, &job->buffer_mapped) < 0) {
 		fprintf(stderr, "Error: Failed to read input\n");
-		goto cleanup;
+		return;
 	}
 
-	if (!opts.silent) {
-		fprintf(stderr, "Read %zu bytes from %s\n", buffer_size, opts.input_file ? opts.input_file : "stdin");
+	if (!opts->silent) {
+		fprintf(stderr, "Read %zu bytes from %s\n", job->buffer_size, opts->input_file ? opts->input_file : "stdin");
+	}
+
+	/* A stored render makes all further work unnecessary (the key is taken before any fallback changes opts) */
+	if (opts->cache) {
+		job->cache_entry = malloc(sizeof(cache_entry_t));
+		if (job->cache_entry != NULL && cache_open(opts, job->buffer, job->buffer_size, job->cache_entry) < 0) {
+			free(job->cache_entry);
+			job->cache_entry = NULL;
+		}
+
+		if (job->cache_entry != NULL && cache_exists(job->cache_entry)) {
+			return;
+		}
+	}
+
+	if (!opts->force_ansi && opts->terminal.is_iterm2) {
+		/* iTerm2 receives the file itself (or re-encodes it when rendering) */
+		return;
+
+	} else if (!opts->force_ansi && opts->terminal.has_kitty) {
+		/* Check if format is supported by Kitty graphics protocol */
+		if (!kitty_is_format_supported(job->buffer, job->buffer_size, opts)) {
+			opts->terminal.has_kitty = false;
+			opts->force_ansi = true;
+
+			if (!opts->silent) {
+				fprintf(stderr, "Format not supported by Kitty graphics protocol, using ANSI rendering\n");
+			}
+
+		} else if (!opts->info_mode && detect_mime_type(job->buffer, job->buffer_size) == MIME_PNG) {
+			/* PNG passthrough: the terminal decodes and scales */
+			return;
+		}
+	}
+
+	job_decode(job);
+}
+
+/**
+ * @brief Write a prepared job to the terminal (calling thread, in order)
+ *
+ * @param job Prepared job
+ *
+ * @return Exit code of the job
+ */
+static int job_emit(render_job_t *job)
+{
+	cli_options_t *opts = &job->opts;
+	uint8_t *buffer = job->buffer;
+	size_t buffer_size = job->buffer_size;
+	int exit_code = EXIT_FAILURE;
+	cache_entry_t *cache_entry = job->cache_entry;
+	bool cache_capturing = false;
+
+	if (buffer == NULL) {
+		return EXIT_FAILURE;
+	}
+
+	/* Render cache: replay a stored render, or record this one (entry opened by job_prepare) */
+	if (cache_entry != NULL) {
+		if (cache_replay(cache_entry) == 0) {
+			if (!opts->silent) {
+				fprintf(stderr, "Replayed cached render %s\n", cache_entry->path);
+			}
+
+			return EXIT_SUCCESS;
+		}
+
+		cache_capturing = cache_capture_begin(cache_entry) == 0;
+	}
+
+	/* A newer preview request makes this one stale */
+	if (cancel_requested()) {
+		goto cleanup;
 	}
 
 	/* DECISION POINT: iTerm2 / Ghostty / ANSI rendering */
 
-	if (!opts.force_ansi && opts.terminal.is_iterm2) {
-		/* Check if format is supported by iTerm2 protocol */
-		if (iterm2_is_format_supported(buffer, buffer_size)) {
-			if (!opts.silent) {
+	if (!opts->force_ansi && opts->terminal.is_iterm2) {
+		/* Check if format is supported by iTerm2 protocol (large mapped inputs are converted) */
+		if (iterm2_is_format_supported(buffer, buffer_size) && buffer_size <= IMAGE_MAX_FILE_SIZE) {
+			if (!opts->silent) {
 				fprintf(stderr, "Using iTerm2 inline images protocol\n");
 			}
 
-			if (pipeline_render_iterm2(buffer, buffer_size, &opts) == 0) {
+			if (pipeline_render_iterm2(buffer, buffer_size, opts) == 0) {
 				/* Success - skip ANSI pipeline */
 				exit_code = EXIT_SUCCESS;
 				goto cleanup;
 			}
+
+		} else if (!opts->info_mode) {
+			/* Decode here and send a PNG instead */
+			if (!opts->silent) {
+				fprintf(stderr, "Using iTerm2 inline images protocol (converted to PNG)\n");
+			}
+
+			if (pipeline_render_iterm2_converted(buffer, buffer_size, opts) == 0) {
+				exit_code = EXIT_SUCCESS;
+				goto cleanup;
+			}
 		}
 
-		opts.terminal.is_iterm2 = false;
-		opts.force_ansi = true;
-		if (!opts.silent) {
+		opts->terminal.is_iterm2 = false;
+		opts->force_ansi = true;
+		if (!opts->silent) {
 			fprintf(stderr, "Format not supported by iTerm2 or rendering failed, using ANSI rendering\n");
 		}
 
-	} else if (!opts.force_ansi && opts.terminal.has_kitty) {
-		/* Check if format is supported by Kitty graphics protocol */
-		if (kitty_is_format_supported(buffer, buffer_size, &opts)) {
-			if (!opts.silent) {
-				fprintf(stderr, "Using Kitty graphics protocol\n");
-			}
+	} else if (!opts->force_ansi && opts->terminal.has_kitty) {
+		if (!opts->silent) {
+			fprintf(stderr, "Using Kitty graphics protocol\n");
+		}
 
-		} else {
-			opts.terminal.has_kitty = false;
-			opts.force_ansi = true;
+		/* PNG passthrough: the terminal decodes and scales (f=100) */
+		if (!job->decoded && !opts->info_mode && detect_mime_type(buffer, buffer_size) == MIME_PNG) {
+			if (pipeline_render_kitty_png(buffer, buffer_size, opts) == 0) {
+				exit_code = EXIT_SUCCESS;
+				goto cleanup;
+			}
 
-			if (!opts.silent) {
-				fprintf(stderr, "Format not supported by Kitty graphics protocol, using ANSI rendering\n");
+			if (!opts->silent) {
+				fprintf(stderr, "PNG passthrough failed, decoding instead\n");
 			}
 		}
 	}
 
-	/* STEP 2: Decode image with MIME detection */
-	if (pipeline_decode(&opts, buffer, buffer_size, &frames, &frame_count) < 0) {
-		fprintf(stderr, "Error: Failed to decode image\n");
+	/* STEP 2 and 3: Decode and scale (normally done ahead by a worker) */
+	if (job_decode(job) < 0) {
 		goto cleanup;
 	}
 
-	if (!opts.silent) {
-		fprintf(stderr, "Decoded %d frame(s)\n", frame_count);
-	}
-
 	/* STEP 2.5: Output metadata and exit if --info specified */
-	if (opts.info_mode) {
+	if (opts->info_mode) {
 		/* Re-detect MIME type for output */
 		mime_type_t mime = detect_mime_type(buffer, buffer_size);
 
-		if (opts.json_output) {
-			output_metadata_json(mime, frames[0]->width, frames[0]->height, frame_count);
+		if (opts->json_output) {
+			output_metadata_json(mime, job->frames[0]->width, job->frames[0]->height, job->frame_count);
 		} else {
-			output_metadata_text(mime, frames[0]->width, frames[0]->height, frame_count);
+			output_metadata_text(mime, job->frames[0]->width, job->frames[0]->height, job->frame_count);
 		}
 
 		/* Success - skip scaling and rendering */
@@ -175,27 +310,22 @@ int main(int argc, char **argv)
 		goto cleanup;
 	}
 
-	/* STEP 3: Scale images to terminal dimensions */
-	if (pipeline_scale(frames, frame_count, &opts, &scaled_frames) < 0) {
-		fprintf(stderr, "Error: Failed to scale images\n");
-		goto cleanup;
-	}
-
-	if (!opts.silent) {
-		fprintf(stderr, "Scaled to %ux%u pixels\n", scaled_frames[0]->width, scaled_frames[0]->height);
-	}
-
 	/* STEP 4.1: Render using Kitty graphics protocol */
-	if (opts.terminal.has_kitty && !opts.force_ansi) {
-		if (kitty_render(scaled_frames, frame_count, &opts) == 0) {
+	if (opts->terminal.has_kitty && !opts->force_ansi) {
+		if (kitty_render(job->scaled_frames, job->frame_count, opts) == 0) {
 			exit_code = EXIT_SUCCESS;
 			goto cleanup;
 		}
 	}
 
 	/* STEP 4.2: Render to terminal */
-	if (pipeline_render(scaled_frames, frame_count, &opts) < 0) {
-		fprintf(stderr, "Error: Failed to render output\n");
+	if (cancel_requested()) {
+		goto cleanup;
+
+	} else if (pipeline_render(job->scaled_frames, job->frame_count, opts) < 0) {
+		if (!cancel_requested()) {
+			fprintf(stderr, "Error: Failed to render output\n");
+		}
 		goto cleanup;
 	}
 
@@ -203,26 +333,192 @@ int main(int argc, char **argv)
 	exit_code = EXIT_SUCCESS;
 
 cleanup:
-	/* Free buffer */
-	if (buffer != NULL) {
-		free(buffer);
+	/* Store the captured render and show it */
+	if (cache_capturing) {
+		cache_capture_end(cache_entry, exit_code == EXIT_SUCCESS);
 	}
 
+	/* Keep stdio output ordered with raw writes of the next job */
+	fflush(stdout);
+
+	return exit_code;
+}
+
+/**
+ * @brief Free everything a job holds
+ *
+ * @param job Job to release
+ */
+static void job_release(render_job_t *job)
+{
+	/* Free buffer */
+	pipeline_release(job->buffer, job->buffer_size, job->buffer_mapped);
+	job->buffer = NULL;
+
+	free(job->cache_entry);
+	job->cache_entry = NULL;
+
 	/* Free decoded frames */
-	if (frames != NULL) {
-		for (int i = 0; i < frame_count; i++) {
-			image_destroy(frames[i]);
+	if (job->frames != NULL) {
+		for (int i = 0; i < job->frame_count; i++) {
+			image_destroy(job->frames[i]);
 		}
-		free(frames);
+		free(job->frames);
+		job->frames = NULL;
 	}
 
 	/* Free scaled frames */
-	if (scaled_frames != NULL) {
-		for (int i = 0; i < frame_count; i++) {
-			image_destroy(scaled_frames[i]);
+	if (job->scaled_frames != NULL) {
+		for (int i = 0; i < job->frame_count; i++) {
+			image_destroy(job->scaled_frames[i]);
+		}
+		free(job->scaled_frames);
+		job->scaled_frames = NULL;
+	}
+}
+
+/**
+ * @brief Executor prepare step
+ */
+static void run_prepare(size_t index, void *ctx)
+{
+	job_prepare(&((render_job_t *)ctx)[index]);
+}
+
+/**
+ * @brief Executor emit step
+ */
+static void run_emit(size_t index, void *ctx)
+{
+	render_job_t *job = &((render_job_t *)ctx)[index];
+
+	job->exit_code = job_emit(job);
+	job_release(job);
+}
+
+/**
+ * @brief Read, decode, scale and render every input file
+ *
+ * Runs in the main process, or in a --daemon worker with the client's
+ * standard streams and terminal description. With several files, reads,
+ * decodes and scales of upcoming files run on worker threads while the
+ * current one is written; output stays in argument order.
+ *
+ * @param opts Parsed and validated options
+ *
+ * @return Process exit code (failure if any file failed)
+ */
+static int run(cli_options_t *opts)
+{
+	int exit_code = EXIT_SUCCESS;
+
+	if (!opts->silent) {
+		const char *terminal_type = opts->terminal.is_iterm2 ? "iTerm2" :
+			opts->terminal.is_ghostty ? "Ghostty" :
+			opts->terminal.is_kitty ? "Kitty" :
+			opts->terminal.is_wezterm ? "WezTerm" :
+			opts->terminal.is_konsole ? "Konsole" :
+			"ANSI";
+
+		fprintf(stderr, "Terminal size: %dx%d (%dx%d) pixels, is %s\n", opts->terminal.width, opts->terminal.height, opts->terminal.cols, opts->terminal.rows, terminal_type);
+	}
+
+	if (opts->terminal.width == 0 || opts->terminal.height == 0) {
+		opts->force_ansi = true;
+		if (!opts->silent) {
+			fprintf(stderr, "Warning: Terminal pixel size unknown, forcing ANSI rendering\n");
+		}
+	}
+
+#ifndef _WIN32
+	/* Interactive pan/zoom viewer */
+	if (opts->view) {
+		return viewer_run(opts);
+	}
+#endif
+
+	/* Contact sheet: all files in one render */
+	if (opts->grid) {
+		return grid_render(opts);
+	}
+
+	/* Initialize decoder registry (before any worker starts) */
+	decoder_registry_init(opts);
+
+	size_t count = opts->input_count > 1 ? (size_t)opts->input_count : 1;
+	render_job_t *jobs = calloc(count, sizeof(render_job_t));
+	if (jobs == NULL) {
+		fprintf(stderr, "Error: Failed to allocate render jobs\n");
+		return EXIT_FAILURE;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		jobs[i].opts = *opts;
+		if (opts->input_count > 1) {
+			jobs[i].opts.input_file = strcmp(opts->input_files[i], "-") == 0 ? NULL : opts->input_files[i];
+		}
+	}
+
+	/* Up to two files in flight per worker bounds memory */
+	int threads = opts->threads > 0 ? opts->threads : executor_default_threads();
+	executor_run(count, threads, (size_t)threads * 2, run_prepare, run_emit, jobs);
+
+	for (size_t i = 0; i < count; i++) {
+		if (jobs[i].exit_code != EXIT_SUCCESS) {
+			exit_code = EXIT_FAILURE;
 		}
-		free(scaled_frames);
 	}
 
+	free(jobs);
+
 	return exit_code;
 }
+
+/**
+ * @brief Main program entry point
+ */
+int main(int argc, char **argv)
+{
+	cli_options_t opts;
+	cli_options_init(&opts);
+	detect_terminal(&opts.terminal);
+
+	/* Pick SIMD pixel and base64 kernels before any worker thread starts */
+	pixel_ops_init();
+	base64_init();
+
+	/* Parse command-line arguments */
+	if (parse_arguments(argc, argv, &opts) != 0) {
+		return EXIT_FAILURE;
+
+		/* Validate options */
+	} else if (validate_options(&opts) < 0) {
+		return EXIT_FAILURE;
+	}
+
+#ifndef _WIN32
+	/* Render server: serve requests until terminated */
+	if (opts.daemon) {
+		return daemon_serve(run, &opts);
+	}
+
+	/* Previewer coprocess: serve requests from stdin */
+	if (opts.preview_server) {
+		return preview_serve(run, &opts);
+	}
+
+	/* Thin client: hand the request to a running server if there is one */
+	if (opts.client) {
+		int exit_code;
+		if (daemon_client(argc, argv, &opts, &exit_code) == 0) {
+			return exit_code;
+		}
+
+		if (!opts.silent) {
+			fprintf(stderr, "No render daemon reachable, rendering locally\n");
+		}
+	}
+#endif
+
+	return run(&opts);
+}
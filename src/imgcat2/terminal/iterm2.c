@@ -6,6 +6,7 @@
  * high-quality image rendering in iTerm2 terminal emulator.
  */
 
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -15,6 +16,135 @@
 #include "../core/cli.h"
 #include "iterm2.h"
 
+/**
+ * @brief Input bytes encoded per output write when streaming image data
+ *
+ * Multiple of 3 so that every slice encodes without carry; the encoded
+ * buffer (64 KiB) stays on the stack instead of a full-size allocation.
+ * Also the payload size of one FilePart sequence in multipart mode.
+ */
+#define ITERM2_STREAM_CHUNK (48 * 1024)
+
+/**
+ * @brief Payload size above which the multipart protocol is used
+ */
+#define ITERM2_MULTIPART_THRESHOLD (1024 * 1024)
+
+/**
+ * @brief Check if the terminal understands MultipartFile (iTerm2 3.5+)
+ *
+ * iTerm2 exports its version in TERM_PROGRAM_VERSION, and in
+ * LC_TERMINAL_VERSION which also survives SSH. Unknown versions are
+ * treated as unsupported and get the single-sequence protocol.
+ */
+static bool iterm2_supports_multipart(void)
+{
+	const char *version = NULL;
+
+	const char *term_program = getenv("TERM_PROGRAM");
+	if (term_program != NULL && strcmp(term_program, "iTerm.app") == 0) {
+		version = getenv("TERM_PROGRAM_VERSION");
+	}
+	if (version == NULL) {
+		version = getenv("LC_TERMINAL_VERSION");
+	}
+
+	int major = 0;
+	int minor = 0;
+	if (version == NULL || sscanf(version, "%d.%d", &major, &minor) < 1) {
+		return false;
+	}
+
+	return major > 3 || (major == 3 && minor >= 5);
+}
+
+/**
+ * @brief Start an OSC 1337 sequence (DCS-wrapped under tmux)
+ */
+static void iterm2_begin(const cli_options_t *opts)
+{
+	if (opts->terminal.is_tmux) {
+		/* Wrap with tmux DCS sequence: \033Ptmux;\033 ... \033\\ */
+		fputs("\033Ptmux;\033\033]1337;", stdout);
+
+	} else {
+		/* Standard OSC sequence */
+		fputs("\033]1337;", stdout);
+	}
+}
+
+/**
+ * @brief Terminate an OSC 1337 sequence
+ */
+static void iterm2_end(const cli_options_t *opts)
+{
+	if (opts->terminal.is_tmux) {
+		fputs("\a\033\\", stdout); /* BEL + tmux end DCS */
+
+	} else {
+		fputs("\a", stdout); /* BEL */
+	}
+}
+
+/**
+ * @brief Stream base64-encoded data to stdout in bounded chunks
+ *
+ * @param data Data to encode
+ * @param size Size of data in bytes
+ *
+ * @return 0 on success, -1 on write error
+ */
+static int iterm2_write_base64(const uint8_t *data, size_t size)
+{
+	char encoded[BASE64_ENCODED_SIZE(ITERM2_STREAM_CHUNK)];
+	base64_state_t state;
+
+	base64_encode_init(&state);
+
+	for (size_t offset = 0; offset < size; offset += ITERM2_STREAM_CHUNK) {
+		size_t chunk = size - offset < ITERM2_STREAM_CHUNK ? size - offset : ITERM2_STREAM_CHUNK;
+		size_t len = base64_encode_update(&state, data + offset, chunk, encoded);
+		if (fwrite(encoded, 1, len, stdout) != len) {
+			return -1;
+		}
+	}
+
+	size_t len = base64_encode_final(&state, encoded);
+	if (fwrite(encoded, 1, len, stdout) != len) {
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Send data as a sequence of FilePart sequences
+ *
+ * Each part carries ITERM2_STREAM_CHUNK input bytes, so only the last
+ * part can contain base64 padding and the terminal can concatenate the
+ * parts as they arrive.
+ *
+ * @return 0 on success, -1 on write error
+ */
+static int iterm2_write_parts(const uint8_t *data, size_t size, const cli_options_t *opts)
+{
+	char encoded[BASE64_ENCODED_SIZE(ITERM2_STREAM_CHUNK)];
+
+	for (size_t offset = 0; offset < size; offset += ITERM2_STREAM_CHUNK) {
+		size_t chunk = size - offset < ITERM2_STREAM_CHUNK ? size - offset : ITERM2_STREAM_CHUNK;
+		size_t len = base64_encode_to(data + offset, chunk, encoded);
+
+		iterm2_begin(opts);
+		fputs("FilePart=", stdout);
+		if (fwrite(encoded, 1, len, stdout) != len) {
+			return -1;
+		}
+		iterm2_end(opts);
+	}
+
+	return 0;
+}
+
 bool iterm2_is_format_supported(const uint8_t *data, size_t size)
 {
 	/* Validate inputs */
@@ -45,14 +175,6 @@ int iterm2_render(const uint8_t *data, size_t size, const cli_options_t *opts, i
 		return -1;
 	}
 
-	/* Base64 encode the image data */
-	size_t encoded_size = 0;
-	char *encoded = base64_encode(data, size, &encoded_size);
-	if (encoded == NULL) {
-		fprintf(stderr, "Error: Failed to base64 encode image data\n");
-		return -1;
-	}
-
 	/* Base64 encode filename if provided */
 	char *encoded_filename = NULL;
 	if (opts->input_file != NULL) {
@@ -60,15 +182,12 @@ int iterm2_render(const uint8_t *data, size_t size, const cli_options_t *opts, i
 		encoded_filename = base64_encode((const uint8_t *)opts->input_file, strlen(opts->input_file), &filename_encoded_size);
 	}
 
-	/* Construct iTerm2 inline images escape sequence (OSC 1337) */
-	if (opts->terminal.is_tmux) {
-		/* Wrap with tmux DCS sequence: \033Ptmux;\033 ... \033\\ */
-		printf("\033Ptmux;\033\033]1337;File=inline=1;size=%zu", size);
+	/* Large payloads go out as MultipartFile + FilePart... + FileEnd */
+	bool multipart = size > ITERM2_MULTIPART_THRESHOLD && iterm2_supports_multipart();
 
-	} else {
-		/* Standard OSC sequence */
-		printf("\033]1337;File=inline=1;size=%zu", size);
-	}
+	/* Construct iTerm2 inline images escape sequence (OSC 1337) */
+	iterm2_begin(opts);
+	printf("%s=inline=1;size=%zu", multipart ? "MultipartFile" : "File", size);
 
 	/* Add filename parameter if available */
 	if (encoded_filename != NULL) {
@@ -108,22 +227,37 @@ int iterm2_render(const uint8_t *data, size_t size, const cli_options_t *opts, i
 	/* Default: no dimensions specified, use original image size */
 	/* Note: fit_mode is intentionally ignored in iTerm2 to preserve native quality */
 
-	/* Add base64 image data */
-	printf(":%s", encoded);
+	int result = 0;
+	if (multipart) {
+		/* Header, then the payload in separate sequences */
+		iterm2_end(opts);
 
-	/* Terminate escape sequence */
-	if (opts->terminal.is_tmux) {
-		printf("\a\033\\"); /* BEL + tmux end DCS */
+		result = iterm2_write_parts(data, size, opts);
+		if (result == 0) {
+			iterm2_begin(opts);
+			fputs("FileEnd", stdout);
+			iterm2_end(opts);
+		}
 
 	} else {
-		printf("\a"); /* BEL */
+		/* Add base64 image data, encoded in bounded chunks */
+		putchar(':');
+		result = iterm2_write_base64(data, size);
+		if (result == 0) {
+			iterm2_end(opts);
+		}
+	}
+
+	if (result != 0) {
+		fprintf(stderr, "Error: Failed to write image data\n");
+		free(encoded_filename);
+		return -1;
 	}
 
 	printf("\n");
 	fflush(stdout);
 
 	/* Cleanup */
-	free(encoded);
 	if (encoded_filename != NULL) {
 		free(encoded_filename);
 	}
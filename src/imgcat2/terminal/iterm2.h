@@ -42,7 +42,8 @@ bool iterm2_is_format_supported(const uint8_t *data, size_t size);
  *
  * Sends image to terminal using the iTerm2 inline images protocol
  * (OSC 1337 escape sequence). The image is base64-encoded and sent
- * as a single escape sequence.
+ * as a single escape sequence, base64-encoded in bounded chunks
+ * without materializing the whole encoded payload.
  *
  * Protocol format:
  * \033]1337;File=inline=1;size=<bytes>;name=<base64_name>;width=<w>;height=<h>:<base64_data>\a
@@ -6,12 +6,23 @@
  * rendering in Ghostty and other Kitty-compatible terminals.
  */
 
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "../core/base64.h"
+#include "../core/pixel_ops.h"
+#include "../core/zcompat.h"
 #include "../decoders/decoder.h"
 #include "../decoders/magic.h"
 #include "../terminal/terminal.h"
@@ -85,49 +96,857 @@ force_ansi:
 	return false;
 }
 
-int kitty_render(image_t **frames, int frame_count, const cli_options_t *opts)
+/**
+ * @brief Maximum base64 payload carried by a single graphics escape
+ *
+ * The protocol requires payloads larger than this to be split into
+ * chunks with m=1 on every chunk except the last one.
+ */
+#define KITTY_CHUNK_SIZE 4096
+
+/**
+ * @brief Raw bytes that encode to exactly one full base64 chunk
+ */
+#define KITTY_CHUNK_RAW_SIZE (KITTY_CHUNK_SIZE / 4 * 3)
+
+/**
+ * @brief Size of the sample compressed to estimate compressibility
+ */
+#define KITTY_PROBE_SIZE (64 * 1024)
+
+/**
+ * @brief Deflate output buffer size used while streaming compression
+ */
+#define KITTY_DEFLATE_BUFFER_SIZE (64 * 1024)
+
+/**
+ * @brief Shared memory names tried before falling back to a temp file
+ */
+#define KITTY_SHM_ATTEMPTS 4
+
+/**
+ * @brief Serial number of the next shared memory object of this process
+ */
+static atomic_uint kitty_shm_serial;
+
+/**
+ * @brief Start a graphics escape, wrapped in DCS passthrough under tmux
+ *
+ * @param opts Command-line options (tmux detection)
+ */
+static void kitty_escape_begin(const cli_options_t *opts)
 {
-	/* Get first frame */
-	image_t *img = frames[0];
+	if (opts->terminal.is_tmux) {
+		fputs("\033Ptmux;\033\033_G", stdout);
+	} else {
+		fputs("\033_G", stdout);
+	}
+}
+
+/**
+ * @brief Terminate a graphics escape started by kitty_escape_begin()
+ *
+ * @param opts Command-line options (tmux detection)
+ */
+static void kitty_escape_end(const cli_options_t *opts)
+{
+	if (opts->terminal.is_tmux) {
+		fputs("\033\\\033\\", stdout);
+	} else {
+		fputs("\033\\", stdout);
+	}
+}
+
+/**
+ * @brief Chunked transmission state
+ *
+ * Raw payload bytes are accumulated until a full chunk is available,
+ * then base64 encoded and written as one escape sequence. A full chunk
+ * is only flushed when more data arrives, so the final chunk (m=0)
+ * carries payload unless the transmission is aborted.
+ */
+typedef struct {
+	const cli_options_t *opts;
+	const char *control; /* Control keys of the first chunk */
+	bool first;          /* First chunk not yet written */
+	uint8_t raw[KITTY_CHUNK_RAW_SIZE];
+	size_t raw_len;
+	char encoded[KITTY_CHUNK_SIZE];
+} kitty_stream_t;
+
+/**
+ * @brief Write one graphics escape carrying the buffered chunk
+ *
+ * @param stream Stream state
+ * @param more true if further chunks follow (m=1)
+ */
+static void kitty_stream_emit(kitty_stream_t *stream, bool more)
+{
+	size_t encoded_len = base64_encode_to(stream->raw, stream->raw_len, stream->encoded);
+
+	kitty_escape_begin(stream->opts);
+
+	/* Only the first chunk carries the control keys */
+	if (stream->first) {
+		printf("%s,m=%d;", stream->control, more ? 1 : 0);
+		stream->first = false;
+	} else {
+		printf("m=%d;", more ? 1 : 0);
+	}
+
+	fwrite(stream->encoded, 1, encoded_len, stdout);
+
+	kitty_escape_end(stream->opts);
+
+	stream->raw_len = 0;
+}
+
+/**
+ * @brief Append payload bytes to a chunked transmission
+ *
+ * @param stream Stream state
+ * @param data Payload bytes
+ * @param size Number of bytes
+ */
+static void kitty_stream_write(kitty_stream_t *stream, const uint8_t *data, size_t size)
+{
+	while (size > 0) {
+		/* Buffer is full and more data follows: flush as a middle chunk */
+		if (stream->raw_len == KITTY_CHUNK_RAW_SIZE) {
+			kitty_stream_emit(stream, true);
+		}
+
+		size_t space = KITTY_CHUNK_RAW_SIZE - stream->raw_len;
+		size_t n = size < space ? size : space;
 
-	/* Calculate RGBA data size */
-	size_t raw_size = (size_t)img->width * img->height * 4;
+		memcpy(stream->raw + stream->raw_len, data, n);
+		stream->raw_len += n;
+		data += n;
+		size -= n;
+	}
+}
+
+/**
+ * @brief Close a chunked transmission that failed part-way
+ *
+ * After an m=1 chunk the terminal treats everything up to the next m=0
+ * chunk as payload. An empty final chunk ends the transmission so later
+ * output is displayed again; the terminal drops the incomplete image.
+ *
+ * @param stream Stream state
+ */
+static void kitty_stream_abort(kitty_stream_t *stream)
+{
+	/* Nothing was sent yet */
+	if (stream->first) {
+		return;
+	}
+
+	stream->raw_len = 0;
+	kitty_stream_emit(stream, false);
+}
+
+/**
+ * @brief Decide whether zlib compression is worth it for a payload
+ *
+ * Compresses a sample from the middle of the payload at the fastest
+ * level and enables o=z only if it saves at least 10%. Photographic
+ * content rarely compresses well and would only burn CPU, while
+ * screenshots and flat artwork usually shrink several-fold.
+ *
+ * @param data Payload bytes
+ * @param size Payload size in bytes
+ *
+ * @return true if the payload should be sent with o=z
+ */
+static bool kitty_should_compress(const uint8_t *data, size_t size)
+{
+	/* Not worth a deflate stream for payloads that fit in one chunk */
+	if (size <= KITTY_CHUNK_RAW_SIZE) {
+		return false;
+	}
 
-	/* Base64 encode the RGBA pixel data */
-	size_t encoded_size = 0;
-	char *encoded = base64_encode(img->pixels, raw_size, &encoded_size);
-	if (encoded == NULL) {
-		fprintf(stderr, "Error: Failed to base64 encode RGBA data\n");
-		decoder_free_frames(frames, frame_count);
+	size_t sample_size = size < KITTY_PROBE_SIZE ? size : KITTY_PROBE_SIZE;
+	const uint8_t *sample = data + (size - sample_size) / 2;
+
+	uint8_t *out = malloc(KITTY_PROBE_SIZE);
+	if (out == NULL) {
+		return false;
+	}
+
+	z_stream_t strm;
+	memset(&strm, 0, sizeof(strm));
+	if (z_deflate_init(&strm, Z_BEST_SPEED) != Z_OK) {
+		free(out);
+		return false;
+	}
+
+	strm.next_in = (void *)sample;
+	strm.avail_in = (unsigned)sample_size;
+	strm.next_out = out;
+	strm.avail_out = (unsigned)sample_size;
+
+	/* Z_STREAM_END means the whole sample fit in sample_size bytes */
+	int ret = z_deflate(&strm, Z_FINISH);
+	size_t compressed = (size_t)strm.total_out;
+	z_deflate_end(&strm);
+	free(out);
+
+	return ret == Z_STREAM_END && compressed * 10 < sample_size * 9;
+}
+
+/**
+ * @brief Stream a payload through deflate into a chunked transmission
+ *
+ * @param stream Stream state
+ * @param data Payload bytes
+ * @param size Payload size in bytes
+ *
+ * @return 0 on success, -1 on error (chunks may already have been sent)
+ */
+static int kitty_stream_deflate(kitty_stream_t *stream, const uint8_t *data, size_t size)
+{
+	uint8_t *out = malloc(KITTY_DEFLATE_BUFFER_SIZE);
+	if (out == NULL) {
 		return -1;
 	}
 
-	/* Start escape sequence */
-	if (opts->terminal.is_tmux) {
-		printf("\033Ptmux;\033\033_G");
+	z_stream_t strm;
+	memset(&strm, 0, sizeof(strm));
+	if (z_deflate_init(&strm, Z_BEST_SPEED) != Z_OK) {
+		free(out);
+		return -1;
+	}
+
+	int ret = Z_OK;
+	while (ret != Z_STREAM_END) {
+		/* Feed input in slices that fit the stream's 32-bit counters */
+		if (strm.avail_in == 0 && size > 0) {
+			size_t n = size < (1u << 30) ? size : (1u << 30);
+			strm.next_in = (void *)data;
+			strm.avail_in = (unsigned)n;
+			data += n;
+			size -= n;
+		}
+
+		strm.next_out = out;
+		strm.avail_out = KITTY_DEFLATE_BUFFER_SIZE;
+
+		ret = z_deflate(&strm, size > 0 ? Z_NO_FLUSH : Z_FINISH);
+		if (ret == Z_STREAM_ERROR) {
+			z_deflate_end(&strm);
+			free(out);
+			return -1;
+		}
+
+		kitty_stream_write(stream, out, KITTY_DEFLATE_BUFFER_SIZE - strm.avail_out);
+	}
+
+	z_deflate_end(&strm);
+	free(out);
+
+	return 0;
+}
+
+/**
+ * @brief Check if the terminal can read pixels from local files or shared memory
+ *
+ * Only Kitty and Ghostty are known to implement t=t and t=s, and both
+ * need the terminal to run on this host.
+ *
+ * @param opts Command-line options (terminal detection)
+ *
+ * @return true if local transmission media may be used
+ */
+static bool kitty_can_use_local_media(const cli_options_t *opts)
+{
+	return (opts->terminal.is_kitty || opts->terminal.is_ghostty) && !opts->terminal.is_remote;
+}
+
+/**
+ * @brief Send a transmission whose payload is a base64-encoded path or name
+ *
+ * @param opts Command-line options (tmux detection)
+ * @param control Control keys including the t= medium
+ * @param name Path of the temp file or name of the shared memory object
+ */
+static void kitty_send_named(const cli_options_t *opts, const char *control, const char *name)
+{
+	size_t name_len = strlen(name);
+	char encoded[((PATH_MAX + 2) / 3) * 4];
+	size_t encoded_len = base64_encode_to((const uint8_t *)name, name_len, encoded);
+
+	kitty_escape_begin(opts);
+	printf("%s;", control);
+	fwrite(encoded, 1, encoded_len, stdout);
+	kitty_escape_end(opts);
+}
+
+/**
+ * @brief Transmit a payload through a POSIX shared memory object (t=s)
+ *
+ * The terminal maps the object, reads it and unlinks it, so nothing is
+ * left behind on success.
+ *
+ * @param opts Command-line options
+ * @param format Format keys (f=, s=, v=)
+ * @param data Payload bytes
+ * @param size Payload size in bytes
+ *
+ * @return 0 on success, -1 if the object could not be created
+ */
+static int kitty_send_shm(const cli_options_t *opts, const char *format, const uint8_t *data, size_t size)
+{
+	/*
+	 * Unique per transmission: pid plus a per-process serial, at most
+	 * 9 + 10 + 1 + 8 = 28 characters (macOS limits names to 31). A stale
+	 * object left by an earlier process with the same pid is skipped.
+	 */
+	char name[32];
+	int fd = -1;
+	for (int attempt = 0; attempt < KITTY_SHM_ATTEMPTS && fd < 0; attempt++) {
+		snprintf(name, sizeof(name), "/imgcat2-%d-%x", (int)getpid(), atomic_fetch_add(&kitty_shm_serial, 1));
+		fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+		if (fd < 0 && errno != EEXIST) {
+			return -1;
+		}
+	}
+	if (fd < 0) {
+		return -1;
+	}
+
+	if (ftruncate(fd, (off_t)size) != 0) {
+		close(fd);
+		shm_unlink(name);
+		return -1;
+	}
+
+	void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		shm_unlink(name);
+		return -1;
+	}
+
+	memcpy(map, data, size);
+	munmap(map, size);
+
+	char control[256];
+	snprintf(control, sizeof(control), "a=T,%s,t=s,S=%zu", format, size);
+	kitty_send_named(opts, control, name);
+
+	return 0;
+}
+
+/**
+ * @brief Transmit a payload through a temporary file (t=t)
+ *
+ * The file is created in $TMPDIR (or /tmp) with "tty-graphics-protocol"
+ * in its name, which is what terminals require before they agree to
+ * read and delete it.
+ *
+ * @param opts Command-line options
+ * @param format Format keys (f=, s=, v=)
+ * @param data Payload bytes
+ * @param size Payload size in bytes
+ *
+ * @return 0 on success, -1 if the file could not be written
+ */
+static int kitty_send_temp_file(const cli_options_t *opts, const char *format, const uint8_t *data, size_t size)
+{
+	const char *tmpdir = getenv("TMPDIR");
+	if (tmpdir == NULL || tmpdir[0] == '\0') {
+		tmpdir = "/tmp";
+	}
+
+	char path[PATH_MAX];
+	int len = snprintf(path, sizeof(path), "%s/tty-graphics-protocol-imgcat2-XXXXXX", tmpdir);
+	if (len < 0 || (size_t)len >= sizeof(path)) {
+		return -1;
+	}
+
+	int fd = mkstemp(path);
+	if (fd < 0) {
+		return -1;
+	}
+
+	/* Write the whole payload, retrying on short writes */
+	size_t written = 0;
+	while (written < size) {
+		ssize_t n = write(fd, data + written, size - written);
+		if (n <= 0) {
+			close(fd);
+			unlink(path);
+			return -1;
+		}
+		written += (size_t)n;
+	}
+	close(fd);
+
+	char control[256];
+	snprintf(control, sizeof(control), "a=T,%s,t=t,S=%zu", format, size);
+	kitty_send_named(opts, control, path);
+
+	return 0;
+}
+
+/**
+ * @brief Transmit a payload inline through the pty (t=d)
+ *
+ * @param opts Command-line options
+ * @param format Format keys (f=, s=, v=)
+ * @param data Payload bytes
+ * @param size Payload size in bytes
+ * @param compressible false for payloads that are already compressed
+ *
+ * @return 0 on success, -1 on error
+ */
+static int kitty_send_direct(const cli_options_t *opts, const char *format, const uint8_t *data, size_t size, bool compressible)
+{
+	kitty_stream_t *stream = malloc(sizeof(kitty_stream_t));
+	if (stream == NULL) {
+		fprintf(stderr, "Error: Failed to allocate Kitty transmission buffer\n");
+		return -1;
+	}
+
+	bool compress = compressible && kitty_should_compress(data, size);
+
+	/* o=z: payload is a zlib (RFC 1950) stream */
+	char control[256];
+	snprintf(control, sizeof(control), "a=T,%s,t=d%s", format, compress ? ",o=z" : "");
+
+	stream->opts = opts;
+	stream->control = control;
+	stream->first = true;
+	stream->raw_len = 0;
+
+	if (compress) {
+		if (kitty_stream_deflate(stream, data, size) != 0) {
+			fprintf(stderr, "Error: Failed to compress pixel data\n");
+			kitty_stream_abort(stream);
+			free(stream);
+			return -1;
+		}
+
 	} else {
-		printf("\033_G");
+		kitty_stream_write(stream, data, size);
 	}
 
-	/* a=T: transmit and display, f=32: RGBA format, t=d: direct transmission */
-	/* s=width, v=height: pixel dimensions (required for f=32) */
-	printf("a=T,f=32,t=d,s=%u,v=%u", img->width, img->height);
+	/* Final chunk (m=0) */
+	kitty_stream_emit(stream, false);
 
-	/* Add base64 RGBA data */
-	printf(";%s", encoded);
+	free(stream);
 
-	/* Terminate escape sequence */
-	if (opts->terminal.is_tmux) {
-		printf("\033\\\033\\");
+	return 0;
+}
+
+/**
+ * @brief Transmit and display a payload using the cheapest available medium
+ *
+ * Local terminals read the payload straight from shared memory or a
+ * temp file: no base64, no pty bandwidth. Falls back to the next medium
+ * whenever one cannot be set up, ending with direct transmission.
+ *
+ * @param opts Command-line options
+ * @param format Format and placement keys (f=, s=, v=, c=, r=)
+ * @param data Payload bytes
+ * @param size Payload size in bytes
+ * @param compressible false for payloads that are already compressed
+ *
+ * @return 0 on success, -1 on error
+ */
+static int kitty_send(const cli_options_t *opts, const char *format, const uint8_t *data, size_t size, bool compressible)
+{
+	/* Cached renders are replayed later, but the terminal consumes shm objects and temp files */
+	if (kitty_can_use_local_media(opts) && !opts->cache) {
+		if (kitty_send_shm(opts, format, data, size) == 0 || kitty_send_temp_file(opts, format, data, size) == 0) {
+			return 0;
+		}
+	}
+
+	return kitty_send_direct(opts, format, data, size, compressible);
+}
+
+/**
+ * @brief Pack pixels into a tightly packed RGB or RGBA buffer
+ *
+ * Drops the alpha channel for RGB and removes row padding, so strided
+ * images and views can be sent as one contiguous payload.
+ *
+ * @param img Source image (RGBA8888)
+ * @param channels 3 for RGB, 4 for RGBA
+ *
+ * @return Allocated buffer of width × height × channels bytes, or NULL on error
+ *
+ * @note Caller must free the returned buffer
+ */
+static uint8_t *kitty_pack_pixels(const image_t *img, int channels)
+{
+	size_t row_size = (size_t)img->width * channels;
+	uint8_t *packed = malloc(row_size * img->height);
+	if (packed == NULL) {
+		return NULL;
+	}
+
+	uint8_t *dst = packed;
+	for (uint32_t y = 0; y < img->height; y++) {
+		const uint8_t *src = image_row(img, y);
+		if (channels == 4) {
+			memcpy(dst, src, row_size);
+
+		} else {
+			pixel_rgba_to_rgb(src, dst, img->width);
+		}
+		dst += row_size;
+	}
+
+	return packed;
+}
+
+/**
+ * @brief Combining diacritics encoding row and column numbers of placeholders
+ *
+ * Entry N encodes row/column N. This is the list from the Kitty graphics
+ * protocol specification (rowcolumn-diacritics.txt), which limits
+ * virtual placements to 297 rows and columns.
+ */
+static const uint32_t kitty_diacritics[] = {
+	0x0305, 0x030D, 0x030E, 0x0310, 0x0312, 0x033D, 0x033E, 0x033F,
+	0x0346, 0x034A, 0x034B, 0x034C, 0x0350, 0x0351, 0x0352, 0x0357,
+	0x035B, 0x0363, 0x0364, 0x0365, 0x0366, 0x0367, 0x0368, 0x0369,
+	0x036A, 0x036B, 0x036C, 0x036D, 0x036E, 0x036F, 0x0483, 0x0484,
+	0x0485, 0x0486, 0x0487, 0x0592, 0x0593, 0x0594, 0x0595, 0x0597,
+	0x0598, 0x0599, 0x059C, 0x059D, 0x059E, 0x059F, 0x05A0, 0x05A1,
+	0x05A8, 0x05A9, 0x05AB, 0x05AC, 0x05AF, 0x05C4, 0x0610, 0x0611,
+	0x0612, 0x0613, 0x0614, 0x0615, 0x0616, 0x0617, 0x0657, 0x0658,
+	0x0659, 0x065A, 0x065B, 0x065D, 0x065E, 0x06D6, 0x06D7, 0x06D8,
+	0x06D9, 0x06DA, 0x06DB, 0x06DC, 0x06DF, 0x06E0, 0x06E1, 0x06E2,
+	0x06E4, 0x06E7, 0x06E8, 0x06EB, 0x06EC, 0x0730, 0x0732, 0x0733,
+	0x0735, 0x0736, 0x073A, 0x073D, 0x073F, 0x0740, 0x0741, 0x0743,
+	0x0745, 0x0747, 0x0749, 0x074A, 0x07EB, 0x07EC, 0x07ED, 0x07EE,
+	0x07EF, 0x07F0, 0x07F1, 0x07F3, 0x0816, 0x0817, 0x0818, 0x0819,
+	0x081B, 0x081C, 0x081D, 0x081E, 0x081F, 0x0820, 0x0821, 0x0822,
+	0x0823, 0x0825, 0x0826, 0x0827, 0x0829, 0x082A, 0x082B, 0x082C,
+	0x082D, 0x0951, 0x0953, 0x0954, 0x0F82, 0x0F83, 0x0F86, 0x0F87,
+	0x135D, 0x135E, 0x135F, 0x17DD, 0x193A, 0x1A17, 0x1A75, 0x1A76,
+	0x1A77, 0x1A78, 0x1A79, 0x1A7A, 0x1A7B, 0x1A7C, 0x1B6B, 0x1B6D,
+	0x1B6E, 0x1B6F, 0x1B70, 0x1B71, 0x1B72, 0x1B73, 0x1CD0, 0x1CD1,
+	0x1CD2, 0x1CDA, 0x1CDB, 0x1CE0, 0x1DC0, 0x1DC1, 0x1DC3, 0x1DC4,
+	0x1DC5, 0x1DC6, 0x1DC7, 0x1DC8, 0x1DC9, 0x1DCB, 0x1DCC, 0x1DD1,
+	0x1DD2, 0x1DD3, 0x1DD4, 0x1DD5, 0x1DD6, 0x1DD7, 0x1DD8, 0x1DD9,
+	0x1DDA, 0x1DDB, 0x1DDC, 0x1DDD, 0x1DDE, 0x1DDF, 0x1DE0, 0x1DE1,
+	0x1DE2, 0x1DE3, 0x1DE4, 0x1DE5, 0x1DE6, 0x1DFE, 0x20D0, 0x20D1,
+	0x20D4, 0x20D5, 0x20D6, 0x20D7, 0x20DB, 0x20DC, 0x20E1, 0x20E7,
+	0x20E9, 0x20F0, 0x2CEF, 0x2CF0, 0x2CF1, 0x2DE0, 0x2DE1, 0x2DE2,
+	0x2DE3, 0x2DE4, 0x2DE5, 0x2DE6, 0x2DE7, 0x2DE8, 0x2DE9, 0x2DEA,
+	0x2DEB, 0x2DEC, 0x2DED, 0x2DEE, 0x2DEF, 0x2DF0, 0x2DF1, 0x2DF2,
+	0x2DF3, 0x2DF4, 0x2DF5, 0x2DF6, 0x2DF7, 0x2DF8, 0x2DF9, 0x2DFA,
+	0x2DFB, 0x2DFC, 0x2DFD, 0x2DFE, 0x2DFF, 0xA66F, 0xA67C, 0xA67D,
+	0xA6F0, 0xA6F1, 0xA8E0, 0xA8E1, 0xA8E2, 0xA8E3, 0xA8E4, 0xA8E5,
+	0xA8E6, 0xA8E7, 0xA8E8, 0xA8E9, 0xA8EA, 0xA8EB, 0xA8EC, 0xA8ED,
+	0xA8EE, 0xA8EF, 0xA8F0, 0xA8F1, 0xAAB0, 0xAAB2, 0xAAB3, 0xAAB7,
+	0xAAB8, 0xAABE, 0xAABF, 0xAAC1, 0xFE20, 0xFE21, 0xFE22, 0xFE23,
+	0xFE24, 0xFE25, 0xFE26, 0x10A0F, 0x10A38, 0x1D185, 0x1D186, 0x1D187,
+	0x1D188, 0x1D189, 0x1D1AA, 0x1D1AB, 0x1D1AC, 0x1D1AD, 0x1D242, 0x1D243,
+	0x1D244,
+};
+
+/**
+ * @brief Number of entries in kitty_diacritics
+ */
+#define KITTY_DIACRITICS_COUNT (sizeof(kitty_diacritics) / sizeof(kitty_diacritics[0]))
+
+/**
+ * @brief Unicode placeholder character for virtual placements
+ */
+#define KITTY_PLACEHOLDER 0x10EEEE
+
+/**
+ * @brief Check if images should be shown through Unicode placeholders
+ *
+ * Under tmux the placeholder cells are ordinary text that tmux keeps in
+ * its grid, so pane switches, scrolling and redraws show the image again
+ * without re-sending pixels. Kitty and Ghostty implement U=1.
+ *
+ * @param opts Command-line options (terminal detection)
+ *
+ * @return true if virtual placements should be used
+ */
+static bool kitty_use_placeholders(const cli_options_t *opts)
+{
+	return opts->terminal.is_tmux && (opts->terminal.is_kitty || opts->terminal.is_ghostty);
+}
+
+/**
+ * @brief Get the terminal cell size in pixels
+ *
+ * @param opts Command-line options (terminal geometry)
+ * @param cell_width Output parameter for cell width
+ * @param cell_height Output parameter for cell height
+ *
+ * @return true if the cell size is known
+ */
+static bool kitty_cell_size(const cli_options_t *opts, float *cell_width, float *cell_height)
+{
+	if (opts->terminal.cols <= 0 || opts->terminal.rows <= 0 || opts->terminal.width <= 0 || opts->terminal.height <= 0) {
+		return false;
+	}
+
+	*cell_width = (float)opts->terminal.width / (float)opts->terminal.cols;
+	*cell_height = (float)opts->terminal.height / (float)opts->terminal.rows;
+
+	return true;
+}
+
+/**
+ * @brief Derive a 24-bit image id from the payload
+ *
+ * FNV-1a over (at most) 4096 sampled bytes plus the size. Ids depend on
+ * content, so showing the same image again reuses its id instead of
+ * overwriting an unrelated image that is still on screen.
+ *
+ * @param data Payload bytes
+ * @param size Payload size in bytes
+ *
+ * @return Image id in [1, 0xFFFFFF]
+ */
+static uint32_t kitty_image_id(const uint8_t *data, size_t size)
+{
+	uint32_t hash = 2166136261u;
+	size_t step = size / 4096 + 1;
+
+	for (size_t i = 0; i < size; i += step) {
+		hash ^= data[i];
+		hash *= 16777619u;
+	}
+	hash ^= (uint32_t)size;
+	hash *= 16777619u;
+
+	/* Fold to 24 bits so the id fits in a truecolor foreground */
+	uint32_t id = (hash ^ (hash >> 24)) & 0xFFFFFF;
+	return id != 0 ? id : 1;
+}
+
+/**
+ * @brief Append the UTF-8 encoding of a code point to a buffer
+ *
+ * @param out Destination buffer (at least 4 bytes free)
+ * @param cp Unicode code point
+ *
+ * @return Number of bytes written
+ */
+static size_t kitty_utf8(char *out, uint32_t cp)
+{
+	if (cp < 0x80) {
+		out[0] = (char)cp;
+		return 1;
+
+	} else if (cp < 0x800) {
+		out[0] = (char)(0xC0 | (cp >> 6));
+		out[1] = (char)(0x80 | (cp & 0x3F));
+		return 2;
+
+	} else if (cp < 0x10000) {
+		out[0] = (char)(0xE0 | (cp >> 12));
+		out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+		out[2] = (char)(0x80 | (cp & 0x3F));
+		return 3;
+	}
+
+	out[0] = (char)(0xF0 | (cp >> 18));
+	out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+	out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+	out[3] = (char)(0x80 | (cp & 0x3F));
+	return 4;
+}
+
+/**
+ * @brief Print the placeholder cells of a virtual placement
+ *
+ * Each cell is U+10EEEE followed by the row and column diacritics. The
+ * foreground color carries the image id, so the text can be moved,
+ * copied and redrawn by tmux like any other text.
+ *
+ * @param image_id Image id (24-bit)
+ * @param cols Placement width in cells
+ * @param rows Placement height in cells
+ */
+static void kitty_print_placeholders(uint32_t image_id, uint32_t cols, uint32_t rows)
+{
+	/* Placeholder + row + column: at most 12 bytes per cell */
+	char *line = malloc((size_t)cols * 12);
+	if (line == NULL) {
+		return;
+	}
+
+	for (uint32_t row = 0; row < rows; row++) {
+		size_t len = 0;
+		for (uint32_t col = 0; col < cols; col++) {
+			len += kitty_utf8(line + len, KITTY_PLACEHOLDER);
+			len += kitty_utf8(line + len, kitty_diacritics[row]);
+			len += kitty_utf8(line + len, kitty_diacritics[col]);
+		}
+
+		printf("\033[38;2;%u;%u;%um", (image_id >> 16) & 0xFF, (image_id >> 8) & 0xFF, image_id & 0xFF);
+		fwrite(line, 1, len, stdout);
+		printf("\033[39m\n");
+	}
+
+	free(line);
+}
+
+/**
+ * @brief Transmit a payload and display it
+ *
+ * Normally the image is transmitted with a=T and placed at the cursor.
+ * Under tmux with a terminal supporting it, the image is transmitted
+ * once as a virtual placement (U=1) and displayed by printing Unicode
+ * placeholder cells instead.
+ *
+ * @param opts Command-line options
+ * @param format Format keys (f=, s=, v=)
+ * @param placement Cell placement keys for regular display (may be empty)
+ * @param data Payload bytes
+ * @param size Payload size in bytes
+ * @param compressible false for payloads that are already compressed
+ * @param cols Display width in cells (0 if unknown)
+ * @param rows Display height in cells (0 if unknown)
+ * @param path Local file holding the payload that the terminal may read in place, or NULL
+ *
+ * @return 0 on success, -1 on error
+ */
+static int kitty_display(const cli_options_t *opts, const char *format, const char *placement, const uint8_t *data, size_t size, bool compressible, uint32_t cols, uint32_t rows, const char *path)
+{
+	bool virtual = kitty_use_placeholders(opts) && cols > 0 && rows > 0 && cols <= KITTY_DIACRITICS_COUNT && rows <= KITTY_DIACRITICS_COUNT;
+	uint32_t image_id = virtual ? kitty_image_id(data, size) : 0;
+
+	/* q=2: an id is set, so suppress the terminal's OK/error replies */
+	char keys[160];
+	if (virtual) {
+		snprintf(keys, sizeof(keys), "%s,U=1,i=%u,c=%u,r=%u,q=2", format, image_id, cols, rows);
 	} else {
-		printf("\033\\");
+		snprintf(keys, sizeof(keys), "%s%s", format, placement);
 	}
 
-	printf("\n");
-	fflush(stdout);
+	if (path != NULL) {
+		char control[256];
+		snprintf(control, sizeof(control), "a=T,%s,t=f", keys);
+		kitty_send_named(opts, control, path);
 
-	/* Cleanup */
-	free(encoded);
+	} else if (kitty_send(opts, keys, data, size, compressible) != 0) {
+		return -1;
+	}
+
+	if (virtual) {
+		kitty_print_placeholders(image_id, cols, rows);
+	} else {
+		printf("\n");
+	}
+	fflush(stdout);
 
 	return 0;
 }
+
+int kitty_render(image_t **frames, int frame_count, const cli_options_t *opts)
+{
+	/* Only the first frame is sent; the caller owns and frees all of them */
+	(void)frame_count;
+
+	/* Get first frame */
+	image_t *img = frames[0];
+
+	/*
+	 * Opaque images drop the alpha channel and go out as f=24 RGB, which
+	 * is 25% less payload before compression. Anything else is f=32 RGBA.
+	 */
+	int channels = image_is_opaque(img) ? 3 : 4;
+
+	/* Packed RGBA goes out as is; padded rows are packed first */
+	uint8_t *packed = NULL;
+	if (channels == 3 || !image_is_packed(img)) {
+		packed = kitty_pack_pixels(img, channels);
+		if (packed == NULL && !image_is_packed(img)) {
+			fprintf(stderr, "Error: Failed to allocate Kitty payload\n");
+			return -1;
+		}
+
+		/* Out of memory for RGB: fall back to the RGBA pixels */
+		if (packed == NULL) {
+			channels = 4;
+		}
+	}
+
+	const uint8_t *payload = packed != NULL ? packed : img->pixels;
+	size_t payload_size = (size_t)img->width * img->height * channels;
+
+	/* a=T: transmit and display, f=24/f=32: RGB/RGBA format */
+	/* s=width, v=height: pixel dimensions (required for raw pixels) */
+	char format[64];
+	snprintf(format, sizeof(format), "f=%d,s=%u,v=%u", channels == 3 ? 24 : 32, img->width, img->height);
+
+	/* Cells covered at native size (only needed for virtual placements) */
+	uint32_t cols = 0, rows = 0;
+	float cell_width, cell_height;
+	if (kitty_cell_size(opts, &cell_width, &cell_height)) {
+		cols = (uint32_t)ceilf((float)img->width / cell_width);
+		rows = (uint32_t)ceilf((float)img->height / cell_height);
+	}
+
+	int result = kitty_display(opts, format, "", payload, payload_size, true, cols, rows, NULL);
+	free(packed);
+
+	return result != 0 ? -1 : 0;
+}
+
+int kitty_render_png(const uint8_t *data, size_t size, const cli_options_t *opts, uint32_t image_width, uint32_t image_height, uint32_t target_width, uint32_t target_height)
+{
+	if (data == NULL || size == 0 || opts == NULL) {
+		return -1;
+	}
+
+	uint32_t cols = 0, rows = 0;
+	float cell_width, cell_height;
+	bool cells_known = kitty_cell_size(opts, &cell_width, &cell_height);
+	if (cells_known) {
+		cols = (uint32_t)roundf((float)target_width / cell_width);
+		rows = (uint32_t)roundf((float)target_height / cell_height);
+		cols = cols > 0 ? cols : 1;
+		rows = rows > 0 ? rows : 1;
+	}
+
+	/*
+	 * f=100: PNG, decoded by the terminal. When the target differs from
+	 * the native size, ask the terminal to scale it into a cell box. If
+	 * only one of c/r is given the terminal derives the other from the
+	 * aspect ratio, so pass the axis with more cells (smaller rounding
+	 * error) unless both dimensions were forced with -w and -H.
+	 */
+	char placement[48] = "";
+	bool native = target_width == image_width && target_height == image_height;
+	if (!native && cells_known) {
+		bool exact = opts->target_width > 0 && opts->target_height > 0;
+		if (exact) {
+			snprintf(placement, sizeof(placement), ",c=%u,r=%u", cols, rows);
+
+		} else if (cols >= rows) {
+			snprintf(placement, sizeof(placement), ",c=%u", cols);
+
+		} else {
+			snprintf(placement, sizeof(placement), ",r=%u", rows);
+		}
+	}
+
+	/* A local file on disk can be read by the terminal in place (t=f) */
+	char path[PATH_MAX];
+	bool in_place = kitty_can_use_local_media(opts) && opts->input_file != NULL && realpath(opts->input_file, path) != NULL;
+
+	return kitty_display(opts, "f=100", placement, data, size, false, cols, rows, in_place ? path : NULL);
+}
+
+void kitty_clear(const cli_options_t *opts)
+{
+	kitty_escape_begin(opts);
+	fputs("a=d,d=a,q=2", stdout);
+	kitty_escape_end(opts);
+	fflush(stdout);
+}
@@ -26,11 +26,11 @@
  * Kitty graphics protocol supports multiple transmission formats:
  * - f=100: PNG format (sent directly, no decoding)
  * - f=32: RGBA raw pixel data (decoded from JPEG/GIF)
- * - f=24: RGB raw pixel data (not currently used)
+ * - f=24: RGB raw pixel data (decoded images that are fully opaque)
  *
  * Supported formats:
  * - PNG (Portable Network Graphics) - sent directly with f=100
- * - JPEG (Joint Photographic Experts Group) - decoded to RGBA and sent with f=32
+ * - JPEG (Joint Photographic Experts Group) - decoded and sent as RGB with f=24
  * - Static GIF (single frame) - decoded to RGBA and sent with f=32
  *
  * Not supported (falls back to ANSI):
@@ -57,16 +57,21 @@ bool kitty_is_format_supported(const uint8_t *data, size_t size, cli_options_t *
  * \033_G<key>=<value>,<key>=<value>,...;<base64_data>\033\\
  *
  * Transmission methods:
- * - PNG: Sends raw PNG data with f=100 (no decoding)
- * - JPEG: Decodes to RGBA, sends with f=32,s=width,v=height
+ * - PNG: Sent raw with f=100 by kitty_render_png() (no decoding)
+ * - JPEG: Decodes, sends opaque pixels as RGB with f=24,s=width,v=height
  * - Static GIF: Decodes to RGBA, sends with f=32,s=width,v=height
  *
  * Key control codes:
  * - a=T: transmit and display
  * - f=100: PNG format (direct transmission)
  * - f=32: RGBA raw pixel data (decoded transmission)
+ * - f=24: RGB raw pixel data (decoded transmission of opaque images)
  * - t=d: direct transmission
- * - s=<width>,v=<height>: pixel dimensions (required for f=32)
+ * - t=s: POSIX shared memory object (local Kitty/Ghostty)
+ * - t=t: temporary file (local Kitty/Ghostty, if shared memory fails)
+ * - o=z: zlib-compressed payload (chosen from a compressibility probe)
+ * - m=1/m=0: chunked transmission, at most 4096 base64 bytes per escape
+ * - s=<width>,v=<height>: pixel dimensions (required for f=24/f=32)
  * - c=<cols>: width in terminal columns (optional sizing)
  * - r=<rows>: height in terminal rows (optional sizing)
  *
@@ -77,12 +82,55 @@ bool kitty_is_format_supported(const uint8_t *data, size_t size, cli_options_t *
  * @return 0 on success, -1 on error
  *
  * @note Automatically handles tmux environments with DCS wrapping
+ * @note Under tmux in Kitty/Ghostty the image is sent once as a virtual
+ *       placement (U=1,i=<id>) and shown with U+10EEEE placeholder cells
+ *       that tmux redraws like text, so pane switches need no re-send
  * @note PNG images bypass decoding for maximum efficiency
  * @note JPEG/GIF images are decoded once and transmitted as RGBA
+ * @note Local sessions (no SSH environment) skip base64 entirely by handing
+ *       the terminal a shared memory object or temp file; t=d is the fallback
+ * @note Payload is compressed at zlib's fastest level and streamed chunk by
+ *       chunk, so no full-size base64 copy of the image is ever built
  * @note Animated GIFs should not reach this function (filtered by kitty_is_format_supported)
  * @note If target_width/height specified: converts to terminal cell dimensions
+ * @note Frames stay owned by the caller, also on failure (ANSI fallback reuses them)
  * @note Outputs to stdout
  */
 int kitty_render(image_t **frames, int frame_count, const cli_options_t *opts);
 
+/**
+ * @brief Render a PNG file by passing its bytes through with f=100
+ *
+ * The terminal decodes the PNG itself, so no decoding or resampling
+ * happens in imgcat2. When the target size differs from the native size
+ * the image is placed into a c=<cols>/r=<rows> cell box and scaled by
+ * the terminal.
+ *
+ * Local sessions reading from a file let the terminal open the file
+ * directly (t=f); otherwise the bytes go through shared memory, a temp
+ * file, or chunked direct transmission.
+ *
+ * @param data Raw PNG file data
+ * @param size Size of data in bytes
+ * @param opts Command-line options for rendering
+ * @param image_width Native image width in pixels (from IHDR)
+ * @param image_height Native image height in pixels (from IHDR)
+ * @param target_width Desired display width in pixels
+ * @param target_height Desired display height in pixels
+ *
+ * @return 0 on success, -1 on error
+ *
+ * @note Outputs to stdout
+ */
+int kitty_render_png(const uint8_t *data, size_t size, const cli_options_t *opts, uint32_t image_width, uint32_t image_height, uint32_t target_width, uint32_t target_height);
+
+/**
+ * @brief Delete all visible image placements (a=d,d=a)
+ *
+ * @param opts Command-line options (tmux detection)
+ *
+ * @note Outputs to stdout
+ */
+void kitty_clear(const cli_options_t *opts);
+
 #endif /* IMGCAT2_KITTY_H */
@@ -138,7 +138,8 @@ bool terminal_is_iterm2(void);
  * @brief Check if terminal is Ghostty
  *
  * Detects if the current terminal is Ghostty by checking environment variables.
- * Ghostty sets TERM_PROGRAM="ghostty".
+ * Ghostty sets TERM_PROGRAM="ghostty" and GHOSTTY_RESOURCES_DIR; the latter
+ * is still visible inside tmux.
  *
  * @return true if running in Ghostty, false otherwise
  *
@@ -150,7 +151,8 @@ bool terminal_is_ghostty(void);
  * @brief Check if terminal is Kitty
  *
  * Detects if the current terminal is Kitty by checking environment variables.
- * Kitty sets TERM="xterm-kitty" and optionally TERM_PROGRAM="kitty".
+ * Kitty sets TERM="xterm-kitty" and optionally TERM_PROGRAM="kitty", plus
+ * KITTY_WINDOW_ID which is still visible inside tmux.
  *
  * @return true if running in Kitty, false otherwise
  *
@@ -171,4 +173,17 @@ bool terminal_is_konsole(void);
  */
 bool terminal_is_tmux(void);
 
+/**
+ * @brief Check if the terminal runs on another host
+ *
+ * Treats the session as remote when any of the SSH_CONNECTION, SSH_CLIENT
+ * or SSH_TTY environment variables is set, or when KITTY_PID names a
+ * process that does not exist on this host.
+ *
+ * @return true if the terminal is (probably) on another host, false otherwise
+ *
+ * @note Local sessions may use file and shared-memory transmission media
+ */
+bool terminal_is_remote(void);
+
 #endif /* IMGCAT2_TERMINAL_H */
@@ -12,6 +12,7 @@
 #include <sys/ioctl.h>
 
 #include <errno.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -206,6 +207,11 @@ bool terminal_is_ghostty(void)
 		return true;
 	}
 
+	/* Inside tmux TERM_PROGRAM is "tmux"; Ghostty's resources dir survives */
+	if (getenv("GHOSTTY_RESOURCES_DIR") != NULL) {
+		return true;
+	}
+
 	/* Not Ghostty */
 	return false;
 }
@@ -227,6 +233,11 @@ bool terminal_is_kitty(void)
 		return true;
 	}
 
+	/* Inside tmux TERM and TERM_PROGRAM are tmux's; KITTY_WINDOW_ID survives */
+	if (getenv("KITTY_WINDOW_ID") != NULL) {
+		return true;
+	}
+
 	/* Not Kitty */
 	return false;
 }
@@ -256,3 +267,26 @@ bool terminal_is_tmux(void)
 	/* Check if TMUX environment variable is set */
 	return getenv("TMUX") != NULL;
 }
+
+/**
+ * @brief Check if the terminal runs on another host
+ */
+bool terminal_is_remote(void)
+{
+	/* Any SSH session marker means the terminal is on the client side */
+	if (getenv("SSH_CONNECTION") != NULL || getenv("SSH_CLIENT") != NULL || getenv("SSH_TTY") != NULL) {
+		return true;
+	}
+
+	/* Kitty exports its PID; if no such process exists here, we are elsewhere */
+	const char *kitty_pid = getenv("KITTY_PID");
+	if (kitty_pid != NULL) {
+		char *end = NULL;
+		long pid = strtol(kitty_pid, &end, 10);
+		if (end != kitty_pid && *end == '\0' && pid > 0 && kill((pid_t)pid, 0) < 0 && errno == ESRCH) {
+			return true;
+		}
+	}
+
+	return false;
+}
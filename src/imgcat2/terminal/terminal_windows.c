@@ -224,4 +224,12 @@ bool terminal_is_kitty(void)
 	return false;
 }
 
+/**
+ * @brief Check if the terminal runs on another host
+ */
+bool terminal_is_remote(void)
+{
+	return getenv("SSH_CONNECTION") != NULL || getenv("SSH_CLIENT") != NULL;
+}
+
 #endif /* _WIN32 */
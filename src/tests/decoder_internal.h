@@ -16,6 +16,7 @@
 
 /* Forward declarations of internal decoder functions */
 extern image_t **decode_png(const uint8_t *data, size_t len, int *frame_count);
+extern image_t **decode_png_hinted(const uint8_t *data, size_t len, int *frame_count, uint32_t box_width, uint32_t box_height);
 extern image_t **decode_jpeg(const uint8_t *data, size_t len, int *frame_count);
 extern image_t **decode_gif(const uint8_t *data, size_t len, int *frame_count);
 extern image_t **decode_stb(const uint8_t *data, size_t len, int *frame_count);
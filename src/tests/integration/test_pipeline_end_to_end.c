@@ -10,8 +10,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include "../../imgcat2/core/cli.h"
+#include "../../imgcat2/core/encoder.h"
 #include "../../imgcat2/core/image.h"
 #include "../../imgcat2/core/pipeline.h"
 #include "../../imgcat2/decoders/decoder.h"
@@ -232,6 +234,211 @@ CTEST(integration, full_pipeline_png)
 	decoder_free_frames(frames, frame_count);
 }
 
+/**
+ * @test Test that single-file output decodes with the terminal size hint
+ *
+ * Mirrors job_decode(): the decode box comes from the terminal size, so
+ * a large PNG is streamed at a reduced size that still covers the
+ * scaled output.
+ */
+CTEST(integration, single_file_decode_hinted)
+{
+	image_t *img = image_create(1600, 800);
+	ASSERT_NOT_NULL(img);
+
+	size_t size = 0;
+	uint8_t *png = encode_png(img, ENCODER_PNG_LEVEL, &size);
+	image_destroy(img);
+	ASSERT_NOT_NULL(png);
+
+	cli_options_t opts;
+	cli_options_init(&opts);
+	opts.terminal.rows = 24;
+	opts.terminal.cols = 80;
+
+	pipeline_set_decode_box(&opts);
+	ASSERT_EQUAL(80, opts.decode_box_width);
+	ASSERT_EQUAL(46, opts.decode_box_height);
+
+	decoder_registry_init(NULL);
+
+	image_t **frames = NULL;
+	int frame_count = 0;
+	int result = pipeline_decode(&opts, png, size, &frames, &frame_count);
+	free(png);
+	ASSERT_EQUAL(0, result);
+	ASSERT_EQUAL(1, frame_count);
+
+	/* Reduced by 16, not decoded at 1600x800 */
+	ASSERT_EQUAL(100, frames[0]->width);
+	ASSERT_EQUAL(50, frames[0]->height);
+
+	image_t **scaled = NULL;
+	result = pipeline_scale(frames, frame_count, &opts, &scaled);
+	ASSERT_EQUAL(0, result);
+	ASSERT_EQUAL(80, scaled[0]->width);
+	ASSERT_EQUAL(40, scaled[0]->height);
+
+	image_destroy(scaled[0]);
+	free(scaled);
+	decoder_free_frames(frames, frame_count);
+
+	/* Stretching to -w and -H needs the full image */
+	opts.has_custom_dimensions = true;
+	opts.target_width = 100;
+	opts.target_height = 100;
+	pipeline_set_decode_box(&opts);
+	ASSERT_EQUAL(0, opts.decode_box_width);
+	ASSERT_EQUAL(0, opts.decode_box_height);
+}
+
+/**
+ * @test Test Kitty output box-filters PNG rows while decoding
+ *
+ * Kitty images never get taller than the terminal, so a 1600x800 PNG on
+ * a 100 pixel high terminal streams through the box filter at 1/8.
+ */
+CTEST(integration, kitty_decode_hinted)
+{
+	image_t *img = image_create(1600, 800);
+	ASSERT_NOT_NULL(img);
+	for (uint32_t y = 0; y < img->height; y++) {
+		for (uint32_t x = 0; x < img->width; x++) {
+			image_set_pixel(img, x, y, x < 800 ? 255 : 0, 0, x < 800 ? 0 : 255, 255);
+		}
+	}
+
+	size_t size = 0;
+	uint8_t *png = encode_png(img, ENCODER_PNG_LEVEL, &size);
+	image_destroy(img);
+	ASSERT_NOT_NULL(png);
+
+	cli_options_t opts;
+	cli_options_init(&opts);
+	opts.terminal.rows = 5;
+	opts.terminal.cols = 20;
+	opts.terminal.width = 200;
+	opts.terminal.height = 100;
+	opts.terminal.has_kitty = true;
+
+	pipeline_set_decode_box(&opts);
+	ASSERT_EQUAL(IMAGE_MAX_DIMENSION, opts.decode_box_width);
+	ASSERT_EQUAL(100, opts.decode_box_height);
+
+	decoder_registry_init(NULL);
+
+	image_t **frames = NULL;
+	int frame_count = 0;
+	int result = pipeline_decode(&opts, png, size, &frames, &frame_count);
+	free(png);
+	ASSERT_EQUAL(0, result);
+	ASSERT_EQUAL(1, frame_count);
+	ASSERT_EQUAL(200, frames[0]->width);
+	ASSERT_EQUAL(100, frames[0]->height);
+
+	/* Boxes on either side of the edge stay unmixed */
+	const uint8_t *p = image_get_pixel(frames[0], 99, 50);
+	ASSERT_EQUAL(255, p[0]);
+	ASSERT_EQUAL(0, p[2]);
+	p = image_get_pixel(frames[0], 100, 50);
+	ASSERT_EQUAL(0, p[0]);
+	ASSERT_EQUAL(255, p[2]);
+
+	decoder_free_frames(frames, frame_count);
+
+	/* --force-ansi falls back to the half-block box */
+	opts.force_ansi = true;
+	pipeline_set_decode_box(&opts);
+	ASSERT_EQUAL(20, opts.decode_box_width);
+	ASSERT_EQUAL(8, opts.decode_box_height);
+}
+
+/**
+ * @brief Decode one base64 character (no padding or error handling)
+ */
+static uint32_t base64_value(char c)
+{
+	if (c >= 'A' && c <= 'Z') {
+		return (uint32_t)(c - 'A');
+	}
+	if (c >= 'a' && c <= 'z') {
+		return (uint32_t)(c - 'a' + 26);
+	}
+	if (c >= '0' && c <= '9') {
+		return (uint32_t)(c - '0' + 52);
+	}
+	return c == '+' ? 62 : 63;
+}
+
+/**
+ * @test Test iTerm2 conversion sends a PNG scaled to the display box
+ *
+ * pipeline_render_iterm2_converted() is what iTerm2 gets for formats it
+ * cannot decode. A 1600x800 image on an 800x480 pixel terminal is sent
+ * as a PNG fitted to 800x240 (half the terminal height).
+ */
+CTEST(integration, iterm2_converted_png)
+{
+	image_t *img = image_create(1600, 800);
+	ASSERT_NOT_NULL(img);
+
+	size_t size = 0;
+	uint8_t *png = encode_png(img, ENCODER_PNG_LEVEL, &size);
+	image_destroy(img);
+	ASSERT_NOT_NULL(png);
+
+	cli_options_t opts;
+	cli_options_init(&opts);
+	opts.silent = true;
+	opts.terminal.rows = 24;
+	opts.terminal.cols = 80;
+	opts.terminal.width = 800;
+	opts.terminal.height = 480;
+	opts.terminal.is_iterm2 = true;
+
+	decoder_registry_init(NULL);
+
+	/* Capture stdout */
+	char path[] = "/tmp/imgcat2_test_iterm2_XXXXXX";
+	int fd = mkstemp(path);
+	ASSERT_TRUE(fd >= 0);
+	fflush(stdout);
+	int saved_stdout = dup(STDOUT_FILENO);
+	dup2(fd, STDOUT_FILENO);
+
+	int result = pipeline_render_iterm2_converted(png, size, &opts);
+
+	fflush(stdout);
+	dup2(saved_stdout, STDOUT_FILENO);
+	close(saved_stdout);
+	free(png);
+	ASSERT_EQUAL(0, result);
+
+	char out[256] = { 0 };
+	ssize_t n = pread(fd, out, sizeof(out) - 1, 0);
+	close(fd);
+	unlink(path);
+	ASSERT_TRUE(n > 0);
+
+	/* OSC 1337 inline file carrying a PNG */
+	ASSERT_TRUE(strstr(out, "]1337;File=inline=1;") != NULL);
+	const char *payload = strchr(out, ':');
+	ASSERT_NOT_NULL(payload);
+	payload++;
+	ASSERT_TRUE(strncmp(payload, "iVBORw0KGgo", 11) == 0);
+
+	/* IHDR width and height: bytes 16..23 of the PNG, base64 characters 20..31 */
+	uint8_t header[24];
+	for (int i = 0; i < 8; i++) {
+		uint32_t v = (base64_value(payload[i * 4]) << 18) | (base64_value(payload[i * 4 + 1]) << 12) | (base64_value(payload[i * 4 + 2]) << 6) | base64_value(payload[i * 4 + 3]);
+		header[i * 3] = (uint8_t)(v >> 16);
+		header[i * 3 + 1] = (uint8_t)(v >> 8);
+		header[i * 3 + 2] = (uint8_t)v;
+	}
+	ASSERT_EQUAL(480, (header[16] << 24) | (header[17] << 16) | (header[18] << 8) | header[19]);
+	ASSERT_EQUAL(240, (header[20] << 24) | (header[21] << 16) | (header[22] << 8) | header[23]);
+}
+
 /**
  * @test Test MIME type detection in pipeline
  *
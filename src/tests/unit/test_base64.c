@@ -0,0 +1,149 @@
+/**
+ * @file test_base64.c
+ * @brief Unit tests for base64 encoding
+ *
+ * Tests base64_encode(), base64_encode_to() and the incremental
+ * encoder against RFC 4648 vectors and a reference implementation.
+ * Buffer sizes cover the SIMD kernels' block boundaries.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../imgcat2/core/base64.h"
+#include "../ctest.h"
+
+/**
+ * @brief Straightforward reference encoder
+ */
+static size_t reference_encode(const uint8_t *data, size_t size, char *out)
+{
+	static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	size_t j = 0;
+
+	for (size_t i = 0; i < size; i += 3) {
+		uint32_t v = (uint32_t)data[i] << 16;
+		if (i + 1 < size) {
+			v |= (uint32_t)data[i + 1] << 8;
+		}
+		if (i + 2 < size) {
+			v |= data[i + 2];
+		}
+
+		out[j++] = table[(v >> 18) & 0x3F];
+		out[j++] = table[(v >> 12) & 0x3F];
+		out[j++] = i + 1 < size ? table[(v >> 6) & 0x3F] : '=';
+		out[j++] = i + 2 < size ? table[v & 0x3F] : '=';
+	}
+
+	return j;
+}
+
+/**
+ * @brief Fill a buffer with deterministic pseudo-random bytes
+ */
+static void fill_pattern(uint8_t *data, size_t size)
+{
+	uint32_t x = 2463534242u;
+	for (size_t i = 0; i < size; i++) {
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		data[i] = (uint8_t)x;
+	}
+}
+
+/**
+ * @test Test RFC 4648 test vectors
+ */
+CTEST(base64, rfc4648_vectors)
+{
+	const char *inputs[] = { "f", "fo", "foo", "foob", "fooba", "foobar" };
+	const char *expected[] = { "Zg==", "Zm8=", "Zm9v", "Zm9vYg==", "Zm9vYmE=", "Zm9vYmFy" };
+
+	for (size_t i = 0; i < 6; i++) {
+		size_t out_size = 0;
+		char *out = base64_encode((const uint8_t *)inputs[i], strlen(inputs[i]), &out_size);
+		ASSERT_NOT_NULL(out);
+		ASSERT_STR(expected[i], out);
+		ASSERT_EQUAL((int)strlen(expected[i]), (int)out_size);
+		free(out);
+	}
+}
+
+/**
+ * @test Test invalid parameters
+ */
+CTEST(base64, invalid_parameters)
+{
+	size_t out_size = 0;
+	ASSERT_NULL(base64_encode(NULL, 10, &out_size));
+	ASSERT_NULL(base64_encode((const uint8_t *)"abc", 0, &out_size));
+}
+
+/**
+ * @test Test one-shot encoding of every size around the kernel block sizes
+ *
+ * Covers sizes below and across the 16-byte (SSSE3) and 28-byte (AVX2)
+ * load windows with every byte value present.
+ */
+CTEST(base64, matches_reference_all_sizes)
+{
+	uint8_t data[1024];
+	char expected[BASE64_ENCODED_SIZE(1024)];
+	char actual[BASE64_ENCODED_SIZE(1024)];
+
+	fill_pattern(data, sizeof(data));
+	base64_init();
+
+	for (size_t size = 1; size <= sizeof(data); size++) {
+		size_t expected_len = reference_encode(data, size, expected);
+		size_t actual_len = base64_encode_to(data, size, actual);
+
+		ASSERT_EQUAL((int)expected_len, (int)actual_len);
+		ASSERT_DATA((const unsigned char *)expected, expected_len, (const unsigned char *)actual, actual_len);
+	}
+}
+
+/**
+ * @test Test incremental encoding with uneven slices
+ *
+ * Concatenated update + final output must equal one-shot encoding
+ * regardless of how the input is sliced.
+ */
+CTEST(base64, incremental_matches_one_shot)
+{
+	const size_t size = 100003;
+	uint8_t *data = malloc(size);
+	char *expected = malloc(BASE64_ENCODED_SIZE(size));
+	char *actual = malloc(BASE64_ENCODED_SIZE(size) + 4);
+	ASSERT_TRUE(data != NULL);
+	ASSERT_TRUE(expected != NULL);
+	ASSERT_TRUE(actual != NULL);
+
+	fill_pattern(data, size);
+	size_t expected_len = reference_encode(data, size, expected);
+
+	const size_t slices[] = { 1, 2, 5, 13, 64, 4097 };
+	for (size_t s = 0; s < sizeof(slices) / sizeof(slices[0]); s++) {
+		base64_state_t state;
+		base64_encode_init(&state);
+
+		size_t actual_len = 0;
+		for (size_t i = 0; i < size; i += slices[s]) {
+			size_t n = size - i < slices[s] ? size - i : slices[s];
+			actual_len += base64_encode_update(&state, data + i, n, actual + actual_len);
+		}
+		actual_len += base64_encode_final(&state, actual + actual_len);
+
+		ASSERT_EQUAL((int)expected_len, (int)actual_len);
+		ASSERT_DATA((const unsigned char *)expected, expected_len, (const unsigned char *)actual, actual_len);
+	}
+
+	free(data);
+	free(expected);
+	free(actual);
+}
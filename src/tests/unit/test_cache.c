@@ -0,0 +1,124 @@
+/**
+ * @file test_cache.c
+ * @brief Unit tests for the on-disk render cache
+ *
+ * Tests the XXH64 content hash against reference vectors and verifies
+ * that cache keys separate content, geometry and options.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../imgcat2/core/cache.h"
+#include "../../imgcat2/core/cli.h"
+#include "../ctest.h"
+
+/**
+ * @brief Point the cache at a private directory
+ */
+static void use_test_cache_dir(void)
+{
+	char dir[] = "/tmp/imgcat2-test-cache-XXXXXX";
+	if (mkdtemp(dir) != NULL) {
+		setenv("XDG_CACHE_HOME", dir, 1);
+	}
+}
+
+/**
+ * @brief Options for a fixed 80x24 terminal
+ */
+static cli_options_t test_options(void)
+{
+	cli_options_t opts = { 0 };
+	opts.interpolation = "lanczos";
+	opts.target_width = -1;
+	opts.target_height = -1;
+	opts.terminal.cols = 80;
+	opts.terminal.rows = 24;
+	opts.terminal.width = 800;
+	opts.terminal.height = 480;
+	return opts;
+}
+
+/**
+ * @test Test XXH64 reference vectors
+ */
+CTEST(cache, hash_vectors)
+{
+	ASSERT_TRUE(cache_hash("", 0, 0) == 0xEF46DB3751D8E999ULL);
+	ASSERT_TRUE(cache_hash("a", 1, 0) == 0xD24EC4F1A98C6E5BULL);
+	ASSERT_TRUE(cache_hash("abc", 3, 0) == 0x44BC2CF5AD770999ULL);
+
+	const char *long_input = "Nobody inspects the spammish repetition";
+	ASSERT_TRUE(cache_hash(long_input, strlen(long_input), 0) == 0xFBCEA83C8A378BF1ULL);
+}
+
+/**
+ * @test Test keys depend on content, geometry and options
+ */
+CTEST(cache, key_separation)
+{
+	use_test_cache_dir();
+
+	const uint8_t data_a[] = "image-a";
+	const uint8_t data_b[] = "image-b";
+	cli_options_t opts = test_options();
+
+	cache_entry_t e1, e2, e3, e4;
+	ASSERT_EQUAL(0, cache_open(&opts, data_a, sizeof(data_a), &e1));
+	ASSERT_EQUAL(0, cache_open(&opts, data_a, sizeof(data_a), &e2));
+	ASSERT_STR(e1.path, e2.path);
+
+	ASSERT_EQUAL(0, cache_open(&opts, data_b, sizeof(data_b), &e3));
+	ASSERT_TRUE(strcmp(e1.path, e3.path) != 0);
+
+	opts.terminal.cols = 120;
+	ASSERT_EQUAL(0, cache_open(&opts, data_a, sizeof(data_a), &e4));
+	ASSERT_TRUE(strcmp(e1.path, e4.path) != 0);
+
+	/* Placed renders (--preview-server) at another position differ */
+	cache_entry_t e5, e6;
+	opts.origin_row = 2;
+	opts.origin_col = 10;
+	ASSERT_EQUAL(0, cache_open(&opts, data_a, sizeof(data_a), &e5));
+	ASSERT_TRUE(strcmp(e4.path, e5.path) != 0);
+	opts.origin_col = 11;
+	ASSERT_EQUAL(0, cache_open(&opts, data_a, sizeof(data_a), &e6));
+	ASSERT_TRUE(strcmp(e5.path, e6.path) != 0);
+
+	/* Animations are never cached */
+	opts.animate = true;
+	ASSERT_EQUAL(-1, cache_open(&opts, data_a, sizeof(data_a), &e4));
+}
+
+/**
+ * @test Test a committed capture is replayed on the next lookup
+ */
+CTEST(cache, capture_and_replay)
+{
+	use_test_cache_dir();
+
+	const uint8_t data[] = "image-data";
+	cli_options_t opts = test_options();
+
+	cache_entry_t entry;
+	ASSERT_EQUAL(0, cache_open(&opts, data, sizeof(data), &entry));
+	ASSERT_EQUAL(-1, cache_replay(&entry));
+
+	ASSERT_EQUAL(0, cache_capture_begin(&entry));
+	printf("cached-output\n");
+	cache_capture_end(&entry, true);
+
+	FILE *fp = fopen(entry.path, "rb");
+	ASSERT_NOT_NULL(fp);
+	char stored[32] = { 0 };
+	size_t n = fread(stored, 1, sizeof(stored) - 1, fp);
+	fclose(fp);
+	ASSERT_EQUAL(14, (int)n);
+	ASSERT_STR("cached-output\n", stored);
+
+	ASSERT_EQUAL(0, cache_replay(&entry));
+}
@@ -0,0 +1,81 @@
+/**
+ * @file test_daemon.c
+ * @brief Unit tests for the render server socket handling
+ *
+ * Tests socket path resolution and the client's local fallback when
+ * no server is listening.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../imgcat2/core/cli.h"
+#include "../../imgcat2/core/daemon.h"
+#include "../ctest.h"
+
+CTEST(daemon, socket_path_explicit)
+{
+	char path[108];
+
+	setenv("IMGCAT2_SOCKET", "/tmp/imgcat2-test.sock", 1);
+	ASSERT_EQUAL(0, daemon_socket_path(path, sizeof(path)));
+	ASSERT_STR("/tmp/imgcat2-test.sock", path);
+
+	unsetenv("IMGCAT2_SOCKET");
+}
+
+CTEST(daemon, socket_path_runtime_dir)
+{
+	char path[108];
+
+	unsetenv("IMGCAT2_SOCKET");
+	setenv("XDG_RUNTIME_DIR", "/run/user/1000", 1);
+	ASSERT_EQUAL(0, daemon_socket_path(path, sizeof(path)));
+	ASSERT_STR("/run/user/1000/imgcat2.sock", path);
+}
+
+CTEST(daemon, socket_path_fallback)
+{
+	char path[108];
+	char expected[108];
+
+	unsetenv("IMGCAT2_SOCKET");
+	unsetenv("XDG_RUNTIME_DIR");
+	snprintf(expected, sizeof(expected), "/tmp/imgcat2-%u.sock", (unsigned)getuid());
+
+	ASSERT_EQUAL(0, daemon_socket_path(path, sizeof(path)));
+	ASSERT_STR(expected, path);
+}
+
+CTEST(daemon, socket_path_too_long)
+{
+	char path[512];
+	char long_path[300];
+
+	memset(long_path, 'a', sizeof(long_path) - 1);
+	long_path[0] = '/';
+	long_path[sizeof(long_path) - 1] = '\0';
+
+	setenv("IMGCAT2_SOCKET", long_path, 1);
+	ASSERT_EQUAL(-1, daemon_socket_path(path, sizeof(path)));
+
+	unsetenv("IMGCAT2_SOCKET");
+}
+
+CTEST(daemon, client_without_server)
+{
+	char *argv[] = { "imgcat2", "--client", NULL };
+	int exit_code = 42;
+	cli_options_t opts;
+
+	cli_options_init(&opts);
+	setenv("IMGCAT2_SOCKET", "/tmp/imgcat2-test-no-server.sock", 1);
+	unlink("/tmp/imgcat2-test-no-server.sock");
+
+	ASSERT_EQUAL(-1, daemon_client(2, argv, &opts, &exit_code));
+	ASSERT_EQUAL(42, exit_code);
+
+	unsetenv("IMGCAT2_SOCKET");
+}
@@ -85,11 +85,18 @@ CTEST(decoder_jpeg, decode_minimal_1x1)
 	ASSERT_EQUAL(1, frames[0]->height);
 	ASSERT_NOT_NULL(frames[0]->pixels);
 
-	/* JPEG has no alpha channel - should be converted to RGBA with alpha=255 */
-	uint8_t *pixel = image_get_pixel(frames[0], 0, 0);
+	/* Grayscale JPEG stays gray; converting to RGBA gives alpha=255 */
+	ASSERT_EQUAL(IMAGE_FORMAT_GRAY8, frames[0]->format);
+	ASSERT_TRUE(frames[0]->opaque);
+
+	image_t *rgba = image_convert_rgba8(frames[0]);
+	ASSERT_NOT_NULL(rgba);
+	uint8_t *pixel = image_get_pixel(rgba, 0, 0);
 	ASSERT_NOT_NULL(pixel);
 	ASSERT_EQUAL(255, pixel[3]); /* Alpha should be opaque */
+	ASSERT_EQUAL(frames[0]->pixels[0], pixel[0]);
 
+	image_destroy(rgba);
 	decoder_free_frames(frames, frame_count);
 }
 
@@ -117,15 +124,18 @@ CTEST(decoder_jpeg, decode_2x2)
 	ASSERT_EQUAL(2, frames[0]->height);
 	ASSERT_NOT_NULL(frames[0]->pixels);
 
-	/* Verify all 4 pixels exist and have opaque alpha */
+	/* Verify all 4 pixels exist and have opaque alpha after conversion */
+	image_t *rgba = image_convert_rgba8(frames[0]);
+	ASSERT_NOT_NULL(rgba);
 	for (uint32_t y = 0; y < 2; y++) {
 		for (uint32_t x = 0; x < 2; x++) {
-			uint8_t *pixel = image_get_pixel(frames[0], x, y);
+			uint8_t *pixel = image_get_pixel(rgba, x, y);
 			ASSERT_NOT_NULL(pixel);
 			ASSERT_EQUAL(255, pixel[3]); /* Alpha=255 */
 		}
 	}
 
+	image_destroy(rgba);
 	decoder_free_frames(frames, frame_count);
 }
 
@@ -12,7 +12,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "../../imgcat2/core/encoder.h"
 #include "../../imgcat2/core/image.h"
+#include "../../imgcat2/core/pipeline.h"
 #include "../../imgcat2/decoders/decoder.h"
 #include "../ctest.h"
 #include "../decoder_internal.h"
@@ -174,3 +176,209 @@ CTEST(decoder_png, find_by_mime)
 	ASSERT_NOT_NULL(decoder->name);
 	ASSERT_NOT_NULL(decoder->decode);
 }
+
+/**
+ * @test Test decode_png_hinted() box-filters large images while reading
+ *
+ * Left half opaque red; right half a checkerboard of transparent green
+ * and opaque blue, whose average must stay blue (alpha weighted) at half
+ * coverage. 203x101 into a 50x50 box reduces by 4 with partial edge
+ * boxes.
+ */
+CTEST(decoder_png, hinted_streams_reduced)
+{
+	image_t *img = image_create(203, 101);
+	ASSERT_NOT_NULL(img);
+	for (uint32_t y = 0; y < img->height; y++) {
+		for (uint32_t x = 0; x < img->width; x++) {
+			if (x < 100) {
+				image_set_pixel(img, x, y, 255, 0, 0, 255);
+
+			} else if ((x + y) % 2 == 0) {
+				image_set_pixel(img, x, y, 0, 255, 0, 0);
+
+			} else {
+				image_set_pixel(img, x, y, 0, 0, 255, 255);
+			}
+		}
+	}
+
+	size_t size = 0;
+	uint8_t *png = encode_png(img, ENCODER_PNG_LEVEL, &size);
+	image_destroy(img);
+	ASSERT_NOT_NULL(png);
+
+	int frame_count = 0;
+	image_t **frames = decode_png_hinted(png, size, &frame_count, 50, 50);
+	ASSERT_NOT_NULL(frames);
+	ASSERT_EQUAL(1, frame_count);
+	ASSERT_EQUAL(51, frames[0]->width);
+	ASSERT_EQUAL(26, frames[0]->height);
+
+	const uint8_t *p = image_get_pixel(frames[0], 0, 0);
+	ASSERT_EQUAL(255, p[0]);
+	ASSERT_EQUAL(0, p[2]);
+	ASSERT_EQUAL(255, p[3]);
+
+	p = image_get_pixel(frames[0], 30, 10);
+	ASSERT_EQUAL(0, p[0]);
+	ASSERT_EQUAL(0, p[1]);
+	ASSERT_EQUAL(255, p[2]);
+	ASSERT_EQUAL(128, p[3]);
+
+	/* Bottom right box covers 3x1 pixels, one of them opaque */
+	p = image_get_pixel(frames[0], 50, 25);
+	ASSERT_EQUAL(255, p[2]);
+	ASSERT_EQUAL(85, p[3]);
+
+	decoder_free_frames(frames, frame_count);
+
+	/* A box larger than the image decodes at full size */
+	frames = decode_png_hinted(png, size, &frame_count, 1000, 1000);
+	ASSERT_NOT_NULL(frames);
+	ASSERT_EQUAL(203, frames[0]->width);
+	ASSERT_EQUAL(101, frames[0]->height);
+	decoder_free_frames(frames, frame_count);
+
+	free(png);
+}
+
+/**
+ * @brief Growing memory buffer for png_set_write_fn()
+ */
+typedef struct {
+	uint8_t *data;
+	size_t size;
+	size_t capacity;
+} png_test_buffer;
+
+static void png_test_write(png_structp png_ptr, png_bytep data, size_t length)
+{
+	png_test_buffer *buf = (png_test_buffer *)png_get_io_ptr(png_ptr);
+	if (buf->size + length > buf->capacity) {
+		buf->capacity = (buf->size + length) * 2;
+		buf->data = realloc(buf->data, buf->capacity);
+	}
+	memcpy(buf->data + buf->size, data, length);
+	buf->size += length;
+}
+
+static void png_test_flush(png_structp png_ptr)
+{
+	(void)png_ptr;
+}
+
+/**
+ * @brief Encode an RGB image with pixel (x, y) = (x, y, x ^ y), Adam7 interlaced
+ */
+static uint8_t *encode_interlaced_png(uint32_t width, uint32_t height, size_t *out_size)
+{
+	png_test_buffer buf = { NULL, 0, 0 };
+	png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+	png_infop info_ptr = png_create_info_struct(png_ptr);
+	uint8_t *row = malloc((size_t)width * 3);
+
+	png_set_write_fn(png_ptr, &buf, png_test_write, png_test_flush);
+	png_set_IHDR(png_ptr, info_ptr, width, height, 8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_ADAM7, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+	png_write_info(png_ptr, info_ptr);
+
+	int passes = png_set_interlace_handling(png_ptr);
+	for (int pass = 0; pass < passes; pass++) {
+		for (uint32_t y = 0; y < height; y++) {
+			for (uint32_t x = 0; x < width; x++) {
+				row[x * 3 + 0] = (uint8_t)x;
+				row[x * 3 + 1] = (uint8_t)y;
+				row[x * 3 + 2] = (uint8_t)(x ^ y);
+			}
+			png_write_row(png_ptr, row);
+		}
+	}
+
+	png_write_end(png_ptr, NULL);
+	png_destroy_write_struct(&png_ptr, &info_ptr);
+	free(row);
+
+	*out_size = buf.size;
+	return buf.data;
+}
+
+/**
+ * @test Test decode_png_hinted() builds previews from the first Adam7 passes
+ *
+ * 61x37 reduces by 8 (pass 1), 4 (passes 1-3) and 2 (passes 1-5) for
+ * growing boxes; every preview pixel must be the source pixel at
+ * (factor * x, factor * y).
+ */
+CTEST(decoder_png, hinted_adam7_preview)
+{
+	size_t size = 0;
+	uint8_t *png = encode_interlaced_png(61, 37, &size);
+	ASSERT_NOT_NULL(png);
+	ASSERT_EQUAL(1, png[28]); /* IHDR interlace method: Adam7 */
+
+	const uint32_t boxes[3] = { 8, 16, 31 };
+	const uint32_t factors[3] = { 8, 4, 2 };
+
+	for (int i = 0; i < 3; i++) {
+		int frame_count = 0;
+		image_t **frames = decode_png_hinted(png, size, &frame_count, boxes[i], boxes[i]);
+		ASSERT_NOT_NULL(frames);
+		ASSERT_EQUAL(1, frame_count);
+
+		uint32_t factor = factors[i];
+		image_t *img = frames[0];
+		ASSERT_EQUAL((61 + factor - 1) / factor, img->width);
+		ASSERT_EQUAL((37 + factor - 1) / factor, img->height);
+		ASSERT_TRUE(img->opaque);
+
+		for (uint32_t y = 0; y < img->height; y++) {
+			for (uint32_t x = 0; x < img->width; x++) {
+				const uint8_t *p = image_get_pixel(img, x, y);
+				ASSERT_EQUAL(x * factor, p[0]);
+				ASSERT_EQUAL(y * factor, p[1]);
+				ASSERT_EQUAL((x * factor) ^ (y * factor), p[2]);
+				ASSERT_EQUAL(255, p[3]);
+			}
+		}
+
+		decoder_free_frames(frames, frame_count);
+	}
+
+	free(png);
+}
+
+/**
+ * @test Test plain terminal output reaches the Adam7 preview
+ *
+ * pipeline_set_decode_box() on a 16x5 terminal hints a 16x8 box, so
+ * pipeline_decode() builds a 61x37 image from Adam7 passes 1-3 (1/4).
+ */
+CTEST(decoder_png, terminal_hint_adam7_preview)
+{
+	size_t size = 0;
+	uint8_t *png = encode_interlaced_png(61, 37, &size);
+	ASSERT_NOT_NULL(png);
+
+	cli_options_t opts;
+	cli_options_init(&opts);
+	opts.terminal.cols = 16;
+	opts.terminal.rows = 5;
+	pipeline_set_decode_box(&opts);
+	ASSERT_EQUAL(16, opts.decode_box_width);
+	ASSERT_EQUAL(8, opts.decode_box_height);
+
+	decoder_registry_init(NULL);
+	image_t **frames = NULL;
+	int frame_count = 0;
+	ASSERT_EQUAL(0, pipeline_decode(&opts, png, size, &frames, &frame_count));
+	ASSERT_EQUAL(1, frame_count);
+	ASSERT_EQUAL(16, frames[0]->width);
+	ASSERT_EQUAL(10, frames[0]->height);
+
+	const uint8_t *p = image_get_pixel(frames[0], 7, 9);
+	ASSERT_EQUAL(28, p[0]);
+	ASSERT_EQUAL(36, p[1]);
+
+	decoder_free_frames(frames, frame_count);
+	free(png);
+}
@@ -0,0 +1,129 @@
+/**
+ * @file test_encoder.c
+ * @brief Unit tests for PNG and JPEG encoders
+ *
+ * Round-trips images through encode_png()/encode_jpeg() and the
+ * decoders to verify dimensions, colour type and pixel data.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../imgcat2/core/encoder.h"
+#include "../../imgcat2/core/image.h"
+#include "../../imgcat2/decoders/decoder.h"
+#include "../ctest.h"
+#include "../decoder_internal.h"
+
+/**
+ * @brief Create a test image with a gradient and optional alpha ramp
+ */
+static image_t *create_gradient(uint32_t width, uint32_t height, bool alpha)
+{
+	image_t *img = image_create(width, height);
+	if (img == NULL) {
+		return NULL;
+	}
+
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			image_set_pixel(img, x, y, (uint8_t)(x * 255 / width), (uint8_t)(y * 255 / height), 128, alpha ? (uint8_t)x : 255);
+		}
+	}
+
+	return img;
+}
+
+/**
+ * @test Test invalid parameters
+ */
+CTEST(encoder, invalid_parameters)
+{
+	size_t size = 0;
+	ASSERT_NULL(encode_png(NULL, ENCODER_PNG_LEVEL, &size));
+	ASSERT_NULL(encode_jpeg(NULL, ENCODER_JPEG_QUALITY, &size));
+}
+
+/**
+ * @test Test PNG round trip of an RGBA image is lossless
+ */
+CTEST(encoder, png_roundtrip_rgba)
+{
+	image_t *img = create_gradient(67, 31, true);
+	ASSERT_NOT_NULL(img);
+
+	size_t size = 0;
+	uint8_t *png = encode_png(img, ENCODER_PNG_LEVEL, &size);
+	ASSERT_NOT_NULL(png);
+	ASSERT_TRUE(size > 33);
+	ASSERT_EQUAL(6, png[25]); /* IHDR colour type: RGBA */
+
+	int frame_count = 0;
+	image_t **frames = decode_png(png, size, &frame_count);
+	ASSERT_NOT_NULL(frames);
+	ASSERT_EQUAL(1, frame_count);
+	ASSERT_EQUAL(67, frames[0]->width);
+	ASSERT_EQUAL(31, frames[0]->height);
+	ASSERT_DATA(img->pixels, (size_t)67 * 31 * 4, frames[0]->pixels, (size_t)67 * 31 * 4);
+
+	decoder_free_frames(frames, frame_count);
+	free(png);
+	image_destroy(img);
+}
+
+/**
+ * @test Test opaque images are written as RGB
+ */
+CTEST(encoder, png_opaque_is_rgb)
+{
+	image_t *img = create_gradient(16, 16, false);
+	ASSERT_NOT_NULL(img);
+
+	size_t size = 0;
+	uint8_t *png = encode_png(img, ENCODER_PNG_LEVEL, &size);
+	ASSERT_NOT_NULL(png);
+	ASSERT_EQUAL(2, png[25]); /* IHDR colour type: RGB */
+
+	int frame_count = 0;
+	image_t **frames = decode_png(png, size, &frame_count);
+	ASSERT_NOT_NULL(frames);
+	ASSERT_DATA(img->pixels, (size_t)16 * 16 * 4, frames[0]->pixels, (size_t)16 * 16 * 4);
+
+	decoder_free_frames(frames, frame_count);
+	free(png);
+	image_destroy(img);
+}
+
+/**
+ * @test Test JPEG encoding produces a decodable image of the same size
+ */
+CTEST(encoder, jpeg_roundtrip)
+{
+	image_t *img = create_gradient(50, 20, false);
+	ASSERT_NOT_NULL(img);
+
+	size_t size = 0;
+	uint8_t *jpeg = encode_jpeg(img, ENCODER_JPEG_QUALITY, &size);
+	ASSERT_NOT_NULL(jpeg);
+	ASSERT_TRUE(size > 2);
+	ASSERT_EQUAL(0xFF, jpeg[0]);
+	ASSERT_EQUAL(0xD8, jpeg[1]);
+
+	int frame_count = 0;
+	image_t **frames = decode_jpeg(jpeg, size, &frame_count);
+	ASSERT_NOT_NULL(frames);
+	ASSERT_EQUAL(50, frames[0]->width);
+	ASSERT_EQUAL(20, frames[0]->height);
+
+	/* Lossy, but a smooth gradient must stay close */
+	const uint8_t *p = image_get_pixel(frames[0], 25, 10);
+	ASSERT_INTERVAL(120, 135, p[0]);
+	ASSERT_INTERVAL(120, 140, p[1]);
+
+	decoder_free_frames(frames, frame_count);
+	free(jpeg);
+	image_destroy(img);
+}
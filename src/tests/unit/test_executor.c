@@ -0,0 +1,132 @@
+/**
+ * @file test_executor.c
+ * @brief Unit tests for the ordered pipelined executor
+ *
+ * Verifies that every item is prepared before it is emitted, that
+ * emission follows item order for any thread count, and that workers
+ * never run further ahead than the window allows, and how workers share
+ * the CPUs with nested parallel work.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <unistd.h>
+
+#include "../../imgcat2/core/executor.h"
+#include "../ctest.h"
+
+#define ITEM_COUNT 200
+
+/**
+ * @brief Shared test state
+ */
+typedef struct {
+	int prepared[ITEM_COUNT];
+	size_t order[ITEM_COUNT];
+	size_t emitted;
+	size_t window;
+	bool ok;
+} executor_test_t;
+
+static void test_prepare(size_t index, void *ctx)
+{
+	executor_test_t *t = (executor_test_t *)ctx;
+
+	/* Uneven work to shuffle completion order */
+	if (index % 7 == 0) {
+		usleep(200);
+	}
+
+	t->prepared[index] = (int)index + 1;
+}
+
+static void test_emit(size_t index, void *ctx)
+{
+	executor_test_t *t = (executor_test_t *)ctx;
+
+	if (t->prepared[index] != (int)index + 1) {
+		t->ok = false;
+	}
+
+	/* Items beyond the window must not have been started yet */
+	if (index + t->window < ITEM_COUNT && t->prepared[index + t->window] != 0) {
+		t->ok = false;
+	}
+
+	t->order[t->emitted++] = index;
+}
+
+static void run_with_threads(int threads)
+{
+	static executor_test_t t;
+	t = (executor_test_t) { .window = 4, .ok = true };
+
+	executor_run(ITEM_COUNT, threads, t.window, test_prepare, test_emit, &t);
+
+	ASSERT_TRUE(t.ok);
+	ASSERT_EQUAL(ITEM_COUNT, (int)t.emitted);
+	for (size_t i = 0; i < ITEM_COUNT; i++) {
+		ASSERT_EQUAL((int)i, (int)t.order[i]);
+	}
+}
+
+CTEST(executor, single_thread_in_order)
+{
+	run_with_threads(1);
+}
+
+CTEST(executor, many_threads_in_order)
+{
+	run_with_threads(8);
+}
+
+CTEST(executor, serial_without_threads)
+{
+	run_with_threads(0);
+}
+
+CTEST(executor, default_threads_in_range)
+{
+	int threads = executor_default_threads();
+
+	ASSERT_TRUE(threads >= 1);
+	ASSERT_TRUE(threads <= EXECUTOR_MAX_THREADS);
+}
+
+/**
+ * @brief Record executor_task_threads() as seen by each prepare step
+ */
+static void record_task_threads(size_t index, void *ctx)
+{
+	((int *)ctx)[index] = executor_task_threads();
+}
+
+static void emit_nothing(size_t index, void *ctx)
+{
+	(void)index;
+	(void)ctx;
+}
+
+CTEST(executor, task_threads_share_cpus)
+{
+	int cpus = executor_default_threads();
+	int seen[64];
+
+	/* Outside a worker every CPU is available */
+	ASSERT_EQUAL(cpus, executor_task_threads());
+
+	/* Two items on two workers split the CPUs */
+	executor_run(2, 2, 2, record_task_threads, emit_nothing, seen);
+	int half = cpus / 2 > 1 ? cpus / 2 : 1;
+	ASSERT_EQUAL(half, seen[0]);
+	ASSERT_EQUAL(half, seen[1]);
+
+	/* A worker per CPU leaves one thread each */
+	int threads = cpus < 64 ? cpus : 64;
+	executor_run(64, threads, 64, record_task_threads, emit_nothing, seen);
+	for (int i = 0; i < 64; i++) {
+		ASSERT_EQUAL(threads > 1 ? 1 : cpus, seen[i]);
+	}
+
+	ASSERT_EQUAL(cpus, executor_task_threads());
+}
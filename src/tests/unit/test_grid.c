@@ -0,0 +1,119 @@
+/**
+ * @file test_grid.c
+ * @brief Unit tests for the contact sheet (--grid) helpers
+ *
+ * Covers the automatic tile layout, label truncation and sanitizing,
+ * bitmap text drawing and the reduced-resolution decode factor.
+ */
+
+#include <string.h>
+
+#include "../../imgcat2/core/grid.h"
+#include "../../imgcat2/core/image.h"
+#include "../../imgcat2/decoders/decoder.h"
+#include "../ctest.h"
+
+CTEST(grid, single_image_uses_one_column)
+{
+	grid_layout_t layout;
+	ASSERT_EQUAL(0, grid_layout(1, 0, 80, 24, 1, 2, 1, &layout));
+	ASSERT_EQUAL(1, (int)layout.columns);
+	ASSERT_EQUAL(1, (int)layout.rows);
+	ASSERT_TRUE(layout.tile_rows + layout.label_rows <= 23);
+}
+
+CTEST(grid, auto_layout_fits_terminal)
+{
+	grid_layout_t layout;
+	ASSERT_EQUAL(0, grid_layout(12, 0, 160, 48, 10, 20, 1, &layout));
+
+	ASSERT_TRUE(layout.columns * layout.rows >= 12);
+	ASSERT_TRUE(layout.columns * layout.tile_cols + (layout.columns - 1) * GRID_GAP_CELLS <= 160);
+	ASSERT_TRUE(layout.rows * (layout.tile_rows + layout.label_rows) <= 47);
+	ASSERT_TRUE(layout.tile_cols >= GRID_MIN_TILE_CELLS);
+}
+
+CTEST(grid, explicit_columns)
+{
+	grid_layout_t layout;
+	ASSERT_EQUAL(0, grid_layout(10, 3, 80, 24, 1, 2, 1, &layout));
+	ASSERT_EQUAL(3, (int)layout.columns);
+	ASSERT_EQUAL(4, (int)layout.rows);
+	ASSERT_EQUAL(26, (int)layout.tile_cols);
+}
+
+CTEST(grid, too_many_images_scroll)
+{
+	grid_layout_t layout;
+	ASSERT_EQUAL(0, grid_layout(500, 0, 80, 24, 1, 2, 1, &layout));
+	ASSERT_TRUE(layout.tile_cols >= GRID_MIN_TILE_CELLS);
+	ASSERT_TRUE(layout.columns * layout.rows >= 500);
+	ASSERT_TRUE(layout.tile_rows >= 1);
+}
+
+CTEST(grid, invalid_layout)
+{
+	grid_layout_t layout;
+	ASSERT_EQUAL(-1, grid_layout(0, 0, 80, 24, 1, 2, 1, &layout));
+	ASSERT_EQUAL(-1, grid_layout(4, 0, 0, 24, 1, 2, 1, &layout));
+	ASSERT_EQUAL(-1, grid_layout(4, -1, 80, 24, 1, 2, 1, &layout));
+}
+
+CTEST(grid, label_basename_and_truncation)
+{
+	char label[64];
+
+	ASSERT_EQUAL(7, (int)grid_label("/tmp/dir/cat.png", 20, label, sizeof(label)));
+	ASSERT_STR("cat.png", label);
+
+	ASSERT_EQUAL(8, (int)grid_label("a_very_long_name.jpg", 8, label, sizeof(label)));
+	ASSERT_STR("a_ver...", label);
+
+	grid_label(NULL, 20, label, sizeof(label));
+	ASSERT_STR("(stdin)", label);
+}
+
+CTEST(grid, label_sanitizes_and_keeps_utf8)
+{
+	char label[64];
+
+	grid_label("bad\033[2Jname", 20, label, sizeof(label));
+	ASSERT_NULL(strchr(label, '\033'));
+
+	/* "\xc3\xa9" is one character */
+	ASSERT_EQUAL(5, (int)grid_label("caf\xc3\xa9.", 20, label, sizeof(label)));
+	ASSERT_EQUAL(4, (int)grid_label("\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9", 4, label, sizeof(label)));
+	ASSERT_STR("\xc3\xa9...", label);
+}
+
+CTEST(grid, draw_text_clips)
+{
+	image_t *img = image_create(8, 8);
+	ASSERT_TRUE(img != NULL);
+
+	const uint8_t white[4] = { 255, 255, 255, 255 };
+	grid_draw_text(img, 0, 0, 1, "I", white);
+
+	/* 'I' has a three pixel top bar and a single center column */
+	ASSERT_EQUAL(0, image_get_pixel(img, 0, 0)[3]);
+	ASSERT_EQUAL(255, image_get_pixel(img, 1, 0)[3]);
+	ASSERT_EQUAL(255, image_get_pixel(img, 2, 3)[3]);
+	ASSERT_EQUAL(0, image_get_pixel(img, 1, 3)[3]);
+
+	/* Drawing past the edges must not write out of bounds */
+	grid_draw_text(img, 6, 6, 3, "WWWW", white);
+
+	image_destroy(img);
+}
+
+CTEST(grid, hint_scale)
+{
+	/* 3000x2000 into a 300x300 box fits at 300x200: 1/8 gives 375x250 */
+	ASSERT_EQUAL(8, (int)decoder_hint_scale(3000, 2000, 300, 300, 8));
+	/* Box needs 750x500: 1/4 exactly */
+	ASSERT_EQUAL(4, (int)decoder_hint_scale(3000, 2000, 750, 750, 8));
+	/* Never reduce below the fit, nor without a hint */
+	ASSERT_EQUAL(1, (int)decoder_hint_scale(3000, 2000, 3000, 3000, 8));
+	ASSERT_EQUAL(1, (int)decoder_hint_scale(3000, 2000, 0, 0, 8));
+	ASSERT_EQUAL(2, (int)decoder_hint_scale(3000, 2000, 300, 300, 2));
+}
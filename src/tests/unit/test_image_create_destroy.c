@@ -342,3 +342,215 @@ CTEST(image, pixel_memory_layout)
 
 	image_destroy(img);
 }
+
+/**
+ * @test Test opaque detection
+ *
+ * Verifies that image_is_opaque() scans the alpha channel, including
+ * the trailing pixel of odd-sized images, and honours the opaque flag.
+ */
+CTEST(image, opaque_detection)
+{
+	image_t *img = image_create(37, 3);
+	ASSERT_NOT_NULL(img);
+
+	/* Freshly created images are transparent black */
+	ASSERT_FALSE(image_is_opaque(img));
+
+	for (uint32_t y = 0; y < img->height; y++) {
+		for (uint32_t x = 0; x < img->width; x++) {
+			image_set_pixel(img, x, y, 10, 20, 30, 255);
+		}
+	}
+	ASSERT_TRUE(image_is_opaque(img));
+
+	/* Last pixel of an odd pixel count (37 × 3 = 111) */
+	image_set_pixel(img, 36, 2, 10, 20, 30, 254);
+	ASSERT_FALSE(image_is_opaque(img));
+
+	/* Decoder-provided flag short-circuits the scan */
+	img->opaque = true;
+	ASSERT_TRUE(image_is_opaque(img));
+
+	image_destroy(img);
+}
+
+/** Release callback state for the adoption test */
+static int s_release_calls = 0;
+static uint8_t *s_released = NULL;
+
+static void count_release(void *ctx, uint8_t *pixels)
+{
+	s_release_calls += *(int *)ctx;
+	s_released = pixels;
+	free(pixels);
+}
+
+/**
+ * @test Test adopting an external pixel buffer
+ *
+ * Verifies that image_adopt() uses the buffer without copying it, that
+ * image_destroy() hands it to the release callback exactly once, and
+ * that a failed adoption leaves the buffer with the caller.
+ */
+CTEST(image, adopt_external_buffer)
+{
+	uint8_t *pixels = malloc(4 * 3 * 4);
+	ASSERT_TRUE(pixels != NULL);
+	memset(pixels, 0x7F, 4 * 3 * 4);
+
+	int increment = 1;
+	image_t *img = image_adopt(4, 3, IMAGE_FORMAT_RGBA8, pixels, 0, count_release, &increment);
+	ASSERT_NOT_NULL(img);
+	ASSERT_TRUE(img->pixels == pixels);
+	ASSERT_EQUAL(0x7F, img->pixels[0]);
+
+	image_destroy(img);
+	ASSERT_EQUAL(1, s_release_calls);
+	ASSERT_TRUE(s_released == pixels);
+
+	/* Invalid dimensions: caller keeps ownership */
+	uint8_t *other = malloc(16);
+	ASSERT_TRUE(other != NULL);
+	ASSERT_NULL(image_adopt(0, 1, IMAGE_FORMAT_RGBA8, other, 0, count_release, &increment));
+	ASSERT_EQUAL(1, s_release_calls);
+	free(other);
+
+	/* NULL release falls back to free() */
+	uint8_t *owned = malloc(2 * 2 * 4);
+	ASSERT_TRUE(owned != NULL);
+	img = image_adopt(2, 2, IMAGE_FORMAT_RGBA8, owned, 0, NULL, NULL);
+	ASSERT_NOT_NULL(img);
+	image_destroy(img);
+}
+
+/**
+ * @test Test uninitialized image creation
+ *
+ * Verifies that image_create_uninit() validates dimensions like
+ * image_create() and returns a writable buffer.
+ */
+CTEST(image, create_uninit)
+{
+	ASSERT_NULL(image_create_uninit(0, 10));
+	ASSERT_NULL(image_create_uninit(IMAGE_MAX_DIMENSION + 1, 1));
+
+	image_t *img = image_create_uninit(8, 8);
+	ASSERT_NOT_NULL(img);
+	ASSERT_EQUAL(8, (int)img->width);
+	ASSERT_FALSE(img->opaque);
+
+	memset(img->pixels, 0xFF, 8 * 8 * 4);
+	ASSERT_TRUE(image_is_opaque(img));
+
+	image_destroy(img);
+}
+
+/**
+ * @test Test views into another image
+ *
+ * Verifies that image_view() shares the parent's pixels and stride,
+ * rejects rectangles outside the parent, and that destroying a view
+ * leaves the parent's buffer alone.
+ */
+CTEST(image, view_shares_pixels)
+{
+	image_t *parent = image_create(6, 4);
+	ASSERT_NOT_NULL(parent);
+	image_set_pixel(parent, 3, 2, 10, 20, 30, 40);
+
+	image_t *view = image_view(parent, 2, 1, 3, 3);
+	ASSERT_NOT_NULL(view);
+	ASSERT_EQUAL(3, (int)view->width);
+	ASSERT_EQUAL(6 * 4, (int)view->stride);
+	ASSERT_FALSE(image_is_packed(view));
+	ASSERT_TRUE(view->parent == parent);
+
+	/* (3,2) in the parent is (1,1) in the view */
+	uint8_t *pixel = image_get_pixel(view, 1, 1);
+	ASSERT_TRUE(pixel == image_get_pixel(parent, 3, 2));
+	ASSERT_EQUAL(30, pixel[2]);
+
+	/* Writes go to the parent */
+	image_set_pixel(view, 2, 2, 1, 2, 3, 4);
+	ASSERT_EQUAL(4, image_get_pixel(parent, 4, 3)[3]);
+
+	/* Views of views refer to the owner */
+	image_t *inner = image_view(view, 1, 1, 1, 1);
+	ASSERT_NOT_NULL(inner);
+	ASSERT_TRUE(inner->parent == parent);
+	ASSERT_EQUAL(10, image_get_pixel(inner, 0, 0)[0]);
+	image_destroy(inner);
+
+	ASSERT_NULL(image_view(parent, 4, 0, 3, 1));
+	ASSERT_NULL(image_view(parent, 0, 4, 1, 1));
+	ASSERT_NULL(image_view(parent, 0, 0, 0, 1));
+
+	image_destroy(view);
+	ASSERT_EQUAL(10, image_get_pixel(parent, 3, 2)[0]);
+	image_destroy(parent);
+}
+
+/**
+ * @test Test images with padded rows
+ *
+ * Verifies that adopting a buffer with a row stride keeps it, that the
+ * padding is ignored by image_is_opaque() and by scaling, and that a too
+ * small stride is rejected.
+ */
+CTEST(image, padded_rows)
+{
+	/* 3x2 image with 4 bytes of padding per row, padding transparent */
+	size_t stride = 3 * 4 + 4;
+	uint8_t *pixels = calloc(stride * 2, 1);
+	ASSERT_TRUE(pixels != NULL);
+	for (int y = 0; y < 2; y++) {
+		memset(pixels + y * stride, 0xFF, 3 * 4);
+	}
+
+	ASSERT_NULL(image_adopt(3, 2, IMAGE_FORMAT_RGBA8, pixels, 3 * 4 - 1, NULL, NULL));
+
+	image_t *img = image_adopt(3, 2, IMAGE_FORMAT_RGBA8, pixels, stride, NULL, NULL);
+	ASSERT_NOT_NULL(img);
+	ASSERT_EQUAL((int)stride, (int)img->stride);
+	ASSERT_TRUE(image_row(img, 1) == pixels + stride);
+	ASSERT_TRUE(image_is_opaque(img));
+
+	image_t *scaled = image_scale_resize(img, 6, 4);
+	ASSERT_NOT_NULL(scaled);
+	ASSERT_TRUE(image_is_packed(scaled));
+	ASSERT_TRUE(image_is_opaque(scaled));
+
+	image_destroy(scaled);
+	image_destroy(img);
+}
+
+/**
+ * @test Test scaling into a view
+ *
+ * Verifies that image_scale_into() fills only the view's rectangle of
+ * its parent.
+ */
+CTEST(image, scale_into_view)
+{
+	image_t *src = image_create(8, 8);
+	image_t *dst = image_create(6, 6);
+	ASSERT_NOT_NULL(src);
+	ASSERT_NOT_NULL(dst);
+	memset(src->pixels, 0xFF, 8 * 8 * 4);
+
+	image_t *view = image_view(dst, 2, 2, 2, 2);
+	ASSERT_NOT_NULL(view);
+	ASSERT_EQUAL(0, image_scale_into(src, view));
+	image_destroy(view);
+
+	for (uint32_t y = 0; y < 6; y++) {
+		for (uint32_t x = 0; x < 6; x++) {
+			bool inside = x >= 2 && x < 4 && y >= 2 && y < 4;
+			ASSERT_EQUAL(inside ? 255 : 0, image_get_pixel(dst, x, y)[3]);
+		}
+	}
+
+	image_destroy(src);
+	image_destroy(dst);
+}
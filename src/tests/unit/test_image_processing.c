@@ -307,3 +307,81 @@ CTEST(image_proc, calculate_size_overflow)
 	result = image_calculate_size(20000, 20000, &size);
 	ASSERT_FALSE(result); /* 400M pixels > 100M limit */
 }
+
+/**
+ * @test Test scaling images stored in native pixel formats
+ *
+ * Verifies that gray, RGB, 16-bit and float images scale to opaque (or
+ * correctly translucent) RGBA8 output with the expected channel values.
+ */
+CTEST(image_proc, scale_native_formats)
+{
+	/* Gray: 8x8 of value 100 */
+	image_t *gray = image_create_format(8, 8, IMAGE_FORMAT_GRAY8);
+	ASSERT_NOT_NULL(gray);
+	ASSERT_EQUAL(8, (int)gray->stride);
+	ASSERT_TRUE(gray->opaque);
+	memset(gray->pixels, 100, 8 * 8);
+
+	image_t *scaled = image_scale_resize(gray, 4, 4);
+	ASSERT_NOT_NULL(scaled);
+	ASSERT_EQUAL(IMAGE_FORMAT_RGBA8, scaled->format);
+	ASSERT_TRUE(scaled->opaque);
+	uint8_t *p = image_get_pixel(scaled, 2, 2);
+	ASSERT_INTERVAL(99, 101, p[0]);
+	ASSERT_EQUAL(p[0], p[2]);
+	ASSERT_EQUAL(255, p[3]);
+	image_destroy(scaled);
+	image_destroy(gray);
+
+	/* RGB: pure red */
+	image_t *rgb = image_create_format(6, 4, IMAGE_FORMAT_RGB8);
+	ASSERT_NOT_NULL(rgb);
+	for (size_t i = 0; i < 6 * 4; i++) {
+		rgb->pixels[i * 3 + 0] = 255;
+		rgb->pixels[i * 3 + 1] = 0;
+		rgb->pixels[i * 3 + 2] = 0;
+	}
+	scaled = image_scale_fit(rgb, 3, 3);
+	ASSERT_NOT_NULL(scaled);
+	ASSERT_EQUAL(3, (int)scaled->width);
+	ASSERT_EQUAL(2, (int)scaled->height);
+	p = image_get_pixel(scaled, 1, 1);
+	ASSERT_EQUAL(255, p[0]);
+	ASSERT_EQUAL(0, p[1]);
+	ASSERT_EQUAL(255, p[3]);
+	image_destroy(scaled);
+	image_destroy(rgb);
+
+	/* RGBA16: half-transparent white keeps the high byte */
+	image_t *wide = image_create_format(4, 4, IMAGE_FORMAT_RGBA16);
+	ASSERT_NOT_NULL(wide);
+	ASSERT_FALSE(wide->opaque);
+	uint16_t *words = (uint16_t *)wide->pixels;
+	for (size_t i = 0; i < 4 * 4; i++) {
+		words[i * 4 + 0] = words[i * 4 + 1] = words[i * 4 + 2] = 0xFFFF;
+		words[i * 4 + 3] = 0x8000;
+	}
+	ASSERT_FALSE(image_is_opaque(wide));
+	scaled = image_scale_resize(wide, 2, 2);
+	ASSERT_NOT_NULL(scaled);
+	p = image_get_pixel(scaled, 0, 0);
+	ASSERT_INTERVAL(0x7F, 0x80, p[3]);
+	image_destroy(scaled);
+	image_destroy(wide);
+
+	/* Float: values above 1.0 clamp to white, negative to black */
+	image_t *hdr = image_create_format(2, 1, IMAGE_FORMAT_RGBF);
+	ASSERT_NOT_NULL(hdr);
+	float values[6] = { 4.0f, 1.0f, 0.5f, -1.0f, 0.0f, 0.0f };
+	memcpy(hdr->pixels, values, sizeof(values));
+	image_t *rgba = image_convert_rgba8(hdr);
+	ASSERT_NOT_NULL(rgba);
+	ASSERT_EQUAL(255, image_get_pixel(rgba, 0, 0)[0]);
+	ASSERT_EQUAL(255, image_get_pixel(rgba, 0, 0)[1]);
+	ASSERT_EQUAL(127, image_get_pixel(rgba, 0, 0)[2]);
+	ASSERT_EQUAL(0, image_get_pixel(rgba, 1, 0)[0]);
+	ASSERT_TRUE(rgba->opaque);
+	image_destroy(rgba);
+	image_destroy(hdr);
+}
@@ -0,0 +1,350 @@
+/**
+ * @file test_kitty.c
+ * @brief Unit tests for the Kitty graphics protocol output
+ *
+ * Renders small images with kitty_render() into a captured stdout and
+ * checks the escapes a terminal would receive: the m=1/m=0 split into
+ * 4096-character base64 chunks, the f=24 RGB payload of opaque images
+ * (also from strided views), and the Unicode placeholder cells of tmux
+ * virtual placements with their row/column diacritics and image id
+ * colour.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../imgcat2/core/cli.h"
+#include "../../imgcat2/core/image.h"
+#include "../../imgcat2/terminal/kitty.h"
+#include "../ctest.h"
+
+/** Base64 characters per escape, from the protocol */
+#define CHUNK_SIZE 4096
+
+/** UTF-8 of U+10EEEE, the placeholder cell */
+#define PLACEHOLDER "\xF4\x8E\xBB\xAE"
+
+/**
+ * @brief Render with kitty_render() and return what was written to stdout
+ *
+ * @param img Image to render
+ * @param opts Options (terminal description)
+ * @param out_len Output: number of bytes captured
+ *
+ * @return Allocated, null-terminated output, or NULL on error
+ */
+static char *capture_render(image_t *img, const cli_options_t *opts, size_t *out_len)
+{
+	char path[] = "/tmp/imgcat2_test_kitty_XXXXXX";
+	int fd = mkstemp(path);
+	if (fd < 0) {
+		return NULL;
+	}
+	unlink(path);
+
+	fflush(stdout);
+	int saved_stdout = dup(STDOUT_FILENO);
+	dup2(fd, STDOUT_FILENO);
+
+	int result = kitty_render(&img, 1, opts);
+
+	fflush(stdout);
+	dup2(saved_stdout, STDOUT_FILENO);
+	close(saved_stdout);
+
+	off_t size = lseek(fd, 0, SEEK_END);
+	char *out = result == 0 && size > 0 ? malloc((size_t)size + 1) : NULL;
+	if (out != NULL && pread(fd, out, (size_t)size, 0) == (ssize_t)size) {
+		out[size] = '\0';
+		*out_len = (size_t)size;
+
+	} else {
+		free(out);
+		out = NULL;
+	}
+	close(fd);
+
+	return out;
+}
+
+/**
+ * @brief Decode base64 without padding checks
+ *
+ * @return Number of bytes written to out
+ */
+static size_t base64_decode(const char *in, size_t len, uint8_t *out)
+{
+	size_t n = 0;
+	uint32_t bits = 0;
+	int count = 0;
+
+	for (size_t i = 0; i < len && in[i] != '='; i++) {
+		char c = in[i];
+		uint32_t v = c >= 'A' && c <= 'Z' ? (uint32_t)(c - 'A') :
+			c >= 'a' && c <= 'z' ? (uint32_t)(c - 'a' + 26) :
+			c >= '0' && c <= '9' ? (uint32_t)(c - '0' + 52) :
+			c == '+' ? 62 : 63;
+
+		bits = (bits << 6) | v;
+		count += 6;
+		if (count >= 8) {
+			count -= 8;
+			out[n++] = (uint8_t)(bits >> count);
+		}
+	}
+
+	return n;
+}
+
+/**
+ * @brief Opaque image of noise (incompressible, so no o=z)
+ */
+static image_t *make_noise(uint32_t width, uint32_t height)
+{
+	image_t *img = image_create(width, height);
+	if (img == NULL) {
+		return NULL;
+	}
+
+	uint32_t state = 0x12345678u;
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			image_set_pixel(img, x, y, (uint8_t)state, (uint8_t)(state >> 8), (uint8_t)(state >> 16), 255);
+		}
+	}
+
+	return img;
+}
+
+/**
+ * @brief Options for a remote Kitty session (direct transmission only)
+ */
+static void kitty_options(cli_options_t *opts)
+{
+	cli_options_init(opts);
+	opts->silent = true;
+	opts->terminal.rows = 24;
+	opts->terminal.cols = 80;
+	opts->terminal.width = 800;
+	opts->terminal.height = 480;
+	opts->terminal.is_kitty = true;
+	opts->terminal.has_kitty = true;
+	opts->terminal.is_remote = true;
+}
+
+/**
+ * @brief Split a direct transmission into chunks and reassemble the payload
+ *
+ * Checks that every chunk but the last is m=1 with exactly CHUNK_SIZE
+ * characters, the last one is m=0, and only the first carries the
+ * control keys.
+ *
+ * @param out Captured output
+ * @param control Expected control keys of the first chunk
+ * @param payload Output: decoded payload
+ * @param chunks Output: number of chunks
+ *
+ * @return Payload size, or 0 if the output is malformed
+ */
+static size_t parse_chunks(const char *out, const char *control, uint8_t *payload, int *chunks)
+{
+	size_t size = 0;
+	*chunks = 0;
+
+	const char *p = out;
+	while ((p = strstr(p, "\033_G")) != NULL) {
+		p += 3;
+		const char *data = strchr(p, ';');
+		const char *end = strstr(p, "\033\\");
+		if (data == NULL || end == NULL || data > end) {
+			return 0;
+		}
+		data++;
+
+		/* First chunk: "<control>,m=N;", then "m=N;" */
+		size_t control_len = strlen(control);
+		if (*chunks == 0) {
+			if (strncmp(p, control, control_len) != 0 || p[control_len] != ',') {
+				return 0;
+			}
+			p += control_len + 1;
+		}
+
+		bool more = strncmp(p, "m=1;", 4) == 0;
+		if (!more && strncmp(p, "m=0;", 4) != 0) {
+			return 0;
+		}
+
+		size_t len = (size_t)(end - data);
+		if ((more && len != CHUNK_SIZE) || len > CHUNK_SIZE) {
+			return 0;
+		}
+
+		size += base64_decode(data, len, payload + size);
+		(*chunks)++;
+		p = end + 2;
+
+		if (!more) {
+			break;
+		}
+	}
+
+	return size;
+}
+
+/**
+ * @test Test m=1/m=0 chunking and the f=24 RGB payload of an opaque image
+ *
+ * 64x40 RGB is 7680 bytes: two full 4096-character chunks (3072 bytes
+ * each) and a final 2048-character one. The image is a view into a
+ * wider one, so the rows have to be packed.
+ */
+CTEST(kitty, rgb_chunks)
+{
+	image_t *parent = make_noise(80, 48);
+	ASSERT_NOT_NULL(parent);
+	image_t *img = image_view(parent, 5, 3, 64, 40);
+	ASSERT_NOT_NULL(img);
+	ASSERT_FALSE(image_is_packed(img));
+
+	cli_options_t opts;
+	kitty_options(&opts);
+
+	size_t len = 0;
+	char *out = capture_render(img, &opts, &len);
+	ASSERT_NOT_NULL(out);
+
+	uint8_t *payload = malloc(64 * 40 * 4);
+	ASSERT_NOT_NULL(payload);
+
+	int chunks = 0;
+	size_t size = parse_chunks(out, "a=T,f=24,s=64,v=40,t=d", payload, &chunks);
+	ASSERT_EQUAL(64 * 40 * 3, (int)size);
+	ASSERT_EQUAL(3, chunks);
+
+	/* Alpha dropped, rows packed */
+	bool match = true;
+	for (uint32_t y = 0; y < 40 && match; y++) {
+		for (uint32_t x = 0; x < 64; x++) {
+			const uint8_t *pixel = image_get_pixel(img, x, y);
+			if (memcmp(pixel, &payload[((size_t)y * 64 + x) * 3], 3) != 0) {
+				match = false;
+				break;
+			}
+		}
+	}
+	ASSERT_TRUE(match);
+
+	free(payload);
+	free(out);
+	image_destroy(img);
+	image_destroy(parent);
+}
+
+/**
+ * @test Test a payload of exactly two chunks ends with a full m=0 chunk
+ *
+ * 64x32 RGB is 6144 bytes = 2 x 3072; the final chunk carries data
+ * rather than an empty m=0 escape after a full m=1 one.
+ */
+CTEST(kitty, exact_chunk_multiple)
+{
+	image_t *img = make_noise(64, 32);
+	ASSERT_NOT_NULL(img);
+
+	cli_options_t opts;
+	kitty_options(&opts);
+
+	size_t len = 0;
+	char *out = capture_render(img, &opts, &len);
+	ASSERT_NOT_NULL(out);
+
+	uint8_t *payload = malloc(64 * 32 * 4);
+	ASSERT_NOT_NULL(payload);
+
+	int chunks = 0;
+	size_t size = parse_chunks(out, "a=T,f=24,s=64,v=32,t=d", payload, &chunks);
+	ASSERT_EQUAL(64 * 32 * 3, (int)size);
+	ASSERT_EQUAL(2, chunks);
+	ASSERT_TRUE(strstr(out, "m=0;\033\\") == NULL);
+
+	free(payload);
+	free(out);
+	image_destroy(img);
+}
+
+/**
+ * @brief Parse the i= image id of a virtual placement
+ */
+static uint32_t placement_id(const char *out)
+{
+	const char *id = strstr(out, ",U=1,i=");
+	return id != NULL ? (uint32_t)strtoul(id + 7, NULL, 10) : 0;
+}
+
+/**
+ * @test Test placeholder cells of a virtual placement under tmux
+ *
+ * A 30x40 image on 10x20 pixel cells covers 3x2 cells. Each cell is
+ * U+10EEEE followed by the diacritics of its row and column (U+0305,
+ * U+030D, U+030E for 0, 1, 2), and each row is coloured with the image
+ * id as a 24-bit foreground.
+ */
+CTEST(kitty, placeholders)
+{
+	image_t *img = make_noise(30, 40);
+	ASSERT_NOT_NULL(img);
+
+	cli_options_t opts;
+	kitty_options(&opts);
+	opts.terminal.is_tmux = true;
+
+	size_t len = 0;
+	char *out = capture_render(img, &opts, &len);
+	ASSERT_NOT_NULL(out);
+
+	/* Transmitted once through DCS passthrough as a virtual placement */
+	const char *prefix = "\033Ptmux;\033\033_Ga=T,f=24,s=30,v=40,U=1,i=";
+	ASSERT_TRUE(strncmp(out, prefix, strlen(prefix)) == 0);
+	ASSERT_TRUE(strstr(out, ",c=3,r=2,q=2,t=d,m=1;") != NULL);
+
+	uint32_t id = placement_id(out);
+	ASSERT_TRUE(id >= 1 && id <= 0xFFFFFF);
+
+	char color[32];
+	snprintf(color, sizeof(color), "\033[38;2;%u;%u;%um", (id >> 16) & 0xFF, (id >> 8) & 0xFF, id & 0xFF);
+
+	char expected[256];
+	snprintf(expected, sizeof(expected),
+		"%s" PLACEHOLDER "\xCC\x85\xCC\x85" PLACEHOLDER "\xCC\x85\xCC\x8D" PLACEHOLDER "\xCC\x85\xCC\x8E\033[39m\n"
+		"%s" PLACEHOLDER "\xCC\x8D\xCC\x85" PLACEHOLDER "\xCC\x8D\xCC\x8D" PLACEHOLDER "\xCC\x8D\xCC\x8E\033[39m\n",
+		color, color);
+
+	/* Cells follow the last chunk's passthrough terminator */
+	const char *cells = strstr(out, color);
+	ASSERT_NOT_NULL(cells);
+	ASSERT_TRUE(cells - out >= 4 && strncmp(cells - 4, "\033\\\033\\", 4) == 0);
+	ASSERT_STR(expected, cells);
+
+	/* Ids follow the content: the same image keeps its id, another one gets a new one */
+	char *again = capture_render(img, &opts, &len);
+	ASSERT_NOT_NULL(again);
+	ASSERT_EQUAL(id, placement_id(again));
+	free(again);
+
+	image_set_pixel(img, 0, 0, 1, 2, 3, 255);
+	char *other = capture_render(img, &opts, &len);
+	ASSERT_NOT_NULL(other);
+	ASSERT_TRUE(placement_id(other) != id);
+	free(other);
+
+	free(out);
+	image_destroy(img);
+}
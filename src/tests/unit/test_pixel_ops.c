@@ -0,0 +1,132 @@
+/**
+ * @file test_pixel_ops.c
+ * @brief Unit tests for the pixel conversion kernels
+ *
+ * Every instruction set the CPU supports must produce exactly what the
+ * scalar kernels produce, for lengths around each SIMD block size.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../imgcat2/core/pixel_ops.h"
+#include "../ctest.h"
+
+/** Longest row tested (covers several blocks plus every tail length) */
+#define TEST_PIXELS 70
+
+typedef void (*kernel_t)(const uint8_t *src, uint8_t *dst, size_t count);
+
+/**
+ * @brief Compare a kernel under isa against the scalar kernel
+ *
+ * Output buffers are pre-filled with a marker so writes past count show up.
+ */
+static bool kernel_matches_scalar(pixel_isa_t isa, kernel_t kernel)
+{
+	uint8_t src[TEST_PIXELS * 4];
+	uint8_t expected[TEST_PIXELS * 4 + 16];
+	uint8_t actual[TEST_PIXELS * 4 + 16];
+
+	for (size_t i = 0; i < sizeof(src); i++) {
+		src[i] = (uint8_t)(i * 37 + 11);
+	}
+
+	for (size_t count = 0; count <= TEST_PIXELS; count++) {
+		memset(expected, 0xA5, sizeof(expected));
+		memset(actual, 0xA5, sizeof(actual));
+
+		pixel_ops_select(PIXEL_ISA_SCALAR);
+		kernel(src, expected, count);
+		pixel_ops_select(isa);
+		kernel(src, actual, count);
+
+		if (memcmp(expected, actual, sizeof(actual)) != 0) {
+			fprintf(stderr, "%s mismatch at %zu pixels\n", pixel_isa_name(isa), count);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @test Scalar kernels produce the documented layouts
+ */
+CTEST(pixel_ops, scalar_layouts)
+{
+	ASSERT_TRUE(pixel_ops_select(PIXEL_ISA_SCALAR));
+
+	const uint8_t bgr[6] = { 1, 2, 3, 4, 5, 6 };
+	uint8_t rgba[8];
+	pixel_bgr_to_rgba(bgr, rgba, 2);
+	const uint8_t bgr_expected[8] = { 3, 2, 1, 255, 6, 5, 4, 255 };
+	ASSERT_DATA(bgr_expected, 8, rgba, 8);
+
+	pixel_rgb_to_rgba(bgr, rgba, 2);
+	const uint8_t rgb_expected[8] = { 1, 2, 3, 255, 4, 5, 6, 255 };
+	ASSERT_DATA(rgb_expected, 8, rgba, 8);
+
+	const uint8_t gray[2] = { 7, 200 };
+	pixel_gray_to_rgba(gray, rgba, 2);
+	const uint8_t gray_expected[8] = { 7, 7, 7, 255, 200, 200, 200, 255 };
+	ASSERT_DATA(gray_expected, 8, rgba, 8);
+
+	/* In place */
+	uint8_t bgra[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	pixel_bgra_to_rgba(bgra, bgra, 2);
+	const uint8_t bgra_expected[8] = { 3, 2, 1, 4, 7, 6, 5, 8 };
+	ASSERT_DATA(bgra_expected, 8, bgra, 8);
+
+	uint8_t rgb[6];
+	pixel_rgba_to_rgb(bgra_expected, rgb, 2);
+	const uint8_t rgba_expected[6] = { 3, 2, 1, 7, 6, 5 };
+	ASSERT_DATA(rgba_expected, 6, rgb, 6);
+
+	/* 0xAABBGGRR words */
+	uint32_t abgr[2] = { 0x80332211u, 0xFF665544u };
+	pixel_abgr32_to_rgba(abgr, (uint8_t *)abgr, 2);
+	const uint8_t abgr_expected[8] = { 0x11, 0x22, 0x33, 0x80, 0x44, 0x55, 0x66, 0xFF };
+	ASSERT_DATA(abgr_expected, 8, (const uint8_t *)abgr, 8);
+
+	pixel_ops_init();
+}
+
+/**
+ * @test Every supported instruction set matches the scalar kernels
+ */
+CTEST(pixel_ops, simd_matches_scalar)
+{
+	const pixel_isa_t isas[] = { PIXEL_ISA_SSSE3, PIXEL_ISA_AVX2, PIXEL_ISA_NEON };
+
+	for (size_t i = 0; i < sizeof(isas) / sizeof(isas[0]); i++) {
+		if (!pixel_ops_select(isas[i])) {
+			continue;
+		}
+
+		ASSERT_TRUE(kernel_matches_scalar(isas[i], pixel_rgb_to_rgba));
+		ASSERT_TRUE(kernel_matches_scalar(isas[i], pixel_bgr_to_rgba));
+		ASSERT_TRUE(kernel_matches_scalar(isas[i], pixel_gray_to_rgba));
+		ASSERT_TRUE(kernel_matches_scalar(isas[i], pixel_bgra_to_rgba));
+		ASSERT_TRUE(kernel_matches_scalar(isas[i], pixel_rgba_to_rgb));
+	}
+
+	pixel_ops_init();
+}
+
+/**
+ * @test The detected instruction set can always be selected
+ */
+CTEST(pixel_ops, init_selects_detected)
+{
+	pixel_ops_init();
+	ASSERT_EQUAL(pixel_ops_detect(), pixel_ops_active());
+	ASSERT_TRUE(pixel_ops_select(PIXEL_ISA_SCALAR));
+	ASSERT_EQUAL(PIXEL_ISA_SCALAR, pixel_ops_active());
+	ASSERT_STR("scalar", pixel_isa_name(PIXEL_ISA_SCALAR));
+
+	pixel_ops_init();
+}
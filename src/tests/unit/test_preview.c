@@ -0,0 +1,163 @@
+/**
+ * @file test_preview.c
+ * @brief Unit tests for the previewer coprocess protocol
+ *
+ * Tests request line parsing and the sticky cancellation state.
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../imgcat2/core/cancel.h"
+#include "../../imgcat2/core/executor.h"
+#include "../../imgcat2/core/preview.h"
+#include "../ctest.h"
+
+/** Number of times the test cancellation check was called */
+static int check_calls = 0;
+
+/**
+ * @brief Cancellation check reporting the value behind ctx
+ */
+static bool test_check(void *ctx)
+{
+	check_calls++;
+	return *(bool *)ctx;
+}
+
+CTEST(preview, parse_placed_request)
+{
+	char line[] = "/tmp/some image.png\t10\t2\t40\t20";
+	preview_request_t req;
+
+	ASSERT_EQUAL(0, preview_parse_request(line, &req));
+	ASSERT_STR("/tmp/some image.png", req.path);
+	ASSERT_TRUE(req.placed);
+	ASSERT_EQUAL(10, req.x);
+	ASSERT_EQUAL(2, req.y);
+	ASSERT_EQUAL(40, req.width);
+	ASSERT_EQUAL(20, req.height);
+}
+
+CTEST(preview, parse_path_only)
+{
+	char line[] = "photo.jpg";
+	preview_request_t req;
+
+	ASSERT_EQUAL(0, preview_parse_request(line, &req));
+	ASSERT_STR("photo.jpg", req.path);
+	ASSERT_FALSE(req.placed);
+}
+
+CTEST(preview, parse_clear)
+{
+	char line[] = "";
+	preview_request_t req;
+
+	ASSERT_EQUAL(0, preview_parse_request(line, &req));
+	ASSERT_STR("", req.path);
+	ASSERT_FALSE(req.placed);
+}
+
+CTEST(preview, parse_malformed)
+{
+	char missing[] = "a.png\t1\t2\t3";
+	char extra[] = "a.png\t1\t2\t3\t4\t5";
+	char not_number[] = "a.png\t1\tx\t3\t4";
+	char negative[] = "a.png\t1\t2\t-3\t4";
+	char empty_area[] = "a.png\t1\t2\t0\t4";
+	preview_request_t req;
+
+	ASSERT_EQUAL(-1, preview_parse_request(missing, &req));
+	ASSERT_EQUAL(-1, preview_parse_request(extra, &req));
+	ASSERT_EQUAL(-1, preview_parse_request(not_number, &req));
+	ASSERT_EQUAL(-1, preview_parse_request(negative, &req));
+	ASSERT_EQUAL(-1, preview_parse_request(empty_area, &req));
+}
+
+CTEST(preview, cancel_is_sticky_until_reset)
+{
+	bool stale = false;
+
+	ASSERT_FALSE(cancel_requested());
+
+	cancel_set_check(test_check, &stale);
+	check_calls = 0;
+	ASSERT_FALSE(cancel_requested());
+	ASSERT_EQUAL(1, check_calls);
+
+	stale = true;
+	ASSERT_TRUE(cancel_requested());
+
+	/* Stays cancelled without asking again */
+	stale = false;
+	ASSERT_TRUE(cancel_requested());
+	ASSERT_EQUAL(2, check_calls);
+
+	cancel_reset();
+	ASSERT_FALSE(cancel_requested());
+
+	cancel_set_check(NULL, NULL);
+	ASSERT_FALSE(cancel_requested());
+}
+
+/** Callbacks currently running, and the most ever seen at once */
+static atomic_int check_inside = 0;
+static atomic_int check_inside_max = 0;
+
+/**
+ * @brief Slow cancellation check recording how many threads run it
+ */
+static bool test_check_concurrent(void *ctx)
+{
+	int inside = atomic_fetch_add(&check_inside, 1) + 1;
+	int seen = atomic_load(&check_inside_max);
+	while (inside > seen && !atomic_compare_exchange_weak(&check_inside_max, &seen, inside)) {
+	}
+
+	usleep(200);
+	bool stale = atomic_fetch_add((atomic_int *)ctx, 1) >= 5;
+
+	atomic_fetch_sub(&check_inside, 1);
+	return stale;
+}
+
+/**
+ * @brief Worker step polling like a TIFF band
+ */
+static void poll_cancel(size_t index, void *ctx)
+{
+	(void)index;
+	(void)ctx;
+	for (int i = 0; i < 50; i++) {
+		cancel_requested();
+	}
+}
+
+/**
+ * @brief Emit step doing nothing
+ */
+static void emit_nothing(size_t index, void *ctx)
+{
+	(void)index;
+	(void)ctx;
+}
+
+CTEST(preview, cancel_check_never_concurrent)
+{
+	atomic_int calls = 0;
+
+	cancel_set_check(test_check_concurrent, &calls);
+	executor_run(64, 8, 64, poll_cancel, emit_nothing, NULL);
+
+	/* One thread at a time, and never again after the sixth call said stale */
+	ASSERT_EQUAL(1, atomic_load(&check_inside_max));
+	ASSERT_EQUAL(6, atomic_load(&calls));
+	ASSERT_TRUE(cancel_requested());
+
+	cancel_set_check(NULL, NULL);
+	ASSERT_FALSE(cancel_requested());
+}
@@ -13,6 +13,10 @@
 #include <string.h>
 #include <unistd.h>
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
 #include "../../imgcat2/core/image.h"
 #include "../../imgcat2/core/pipeline.h"
 #include "../../imgcat2/decoders/magic.h"
@@ -104,6 +108,52 @@ CTEST(security, file_size_limit)
 	ASSERT_TRUE(true);
 }
 
+#ifndef _WIN32
+/**
+ * @brief Create a sparse file of the given size starting with a signature
+ */
+static bool create_sparse_file(const char *path, const uint8_t *magic, size_t magic_len, size_t size)
+{
+	FILE *fp = fopen(path, "wb");
+	if (fp == NULL) {
+		return false;
+	}
+
+	bool ok = fwrite(magic, 1, magic_len, fp) == magic_len && ftruncate(fileno(fp), (off_t)size) == 0;
+	fclose(fp);
+	return ok;
+}
+
+/**
+ * @test Test map_file_secure() keeps the regular limit for non-TIFF files
+ *
+ * Only TIFF may exceed IMAGE_MAX_FILE_SIZE when mapped; a PNG that large
+ * must be rejected before the Kitty passthrough or the cache see it.
+ */
+CTEST(security, mapped_size_limit_by_format)
+{
+	const char *temp_file = "/tmp/imgcat2_test_large_mapped.bin";
+	static const uint8_t png_magic[] = { 0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A };
+	static const uint8_t tiff_magic[] = { 'I', 'I', 0x2A, 0x00, 0x08, 0x00, 0x00, 0x00 };
+
+	uint8_t *data = NULL;
+	size_t size = 0;
+
+	if (create_sparse_file(temp_file, png_magic, sizeof(png_magic), IMAGE_MAX_FILE_SIZE + 1)) {
+		ASSERT_FALSE(map_file_secure(temp_file, &data, &size));
+		ASSERT_NULL(data);
+	}
+
+	if (create_sparse_file(temp_file, tiff_magic, sizeof(tiff_magic), IMAGE_MAX_FILE_SIZE + 1)) {
+		ASSERT_TRUE(map_file_secure(temp_file, &data, &size));
+		ASSERT_EQUAL(IMAGE_MAX_FILE_SIZE + 1, size);
+		munmap(data, size);
+	}
+
+	unlink(temp_file);
+}
+#endif
+
 /**
  * @test Test maximum image dimension validation
  *
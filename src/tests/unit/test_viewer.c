@@ -0,0 +1,161 @@
+/**
+ * @file test_viewer.c
+ * @brief Unit tests for the pan/zoom viewer's pyramid and sampling
+ *
+ * Checks pyramid level sizes and averaging, extending a pyramid for a
+ * smaller viewport, level selection for a zoom,
+ * and that sampling a panned viewport piecewise matches sampling it in
+ * one go.
+ */
+
+#include <string.h>
+
+#include "../../imgcat2/core/image.h"
+#include "../../imgcat2/core/viewer.h"
+#include "../ctest.h"
+
+/**
+ * @brief Image whose pixels encode their coordinates
+ */
+static image_t *make_gradient(uint32_t width, uint32_t height)
+{
+	image_t *img = image_create(width, height);
+	if (img == NULL) {
+		return NULL;
+	}
+
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			image_set_pixel(img, x, y, (uint8_t)x, (uint8_t)y, (uint8_t)(x ^ y), 255);
+		}
+	}
+
+	return img;
+}
+
+CTEST(viewer, pyramid_levels)
+{
+	image_t *img = make_gradient(101, 40);
+	ASSERT_TRUE(img != NULL);
+
+	viewer_pyramid_t pyramid;
+	ASSERT_EQUAL(0, viewer_pyramid_build(img, 20, 20, &pyramid));
+
+	/* 101x40 -> 51x20 -> 26x10 -> 13x5 */
+	ASSERT_EQUAL(4, pyramid.count);
+	ASSERT_EQUAL(51, (int)pyramid.levels[1]->width);
+	ASSERT_EQUAL(20, (int)pyramid.levels[1]->height);
+	ASSERT_EQUAL(13, (int)pyramid.levels[3]->width);
+	ASSERT_TRUE(pyramid.levels[0] == img);
+
+	/* Box filter: average of red values 0, 1, 0, 1 */
+	ASSERT_EQUAL(1, image_get_pixel(pyramid.levels[1], 0, 0)[0]);
+	/* Last column of an odd width repeats the edge pixel */
+	ASSERT_EQUAL(100, image_get_pixel(pyramid.levels[1], 50, 0)[0]);
+
+	viewer_pyramid_free(&pyramid);
+	ASSERT_EQUAL(1, pyramid.count);
+	image_destroy(img);
+}
+
+CTEST(viewer, pyramid_extend)
+{
+	image_t *img = make_gradient(256, 128);
+	ASSERT_TRUE(img != NULL);
+
+	viewer_pyramid_t pyramid;
+	ASSERT_EQUAL(0, viewer_pyramid_build(img, 64, 64, &pyramid));
+
+	/* 256x128 -> 128x64 -> 64x32 */
+	ASSERT_EQUAL(3, pyramid.count);
+	const image_t *level2 = pyramid.levels[2];
+
+	/* A smaller viewport adds levels below the existing ones */
+	ASSERT_EQUAL(0, viewer_pyramid_extend(&pyramid, 16, 16));
+	ASSERT_EQUAL(5, pyramid.count);
+	ASSERT_TRUE(pyramid.levels[2] == level2);
+	ASSERT_EQUAL(16, (int)pyramid.levels[4]->width);
+	ASSERT_EQUAL(8, (int)pyramid.levels[4]->height);
+
+	/* A larger one needs nothing */
+	ASSERT_EQUAL(0, viewer_pyramid_extend(&pyramid, 64, 64));
+	ASSERT_EQUAL(5, pyramid.count);
+
+	viewer_pyramid_free(&pyramid);
+	image_destroy(img);
+}
+
+CTEST(viewer, level_for_zoom)
+{
+	image_t *img = make_gradient(256, 256);
+	ASSERT_TRUE(img != NULL);
+
+	viewer_pyramid_t pyramid;
+	ASSERT_EQUAL(0, viewer_pyramid_build(img, 16, 16, &pyramid));
+	ASSERT_EQUAL(5, pyramid.count);
+
+	ASSERT_EQUAL(0, viewer_level_for_zoom(&pyramid, 4.0));
+	ASSERT_EQUAL(0, viewer_level_for_zoom(&pyramid, 0.6));
+	ASSERT_EQUAL(1, viewer_level_for_zoom(&pyramid, 0.5));
+	ASSERT_EQUAL(2, viewer_level_for_zoom(&pyramid, 0.2));
+	ASSERT_EQUAL(4, viewer_level_for_zoom(&pyramid, 0.001));
+
+	viewer_pyramid_free(&pyramid);
+	image_destroy(img);
+}
+
+CTEST(viewer, sample_actual_size)
+{
+	image_t *img = make_gradient(64, 64);
+	image_t *view = image_create(16, 8);
+	ASSERT_TRUE(img != NULL && view != NULL);
+
+	viewer_pyramid_t pyramid;
+	ASSERT_EQUAL(0, viewer_pyramid_build(img, 16, 8, &pyramid));
+
+	viewer_sample(&pyramid, 1.0, 10, 20, view, 0, 0, view->width, view->height);
+	ASSERT_EQUAL(10, image_get_pixel(view, 0, 0)[0]);
+	ASSERT_EQUAL(20, image_get_pixel(view, 0, 0)[1]);
+	ASSERT_EQUAL(25, image_get_pixel(view, 15, 7)[0]);
+	ASSERT_EQUAL(27, image_get_pixel(view, 15, 7)[1]);
+
+	/* Outside the image is transparent */
+	viewer_sample(&pyramid, 1.0, -4, 0, view, 0, 0, view->width, view->height);
+	ASSERT_EQUAL(0, image_get_pixel(view, 0, 0)[3]);
+	ASSERT_EQUAL(0, image_get_pixel(view, 4, 0)[0]);
+	ASSERT_EQUAL(255, image_get_pixel(view, 4, 0)[3]);
+
+	viewer_pyramid_free(&pyramid);
+	image_destroy(view);
+	image_destroy(img);
+}
+
+CTEST(viewer, incremental_pan_matches_full)
+{
+	image_t *img = make_gradient(200, 150);
+	image_t *full = image_create(40, 20);
+	image_t *part = image_create(40, 20);
+	ASSERT_TRUE(img != NULL && full != NULL && part != NULL);
+
+	viewer_pyramid_t pyramid;
+	ASSERT_EQUAL(0, viewer_pyramid_build(img, 40, 20, &pyramid));
+
+	double zoom = 0.7;
+
+	/* Sample at (30, 12), then pan by (+6, +4) reusing the overlap */
+	viewer_sample(&pyramid, zoom, 30, 12, part, 0, 0, 40, 20);
+	size_t stride = (size_t)part->width * 4;
+	for (uint32_t y = 0; y < part->height - 4; y++) {
+		memmove(&part->pixels[y * stride], &part->pixels[(y + 4) * stride + 6 * 4], (size_t)(part->width - 6) * 4);
+	}
+	viewer_sample(&pyramid, zoom, 36, 16, part, 34, 0, 40, 20);
+	viewer_sample(&pyramid, zoom, 36, 16, part, 0, 16, 40, 20);
+
+	viewer_sample(&pyramid, zoom, 36, 16, full, 0, 0, 40, 20);
+	ASSERT_EQUAL(0, memcmp(full->pixels, part->pixels, (size_t)full->width * full->height * 4));
+
+	viewer_pyramid_free(&pyramid);
+	image_destroy(part);
+	image_destroy(full);
+	image_destroy(img);
+}